@@ -0,0 +1,74 @@
+/*
+ * File:    Arena.c
+ * 
+ * Author:  David Petrovic
+ * 
+ * Description:
+ * 
+ * Simple bump allocator over a single pool allocation
+ */
+
+#include <Uefi.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/BaseMemoryLib.h>
+#include "Arena.h"
+
+/*
+ * ArenaCreate()
+ */
+EFI_STATUS ArenaCreate(ARENA *Arena, UINTN Size)
+{
+    if (!Arena || !Size) {
+        return EFI_INVALID_PARAMETER;
+    }
+    ZeroMem(Arena, sizeof(ARENA));
+    Arena->Pool = (UINT8 *)AllocatePool(Size + ARENA_DEFAULT_ALIGN);
+    if (!Arena->Pool) {
+        return EFI_OUT_OF_RESOURCES;
+    }
+    Arena->Base = (UINT8 *)ALIGN_VALUE((UINTN)Arena->Pool, ARENA_DEFAULT_ALIGN);
+    Arena->Size = Size;
+    return EFI_SUCCESS;
+}
+
+/*
+ * ArenaDestroy()
+ */
+VOID ArenaDestroy(ARENA *Arena)
+{
+    if (Arena) {
+        if (Arena->Pool) {
+            FreePool(Arena->Pool);
+        }
+        ZeroMem(Arena, sizeof(ARENA));
+    }
+}
+
+/*
+ * ArenaAlloc() - Align must be a power of 2, returns NULL when arena exhausted
+ */
+VOID *ArenaAlloc(ARENA *Arena, UINTN Size, UINTN Align)
+{
+    if (!Arena || !Arena->Base) {
+        return NULL;
+    }
+    if (!Align) {
+        Align = ARENA_DEFAULT_ALIGN;
+    }
+    UINTN Offset = ALIGN_VALUE(Arena->Used, Align);
+    if (Offset > Arena->Size || Size > Arena->Size - Offset) {
+        return NULL;
+    }
+    Arena->Used = Offset + Size;
+    return Arena->Base + Offset;
+}
+
+/*
+ * ArenaReset() - Release all allocations, keeping the pool
+ */
+VOID ArenaReset(ARENA *Arena)
+{
+    if (Arena) {
+        Arena->Used = 0;
+    }
+}
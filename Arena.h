@@ -0,0 +1,30 @@
+/*
+ * File:    Arena.h
+ * 
+ * Author:  David Petrovic
+ *
+ * Description:
+ * 
+ * Simple bump allocator over a single pool allocation
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <Uefi.h>
+
+#define ARENA_DEFAULT_ALIGN 64  // cache line
+
+typedef struct {
+    UINT8 *Pool;    // pool allocation
+    UINT8 *Base;    // aligned start of arena
+    UINTN Size;     // usable size in bytes
+    UINTN Used;     // bytes allocated so far
+} ARENA;
+
+EFI_STATUS ArenaCreate(ARENA *Arena, UINTN Size);
+VOID ArenaDestroy(ARENA *Arena);
+VOID *ArenaAlloc(ARENA *Arena, UINTN Size, UINTN Align);
+VOID ArenaReset(ARENA *Arena);
+
+#endif // ARENA_H
@@ -0,0 +1,285 @@
+/*
+ * File:    Bandwidth.c
+ * 
+ * Author:  David Petrovic
+ * 
+ * Description:
+ * 
+ * Raw sequential memory bandwidth of the framebuffer and system memory
+ */
+
+#include <Uefi.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Protocol/GraphicsOutput.h>
+#include "Bandwidth.h"
+#include "Arena.h"
+#include "Timer.h"
+
+STATIC UINT8 *FrameBuffer = NULL;   // NULL if no linear framebuffer
+STATIC UINTN BufferSize = 0;        // bytes of framebuffer covering visible lines
+STATIC ARENA SysMem;                // system memory buffers
+STATIC UINT8 *SysBuffer = NULL;
+STATIC UINT8 *SrcBuffer = NULL;     // copy source
+STATIC BANDWIDTH_RESULTS Results;
+
+/*
+ * InitBandwidth() - Locate framebuffer of current mode and allocate buffers
+ */
+EFI_STATUS InitBandwidth(VOID)
+{
+    EFI_STATUS Status;
+    EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop;
+
+    FreeBandwidth();
+    FrameBuffer = NULL;
+    Status = gBS->LocateProtocol(&gEfiGraphicsOutputProtocolGuid, NULL, (VOID **)&Gop);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *Info = Gop->Mode->Info;
+    BufferSize = ((UINTN)Info->PixelsPerScanLine * Info->VerticalResolution * sizeof(UINT32)) & ~(UINTN)15;
+    if (Info->PixelFormat != PixelBltOnly && BufferSize <= Gop->Mode->FrameBufferSize) {
+        FrameBuffer = (UINT8 *)(UINTN)Gop->Mode->FrameBufferBase;
+    }
+    Status = ArenaCreate(&SysMem, 2 * BufferSize + ARENA_DEFAULT_ALIGN);
+    if (EFI_ERROR(Status)) {
+        FrameBuffer = NULL;
+        return Status;
+    }
+    SysBuffer = (UINT8 *)ArenaAlloc(&SysMem, BufferSize, 0);
+    SrcBuffer = (UINT8 *)ArenaAlloc(&SysMem, BufferSize, 0);
+    SetMem(SrcBuffer, BufferSize, 0x55);
+    return EFI_SUCCESS;
+}
+
+/*
+ * FreeBandwidth() - Framebuffer details are kept for FramebufferPixels()
+ */
+VOID FreeBandwidth(VOID)
+{
+    ArenaDestroy(&SysMem);
+    SysBuffer = SrcBuffer = NULL;
+}
+
+/*
+ * Sequential kernels - Size is a multiple of 16 and buffers are 16 byte aligned
+ */
+STATIC VOID WriteBuffer(UINT8 *Dst, UINTN Size, BW_WIDTH Width, UINT32 Value)
+{
+    switch (Width) {
+    case BW_WIDTH_8: {
+        volatile UINT8 *p = Dst;
+        for (UINTN i = 0; i < Size; i++) p[i] = (UINT8)Value;
+        break;
+    }
+    case BW_WIDTH_32: {
+        volatile UINT32 *p = (UINT32 *)Dst;
+        for (UINTN i = 0; i < Size / 4; i++) p[i] = Value;
+        break;
+    }
+    case BW_WIDTH_64: {
+        volatile UINT64 *p = (UINT64 *)Dst;
+        UINT64 v = ((UINT64)Value << 32) | Value;
+        for (UINTN i = 0; i < Size / 8; i++) p[i] = v;
+        break;
+    }
+    case BW_WIDTH_128:
+        asm volatile ("movd %0, %%xmm0\n\tpshufd $0, %%xmm0, %%xmm0" :: "r" (Value) : "xmm0");
+        for (UINT8 *p = Dst; p < Dst + Size; p += 16) {
+            asm volatile ("movdqa %%xmm0, (%0)" :: "r" (p) : "memory");
+        }
+        break;
+    case BW_WIDTH_128_NT:
+        asm volatile ("movd %0, %%xmm0\n\tpshufd $0, %%xmm0, %%xmm0" :: "r" (Value) : "xmm0");
+        for (UINT8 *p = Dst; p < Dst + Size; p += 16) {
+            asm volatile ("movntdq %%xmm0, (%0)" :: "r" (p) : "memory");
+        }
+        asm volatile ("sfence" ::: "memory");
+        break;
+    default:
+        break;
+    }
+}
+
+STATIC VOID ReadBuffer(UINT8 *Src, UINTN Size, BW_WIDTH Width)
+{
+    switch (Width) {
+    case BW_WIDTH_8: {
+        volatile UINT8 *p = Src;
+        for (UINTN i = 0; i < Size; i++) (VOID)p[i];
+        break;
+    }
+    case BW_WIDTH_32: {
+        volatile UINT32 *p = (UINT32 *)Src;
+        for (UINTN i = 0; i < Size / 4; i++) (VOID)p[i];
+        break;
+    }
+    case BW_WIDTH_64: {
+        volatile UINT64 *p = (UINT64 *)Src;
+        for (UINTN i = 0; i < Size / 8; i++) (VOID)p[i];
+        break;
+    }
+    case BW_WIDTH_128:
+        for (UINT8 *p = Src; p < Src + Size; p += 16) {
+            asm volatile ("movdqa (%0), %%xmm0" :: "r" (p) : "xmm0", "memory");
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+STATIC VOID CopyBuffer(UINT8 *Dst, UINT8 *Src, UINTN Size, BW_WIDTH Width)
+{
+    switch (Width) {
+    case BW_WIDTH_8: {
+        volatile UINT8 *d = Dst;
+        volatile UINT8 *s = Src;
+        for (UINTN i = 0; i < Size; i++) d[i] = s[i];
+        break;
+    }
+    case BW_WIDTH_32: {
+        volatile UINT32 *d = (UINT32 *)Dst;
+        volatile UINT32 *s = (UINT32 *)Src;
+        for (UINTN i = 0; i < Size / 4; i++) d[i] = s[i];
+        break;
+    }
+    case BW_WIDTH_64: {
+        volatile UINT64 *d = (UINT64 *)Dst;
+        volatile UINT64 *s = (UINT64 *)Src;
+        for (UINTN i = 0; i < Size / 8; i++) d[i] = s[i];
+        break;
+    }
+    case BW_WIDTH_128:
+        for (UINTN i = 0; i < Size; i += 16) {
+            asm volatile ("movdqa (%1), %%xmm0\n\tmovdqa %%xmm0, (%0)" :: "r" (Dst + i), "r" (Src + i) : "xmm0", "memory");
+        }
+        break;
+    case BW_WIDTH_128_NT:
+        for (UINTN i = 0; i < Size; i += 16) {
+            asm volatile ("movdqa (%1), %%xmm0\n\tmovntdq %%xmm0, (%0)" :: "r" (Dst + i), "r" (Src + i) : "xmm0", "memory");
+        }
+        asm volatile ("sfence" ::: "memory");
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * MeasureProbe() - Repeat kernel for BW_PROBE_MS, returns MB/s or 0 if not supported
+ */
+STATIC UINT64 MeasureProbe(UINT8 *Target, BW_OP Op, BW_WIDTH Width)
+{
+    if (Op == BW_READ && Width == BW_WIDTH_128_NT) {
+        return 0;   // non-temporal loads need SSE4.1
+    }
+    UINT64 Ticks = BW_PROBE_MS * GetTimerFreq() / 1000;
+    UINT64 Bytes = 0;
+    UINT64 StartTime = ReadTimer();
+    UINT64 EndTime;
+    do {
+        switch (Op) {
+        case BW_WRITE:
+            WriteBuffer(Target, BufferSize, Width, 0);
+            break;
+        case BW_READ:
+            ReadBuffer(Target, BufferSize, Width);
+            break;
+        case BW_COPY:
+            CopyBuffer(Target, SrcBuffer, BufferSize, Width);
+            break;
+        default:
+            break;
+        }
+        Bytes += BufferSize;
+        EndTime = ReadTimer();
+    } while (EndTime - StartTime < Ticks);
+    UINT64 TimeNs = CalcNsTime(EndTime, StartTime);
+    return TimeNs ? (Bytes * 1000 + TimeNs/2) / TimeNs : 0;
+}
+
+/*
+ * RunBandwidthProbes() - Measure all probes once per mode
+ */
+VOID RunBandwidthProbes(VOID)
+{
+    if (Results.Valid || !SysBuffer) {
+        return;
+    }
+    for (UINTN t = 0; t < NUM_BW_TARGETS; t++) {
+        UINT8 *Target = (t == BW_FRAMEBUFFER) ? FrameBuffer : SysBuffer;
+        if (!Target) {
+            continue;
+        }
+        for (UINTN o = 0; o < NUM_BW_OPS; o++) {
+            for (UINTN w = 0; w < NUM_BW_WIDTHS; w++) {
+                Results.MBps[t][o][w] = MeasureProbe(Target, o, w);
+            }
+        }
+    }
+    for (UINTN w = 0; w < NUM_BW_WIDTHS; w++) {
+        if (Results.MBps[BW_FRAMEBUFFER][BW_WRITE][w] > Results.PeakMBps) {
+            Results.PeakMBps = Results.MBps[BW_FRAMEBUFFER][BW_WRITE][w];
+            Results.PeakWidth = w;
+        }
+    }
+    Results.Valid = TRUE;
+}
+
+/*
+ * GetBandwidthResults()
+ */
+VOID GetBandwidthResults(BANDWIDTH_RESULTS *Res)
+{
+    CopyMem(Res, &Results, sizeof(BANDWIDTH_RESULTS));
+}
+
+/*
+ * ResetBandwidthResults()
+ */
+VOID ResetBandwidthResults(VOID)
+{
+    ZeroMem(&Results, sizeof(BANDWIDTH_RESULTS));
+}
+
+/*
+ * FillFramebuffer() - Whole framebuffer with the fastest measured store width
+ */
+VOID FillFramebuffer(UINT32 Colour)
+{
+    if (FrameBuffer && SysBuffer) {
+        WriteBuffer(FrameBuffer, BufferSize, Results.Valid ? Results.PeakWidth : BW_WIDTH_64, Colour);
+    }
+}
+
+/*
+ * FramebufferPixels() - Pixels written by FillFramebuffer()
+ */
+UINT64 FramebufferPixels(VOID)
+{
+    return FrameBuffer ? BufferSize / sizeof(UINT32) : 0;
+}
+
+/*
+ * GetBwWidthDesc()
+ */
+CHAR16 *GetBwWidthDesc(BW_WIDTH Width)
+{
+    switch (Width) {
+    case BW_WIDTH_8:
+        return L"8-bit";
+    case BW_WIDTH_32:
+        return L"32-bit";
+    case BW_WIDTH_64:
+        return L"64-bit";
+    case BW_WIDTH_128:
+        return L"128-bit";
+    case BW_WIDTH_128_NT:
+        return L"128-bit NT";
+    default:
+        break;
+    }
+    return L"Unknown";
+}
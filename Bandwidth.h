@@ -0,0 +1,56 @@
+/*
+ * File:    Bandwidth.h
+ * 
+ * Author:  David Petrovic
+ *
+ * Description:
+ * 
+ * Raw sequential memory bandwidth of the framebuffer and system memory
+ */
+
+#ifndef BANDWIDTH_H
+#define BANDWIDTH_H
+
+#include <Uefi.h>
+
+#define BW_PROBE_MS     50  // measuring time of each probe
+
+typedef enum {
+    BW_FRAMEBUFFER=0,   // GOP framebuffer
+    BW_SYSMEM,          // system memory buffer the size of the framebuffer
+    NUM_BW_TARGETS
+} BW_TARGET;
+
+typedef enum {
+    BW_WRITE=0,         // sequential stores
+    BW_READ,            // sequential loads
+    BW_COPY,            // system memory to target
+    NUM_BW_OPS
+} BW_OP;
+
+typedef enum {
+    BW_WIDTH_8=0,
+    BW_WIDTH_32,
+    BW_WIDTH_64,
+    BW_WIDTH_128,       // SSE2
+    BW_WIDTH_128_NT,    // SSE2 non-temporal stores
+    NUM_BW_WIDTHS
+} BW_WIDTH;
+
+typedef struct {
+    BOOLEAN Valid;      // true if probes have been run
+    UINT64 MBps[NUM_BW_TARGETS][NUM_BW_OPS][NUM_BW_WIDTHS]; // 0 if not measured
+    UINT64 PeakMBps;    // best framebuffer write
+    BW_WIDTH PeakWidth;
+} BANDWIDTH_RESULTS;
+
+EFI_STATUS InitBandwidth(VOID);
+VOID FreeBandwidth(VOID);
+VOID RunBandwidthProbes(VOID);
+VOID GetBandwidthResults(BANDWIDTH_RESULTS *Results);
+VOID ResetBandwidthResults(VOID);
+VOID FillFramebuffer(UINT32 Colour);
+UINT64 FramebufferPixels(VOID);
+CHAR16 *GetBwWidthDesc(BW_WIDTH Width);
+
+#endif // BANDWIDTH_H
@@ -0,0 +1,203 @@
+/*
+ * File:    Baseline.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Previous JSON results loaded for throughput regression checks
+ *
+ * Only the results JSON written by this program is understood. Each test
+ * entry is keyed by the last resolution, test and run names seen before its
+ * iterPerSec value, so other fields and their order don't matter.
+ */
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/ShellLib.h>
+#include "Baseline.h"
+
+#define MAX_BASELINE_SIZE   (4 * 1024 * 1024)
+
+/*
+ * KeyIs() - Compare a JSON key that isn't NUL terminated
+ */
+STATIC BOOLEAN KeyIs(IN CONST CHAR8 *Key, IN UINTN KeyLen, IN CONST CHAR8 *Name)
+{
+    return KeyLen == AsciiStrLen(Name) && AsciiStrnCmp(Key, Name, KeyLen) == 0;
+}
+
+/*
+ * CopyName() - Copy an ASCII JSON string value to a name, truncating
+ */
+STATIC VOID CopyName(OUT CHAR16 *Name, IN CONST CHAR8 *Value, IN UINTN ValueLen)
+{
+    UINTN i;
+
+    for (i = 0; i < ValueLen && i < BASELINE_NAME_LEN - 1; i++) {
+        Name[i] = (CHAR16)Value[i];
+    }
+    Name[i] = L'\0';
+}
+
+/*
+ * SkipSpace()
+ */
+STATIC CONST CHAR8 *SkipSpace(IN CONST CHAR8 *p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+        p++;
+    }
+    return p;
+}
+
+/*
+ * ParseBaseline() - Scan JSON text for test entries, which are only counted
+ *                   if Entries is NULL
+ */
+STATIC UINT32 ParseBaseline(IN CONST CHAR8 *Text, OUT BASELINE_ENTRY *Entries)
+{
+    BASELINE_ENTRY Cur;
+    UINT32 Num = 0;
+    CONST CHAR8 *p = Text;
+
+    ZeroMem(&Cur, sizeof(BASELINE_ENTRY));
+    while (*p) {
+        if (*p != '"') {
+            p++;
+            continue;
+        }
+        // names written by this program have no escapes
+        CONST CHAR8 *Key = ++p;
+        while (*p && *p != '"') {
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+        UINTN KeyLen = p - Key;
+        p = SkipSpace(p + 1);
+        if (*p != ':') {
+            continue;       // string value or array element
+        }
+        p = SkipSpace(p + 1);
+        if (*p == '"') {
+            CONST CHAR8 *Value = ++p;
+            while (*p && *p != '"') {
+                p++;
+            }
+            if (!*p) {
+                break;
+            }
+            if (KeyIs(Key, KeyLen, "test")) {
+                CopyName(Cur.Test, Value, p - Value);
+            } else if (KeyIs(Key, KeyLen, "run")) {
+                CopyName(Cur.Run, Value, p - Value);
+            }
+            p++;
+        } else {
+            UINT64 Value = 0;
+            while (*p >= '0' && *p <= '9') {
+                Value = Value * 10 + (*p - '0');
+                p++;
+            }
+            if (KeyIs(Key, KeyLen, "horRes")) {
+                Cur.HorRes = (UINT32)Value;
+            } else if (KeyIs(Key, KeyLen, "verRes")) {
+                Cur.VerRes = (UINT32)Value;
+            } else if (KeyIs(Key, KeyLen, "iterPerSec")) {
+                if (Entries) {
+                    Cur.IterPerSec = Value;
+                    Entries[Num] = Cur;
+                }
+                Num++;
+            }
+        }
+    }
+    return Num;
+}
+
+/*
+ * CreateBaseline() - Load test throughput from a JSON results file
+ */
+EFI_STATUS CreateBaseline(IN CHAR16 *Filename, OUT BASELINE *Baseline)
+{
+    EFI_STATUS Status;
+    SHELL_FILE_HANDLE FileHandle = NULL;
+    CHAR8 *Text = NULL;
+    UINT64 Size;
+
+    ZeroMem(Baseline, sizeof(BASELINE));
+    Status = ShellOpenFileByName(Filename, &FileHandle, EFI_FILE_MODE_READ, 0);
+    if (EFI_ERROR(Status)) {
+        goto Error_exit;
+    }
+    Status = ShellGetFileSize(FileHandle, &Size);
+    if (EFI_ERROR(Status)) {
+        goto Error_exit;
+    }
+    if (Size > MAX_BASELINE_SIZE) {
+        Status = EFI_BAD_BUFFER_SIZE;
+        goto Error_exit;
+    }
+    Text = (CHAR8 *)AllocatePool((UINTN)Size + 1);
+    if (!Text) {
+        Status = EFI_OUT_OF_RESOURCES;
+        goto Error_exit;
+    }
+    UINTN ReadSize = (UINTN)Size;
+    Status = ShellReadFile(FileHandle, &ReadSize, Text);
+    if (EFI_ERROR(Status)) {
+        goto Error_exit;
+    }
+    Text[ReadSize] = '\0';
+
+    UINT32 Num = ParseBaseline(Text, NULL);
+    if (!Num) {
+        Status = EFI_NOT_FOUND;
+        goto Error_exit;
+    }
+    Baseline->Entries = (BASELINE_ENTRY *)AllocatePool(Num * sizeof(BASELINE_ENTRY));
+    if (!Baseline->Entries) {
+        Status = EFI_OUT_OF_RESOURCES;
+        goto Error_exit;
+    }
+    Baseline->Num = ParseBaseline(Text, Baseline->Entries);
+
+Error_exit:
+    if (Text) {
+        FreePool(Text);
+    }
+    if (FileHandle) {
+        ShellCloseFile(&FileHandle);
+    }
+    return Status;
+}
+
+/*
+ * DestroyBaseline()
+ */
+VOID DestroyBaseline(IN BASELINE *Baseline)
+{
+    if (Baseline->Entries) {
+        FreePool(Baseline->Entries);
+        Baseline->Entries = NULL;
+    }
+    Baseline->Num = 0;
+}
+
+/*
+ * FindBaseline() - Entry for a test run at a resolution, NULL if not present
+ */
+BASELINE_ENTRY *FindBaseline(IN BASELINE *Baseline, IN UINT32 HorRes, IN UINT32 VerRes, IN CONST CHAR16 *Test, IN CONST CHAR16 *Run)
+{
+    for (UINT32 i = 0; i < Baseline->Num; i++) {
+        BASELINE_ENTRY *Entry = &Baseline->Entries[i];
+        if (Entry->HorRes == HorRes && Entry->VerRes == VerRes && StrCmp(Entry->Test, Test) == 0 && StrCmp(Entry->Run, Run) == 0) {
+            return Entry;
+        }
+    }
+    return NULL;
+}
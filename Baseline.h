@@ -0,0 +1,35 @@
+/*
+ * File:    Baseline.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Previous JSON results loaded for throughput regression checks
+ */
+
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include <Uefi.h>
+
+#define BASELINE_NAME_LEN   32
+
+typedef struct {
+    UINT32 HorRes;
+    UINT32 VerRes;
+    CHAR16 Test[BASELINE_NAME_LEN];     // test description
+    CHAR16 Run[BASELINE_NAME_LEN];      // inline, pregen or cold
+    UINT64 IterPerSec;
+} BASELINE_ENTRY;
+
+typedef struct {
+    BASELINE_ENTRY *Entries;
+    UINT32 Num;
+} BASELINE;
+
+EFI_STATUS CreateBaseline(IN CHAR16 *Filename, OUT BASELINE *Baseline);
+VOID DestroyBaseline(IN BASELINE *Baseline);
+BASELINE_ENTRY *FindBaseline(IN BASELINE *Baseline, IN UINT32 HorRes, IN UINT32 VerRes, IN CONST CHAR16 *Test, IN CONST CHAR16 *Run);
+
+#endif // BASELINE_H
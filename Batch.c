@@ -0,0 +1,623 @@
+/*
+ * File:    Batch.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Batched drawing of pixels, lines, filled rectangles, filled triangles and
+ * circles from arrays, and strings from a glyph cache
+ */
+
+#include <Uefi.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Protocol/GraphicsOutput.h>
+#include "GraphicsLib/Graphics.h"
+#include "GraphicsLib/Font.h"
+#include "Batch.h"
+#include "Fill.h"
+#include "Parallel.h"
+
+#define SUBPIXEL_BITS   4           // fraction bits of triangle vertices
+#define RASTER_BLOCK    8           // pixels per side of a triangle block
+#define TO_FIXED(v)     ((INT64)(v) * (1 << SUBPIXEL_BITS))
+
+// filled rectangle split into tiles across CPUs
+typedef struct {
+    UINT32 *FrameBuffer;
+    UINTN Stride;
+    UINT32 Value;
+    UINT64 Bytes;           // size of the whole fill
+} FILL_JOB;
+
+// edge function A x + B y + C of pixel x, y, in fixed point, not negative
+// inside the triangle
+typedef struct {
+    INT64 StepX;            // A, per pixel across
+    INT64 StepY;            // B, per pixel down
+    INT64 Origin;           // value at pixel 0, 0
+} EDGE;
+
+// triangle set up for drawing, in tiles across CPUs if large
+typedef struct {
+    BATCH_TARGET *Target;
+    EDGE Edge[3];
+    UINT32 Value;
+} TRIANGLE_JOB;
+
+/*
+ * InitBatchTarget() - Look up the framebuffer of the current mode, the clip
+ *                     window must match the graphics library
+ */
+EFI_STATUS InitBatchTarget(OUT BATCH_TARGET *Target, IN INT32 ClipX0, IN INT32 ClipY0, IN INT32 ClipX1, IN INT32 ClipY1)
+{
+    EFI_STATUS Status;
+    EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop;
+
+    ZeroMem(Target, sizeof(BATCH_TARGET));
+    Target->ClipX0 = ClipX0;
+    Target->ClipY0 = ClipY0;
+    Target->ClipX1 = ClipX1;
+    Target->ClipY1 = ClipY1;
+    Status = gBS->LocateProtocol(&gEfiGraphicsOutputProtocolGuid, NULL, (VOID **)&Gop);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *Info = Gop->Mode->Info;
+    UINTN Size = (UINTN)Info->PixelsPerScanLine * Info->VerticalResolution * sizeof(UINT32);
+    if ((Info->PixelFormat == PixelBlueGreenRedReserved8BitPerColor || Info->PixelFormat == PixelRedGreenBlueReserved8BitPerColor) &&
+        Size <= Gop->Mode->FrameBufferSize) {
+        Target->FrameBuffer = (UINT32 *)(UINTN)Gop->Mode->FrameBufferBase;
+        Target->Stride = Info->PixelsPerScanLine;
+        Target->SwapRB = (Info->PixelFormat == PixelRedGreenBlueReserved8BitPerColor);
+    }
+    return EFI_SUCCESS;
+}
+
+/*
+ * FbColour() - Framebuffer pixel value of a 0xRRGGBB colour
+ */
+STATIC UINT32 FbColour(IN BOOLEAN SwapRB, IN UINT32 Colour)
+{
+    return SwapRB ? ((Colour & 0xFF) << 16) | (Colour & 0xFF00) | ((Colour >> 16) & 0xFF) : Colour;
+}
+
+/*
+ * BatchPutPixels()
+ */
+VOID BatchPutPixels(IN BATCH_TARGET *Target, IN CONST BATCH_POINT *Points, IN UINTN Num)
+{
+    UINT32 *Fb = Target->FrameBuffer;
+
+    if (!Fb) {
+        for (UINTN i = 0; i < Num; i++) {
+            PutPixel(Points[i].x, Points[i].y, Points[i].Colour);
+        }
+        return;
+    }
+    // one unsigned compare per axis against the clip window
+    INT32 x0 = Target->ClipX0;
+    INT32 y0 = Target->ClipY0;
+    UINT32 Width = (UINT32)(Target->ClipX1 - x0);
+    UINT32 Height = (UINT32)(Target->ClipY1 - y0);
+    UINTN Stride = Target->Stride;
+    BOOLEAN SwapRB = Target->SwapRB;
+    for (UINTN i = 0; i < Num; i++) {
+        CONST BATCH_POINT *p = &Points[i];
+        if ((UINT32)(p->x - x0) <= Width && (UINT32)(p->y - y0) <= Height) {
+            Fb[(UINTN)p->y * Stride + p->x] = FbColour(SwapRB, p->Colour);
+        }
+    }
+}
+
+/*
+ * DrawSpan() - Horizontal span x0...x1 inclusive, clipped
+ */
+STATIC VOID DrawSpan(IN BATCH_TARGET *Target, IN INT32 x0, IN INT32 x1, IN INT32 y, IN UINT32 Value)
+{
+    if (y < Target->ClipY0 || y > Target->ClipY1) return;
+    if (x0 > x1) {
+        INT32 t = x0; x0 = x1; x1 = t;
+    }
+    if (x0 < Target->ClipX0) x0 = Target->ClipX0;
+    if (x1 > Target->ClipX1) x1 = Target->ClipX1;
+    if (x1 >= x0) {
+        FillRect32(&Target->FrameBuffer[(UINTN)y * Target->Stride + x0], Target->Stride, x1 - x0 + 1, 1, Value);
+    }
+}
+
+/*
+ * DrawColumn() - Vertical span y0...y1 inclusive, clipped
+ */
+STATIC VOID DrawColumn(IN BATCH_TARGET *Target, IN INT32 x, IN INT32 y0, IN INT32 y1, IN UINT32 Value)
+{
+    if (x < Target->ClipX0 || x > Target->ClipX1) return;
+    if (y0 > y1) {
+        INT32 t = y0; y0 = y1; y1 = t;
+    }
+    if (y0 < Target->ClipY0) y0 = Target->ClipY0;
+    if (y1 > Target->ClipY1) y1 = Target->ClipY1;
+    if (y1 < y0) return;
+    UINTN Stride = Target->Stride;
+    UINT32 *p = &Target->FrameBuffer[(UINTN)y0 * Stride + x];
+    for (INT32 y = y0; y <= y1; y++, p += Stride) {
+        *p = Value;
+    }
+}
+
+/*
+ * BatchDrawLines() - Bresenham, one pixel per step along the major axis
+ *
+ * Lines inside the clip window step a framebuffer pointer with no bounds
+ * checks, others check each pixel.
+ */
+VOID BatchDrawLines(IN BATCH_TARGET *Target, IN CONST BATCH_LINE *Lines, IN UINTN Num)
+{
+    UINT32 *Fb = Target->FrameBuffer;
+
+    if (!Fb) {
+        for (UINTN i = 0; i < Num; i++) {
+            DrawLine(Lines[i].x0, Lines[i].y0, Lines[i].x1, Lines[i].y1, Lines[i].Colour);
+        }
+        return;
+    }
+    INT32 cx0 = Target->ClipX0;
+    INT32 cy0 = Target->ClipY0;
+    INT32 cx1 = Target->ClipX1;
+    INT32 cy1 = Target->ClipY1;
+    UINTN Stride = Target->Stride;
+    BOOLEAN SwapRB = Target->SwapRB;
+    for (UINTN i = 0; i < Num; i++) {
+        INT32 x0 = Lines[i].x0;
+        INT32 y0 = Lines[i].y0;
+        INT32 x1 = Lines[i].x1;
+        INT32 y1 = Lines[i].y1;
+        UINT32 Value = FbColour(SwapRB, Lines[i].Colour);
+        if (y0 == y1) {
+            DrawSpan(Target, x0, x1, y0, Value);
+            continue;
+        }
+        if (x0 == x1) {
+            DrawColumn(Target, x0, y0, y1, Value);
+            continue;
+        }
+        INT32 dx = ABS(x1 - x0);
+        INT32 dy = -ABS(y1 - y0);
+        INT32 sx = x0 < x1 ? 1 : -1;
+        INT32 sy = y0 < y1 ? 1 : -1;
+        INT32 err = dx + dy;
+        if (MIN(x0, x1) >= cx0 && MAX(x0, x1) <= cx1 && MIN(y0, y1) >= cy0 && MAX(y0, y1) <= cy1) {
+            UINT32 *p = &Fb[(UINTN)y0 * Stride + x0];
+            INTN Step = sy > 0 ? (INTN)Stride : -(INTN)Stride;
+            while (TRUE) {
+                *p = Value;
+                if (x0 == x1 && y0 == y1) break;
+                INT32 e2 = 2 * err;
+                if (e2 >= dy) { err += dy; x0 += sx; p += sx; }
+                if (e2 <= dx) { err += dx; y0 += sy; p += Step; }
+            }
+        } else {
+            while (TRUE) {
+                if (x0 >= cx0 && x0 <= cx1 && y0 >= cy0 && y0 <= cy1) {
+                    Fb[(UINTN)y0 * Stride + x0] = Value;
+                }
+                if (x0 == x1 && y0 == y1) break;
+                INT32 e2 = 2 * err;
+                if (e2 >= dy) { err += dy; x0 += sx; }
+                if (e2 <= dx) { err += dx; y0 += sy; }
+            }
+        }
+    }
+}
+
+/*
+ * FillTile() - One tile of a filled rectangle
+ */
+STATIC VOID FillTile(IN VOID *Context, IN INT32 x0, IN INT32 y0, IN INT32 x1, IN INT32 y1)
+{
+    FILL_JOB *Job = (FILL_JOB *)Context;
+
+    FillRect32Part(&Job->FrameBuffer[(UINTN)y0 * Job->Stride + x0], Job->Stride, x1 - x0 + 1, y1 - y0 + 1, Job->Value, Job->Bytes);
+}
+
+/*
+ * BatchDrawFillRectangles() - Clipped rows filled by the selected fill
+ *                             kernel, large rectangles in tiles across CPUs
+ */
+VOID BatchDrawFillRectangles(IN BATCH_TARGET *Target, IN CONST BATCH_RECT *Rects, IN UINTN Num)
+{
+    UINT32 *Fb = Target->FrameBuffer;
+
+    if (!Fb) {
+        for (UINTN i = 0; i < Num; i++) {
+            DrawFillRectangle(Rects[i].x0, Rects[i].y0, Rects[i].x1, Rects[i].y1, Rects[i].Colour);
+        }
+        return;
+    }
+    INT32 cx0 = Target->ClipX0;
+    INT32 cy0 = Target->ClipY0;
+    INT32 cx1 = Target->ClipX1;
+    INT32 cy1 = Target->ClipY1;
+    UINTN Stride = Target->Stride;
+    BOOLEAN SwapRB = Target->SwapRB;
+    for (UINTN i = 0; i < Num; i++) {
+        CONST BATCH_RECT *r = &Rects[i];
+        INT32 xmin = MAX(MIN(r->x0, r->x1), cx0);
+        INT32 xmax = MIN(MAX(r->x0, r->x1), cx1);
+        INT32 ymin = MAX(MIN(r->y0, r->y1), cy0);
+        INT32 ymax = MIN(MAX(r->y0, r->y1), cy1);
+        if (xmin > xmax || ymin > ymax) {
+            continue;
+        }
+        FILL_JOB Job = { Fb, Stride, FbColour(SwapRB, r->Colour), (UINT64)(xmax - xmin + 1) * (ymax - ymin + 1) * sizeof(UINT32) };
+        ParallelTiles(xmin, ymin, xmax, ymax, FillTile, &Job);
+    }
+}
+
+/*
+ * FillTargetClip() - Whole clip window, the screen if not clipped
+ */
+VOID FillTargetClip(IN BATCH_TARGET *Target, IN UINT32 Colour)
+{
+    BATCH_RECT Rect = { Target->ClipX0, Target->ClipY0, Target->ClipX1, Target->ClipY1, Colour };
+
+    BatchDrawFillRectangles(Target, &Rect, 1);
+}
+
+/*
+ * SetupEdge() - Edge function from a to b of a clockwise triangle
+ *
+ * Pixel centres are at whole fixed point coordinates. Pixels on a top or
+ * left edge are inside and on any other edge outside, the bias of -1 makes
+ * a value of 0 fail the not negative test.
+ */
+STATIC VOID SetupEdge(OUT EDGE *Edge, IN INT64 ax, IN INT64 ay, IN INT64 bx, IN INT64 by)
+{
+    INT64 A = ay - by;
+    INT64 B = bx - ax;
+    BOOLEAN TopLeft = (A > 0) || (A == 0 && B > 0);
+
+    Edge->StepX = TO_FIXED(A);
+    Edge->StepY = TO_FIXED(B);
+    Edge->Origin = -(A * ax + B * ay) - (TopLeft ? 0 : 1);
+}
+
+/*
+ * TriangleTile() - Draw the part of a triangle inside a rectangle of the
+ *                  clipped bounding box, 8x8 blocks at a time
+ */
+STATIC VOID TriangleTile(IN VOID *Context, IN INT32 x0, IN INT32 y0, IN INT32 x1, IN INT32 y1)
+{
+    TRIANGLE_JOB *Job = (TRIANGLE_JOB *)Context;
+    EDGE *Edge = Job->Edge;
+    UINT32 *Fb = Job->Target->FrameBuffer;
+    UINTN Stride = Job->Target->Stride;
+    UINT32 Value = Job->Value;
+    INT64 Reject[3], Accept[3];
+
+    // offsets from a block's top left to the corners where each edge
+    // function is greatest and least
+    for (UINTN i = 0; i < 3; i++) {
+        INT64 dx = Edge[i].StepX * (RASTER_BLOCK - 1);
+        INT64 dy = Edge[i].StepY * (RASTER_BLOCK - 1);
+        Reject[i] = MAX(dx, 0) + MAX(dy, 0);
+        Accept[i] = MIN(dx, 0) + MIN(dy, 0);
+    }
+    INT32 bx0 = x0 & ~(RASTER_BLOCK - 1);
+    for (INT32 by = y0 & ~(RASTER_BLOCK - 1); by <= y1; by += RASTER_BLOCK) {
+        INT32 ry0 = MAX(by, y0);
+        INT32 ry1 = MIN(by + RASTER_BLOCK - 1, y1);
+        INT64 e[3];
+        for (UINTN i = 0; i < 3; i++) {
+            e[i] = Edge[i].Origin + Edge[i].StepX * bx0 + Edge[i].StepY * by;
+        }
+        // run of accepted blocks, filled when a block breaks it
+        INT32 RunX0 = 0;
+        INT32 RunX1 = -1;
+        for (INT32 bx = bx0; bx <= x1; bx += RASTER_BLOCK) {
+            INT32 cx0 = MAX(bx, x0);
+            INT32 cx1 = MIN(bx + RASTER_BLOCK - 1, x1);
+            BOOLEAN Outside = (e[0] + Reject[0] < 0) || (e[1] + Reject[1] < 0) || (e[2] + Reject[2] < 0);
+            BOOLEAN Inside = (e[0] + Accept[0] >= 0) && (e[1] + Accept[1] >= 0) && (e[2] + Accept[2] >= 0);
+            if (Inside) {
+                if (RunX1 < RunX0) {
+                    RunX0 = cx0;
+                }
+                RunX1 = cx1;
+            } else {
+                if (RunX1 >= RunX0) {
+                    FillRect32(&Fb[(UINTN)ry0 * Stride + RunX0], Stride, RunX1 - RunX0 + 1, ry1 - ry0 + 1, Value);
+                    RunX1 = RunX0 - 1;
+                }
+                if (!Outside) {
+                    // edge block, the inside of each row is one span as the
+                    // triangle is convex
+                    INT64 r0 = e[0] + Edge[0].StepX * (cx0 - bx) + Edge[0].StepY * (ry0 - by);
+                    INT64 r1 = e[1] + Edge[1].StepX * (cx0 - bx) + Edge[1].StepY * (ry0 - by);
+                    INT64 r2 = e[2] + Edge[2].StepX * (cx0 - bx) + Edge[2].StepY * (ry0 - by);
+                    for (INT32 y = ry0; y <= ry1; y++) {
+                        UINT32 *p = &Fb[(UINTN)y * Stride + cx0];
+                        INT64 p0 = r0, p1 = r1, p2 = r2;
+                        INT32 x = cx0;
+                        while (x <= cx1 && (p0 | p1 | p2) < 0) {
+                            p0 += Edge[0].StepX;
+                            p1 += Edge[1].StepX;
+                            p2 += Edge[2].StepX;
+                            x++;
+                            p++;
+                        }
+                        while (x <= cx1 && (p0 | p1 | p2) >= 0) {
+                            *p++ = Value;
+                            p0 += Edge[0].StepX;
+                            p1 += Edge[1].StepX;
+                            p2 += Edge[2].StepX;
+                            x++;
+                        }
+                        r0 += Edge[0].StepY;
+                        r1 += Edge[1].StepY;
+                        r2 += Edge[2].StepY;
+                    }
+                }
+            }
+            for (UINTN i = 0; i < 3; i++) {
+                e[i] += Edge[i].StepX * RASTER_BLOCK;
+            }
+        }
+        if (RunX1 >= RunX0) {
+            FillRect32(&Fb[(UINTN)ry0 * Stride + RunX0], Stride, RunX1 - RunX0 + 1, ry1 - ry0 + 1, Value);
+        }
+    }
+}
+
+/*
+ * BatchDrawFillTriangles() - Half-space rasterizer with the top-left rule,
+ *                            large triangles in tiles across CPUs
+ */
+VOID BatchDrawFillTriangles(IN BATCH_TARGET *Target, IN CONST BATCH_TRIANGLE *Triangles, IN UINTN Num)
+{
+    TRIANGLE_JOB Job;
+
+    if (!Target->FrameBuffer) {
+        for (UINTN i = 0; i < Num; i++) {
+            CONST BATCH_TRIANGLE *t = &Triangles[i];
+            DrawFillTriangle(t->x0, t->y0, t->x1, t->y1, t->x2, t->y2, t->Colour);
+        }
+        return;
+    }
+    Job.Target = Target;
+    for (UINTN i = 0; i < Num; i++) {
+        CONST BATCH_TRIANGLE *t = &Triangles[i];
+        INT32 xmin = MAX(MIN(t->x0, MIN(t->x1, t->x2)), Target->ClipX0);
+        INT32 xmax = MIN(MAX(t->x0, MAX(t->x1, t->x2)), Target->ClipX1);
+        INT32 ymin = MAX(MIN(t->y0, MIN(t->y1, t->y2)), Target->ClipY0);
+        INT32 ymax = MIN(MAX(t->y0, MAX(t->y1, t->y2)), Target->ClipY1);
+        if (xmin > xmax || ymin > ymax) {
+            continue;
+        }
+        INT64 x0 = TO_FIXED(t->x0), y0 = TO_FIXED(t->y0);
+        INT64 x1 = TO_FIXED(t->x1), y1 = TO_FIXED(t->y1);
+        INT64 x2 = TO_FIXED(t->x2), y2 = TO_FIXED(t->y2);
+        // twice the signed area, positive if clockwise on the screen
+        INT64 Area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+        if (Area == 0) {
+            continue;
+        }
+        if (Area < 0) {
+            INT64 tx = x1, ty = y1;
+            x1 = x2; y1 = y2;
+            x2 = tx; y2 = ty;
+        }
+        SetupEdge(&Job.Edge[0], x0, y0, x1, y1);
+        SetupEdge(&Job.Edge[1], x1, y1, x2, y2);
+        SetupEdge(&Job.Edge[2], x2, y2, x0, y0);
+        Job.Value = FbColour(Target->SwapRB, t->Colour);
+        ParallelTiles(xmin, ymin, xmax, ymax, TriangleTile, &Job);
+    }
+}
+
+/*
+ * PutRun() - Pixels x0...x1 of a row, clipped to cx0...cx1
+ */
+STATIC VOID PutRun(IN UINT32 *Row, IN INT32 x0, IN INT32 x1, IN INT32 cx0, IN INT32 cx1, IN UINT32 Value)
+{
+    x0 = MAX(x0, cx0);
+    x1 = MIN(x1, cx1);
+    for (INT32 x = x0; x <= x1; x++) {
+        Row[x] = Value;
+    }
+}
+
+/*
+ * DrawOutlineRow() - Runs either side of the centre of a row of an outline,
+ *                    outline runs are short so are stored directly
+ */
+STATIC VOID DrawOutlineRow(IN BATCH_TARGET *Target, IN INT32 xc, IN INT32 y, IN CONST CIRCLE_SPAN *Span, IN UINT32 Value)
+{
+    if (y < Target->ClipY0 || y > Target->ClipY1) return;
+    UINT32 *Row = &Target->FrameBuffer[(UINTN)y * Target->Stride];
+    if (Span->Inner == 0) {
+        PutRun(Row, xc - Span->Outer, xc + Span->Outer, Target->ClipX0, Target->ClipX1, Value);
+    } else {
+        PutRun(Row, xc - Span->Outer, xc - Span->Inner, Target->ClipX0, Target->ClipX1, Value);
+        PutRun(Row, xc + Span->Inner, xc + Span->Outer, Target->ClipX0, Target->ClipX1, Value);
+    }
+}
+
+/*
+ * BatchDrawCircles() - Outlines from the cached span table of each radius
+ */
+VOID BatchDrawCircles(IN BATCH_TARGET *Target, IN CIRCLE_CACHE *Cache, IN CONST BATCH_CIRCLE *Circles, IN UINTN Num)
+{
+    if (!Target->FrameBuffer) {
+        for (UINTN i = 0; i < Num; i++) {
+            DrawCircle(Circles[i].xc, Circles[i].yc, Circles[i].r, Circles[i].Colour);
+        }
+        return;
+    }
+    for (UINTN i = 0; i < Num; i++) {
+        CONST BATCH_CIRCLE *c = &Circles[i];
+        CONST CIRCLE_SPAN *Spans = GetCircleSpans(Cache, c->r);
+        if (!Spans) {
+            DrawCircle(c->xc, c->yc, c->r, c->Colour);
+            continue;
+        }
+        UINT32 Value = FbColour(Target->SwapRB, c->Colour);
+        if (c->xc - c->r < Target->ClipX0 || c->xc + c->r > Target->ClipX1 ||
+            c->yc - c->r < Target->ClipY0 || c->yc + c->r > Target->ClipY1) {
+            DrawOutlineRow(Target, c->xc, c->yc, &Spans[0], Value);
+            for (INT32 dy = 1; dy <= c->r; dy++) {
+                DrawOutlineRow(Target, c->xc, c->yc - dy, &Spans[dy], Value);
+                DrawOutlineRow(Target, c->xc, c->yc + dy, &Spans[dy], Value);
+            }
+            continue;
+        }
+        // inside the clip window, rows above and below the centre are
+        // stored together from the centre of each
+        UINTN Stride = Target->Stride;
+        UINT32 *Centre = &Target->FrameBuffer[(UINTN)c->yc * Stride + c->xc];
+        for (INT32 dy = 0; dy <= c->r; dy++) {
+            CONST CIRCLE_SPAN *Span = &Spans[dy];
+            UINT32 *Up = Centre - (UINTN)dy * Stride;
+            UINT32 *Down = Centre + (UINTN)dy * Stride;
+            for (INT32 x = Span->Inner; x <= Span->Outer; x++) {
+                Up[x] = Value;
+                Up[-x] = Value;
+                Down[x] = Value;
+                Down[-x] = Value;
+            }
+        }
+    }
+}
+
+/*
+ * BatchDrawFillCircles() - One span per row from the cached span table of
+ *                          each radius, filled by the selected fill kernel
+ */
+VOID BatchDrawFillCircles(IN BATCH_TARGET *Target, IN CIRCLE_CACHE *Cache, IN CONST BATCH_CIRCLE *Circles, IN UINTN Num)
+{
+    if (!Target->FrameBuffer) {
+        for (UINTN i = 0; i < Num; i++) {
+            DrawFillCircle(Circles[i].xc, Circles[i].yc, Circles[i].r, Circles[i].Colour);
+        }
+        return;
+    }
+    for (UINTN i = 0; i < Num; i++) {
+        CONST BATCH_CIRCLE *c = &Circles[i];
+        CONST CIRCLE_SPAN *Spans = GetCircleSpans(Cache, c->r);
+        if (!Spans) {
+            DrawFillCircle(c->xc, c->yc, c->r, c->Colour);
+            continue;
+        }
+        UINT32 Value = FbColour(Target->SwapRB, c->Colour);
+        DrawSpan(Target, c->xc - Spans[0].Fill, c->xc + Spans[0].Fill, c->yc, Value);
+        for (INT32 dy = 1; dy <= c->r; dy++) {
+            DrawSpan(Target, c->xc - Spans[dy].Fill, c->xc + Spans[dy].Fill, c->yc - dy, Value);
+            DrawSpan(Target, c->xc - Spans[dy].Fill, c->xc + Spans[dy].Fill, c->yc + dy, Value);
+        }
+    }
+}
+
+/*
+ * DrawGlyph() - One character cell, clipped, from the glyph pixels if given
+ *               or its runs
+ */
+STATIC VOID DrawGlyph(IN BATCH_TARGET *Target, IN GLYPH *Glyph, IN CONST UINT32 *Pixels, IN INT32 x, IN INT32 y, IN UINT32 Fg, IN UINT32 Bg, IN BOOLEAN Opaque)
+{
+    INT32 gx0 = MAX(x, Target->ClipX0) - x;
+    INT32 gx1 = MIN(x + (INT32)Glyph->Width - 1, Target->ClipX1) - x;
+    INT32 gy0 = MAX(y, Target->ClipY0) - y;
+    INT32 gy1 = MIN(y + (INT32)Glyph->Height - 1, Target->ClipY1) - y;
+
+    if (gx0 > gx1 || gy0 > gy1) {
+        return;
+    }
+    for (INT32 gy = gy0; gy <= gy1; gy++) {
+        // Dst[0] is glyph column gx0
+        UINT32 *Dst = &Target->FrameBuffer[(UINTN)(y + gy) * Target->Stride + (x + gx0)];
+        if (Pixels) {
+            CopyMem(Dst, &Pixels[gy * Glyph->Width + gx0], (gx1 - gx0 + 1) * sizeof(UINT32));
+            continue;
+        }
+        if (Opaque) {
+            for (INT32 gx = gx0; gx <= gx1; gx++) {
+                Dst[gx - gx0] = Bg;
+            }
+        }
+        for (UINT16 r = Glyph->RowRun[gy]; r < Glyph->RowRun[gy+1]; r++) {
+            INT32 rx0 = MAX(Glyph->Runs[r].x, gx0);
+            INT32 rx1 = MIN(Glyph->Runs[r].x + Glyph->Runs[r].Length - 1, gx1);
+            for (INT32 gx = rx0; gx <= rx1; gx++) {
+                Dst[gx - gx0] = Fg;
+            }
+        }
+    }
+}
+
+/*
+ * BatchPutString() - Left to right from x, y, as GPutString() in a single
+ *                    font, glyphs from the cache
+ */
+VOID BatchPutString(IN BATCH_TARGET *Target, IN GLYPH_CACHE *Cache, IN INT32 x, IN INT32 y, IN CONST CHAR16 *String, IN UINT32 Fg, IN UINT32 Bg, IN BOOLEAN Opaque, IN FONT Font)
+{
+    if (!Target->FrameBuffer) {
+        GPutString(x, y, (CHAR16 *)String, Fg, Bg, Opaque, Font);
+        return;
+    }
+    UINT32 FgValue = FbColour(Target->SwapRB, Fg);
+    UINT32 BgValue = FbColour(Target->SwapRB, Bg);
+    if (Opaque) {
+        SetGlyphColours(Cache, FgValue, BgValue);
+    }
+    for (; *String; String++) {
+        GLYPH *Glyph = GetGlyph(Cache, Font, *String);
+        if (!Glyph) {
+            CHAR16 Char[2] = { *String, 0 };
+            GPutString(x, y, Char, Fg, Bg, Opaque, Font);
+            x += (INT32)GetFontWidth(Font);
+            continue;
+        }
+        CONST UINT32 *Pixels = Opaque ? GetGlyphPixels(Cache, Glyph) : NULL;
+        DrawGlyph(Target, Glyph, Pixels, x, y, FgValue, BgValue, Opaque);
+        x += (INT32)Glyph->Width;
+    }
+}
+
+/*
+ * BatchPutCachedString() - As BatchPutString(), drawing the whole string
+ *                          from the string cache, rendered on a miss
+ */
+VOID BatchPutCachedString(IN BATCH_TARGET *Target, IN STRING_CACHE *Cache, IN INT32 x, IN INT32 y, IN CONST CHAR16 *String, IN UINT32 Fg, IN UINT32 Bg, IN BOOLEAN Opaque, IN FONT Font)
+{
+    if (!Target->FrameBuffer) {
+        GPutString(x, y, (CHAR16 *)String, Fg, Bg, Opaque, Font);
+        return;
+    }
+    CONST STRING_ENTRY *Entry = GetStringEntry(Cache, Font, String, FbColour(Target->SwapRB, Fg), FbColour(Target->SwapRB, Bg), Opaque);
+    if (!Entry) {
+        BatchPutString(Target, Cache->Glyphs, x, y, String, Fg, Bg, Opaque, Font);
+        return;
+    }
+    INT32 sx0 = MAX(x, Target->ClipX0) - x;
+    INT32 sx1 = MIN(x + (INT32)Entry->Width - 1, Target->ClipX1) - x;
+    INT32 sy0 = MAX(y, Target->ClipY0) - y;
+    INT32 sy1 = MIN(y + (INT32)Entry->Height - 1, Target->ClipY1) - y;
+    if (sx0 > sx1 || sy0 > sy1) {
+        return;
+    }
+    for (INT32 sy = sy0; sy <= sy1; sy++) {
+        // Dst[0] is string column sx0
+        UINT32 *Dst = &Target->FrameBuffer[(UINTN)(y + sy) * Target->Stride + (x + sx0)];
+        if (Entry->Pixels) {
+            CopyMem(Dst, &Entry->Pixels[(UINTN)sy * Entry->Width + sx0], (sx1 - sx0 + 1) * sizeof(UINT32));
+            continue;
+        }
+        for (UINT32 r = Entry->RowRun[sy]; r < Entry->RowRun[sy+1]; r++) {
+            INT32 rx0 = MAX(Entry->Runs[r].x, sx0);
+            INT32 rx1 = MIN(Entry->Runs[r].x + Entry->Runs[r].Length - 1, sx1);
+            for (INT32 sx = rx0; sx <= rx1; sx++) {
+                Dst[sx - sx0] = Entry->Fg;
+            }
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * File:    Batch.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Batched drawing of pixels, lines, filled rectangles, filled triangles and
+ * circles from arrays, and strings from a glyph or string cache
+ *
+ * A batch target holds the framebuffer address, scanline stride and clip
+ * window, looked up once with InitBatchTarget() when the mode or clip window
+ * changes. The batch calls then draw every primitive of an array with those
+ * held in locals, with no per-call clip or target lookup. Only 32-bit BGR and
+ * RGB linear framebuffers are drawn directly, other formats fall back to a
+ * graphics library call per primitive.
+ *
+ * Filled triangles are rasterized with half-space edge functions in fixed
+ * point, stepped across 8x8 blocks of the bounding box clipped to the clip
+ * window. A block outside an edge is skipped, a run of blocks inside all
+ * three is filled as a rectangle and only blocks on an edge are tested per
+ * pixel. The top-left rule draws pixels on an edge shared by two triangles
+ * once, so the triangle covers fewer pixels than the library's inclusive
+ * spans and zero area triangles draw nothing.
+ *
+ * Circles and filled circles are drawn as spans from the table of their
+ * radius in a circle cache, with the pixels of the library's midpoint
+ * outline and filled spans. Each outline pixel is drawn once, where the
+ * library plots some points twice. Radii too large to cache are drawn by
+ * the library.
+ *
+ * Strings are drawn from the glyphs of a glyph cache, as runs of set pixels
+ * or, for opaque text in the cache's expanded colour pair, by copying rows
+ * of glyph pixels. Characters that can't be cached are drawn by the library.
+ * A string from a string cache is drawn whole, copying the rows of an opaque
+ * string's pixels or storing the runs of a transparent string. Strings that
+ * can't be cached are drawn from the glyph cache.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <Uefi.h>
+#include "CircleCache.h"
+#include "GlyphCache.h"
+#include "StringCache.h"
+
+typedef struct {
+    INT32 x, y;
+    UINT32 Colour;
+} BATCH_POINT;
+
+// line end points or rectangle corners, inclusive
+typedef struct {
+    INT32 x0, y0, x1, y1;
+    UINT32 Colour;
+} BATCH_LINE;
+typedef BATCH_LINE BATCH_RECT;
+
+typedef struct {
+    INT32 x0, y0, x1, y1, x2, y2;
+    UINT32 Colour;
+} BATCH_TRIANGLE;
+
+typedef struct {
+    INT32 xc, yc, r;
+    UINT32 Colour;
+} BATCH_CIRCLE;
+
+typedef struct {
+    UINT32 *FrameBuffer;    // NULL if not drawn directly
+    UINTN Stride;           // pixels per scanline
+    BOOLEAN SwapRB;         // RGB framebuffer, colours are 0xRRGGBB
+    INT32 ClipX0, ClipY0;   // clip window, inclusive and on the screen
+    INT32 ClipX1, ClipY1;
+} BATCH_TARGET;
+
+EFI_STATUS InitBatchTarget(OUT BATCH_TARGET *Target, IN INT32 ClipX0, IN INT32 ClipY0, IN INT32 ClipX1, IN INT32 ClipY1);
+VOID BatchPutPixels(IN BATCH_TARGET *Target, IN CONST BATCH_POINT *Points, IN UINTN Num);
+VOID BatchDrawLines(IN BATCH_TARGET *Target, IN CONST BATCH_LINE *Lines, IN UINTN Num);
+VOID BatchDrawFillRectangles(IN BATCH_TARGET *Target, IN CONST BATCH_RECT *Rects, IN UINTN Num);
+VOID BatchDrawFillTriangles(IN BATCH_TARGET *Target, IN CONST BATCH_TRIANGLE *Triangles, IN UINTN Num);
+VOID BatchDrawCircles(IN BATCH_TARGET *Target, IN CIRCLE_CACHE *Cache, IN CONST BATCH_CIRCLE *Circles, IN UINTN Num);
+VOID BatchDrawFillCircles(IN BATCH_TARGET *Target, IN CIRCLE_CACHE *Cache, IN CONST BATCH_CIRCLE *Circles, IN UINTN Num);
+VOID BatchPutString(IN BATCH_TARGET *Target, IN GLYPH_CACHE *Cache, IN INT32 x, IN INT32 y, IN CONST CHAR16 *String, IN UINT32 Fg, IN UINT32 Bg, IN BOOLEAN Opaque, IN FONT Font);
+VOID BatchPutCachedString(IN BATCH_TARGET *Target, IN STRING_CACHE *Cache, IN INT32 x, IN INT32 y, IN CONST CHAR16 *String, IN UINT32 Fg, IN UINT32 Bg, IN BOOLEAN Opaque, IN FONT Font);
+VOID FillTargetClip(IN BATCH_TARGET *Target, IN UINT32 Colour);
+
+#endif // BATCH_H
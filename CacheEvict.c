@@ -0,0 +1,135 @@
+/*
+ * File:    CacheEvict.c
+ * 
+ * Author:  David Petrovic
+ * 
+ * Description:
+ * 
+ * Data cache eviction by sweeping a buffer larger than the last level cache
+ */
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include "CacheEvict.h"
+#include "Arena.h"
+
+#define DEFAULT_LLC_SIZE    (32 * 1024 * 1024)  // if not reported by CPUID
+#define EVICT_FACTOR        2                   // buffer size relative to LLC
+#define MAX_EVICT_SIZE      (256 * 1024 * 1024)
+
+#define CPUID_CACHE_LEAF        0x04        // Intel deterministic cache parameters
+#define CPUID_EXT_CACHE_LEAF    0x8000001D  // AMD equivalent
+#define CPUID_CACHE_TYPE_NULL   0
+
+STATIC ARENA EvictArena;
+STATIC volatile UINT64 *EvictBuffer = NULL;
+STATIC UINTN EvictSize = 0;
+STATIC UINTN LlcSize = 0;
+STATIC volatile UINT64 EvictSink;   // keeps the sweep reads
+
+#if !EDK2SIM_SUPPORT
+/*
+ * CpuidCacheSize() - Largest cache described by a deterministic cache
+ *                    parameters leaf, 0 if none
+ */
+STATIC UINTN CpuidCacheSize(UINT32 Leaf)
+{
+    UINTN MaxSize = 0;
+
+    for (UINT32 Index = 0; Index < 16; Index++) {
+        UINT32 Eax, Ebx, Ecx;
+        AsmCpuidEx(Leaf, Index, &Eax, &Ebx, &Ecx, NULL);
+        if ((Eax & 0x1F) == CPUID_CACHE_TYPE_NULL) {
+            break;
+        }
+        // ways x partitions x line size x sets
+        UINTN Size = (UINTN)(((Ebx >> 22) & 0x3FF) + 1) * (((Ebx >> 12) & 0x3FF) + 1) * ((Ebx & 0xFFF) + 1) * ((UINTN)Ecx + 1);
+        if (Size > MaxSize) {
+            MaxSize = Size;
+        }
+    }
+    return MaxSize;
+}
+#endif
+
+/*
+ * GetLlcSize() - Last level cache size in bytes, cached after first call
+ */
+UINTN GetLlcSize(VOID)
+{
+    if (LlcSize) {
+        return LlcSize;
+    }
+#if !EDK2SIM_SUPPORT
+    UINT32 MaxLeaf, MaxExtLeaf;
+    AsmCpuid(0, &MaxLeaf, NULL, NULL, NULL);
+    if (MaxLeaf >= CPUID_CACHE_LEAF) {
+        LlcSize = CpuidCacheSize(CPUID_CACHE_LEAF);
+    }
+    if (!LlcSize) {
+        AsmCpuid(0x80000000, &MaxExtLeaf, NULL, NULL, NULL);
+        if (MaxExtLeaf >= CPUID_EXT_CACHE_LEAF) {
+            LlcSize = CpuidCacheSize(CPUID_EXT_CACHE_LEAF);
+        }
+    }
+#endif
+    if (!LlcSize) {
+        LlcSize = DEFAULT_LLC_SIZE;
+    }
+    return LlcSize;
+}
+
+/*
+ * InitCacheEvict() - Allocate and touch sweep buffer
+ */
+EFI_STATUS InitCacheEvict(VOID)
+{
+    EFI_STATUS Status;
+
+    FreeCacheEvict();
+    UINTN Size = GetLlcSize() * EVICT_FACTOR;
+    if (Size > MAX_EVICT_SIZE) {
+        Size = MAX_EVICT_SIZE;
+    }
+    Status = ArenaCreate(&EvictArena, Size + ARENA_DEFAULT_ALIGN);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    EvictBuffer = (volatile UINT64 *)ArenaAlloc(&EvictArena, Size, CACHE_LINE_SIZE);
+    EvictSize = Size;
+    SetMem((VOID *)EvictBuffer, Size, 0);
+    return EFI_SUCCESS;
+}
+
+/*
+ * FreeCacheEvict()
+ */
+VOID FreeCacheEvict(VOID)
+{
+    ArenaDestroy(&EvictArena);
+    EvictBuffer = NULL;
+    EvictSize = 0;
+}
+
+/*
+ * EvictCache() - Read one word per line of sweep buffer, does nothing if
+ *                not initialised
+ */
+VOID EvictCache(VOID)
+{
+    UINT64 Sum = 0;
+
+    for (UINTN i = 0; i < EvictSize / sizeof(UINT64); i += CACHE_LINE_SIZE / sizeof(UINT64)) {
+        Sum += EvictBuffer[i];
+    }
+    EvictSink = Sum;
+}
+
+/*
+ * GetEvictSize() - Sweep buffer size in bytes, 0 if not initialised
+ */
+UINTN GetEvictSize(VOID)
+{
+    return EvictSize;
+}
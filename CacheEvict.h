@@ -0,0 +1,24 @@
+/*
+ * File:    CacheEvict.h
+ * 
+ * Author:  David Petrovic
+ *
+ * Description:
+ * 
+ * Data cache eviction by sweeping a buffer larger than the last level cache
+ */
+
+#ifndef CACHE_EVICT_H
+#define CACHE_EVICT_H
+
+#include <Uefi.h>
+
+#define CACHE_LINE_SIZE     64
+
+EFI_STATUS InitCacheEvict(VOID);
+VOID FreeCacheEvict(VOID);
+VOID EvictCache(VOID);
+UINTN GetLlcSize(VOID);
+UINTN GetEvictSize(VOID);
+
+#endif // CACHE_EVICT_H
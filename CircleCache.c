@@ -0,0 +1,140 @@
+/*
+ * File:    CircleCache.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Least recently used cache of circle span tables by radius
+ */
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+#include "CircleCache.h"
+#include "Stats.h"
+
+#define SPAN_TABLE_SIZE     ((CIRCLE_CACHE_MAX_RADIUS + 1) * sizeof(CIRCLE_SPAN))
+
+STATIC VOID AddOutline(IN OUT CIRCLE_SPAN *Span, IN INT32 Offset);
+
+/*
+ * CreateCircleCache() - Tables for every entry are allocated up front, so a
+ *                       miss never allocates, every lookup misses if Uncached
+ */
+EFI_STATUS CreateCircleCache(OUT CIRCLE_CACHE *Cache, IN BOOLEAN Uncached)
+{
+    EFI_STATUS Status;
+
+    ZeroMem(Cache, sizeof(CIRCLE_CACHE));
+    Status = ArenaCreate(&Cache->Arena, CIRCLE_CACHE_ENTRIES * SPAN_TABLE_SIZE);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    for (UINTN i = 0; i < CIRCLE_CACHE_ENTRIES; i++) {
+        Cache->Entry[i].Radius = -1;
+        Cache->Entry[i].Spans = (CIRCLE_SPAN *)ArenaAlloc(&Cache->Arena, SPAN_TABLE_SIZE, 0);
+    }
+    Cache->Uncached = Uncached;
+    return EFI_SUCCESS;
+}
+
+/*
+ * DestroyCircleCache()
+ */
+VOID DestroyCircleCache(IN CIRCLE_CACHE *Cache)
+{
+    ArenaDestroy(&Cache->Arena);
+    ZeroMem(Cache, sizeof(CIRCLE_CACHE));
+}
+
+/*
+ * GetCircleSpans() - Span table of a radius, computed into the least
+ *                    recently used entry on a miss, NULL if not cached
+ */
+CONST CIRCLE_SPAN *GetCircleSpans(IN CIRCLE_CACHE *Cache, IN INT32 Radius)
+{
+    CIRCLE_CACHE_ENTRY *Entry = &Cache->Entry[Cache->Last];
+
+    if (Radius < 0 || Radius > CIRCLE_CACHE_MAX_RADIUS || !Cache->Arena.Base) {
+        return NULL;
+    }
+    Cache->Clock++;
+    if (Cache->Uncached) {
+        Cache->Stats.Misses++;
+        ComputeCircleSpans(Radius, Cache->Entry[0].Spans);
+        return Cache->Entry[0].Spans;
+    }
+    if (Entry->Radius != Radius) {
+        UINT32 Lru = 0;
+        UINT32 i;
+        for (i = 0; i < CIRCLE_CACHE_ENTRIES; i++) {
+            if (Cache->Entry[i].Radius == Radius) {
+                break;
+            }
+            if (Cache->Entry[i].LastUse < Cache->Entry[Lru].LastUse) {
+                Lru = i;
+            }
+        }
+        if (i == CIRCLE_CACHE_ENTRIES) {
+            // empty entries were never used, so are taken first
+            i = Lru;
+            Entry = &Cache->Entry[i];
+            if (Entry->Radius >= 0) {
+                Cache->Stats.Evictions++;
+            }
+            Cache->Stats.Misses++;
+            ComputeCircleSpans(Radius, Entry->Spans);
+            Entry->Radius = Radius;
+            Entry->LastUse = Cache->Clock;
+            Cache->Last = i;
+            return Entry->Spans;
+        }
+        Entry = &Cache->Entry[i];
+        Cache->Last = i;
+    }
+    Cache->Stats.Hits++;
+    Entry->LastUse = Cache->Clock;
+    return Entry->Spans;
+}
+
+/*
+ * AddOutline() - Widen a row of the outline to a point Offset from the centre
+ */
+STATIC VOID AddOutline(IN OUT CIRCLE_SPAN *Span, IN INT32 Offset)
+{
+    Span->Inner = MIN(Span->Inner, Offset);
+    Span->Outer = MAX(Span->Outer, Offset);
+}
+
+/*
+ * ComputeCircleSpans() - Rows 0...Radius, fill as the graphics library with
+ *                        one span per row, outline of the midpoint circle
+ *
+ * The midpoint circle steps the octant from the x axis to the diagonal and
+ * mirrors each point, so each row of the outline is one run of points
+ * either side of the centre.
+ */
+VOID ComputeCircleSpans(IN INT32 Radius, OUT CIRCLE_SPAN *Spans)
+{
+    INT64 r2 = (INT64)Radius * Radius;
+
+    for (INT32 dy = 0; dy <= Radius; dy++) {
+        Spans[dy].Fill = (INT32)ISqrt64((UINT64)(r2 - (INT64)dy * dy));
+        Spans[dy].Inner = Radius;
+        Spans[dy].Outer = 0;
+    }
+    INT32 x = Radius;
+    INT32 y = 0;
+    INT32 err = 1 - Radius;
+    while (x >= y) {
+        AddOutline(&Spans[y], x);
+        AddOutline(&Spans[x], y);
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+}
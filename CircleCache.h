@@ -0,0 +1,62 @@
+/*
+ * File:    CircleCache.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Least recently used cache of circle span tables by radius
+ *
+ * A span table holds, for each row from the centre of a circle to its top,
+ * the half width of the filled span and the offsets either side of the
+ * centre of the outline drawn by the midpoint circle. A circle of a cached
+ * radius is then drawn as spans, with no circle stepping per call. The cache
+ * holds CIRCLE_CACHE_ENTRIES tables, a miss replaces the least recently used
+ * and radii over CIRCLE_CACHE_MAX_RADIUS aren't cached. An uncached cache
+ * computes the table into its first entry on every lookup, to measure what
+ * caching saves.
+ */
+
+#ifndef CIRCLE_CACHE_H
+#define CIRCLE_CACHE_H
+
+#include <Uefi.h>
+#include "Arena.h"
+
+#define CIRCLE_CACHE_ENTRIES    16
+#define CIRCLE_CACHE_MAX_RADIUS 1023
+
+// one row of a circle dy rows from the centre, offsets from the centre x
+typedef struct {
+    INT32 Fill;         // filled span is -Fill...Fill
+    INT32 Inner;        // outline is Inner...Outer each side, one span if Inner is 0
+    INT32 Outer;
+} CIRCLE_SPAN;
+
+typedef struct {
+    UINT64 Hits;
+    UINT64 Misses;
+    UINT64 Evictions;   // misses that replaced a table
+} CIRCLE_CACHE_STATS;
+
+typedef struct {
+    INT32 Radius;           // -1 if empty
+    UINT64 LastUse;         // cache clock at the last lookup
+    CIRCLE_SPAN *Spans;     // rows 0...Radius
+} CIRCLE_CACHE_ENTRY;
+
+typedef struct {
+    ARENA Arena;
+    CIRCLE_CACHE_ENTRY Entry[CIRCLE_CACHE_ENTRIES];
+    UINT32 Last;            // entry of the last hit, looked at first
+    UINT64 Clock;           // lookups so far
+    BOOLEAN Uncached;       // every lookup computes the table
+    CIRCLE_CACHE_STATS Stats;
+} CIRCLE_CACHE;
+
+EFI_STATUS CreateCircleCache(OUT CIRCLE_CACHE *Cache, IN BOOLEAN Uncached);
+VOID DestroyCircleCache(IN CIRCLE_CACHE *Cache);
+CONST CIRCLE_SPAN *GetCircleSpans(IN CIRCLE_CACHE *Cache, IN INT32 Radius);
+VOID ComputeCircleSpans(IN INT32 Radius, OUT CIRCLE_SPAN *Spans);
+
+#endif // CIRCLE_CACHE_H
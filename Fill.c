@@ -0,0 +1,218 @@
+/*
+ * File:    Fill.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * 32-bit pixel fill kernels, scalar reference and SSE2/AVX2 selected by CPUID
+ */
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include "Fill.h"
+
+#define XCR0_SSE_AVX    0x06    // XMM and YMM state enabled
+
+STATIC BOOLEAN Supported[NUM_FILL_KERNELS] = { TRUE, FALSE, FALSE };
+STATIC FILL_KERNEL Kernel = FILL_SCALAR;
+
+STATIC VOID DetectFill(OUT BOOLEAN *Kernels);
+
+/*
+ * DetectFill() - Kernels supported by the CPU this runs on
+ *
+ * AVX2 also needs the firmware to have enabled YMM state in XCR0, which not
+ * all UEFI implementations do.
+ */
+STATIC VOID DetectFill(OUT BOOLEAN *Kernels)
+{
+    Kernels[FILL_SCALAR] = TRUE;
+    Kernels[FILL_SSE2] = FALSE;
+    Kernels[FILL_AVX2] = FALSE;
+#if !EDK2SIM_SUPPORT
+    UINT32 MaxLeaf, Ebx, Ecx, Edx;
+
+    AsmCpuid(0, &MaxLeaf, NULL, NULL, NULL);
+    AsmCpuid(1, NULL, NULL, &Ecx, &Edx);
+    Kernels[FILL_SSE2] = (Edx & BIT26) != 0;
+    if (MaxLeaf >= 7 && (Ecx & BIT27) && (Ecx & BIT28)) {     // OSXSAVE, AVX
+        AsmCpuidEx(7, 0, NULL, &Ebx, NULL, NULL);
+        Kernels[FILL_AVX2] = (Ebx & BIT5) && (AsmXGetBv(0) & XCR0_SSE_AVX) == XCR0_SSE_AVX;
+    }
+#endif
+}
+
+/*
+ * InitFill() - Find the supported kernels and select the best
+ */
+VOID InitFill(VOID)
+{
+    DetectFill(Supported);
+    Kernel = GetBestFillKernel();
+}
+
+/*
+ * CpuFillKernelSupported() - Kernel supported on the CPU this runs on,
+ *                            for APs, whose XCR0 the firmware sets apart
+ *                            from the BSP
+ */
+BOOLEAN CpuFillKernelSupported(FILL_KERNEL Kernel)
+{
+    BOOLEAN Kernels[NUM_FILL_KERNELS];
+
+    DetectFill(Kernels);
+    return Kernel < NUM_FILL_KERNELS && Kernels[Kernel];
+}
+
+/*
+ * FillKernelSupported()
+ */
+BOOLEAN FillKernelSupported(FILL_KERNEL Kernel)
+{
+    return Kernel < NUM_FILL_KERNELS && Supported[Kernel];
+}
+
+/*
+ * GetBestFillKernel() - Widest supported stores
+ */
+FILL_KERNEL GetBestFillKernel(VOID)
+{
+    FILL_KERNEL Best = FILL_SCALAR;
+
+    for (UINTN k = 0; k < NUM_FILL_KERNELS; k++) {
+        if (Supported[k]) {
+            Best = (FILL_KERNEL)k;
+        }
+    }
+    return Best;
+}
+
+/*
+ * SetFillKernel() - Kernel used by FillRect32(), FILL_AUTO for the best
+ */
+EFI_STATUS SetFillKernel(FILL_KERNEL NewKernel)
+{
+    if (NewKernel == FILL_AUTO) {
+        NewKernel = GetBestFillKernel();
+    }
+    if (!FillKernelSupported(NewKernel)) {
+        return EFI_UNSUPPORTED;
+    }
+    Kernel = NewKernel;
+    return EFI_SUCCESS;
+}
+
+/*
+ * GetFillKernel()
+ */
+FILL_KERNEL GetFillKernel(VOID)
+{
+    return Kernel;
+}
+
+/*
+ * FillVector() - Blocks of 16 bytes (SSE2) or 32 bytes (AVX2) at an aligned
+ *                address, Blocks is not 0
+ */
+STATIC VOID FillVector(UINT32 *p, UINTN Blocks, UINT32 Value, BOOLEAN Avx2, BOOLEAN Nt)
+{
+    if (Avx2) {
+        if (Nt) {
+            asm volatile ("vmovd %2, %%xmm0\n\tvpbroadcastd %%xmm0, %%ymm0\n"
+                          "1:\n\tvmovntdq %%ymm0, (%0)\n\tadd $32, %0\n\tsub $1, %1\n\tjnz 1b\n\tvzeroupper"
+                          : "+r" (p), "+r" (Blocks) : "r" (Value) : "xmm0", "memory", "cc");
+        } else {
+            asm volatile ("vmovd %2, %%xmm0\n\tvpbroadcastd %%xmm0, %%ymm0\n"
+                          "1:\n\tvmovdqa %%ymm0, (%0)\n\tadd $32, %0\n\tsub $1, %1\n\tjnz 1b\n\tvzeroupper"
+                          : "+r" (p), "+r" (Blocks) : "r" (Value) : "xmm0", "memory", "cc");
+        }
+    } else {
+        if (Nt) {
+            asm volatile ("movd %2, %%xmm0\n\tpshufd $0, %%xmm0, %%xmm0\n"
+                          "1:\n\tmovntdq %%xmm0, (%0)\n\tadd $16, %0\n\tsub $1, %1\n\tjnz 1b"
+                          : "+r" (p), "+r" (Blocks) : "r" (Value) : "xmm0", "memory", "cc");
+        } else {
+            asm volatile ("movd %2, %%xmm0\n\tpshufd $0, %%xmm0, %%xmm0\n"
+                          "1:\n\tmovdqa %%xmm0, (%0)\n\tadd $16, %0\n\tsub $1, %1\n\tjnz 1b"
+                          : "+r" (p), "+r" (Blocks) : "r" (Value) : "xmm0", "memory", "cc");
+        }
+    }
+}
+
+/*
+ * FillRow() - Head to vector alignment, aligned vector body and tail
+ */
+STATIC VOID FillRow(UINT32 *p, UINTN Count, UINT32 Value, BOOLEAN Avx2, BOOLEAN Nt)
+{
+    UINTN Align = Avx2 ? 32 : 16;
+    UINTN PerBlock = Align / sizeof(UINT32);
+
+    while (Count && ((UINTN)p & (Align - 1))) {
+        *p++ = Value;
+        Count--;
+    }
+    UINTN Blocks = Count / PerBlock;
+    if (Blocks) {
+        FillVector(p, Blocks, Value, Avx2, Nt);
+        p += Blocks * PerBlock;
+        Count -= Blocks * PerBlock;
+    }
+    while (Count--) {
+        *p++ = Value;
+    }
+}
+
+/*
+ * FillRect32() - Width x Height pixels, Stride pixels apart, with the
+ *                selected kernel
+ */
+VOID FillRect32(UINT32 *Dst, UINTN Stride, UINTN Width, UINTN Height, UINT32 Value)
+{
+    FillRect32Part(Dst, Stride, Width, Height, Value, (UINT64)Width * Height * sizeof(UINT32));
+}
+
+/*
+ * FillRect32Part() - Part of a fill of FillBytes, split across CPUs, whose
+ *                    size picks the store type
+ */
+VOID FillRect32Part(UINT32 *Dst, UINTN Stride, UINTN Width, UINTN Height, UINT32 Value, UINT64 FillBytes)
+{
+    if (Kernel == FILL_SCALAR) {
+        for (UINTN y = 0; y < Height; y++, Dst += Stride) {
+            volatile UINT32 *p = Dst;
+            for (UINTN x = 0; x < Width; x++) p[x] = Value;
+        }
+        return;
+    }
+    BOOLEAN Avx2 = (Kernel == FILL_AVX2);
+    BOOLEAN Nt = FillBytes >= FILL_NT_BYTES;
+    for (UINTN y = 0; y < Height; y++, Dst += Stride) {
+        FillRow(Dst, Width, Value, Avx2, Nt);
+    }
+    if (Nt) {
+        asm volatile ("sfence" ::: "memory");
+    }
+}
+
+/*
+ * GetFillKernelDesc()
+ */
+CHAR16 *GetFillKernelDesc(FILL_KERNEL Kernel)
+{
+    switch (Kernel) {
+    case FILL_SCALAR:
+        return L"scalar";
+    case FILL_SSE2:
+        return L"sse2";
+    case FILL_AVX2:
+        return L"avx2";
+    case FILL_AUTO:
+        return L"auto";
+    case FILL_LIBRARY:
+        return L"library";
+    default:
+        break;
+    }
+    return L"Unknown";
+}
@@ -0,0 +1,42 @@
+/*
+ * File:    Fill.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * 32-bit pixel fill kernels, scalar reference and SSE2/AVX2 selected by CPUID
+ *
+ * Each row is filled with 32-bit stores up to vector alignment, aligned
+ * vector stores, then 32-bit stores for the tail. Fills of FILL_NT_BYTES or
+ * more use non-temporal vector stores, so a large fill doesn't evict the
+ * cache, with one store fence at the end of the fill.
+ */
+
+#ifndef FILL_H
+#define FILL_H
+
+#include <Uefi.h>
+
+#define FILL_NT_BYTES   (256 * 1024)    // fills this size or larger are non-temporal
+
+typedef enum {
+    FILL_SCALAR=0,      // reference, 32-bit stores
+    FILL_SSE2,          // 16-byte stores
+    FILL_AVX2,          // 32-byte stores
+    NUM_FILL_KERNELS,   // number of kernels
+    FILL_AUTO,          // best supported kernel
+    FILL_LIBRARY        // graphics library fills, no kernel
+} FILL_KERNEL;
+
+VOID InitFill(VOID);
+BOOLEAN FillKernelSupported(FILL_KERNEL Kernel);
+BOOLEAN CpuFillKernelSupported(FILL_KERNEL Kernel);
+FILL_KERNEL GetBestFillKernel(VOID);
+EFI_STATUS SetFillKernel(FILL_KERNEL Kernel);
+FILL_KERNEL GetFillKernel(VOID);
+VOID FillRect32(UINT32 *Dst, UINTN Stride, UINTN Width, UINTN Height, UINT32 Value);
+VOID FillRect32Part(UINT32 *Dst, UINTN Stride, UINTN Width, UINTN Height, UINT32 Value, UINT64 FillBytes);
+CHAR16 *GetFillKernelDesc(FILL_KERNEL Kernel);
+
+#endif // FILL_H
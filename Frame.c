@@ -0,0 +1,132 @@
+/*
+ * File:    Frame.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Double-buffered frames, drawn to a back buffer and presented to the screen
+ */
+
+#include <Uefi.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/BaseMemoryLib.h>
+#include "Frame.h"
+#include "Parallel.h"
+
+STATIC VOID CopyTile(IN VOID *Context, IN INT32 x0, IN INT32 y0, IN INT32 x1, IN INT32 y1);
+
+/*
+ * GetPresentMethod() - Method used for a request in the current mode, copy
+ *                      needs a 32-bit BGR linear framebuffer
+ */
+PRESENT_METHOD GetPresentMethod(IN PRESENT_METHOD Requested)
+{
+    EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop;
+
+    if (Requested == PRESENT_BLT) {
+        return PRESENT_BLT;
+    }
+    if (EFI_ERROR(gBS->LocateProtocol(&gEfiGraphicsOutputProtocolGuid, NULL, (VOID **)&Gop))) {
+        return PRESENT_BLT;
+    }
+    EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *Info = Gop->Mode->Info;
+    UINTN Size = (UINTN)Info->PixelsPerScanLine * Info->VerticalResolution * sizeof(UINT32);
+    if (Info->PixelFormat == PixelBlueGreenRedReserved8BitPerColor && Size <= Gop->Mode->FrameBufferSize) {
+        return PRESENT_COPY;
+    }
+    return PRESENT_BLT;
+}
+
+/*
+ * CreateFrameBuffers() - Back buffer of the whole screen in the current mode
+ */
+EFI_STATUS CreateFrameBuffers(OUT FRAME_BUFFERS *Frame, IN PRESENT_METHOD Present)
+{
+    EFI_STATUS Status;
+
+    ZeroMem(Frame, sizeof(FRAME_BUFFERS));
+    Status = gBS->LocateProtocol(&gEfiGraphicsOutputProtocolGuid, NULL, (VOID **)&Frame->Gop);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *Info = Frame->Gop->Mode->Info;
+    Frame->Width = Info->HorizontalResolution;
+    Frame->Height = Info->VerticalResolution;
+    UINTN Size = (UINTN)Frame->Width * Frame->Height * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+    Status = ArenaCreate(&Frame->Arena, Size);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    Frame->Back = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)ArenaAlloc(&Frame->Arena, Size, 0);
+    ZeroMem(Frame->Back, Size);
+    Frame->Present = GetPresentMethod(Present);
+    if (Frame->Present == PRESENT_COPY) {
+        Frame->Front = (UINT32 *)(UINTN)Frame->Gop->Mode->FrameBufferBase;
+        Frame->FrontStride = Info->PixelsPerScanLine;
+    }
+    // Blt pixels are 32-bit BGR
+    Frame->Target.FrameBuffer = (UINT32 *)Frame->Back;
+    Frame->Target.Stride = Frame->Width;
+    Frame->Target.SwapRB = FALSE;
+    Frame->Target.ClipX0 = 0;
+    Frame->Target.ClipY0 = 0;
+    Frame->Target.ClipX1 = Frame->Width - 1;
+    Frame->Target.ClipY1 = Frame->Height - 1;
+    return EFI_SUCCESS;
+}
+
+/*
+ * DestroyFrameBuffers()
+ */
+VOID DestroyFrameBuffers(IN FRAME_BUFFERS *Frame)
+{
+    ArenaDestroy(&Frame->Arena);
+    ZeroMem(Frame, sizeof(FRAME_BUFFERS));
+}
+
+/*
+ * CopyTile() - Copy one tile of the back buffer to the framebuffer
+ */
+STATIC VOID CopyTile(IN VOID *Context, IN INT32 x0, IN INT32 y0, IN INT32 x1, IN INT32 y1)
+{
+    FRAME_BUFFERS *Frame = (FRAME_BUFFERS *)Context;
+    UINT32 *Src = (UINT32 *)Frame->Back + (UINTN)y0 * Frame->Width + x0;
+    UINT32 *Dst = Frame->Front + (UINTN)y0 * Frame->FrontStride + x0;
+    UINTN Bytes = (UINTN)(x1 - x0 + 1) * sizeof(UINT32);
+
+    for (INT32 y = y0; y <= y1; y++, Src += Frame->Width, Dst += Frame->FrontStride) {
+        CopyMem(Dst, Src, Bytes);
+    }
+}
+
+/*
+ * PresentFrame() - Copy the completed back buffer to the screen, by copy in
+ *                  tiles across CPUs
+ */
+EFI_STATUS PresentFrame(IN FRAME_BUFFERS *Frame)
+{
+    if (Frame->Present == PRESENT_COPY) {
+        ParallelTiles(0, 0, Frame->Width - 1, Frame->Height - 1, CopyTile, Frame);
+        return EFI_SUCCESS;
+    }
+    return Frame->Gop->Blt(Frame->Gop, Frame->Back, EfiBltBufferToVideo, 0, 0, 0, 0, Frame->Width, Frame->Height, 0);
+}
+
+/*
+ * GetPresentDesc()
+ */
+CHAR16 *GetPresentDesc(IN PRESENT_METHOD Present)
+{
+    switch (Present) {
+    case PRESENT_COPY:
+        return L"copy";
+    case PRESENT_BLT:
+        return L"blt";
+    case PRESENT_AUTO:
+        return L"auto";
+    default:
+        break;
+    }
+    return L"Unknown";
+}
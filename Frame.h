@@ -0,0 +1,48 @@
+/*
+ * File:    Frame.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Double-buffered frames, drawn to a back buffer and presented to the screen
+ *
+ * Each frame is drawn in full to a system memory back buffer through its
+ * batch target, then presented to the front buffer, the screen. Present
+ * copies scanlines straight to a 32-bit BGR linear framebuffer, or copies
+ * the whole frame with one GOP Blt in any other format.
+ */
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <Uefi.h>
+#include <Protocol/GraphicsOutput.h>
+#include "Arena.h"
+#include "Batch.h"
+
+typedef enum {
+    PRESENT_COPY=0,     // scanline copies to the framebuffer
+    PRESENT_BLT,        // one GOP Blt
+    PRESENT_AUTO        // copy if framebuffer is 32-bit BGR linear, else Blt
+} PRESENT_METHOD;
+
+typedef struct {
+    EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop;
+    ARENA Arena;
+    EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Back;
+    UINT32 Width;
+    UINT32 Height;
+    UINT32 *Front;          // framebuffer if presented by copy
+    UINTN FrontStride;      // pixels per framebuffer scanline
+    PRESENT_METHOD Present;
+    BATCH_TARGET Target;    // draws to the back buffer
+} FRAME_BUFFERS;
+
+PRESENT_METHOD GetPresentMethod(IN PRESENT_METHOD Requested);
+EFI_STATUS CreateFrameBuffers(OUT FRAME_BUFFERS *Frame, IN PRESENT_METHOD Present);
+VOID DestroyFrameBuffers(IN FRAME_BUFFERS *Frame);
+EFI_STATUS PresentFrame(IN FRAME_BUFFERS *Frame);
+CHAR16 *GetPresentDesc(IN PRESENT_METHOD Present);
+
+#endif // FRAME_H
@@ -0,0 +1,311 @@
+/*
+ * File:    GlyphCache.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Cache of font glyphs as runs of set pixels per row, with colour expanded
+ * pixels for opaque text
+ */
+
+#include <Uefi.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include "GraphicsLib/Graphics.h"
+#include "GraphicsLib/Font.h"
+#include "GlyphCache.h"
+
+STATIC UINTN HashGlyph(IN FONT Font, IN CHAR16 Char);
+STATIC VOID UnlinkGlyph(IN GLYPH_CACHE *Cache, IN GLYPH *Glyph);
+STATIC VOID LinkNewest(IN GLYPH_CACHE *Cache, IN GLYPH *Glyph);
+STATIC VOID FreeGlyph(IN GLYPH_CACHE *Cache, IN GLYPH *Glyph);
+STATIC BOOLEAN MakeRoom(IN GLYPH_CACHE *Cache, IN UINTN Bytes, IN GLYPH *Keep);
+STATIC VOID AddBytes(IN GLYPH_CACHE *Cache, IN UINTN Bytes);
+STATIC GLYPH *CaptureGlyph(IN GLYPH_CACHE *Cache, IN FONT Font, IN CHAR16 Char);
+
+/*
+ * CreateGlyphCache() - Empty cache holding up to MaxBytes of glyphs,
+ *                      captured in a character cell at CaptureX, CaptureY
+ *                      which must be on the screen and inside the clip window
+ */
+EFI_STATUS CreateGlyphCache(OUT GLYPH_CACHE *Cache, IN UINTN MaxBytes, IN INT32 CaptureX, IN INT32 CaptureY)
+{
+    ZeroMem(Cache, sizeof(GLYPH_CACHE));
+    Cache->MaxBytes = MaxBytes;
+    Cache->CaptureX = CaptureX;
+    Cache->CaptureY = CaptureY;
+    return gBS->LocateProtocol(&gEfiGraphicsOutputProtocolGuid, NULL, (VOID **)&Cache->Gop);
+}
+
+/*
+ * DestroyGlyphCache()
+ */
+VOID DestroyGlyphCache(IN GLYPH_CACHE *Cache)
+{
+    while (Cache->Oldest) {
+        FreeGlyph(Cache, Cache->Oldest);
+    }
+    ZeroMem(Cache, sizeof(GLYPH_CACHE));
+}
+
+/*
+ * HashGlyph()
+ */
+STATIC UINTN HashGlyph(IN FONT Font, IN CHAR16 Char)
+{
+    return ((UINTN)Char * 31 + (UINTN)Font) & (GLYPH_HASH_BUCKETS - 1);
+}
+
+/*
+ * UnlinkGlyph() - Take a glyph out of the least recently used list
+ */
+STATIC VOID UnlinkGlyph(IN GLYPH_CACHE *Cache, IN GLYPH *Glyph)
+{
+    if (Glyph->Newer) {
+        Glyph->Newer->Older = Glyph->Older;
+    } else {
+        Cache->Newest = Glyph->Older;
+    }
+    if (Glyph->Older) {
+        Glyph->Older->Newer = Glyph->Newer;
+    } else {
+        Cache->Oldest = Glyph->Newer;
+    }
+}
+
+/*
+ * LinkNewest() - Put a glyph at the most recently used end of the list
+ */
+STATIC VOID LinkNewest(IN GLYPH_CACHE *Cache, IN GLYPH *Glyph)
+{
+    Glyph->Newer = NULL;
+    Glyph->Older = Cache->Newest;
+    if (Cache->Newest) {
+        Cache->Newest->Newer = Glyph;
+    } else {
+        Cache->Oldest = Glyph;
+    }
+    Cache->Newest = Glyph;
+}
+
+/*
+ * FreeGlyph() - Remove a glyph from the cache and free it
+ */
+STATIC VOID FreeGlyph(IN GLYPH_CACHE *Cache, IN GLYPH *Glyph)
+{
+    GLYPH **Link = &Cache->Hash[HashGlyph(Glyph->Font, Glyph->Char)];
+
+    while (*Link != Glyph) {
+        Link = &(*Link)->HashNext;
+    }
+    *Link = Glyph->HashNext;
+    UnlinkGlyph(Cache, Glyph);
+    Cache->Bytes -= Glyph->Bytes;
+    if (Glyph->Pixels) {
+        FreePool(Glyph->Pixels);
+    }
+    FreePool(Glyph);
+}
+
+/*
+ * MakeRoom() - Free the least recently used glyphs, except Keep, until
+ *              Bytes more fit under the cap, FALSE if they can't
+ */
+STATIC BOOLEAN MakeRoom(IN GLYPH_CACHE *Cache, IN UINTN Bytes, IN GLYPH *Keep)
+{
+    while (Cache->Bytes + Bytes > Cache->MaxBytes) {
+        GLYPH *Victim = Cache->Oldest;
+        if (Victim && Victim == Keep) {
+            Victim = Victim->Newer;
+        }
+        if (!Victim) {
+            return FALSE;
+        }
+        FreeGlyph(Cache, Victim);
+        Cache->Stats.Evictions++;
+    }
+    return TRUE;
+}
+
+/*
+ * AddBytes()
+ */
+STATIC VOID AddBytes(IN GLYPH_CACHE *Cache, IN UINTN Bytes)
+{
+    Cache->Bytes += Bytes;
+    if (Cache->Bytes > Cache->Stats.PeakBytes) {
+        Cache->Stats.PeakBytes = Cache->Bytes;
+    }
+}
+
+/*
+ * CaptureGlyph() - Draw a character with the library and read it back as
+ *                  runs of set pixels, NULL if it can't be cached
+ */
+STATIC GLYPH *CaptureGlyph(IN GLYPH_CACHE *Cache, IN FONT Font, IN CHAR16 Char)
+{
+    EFI_STATUS Status;
+    CHAR16 String[2] = { Char, 0 };
+    UINT32 Width = GetFontWidth(Font);
+    UINT32 Height = GetFontHeight(Font);
+    INT32 x = Cache->CaptureX;
+    INT32 y = Cache->CaptureY;
+
+    if (!Width || !Height || Width > GLYPH_MAX_WIDTH || Height > GLYPH_MAX_HEIGHT) {
+        return NULL;
+    }
+    GPutString(x, y, String, WHITE, BLACK, TRUE, Font);
+    Status = Cache->Gop->Blt(Cache->Gop, Cache->Cell, EfiBltVideoToBltBuffer, x, y, 0, 0, Width, Height, 0);
+    DrawFillRectangle(x, y, x + Width - 1, y + Height - 1, BLACK);
+    if (EFI_ERROR(Status)) {
+        return NULL;
+    }
+
+    // count the runs, then store them after the glyph
+    UINTN NumRuns = 0;
+    for (UINT32 i = 0; i < Width * Height; i++) {
+        EFI_GRAPHICS_OUTPUT_BLT_PIXEL *p = &Cache->Cell[i];
+        BOOLEAN Set = (p->Blue | p->Green | p->Red) != 0;
+        BOOLEAN PrevSet = (i % Width) && (p[-1].Blue | p[-1].Green | p[-1].Red) != 0;
+        NumRuns += (Set && !PrevSet);
+    }
+    UINTN Bytes = sizeof(GLYPH) + NumRuns * sizeof(GLYPH_RUN);
+    if (!MakeRoom(Cache, Bytes, NULL)) {
+        return NULL;
+    }
+    GLYPH *Glyph = AllocateZeroPool(Bytes);
+    if (!Glyph) {
+        return NULL;
+    }
+    Glyph->Font = Font;
+    Glyph->Char = Char;
+    Glyph->Width = Width;
+    Glyph->Height = Height;
+    Glyph->Runs = (GLYPH_RUN *)(Glyph + 1);
+    Glyph->Bytes = Bytes;
+    UINT16 Run = 0;
+    for (UINT32 gy = 0; gy < Height; gy++) {
+        Glyph->RowRun[gy] = Run;
+        EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Row = &Cache->Cell[gy * Width];
+        for (UINT32 gx = 0; gx < Width; gx++) {
+            if (!(Row[gx].Blue | Row[gx].Green | Row[gx].Red)) {
+                continue;
+            }
+            if (gx && (Row[gx-1].Blue | Row[gx-1].Green | Row[gx-1].Red)) {
+                Glyph->Runs[Run-1].Length++;
+            } else {
+                Glyph->Runs[Run].x = (UINT8)gx;
+                Glyph->Runs[Run].Length = 1;
+                Run++;
+            }
+        }
+    }
+    Glyph->RowRun[Height] = Run;
+    AddBytes(Cache, Bytes);
+    return Glyph;
+}
+
+/*
+ * GetGlyph() - Cached glyph of a character, captured on a miss, NULL if it
+ *              can't be cached
+ */
+GLYPH *GetGlyph(IN GLYPH_CACHE *Cache, IN FONT Font, IN CHAR16 Char)
+{
+    UINTN Bucket = HashGlyph(Font, Char);
+    GLYPH *Glyph;
+
+    for (Glyph = Cache->Hash[Bucket]; Glyph; Glyph = Glyph->HashNext) {
+        if (Glyph->Char == Char && Glyph->Font == Font) {
+            Cache->Stats.Hits++;
+            if (Glyph != Cache->Newest) {
+                UnlinkGlyph(Cache, Glyph);
+                LinkNewest(Cache, Glyph);
+            }
+            return Glyph;
+        }
+    }
+    Cache->Stats.Misses++;
+    Glyph = CaptureGlyph(Cache, Font, Char);
+    if (Glyph) {
+        Glyph->HashNext = Cache->Hash[Bucket];
+        Cache->Hash[Bucket] = Glyph;
+        LinkNewest(Cache, Glyph);
+    }
+    return Glyph;
+}
+
+/*
+ * SetGlyphColours() - Colours of an opaque string, as framebuffer pixel
+ *                     values, which become the expanded pair when the same
+ *                     as the last string's
+ *
+ * Text in a new pair every string, as the text tests draw, would expand
+ * every glyph for one use, so is drawn from the runs instead.
+ */
+VOID SetGlyphColours(IN GLYPH_CACHE *Cache, IN UINT32 Fg, IN UINT32 Bg)
+{
+    if (Cache->Pair && Fg == Cache->Fg && Bg == Cache->Bg) {
+        return;
+    }
+    if (Cache->LastValid && Fg == Cache->LastFg && Bg == Cache->LastBg) {
+        Cache->Fg = Fg;
+        Cache->Bg = Bg;
+        Cache->Pair++;
+    }
+    Cache->LastFg = Fg;
+    Cache->LastBg = Bg;
+    Cache->LastValid = TRUE;
+}
+
+/*
+ * GetGlyphPixels() - Glyph expanded in the pair of the current opaque
+ *                    string, NULL if not the expanded pair or the pixels
+ *                    don't fit under the cap
+ */
+CONST UINT32 *GetGlyphPixels(IN GLYPH_CACHE *Cache, IN GLYPH *Glyph)
+{
+    if (!Cache->Pair || Cache->Fg != Cache->LastFg || Cache->Bg != Cache->LastBg) {
+        return NULL;
+    }
+    if (Glyph->PixelsPair == Cache->Pair) {
+        return Glyph->Pixels;
+    }
+    if (!Glyph->Pixels) {
+        UINTN Bytes = Glyph->Width * Glyph->Height * sizeof(UINT32);
+        if (!MakeRoom(Cache, Bytes, Glyph)) {
+            return NULL;
+        }
+        Glyph->Pixels = AllocatePool(Bytes);
+        if (!Glyph->Pixels) {
+            return NULL;
+        }
+        Glyph->Bytes += Bytes;
+        AddBytes(Cache, Bytes);
+    }
+    for (UINT32 gy = 0; gy < Glyph->Height; gy++) {
+        UINT32 *Row = &Glyph->Pixels[gy * Glyph->Width];
+        for (UINT32 gx = 0; gx < Glyph->Width; gx++) {
+            Row[gx] = Cache->Bg;
+        }
+        for (UINT16 r = Glyph->RowRun[gy]; r < Glyph->RowRun[gy+1]; r++) {
+            for (UINT32 gx = Glyph->Runs[r].x; gx < (UINT32)Glyph->Runs[r].x + Glyph->Runs[r].Length; gx++) {
+                Row[gx] = Cache->Fg;
+            }
+        }
+    }
+    Glyph->PixelsPair = Cache->Pair;
+    Cache->Stats.Expansions++;
+    return Glyph->Pixels;
+}
+
+/*
+ * LoadGlyphs() - Capture the glyphs of a string ahead of drawing it
+ */
+VOID LoadGlyphs(IN GLYPH_CACHE *Cache, IN FONT Font, IN CONST CHAR16 *String)
+{
+    for (; *String; String++) {
+        GetGlyph(Cache, Font, *String);
+    }
+}
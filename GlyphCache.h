@@ -0,0 +1,88 @@
+/*
+ * File:    GlyphCache.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Cache of font glyphs as runs of set pixels per row, with colour expanded
+ * pixels for opaque text
+ *
+ * The graphics library doesn't expose its font bitmaps, so a glyph is
+ * captured once on a miss: drawn with GPutString() in a character cell at
+ * the capture position, read back with a GOP Blt and the cell cleared to
+ * black. Each row is kept as runs of set pixels, so transparent text stores
+ * runs and never walks the bitmap. Opaque text in the colour pair of the
+ * last two strings is drawn by copying rows of the glyph expanded to 32-bit
+ * pixels in that pair, expanded when the glyph is first drawn in the pair.
+ * Other pairs are drawn by filling the background and storing the runs.
+ * Glyphs are found by hash of font and character and the least recently
+ * used are freed to keep the cache within its memory cap.
+ */
+
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <Uefi.h>
+#include <Protocol/GraphicsOutput.h>
+#include "GraphicsLib/Graphics.h"
+
+#define GLYPH_CACHE_DEFAULT_KB  64
+#define GLYPH_MAX_WIDTH         32      // wider or taller fonts aren't cached
+#define GLYPH_MAX_HEIGHT        32
+#define GLYPH_HASH_BUCKETS      256     // power of 2
+
+// run of set pixels in a glyph row
+typedef struct {
+    UINT8 x;
+    UINT8 Length;
+} GLYPH_RUN;
+
+typedef struct _GLYPH GLYPH;
+struct _GLYPH {
+    GLYPH *HashNext;
+    GLYPH *Newer;           // least recently used list
+    GLYPH *Older;
+    FONT Font;
+    CHAR16 Char;
+    UINT32 Width;
+    UINT32 Height;
+    UINT16 RowRun[GLYPH_MAX_HEIGHT + 1];    // runs of row y are RowRun[y]...RowRun[y+1]-1
+    GLYPH_RUN *Runs;
+    UINT32 *Pixels;         // expanded in the pair of PixelsPair, NULL until drawn opaque
+    UINT32 PixelsPair;
+    UINTN Bytes;            // allocated for the glyph and its pixels
+};
+
+typedef struct {
+    UINT64 Hits;
+    UINT64 Misses;
+    UINT64 Evictions;       // glyphs freed for the memory cap
+    UINT64 Expansions;      // glyphs expanded to pixels of a colour pair
+    UINT64 PeakBytes;       // most memory held
+} GLYPH_CACHE_STATS;
+
+typedef struct {
+    EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop;
+    INT32 CaptureX, CaptureY;           // top left of the capture cell
+    UINTN MaxBytes;                     // memory cap
+    UINTN Bytes;                        // memory held
+    GLYPH *Hash[GLYPH_HASH_BUCKETS];
+    GLYPH *Newest;
+    GLYPH *Oldest;
+    UINT32 Fg, Bg;                      // pixel values of the expanded pair
+    UINT32 Pair;                        // expanded pair, changed with the colours
+    UINT32 LastFg, LastBg;              // pixel values of the last opaque string
+    BOOLEAN LastValid;                  // an opaque string has been drawn
+    EFI_GRAPHICS_OUTPUT_BLT_PIXEL Cell[GLYPH_MAX_WIDTH * GLYPH_MAX_HEIGHT];
+    GLYPH_CACHE_STATS Stats;
+} GLYPH_CACHE;
+
+EFI_STATUS CreateGlyphCache(OUT GLYPH_CACHE *Cache, IN UINTN MaxBytes, IN INT32 CaptureX, IN INT32 CaptureY);
+VOID DestroyGlyphCache(IN GLYPH_CACHE *Cache);
+GLYPH *GetGlyph(IN GLYPH_CACHE *Cache, IN FONT Font, IN CHAR16 Char);
+VOID SetGlyphColours(IN GLYPH_CACHE *Cache, IN UINT32 Fg, IN UINT32 Bg);
+CONST UINT32 *GetGlyphPixels(IN GLYPH_CACHE *Cache, IN GLYPH *Glyph);
+VOID LoadGlyphs(IN GLYPH_CACHE *Cache, IN FONT Font, IN CONST CHAR16 *String);
+
+#endif // GLYPH_CACHE_H
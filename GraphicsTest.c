@@ -15,12 +15,29 @@
 #include <Library/PrintLib.h>
 //####include <Library/IoLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Protocol/GraphicsOutput.h>
 #include "GraphicsLib/Graphics.h"
 #include "CmdLineLib/CmdLine.h"
 #include "GraphicsTest.h"
 #include "Timer.h"
 #include "Rand.h"
+#include "Workload.h"
+#include "Histogram.h"
+#include "PixelCount.h"
+#include "CacheEvict.h"
+#include "Profile.h"
+#include "Raw.h"
+#include "Batch.h"
+#include "Fill.h"
+#include "Shadow.h"
+#include "Frame.h"
+#include "Parallel.h"
+#include "CircleCache.h"
+#include "GlyphCache.h"
+#include "StringCache.h"
 #include "GraphicsLib/Font.h"
+#define PRIM_STATS_HOOK
+#include "PrimStats.h"
 
 #define DbgPrint(Level, sFormat, ...)
 
@@ -28,42 +45,385 @@
 #define CIRCLE_MIN_RADIUS   5
 #define CIRCLE_MIN_DIAMETER (2 * CIRCLE_MIN_RADIUS)
 #define CLIP_FACTOR         8
+#define PREGEN_HEADROOM     2   // workload size relative to inline iteration count
+#define BALL_RADIUS         100
+#define FRAME_BACKGROUND    RGB_COLOUR(0, 0, 64)
+#define FRAME_BAR_COLOUR    RGB_COLOUR(192, 192, 192)
+#define BATCH_PRIMS         64  // primitives per batch test iteration
 
+// harness deadline check, the interval doubles until checks are at least
+// 1/DEADLINE_CHECK_RATE seconds apart
+#define DEADLINE_CHECK_RATE     10000
+#define MAX_CHECK_INTERVAL      1024
+#define OVERHEAD_ITERATIONS     0x10000
+#define OVERHEAD_FP_SHIFT       8       // fixed point fraction bits
+#define QUIET_ABORT_CHECK_MS    100     // abort check interval at raised TPL
+#define CALL_OVERHEAD_SAMPLES   1024
+
+typedef struct _TEST_CONTEXT TEST_CONTEXT;
+
+// parameter generator for a single test iteration
+typedef VOID (*PARAM_GEN)(WORKLOAD_ENTRY *Entry);
+// optional per-test setup and teardown around the timed loop
+typedef EFI_STATUS (*TEST_SETUP)(TEST_CONTEXT *Ctx);
+typedef VOID (*TEST_TEARDOWN)(TEST_CONTEXT *Ctx);
+// single test iteration
+typedef VOID (*TEST_KERNEL)(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *Entry);
+// pixels written by a single test iteration
+typedef UINT64 (*PIXEL_COUNT)(WORKLOAD_ENTRY *Entry);
+
+// test descriptor
+typedef struct {
+    CHAR16 *Desc;           // name used in results
+    PARAM_GEN Gen;          // NULL if test has no random parameters
+    UINT32 NumParams;       // parameters used from WORKLOAD_ENTRY
+    TEST_SETUP Setup;       // optional
+    TEST_KERNEL Kernel;
+    TEST_TEARDOWN Teardown; // optional
+    PIXEL_COUNT Pixels;
+    UINT32 Prims;           // primitives per iteration, each with its own parameters
+} TEST_DESC;
+
+// bouncing ball state
+typedef struct {
+    RENDER_BUFFER RenBuf;
+    BOOLEAN Created;
+    INT32 Radius;
+    INT32 x, y;     // centre of circle
+    INT32 dx, dy;
+} BALL_STATE;
+
+// row of a sprite drawn, x0...x1 inclusive
+typedef struct {
+    INT32 x0, x1;
+} SPRITE_SPAN;
+
+// animated frame state, a ball bouncing over a progress bar
+typedef struct {
+    FRAME_BUFFERS Buffers;
+    BOOLEAN Created;
+    ARENA SpriteArena;
+    UINT32 *Sprite;         // ball pixels, Size x Size
+    SPRITE_SPAN *Spans;     // drawn part of each sprite row
+    INT32 Size;
+    INT32 x, y;             // top left of sprite
+    INT32 dx, dy;
+    UINT32 Count;           // frames drawn
+} FRAME_STATE;
+
+// state passed to test functions
+struct _TEST_CONTEXT {
+    EFI_STATUS Status;  // kernel error ends the test
+    WORKLOAD *Wl;       // pre-generated parameters or NULL
+    UINT32 Index;       // next workload entry
+    PARAM_GEN Gen;
+    BALL_STATE Ball;
+    BATCH_TARGET Target;
+    SHADOW_BUFFER *Shadow;  // shadow pass only
+    CIRCLE_CACHE *Circles;  // cached circle tests only
+    GLYPH_CACHE *Glyphs;    // cached text tests only
+    STRING_CACHE *Strings;  // cached label test only
+    FRAME_STATE Frame;
+};
 
 // local functions
-STATIC VOID RunTest(GRAPHIC_TEST_TYPE TestType, UINT32 Duration, UINT32 Iterations, BOOLEAN Pause, TEST_RESULTS *TestResults);
-STATIC VOID RunRandPixelTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData);
-STATIC VOID RunRandLineTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData);
-STATIC VOID RunRandHLineTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData);
-STATIC VOID RunRandVLineTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData);
-STATIC VOID RunRandTriangleTest(UINT32 Duration, UINT32 Iterations, BOOLEAN Filled, TEST_RUN_DATA *RunData);
-STATIC VOID RunRandRectangleTest(UINT32 Duration, UINT32 Iterations, BOOLEAN Filled, TEST_RUN_DATA *RunData);
-STATIC VOID RunRandCircleTest(UINT32 Duration, UINT32 Iterations, BOOLEAN Filled, TEST_RUN_DATA *RunData);
-STATIC VOID RunRandTextTest(UINT32 Duration, UINT32 Iterations, BOOLEAN SetBackground, TEST_RUN_DATA *RunData);
-STATIC VOID RunClearScreenTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData);
-STATIC VOID RunBouncingBallTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData);
+STATIC VOID RunTest(GRAPHIC_TEST_TYPE TestType, TEST_OPTIONS *Options, TEST_RESULTS *TestResults);
+STATIC VOID RunTrials(CONST TEST_DESC *Desc, TEST_OPTIONS *Options, WORKLOAD *Wl, TEST_RUN_DATA *RunData);
+STATIC VOID RunHarness(CONST TEST_DESC *Desc, TEST_OPTIONS *Options, WORKLOAD *Wl, HISTOGRAM *Hist, RAW_SAMPLES *Raw, TEST_RUN_DATA *RunData);
+STATIC EFI_STATUS RunSweep(TEST_OPTIONS *Options, SWEEP_RESULTS *Sweep);
+STATIC UINT64 MeasureHarnessOverhead(VOID);
+STATIC EFI_GRAPHICS_PIXEL_FORMAT GetPixelFormat(VOID);
+STATIC VOID NextParams(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *Entry);
+STATIC VOID SeedParams(VOID);
+STATIC UINT32 RandParam(UINT32 Range);
+STATIC VOID GenPixelParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenLineParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenHLineParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenVLineParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenTriangleParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenCircleParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenTextParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenColourParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenSweepLineParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenSweepRectangleParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenSweepCircleParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenSweepTriangleParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenRadiusParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID GenLabelParams(WORKLOAD_ENTRY *Entry);
+STATIC VOID PixelKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID LineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID HLineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID VLineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID TriangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID RectangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID CircleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID FillTriangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID FillRectangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID FillCircleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID Text1Kernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID Text2Kernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ClearScreenKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC EFI_STATUS BandwidthSetup(TEST_CONTEXT *Ctx);
+STATIC VOID BandwidthKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID BandwidthTeardown(TEST_CONTEXT *Ctx);
+STATIC EFI_STATUS BallSetup(TEST_CONTEXT *Ctx);
+STATIC VOID BallKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID BallTeardown(TEST_CONTEXT *Ctx);
+STATIC EFI_STATUS FrameSetup(TEST_CONTEXT *Ctx);
+STATIC VOID FrameKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID FrameTeardown(TEST_CONTEXT *Ctx);
+STATIC EFI_STATUS BatchSetup(TEST_CONTEXT *Ctx);
+STATIC EFI_STATUS FillSetup(TEST_CONTEXT *Ctx);
+STATIC EFI_STATUS ShadowSetup(TEST_CONTEXT *Ctx);
+STATIC TEST_KERNEL GetShadowKernel(GRAPHIC_TEST_TYPE TestType);
+STATIC VOID ShadowPixelKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ShadowLineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ShadowHLineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ShadowVLineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ShadowTriangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ShadowRectangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ShadowFillTriangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ShadowFillRectangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ShadowClearScreenKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ShadowPixelBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ShadowLineBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID ShadowFillRectangleBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID PixelBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID GatherBatch(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID GatherBatchLines(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID LineBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID FillRectangleBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID HalfSpaceTriKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC EFI_STATUS CircleSetup(TEST_CONTEXT *Ctx);
+STATIC EFI_STATUS SpansSetup(TEST_CONTEXT *Ctx);
+STATIC VOID CircleCacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID FillCircleCacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID CircleTeardown(TEST_CONTEXT *Ctx);
+STATIC EFI_STATUS GlyphSetup(TEST_CONTEXT *Ctx);
+STATIC VOID Text1CacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID Text2CacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID Text2FixedKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID Text2FixedCacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID GlyphTeardown(TEST_CONTEXT *Ctx);
+STATIC VOID LabelKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC EFI_STATUS StringSetup(TEST_CONTEXT *Ctx);
+STATIC VOID LabelCacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC VOID StringTeardown(TEST_CONTEXT *Ctx);
+STATIC VOID NoopGen(WORKLOAD_ENTRY *Entry);
+STATIC VOID NoopKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E);
+STATIC UINT64 CountTestPixels(CONST TEST_DESC *Desc, WORKLOAD *Wl, UINT32 Count);
+STATIC UINT64 PixelPixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 LinePixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 HLinePixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 VLinePixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 TrianglePixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 RectanglePixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 CirclePixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 FillTrianglePixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 FillRectanglePixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 FillCirclePixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 TextPixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 LabelPixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 ClearScreenPixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 BandwidthPixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 BallPixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 FramePixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 HalfSpaceTriPixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 CircleCachePixels(WORKLOAD_ENTRY *E);
+STATIC UINT64 FillCircCachePixels(WORKLOAD_ENTRY *E);
+
+// test table, indexed by GRAPHIC_TEST_TYPE
+STATIC CONST TEST_DESC TestTable[NUM_TESTS] = {
+//    Desc              Gen                Params Setup           Kernel                    Teardown           Pixels               Prims
+    { L"Pixel",         GenPixelParams,    2,     NULL,           PixelKernel,              NULL,              PixelPixels,         1 },
+    { L"Line",          GenLineParams,     4,     NULL,           LineKernel,               NULL,              LinePixels,          1 },
+    { L"HorLine",       GenHLineParams,    3,     NULL,           HLineKernel,              NULL,              HLinePixels,         1 },
+    { L"VerLine",       GenVLineParams,    3,     NULL,           VLineKernel,              NULL,              VLinePixels,         1 },
+    { L"Triangle",      GenTriangleParams, 6,     NULL,           TriangleKernel,           NULL,              TrianglePixels,      1 },
+    { L"Rectangle",     GenLineParams,     4,     NULL,           RectangleKernel,          NULL,              RectanglePixels,     1 },
+    { L"Circle",        GenCircleParams,   3,     NULL,           CircleKernel,             NULL,              CirclePixels,        1 },
+    { L"FillTriangle",  GenTriangleParams, 6,     NULL,           FillTriangleKernel,       NULL,              FillTrianglePixels,  1 },
+    { L"FillRectangle", GenLineParams,     4,     FillSetup,      FillRectangleKernel,      NULL,              FillRectanglePixels, 1 },
+    { L"FillCircle",    GenCircleParams,   3,     NULL,           FillCircleKernel,         NULL,              FillCirclePixels,    1 },
+    { L"Text",          GenTextParams,     2,     NULL,           Text1Kernel,              NULL,              TextPixels,          1 },
+    { L"Text2",         GenTextParams,     2,     NULL,           Text2Kernel,              NULL,              TextPixels,          1 },
+    { L"ClearScreen",   GenColourParams,   0,     FillSetup,      ClearScreenKernel,        NULL,              ClearScreenPixels,   1 },
+    { L"Bandwidth",     GenColourParams,   0,     BandwidthSetup, BandwidthKernel,          BandwidthTeardown, BandwidthPixels,     1 },
+    { L"Bouncing Ball", NULL,              0,     BallSetup,      BallKernel,               BallTeardown,      BallPixels,          1 },
+    { L"PixelBatch",    GenPixelParams,    2,     BatchSetup,     PixelBatchKernel,         NULL,              PixelPixels,         BATCH_PRIMS },
+    { L"LineBatch",     GenLineParams,     4,     BatchSetup,     LineBatchKernel,          NULL,              LinePixels,          BATCH_PRIMS },
+    { L"FillRectBatch", GenLineParams,     4,     BatchSetup,     FillRectangleBatchKernel, NULL,              FillRectanglePixels, BATCH_PRIMS },
+    { L"Frame",         NULL,              0,     FrameSetup,     FrameKernel,              FrameTeardown,     FramePixels,         1 },
+    { L"HalfSpaceTri",  GenTriangleParams, 6,     BatchSetup,     HalfSpaceTriKernel,       NULL,              HalfSpaceTriPixels,  1 },
+    { L"CircleCache",   GenRadiusParams,   3,     CircleSetup,    CircleCacheKernel,        CircleTeardown,    CircleCachePixels,   1 },
+    { L"FillCircCache", GenRadiusParams,   3,     CircleSetup,    FillCircleCacheKernel,    CircleTeardown,    FillCircCachePixels, 1 },
+    { L"CircleSpans",   GenRadiusParams,   3,     SpansSetup,     CircleCacheKernel,        CircleTeardown,    CircleCachePixels,   1 },
+    { L"FillCircSpans", GenRadiusParams,   3,     SpansSetup,     FillCircleCacheKernel,    CircleTeardown,    FillCircCachePixels, 1 },
+    { L"TextCache",     GenTextParams,     2,     GlyphSetup,     Text1CacheKernel,         GlyphTeardown,     TextPixels,          1 },
+    { L"Text2Cache",    GenTextParams,     2,     GlyphSetup,     Text2CacheKernel,         GlyphTeardown,     TextPixels,          1 },
+    { L"Text2Fixed",    GenTextParams,     2,     NULL,           Text2FixedKernel,         NULL,              TextPixels,          1 },
+    { L"Text2FixCache", GenTextParams,     2,     GlyphSetup,     Text2FixedCacheKernel,    GlyphTeardown,     TextPixels,          1 },
+    { L"Labels",        GenLabelParams,    3,     NULL,           LabelKernel,              NULL,              LabelPixels,         1 },
+    { L"LabelCache",    GenLabelParams,    3,     StringSetup,    LabelCacheKernel,         StringTeardown,    LabelPixels,         1 },
+};
+
+// kernels drawing to the shadow buffer, tests not listed aren't run in the
+// shadow pass as only the batch calls can draw to system memory
+STATIC CONST struct {
+    GRAPHIC_TEST_TYPE Test;
+    TEST_KERNEL Kernel;
+} ShadowTests[] = {
+    { PIXEL_TEST,                   ShadowPixelKernel },
+    { LINE_TEST,                    ShadowLineKernel },
+    { HLINE_TEST,                   ShadowHLineKernel },
+    { VLINE_TEST,                   ShadowVLineKernel },
+    { TRIANGLE_TEST,                ShadowTriangleKernel },
+    { RECTANGLE_TEST,               ShadowRectangleKernel },
+    { FILL_TRIANGLE_TEST,           ShadowFillTriangleKernel },
+    { FILL_RECTANGLE_TEST,          ShadowFillRectangleKernel },
+    { CLEAR_SCREEN_TEST,            ShadowClearScreenKernel },
+    { PIXEL_BATCH_TEST,             ShadowPixelBatchKernel },
+    { LINE_BATCH_TEST,              ShadowLineBatchKernel },
+    { FILL_RECTANGLE_BATCH_TEST,    ShadowFillRectangleBatchKernel },
+    { FILL_TRIANGLE_HS_TEST,        ShadowFillTriangleKernel },
+};
+
+// size sweep table, indexed by SWEEP_PRIM
+STATIC CONST TEST_DESC SweepTable[NUM_SWEEP_PRIMS] = {
+//    Desc              Gen                      Params Setup      Kernel               Teardown Pixels               Prims
+    { L"Line",          GenSweepLineParams,      4,     NULL,      LineKernel,          NULL,    LinePixels,          1 },
+    { L"FillRectangle", GenSweepRectangleParams, 4,     FillSetup, FillRectangleKernel, NULL,    FillRectanglePixels, 1 },
+    { L"FillCircle",    GenSweepCircleParams,    3,     NULL,      FillCircleKernel,    NULL,    FillCirclePixels,    1 },
+    { L"FillTriangle",  GenSweepTriangleParams,  6,     NULL,      FillTriangleKernel,  NULL,    FillTrianglePixels,  1 },
+};
+// primitive extent in pixels for each sweep bucket
+STATIC CONST UINT32 SweepSizes[NUM_SWEEP_SIZES] = { 1, 4, 16, 64, 256, 1024 };
+STATIC INT32 SweepSize;
+
+// empty test used to measure harness overhead
+STATIC CONST TEST_DESC NoopTest = { L"Noop", NoopGen, 0, NULL, NoopKernel, NULL, NULL, 1 };
+
+// radii of the cached circle tests, as UI code redraws a few sizes
+STATIC CONST INT32 CircleRadii[] = { 4, 8, 12, 16, 24, 32, 48, 64 };
+// span cache of the cached circle tests and table of circles being counted
+STATIC CIRCLE_CACHE CircleCache;
+STATIC CIRCLE_SPAN CountCircleTable[CIRCLE_CACHE_MAX_RADIUS + 1];
+
+// display and text dimensions used by the parameter generators
+STATIC INT32 DisplayWidth;
+STATIC INT32 DisplayHeight;
+STATIC CONST FONT TextFont = FONT10x20;
+STATIC CHAR16 TextMessage[] = L"The quick brown fox jumps over the lazy dog.";
+STATIC INT32 TextWidth;
+STATIC INT32 TextHeight;
+// glyph cache of the cached text tests, the fixed colour tests draw opaque
+// text in one pair as UI text is, the cache's expanded pair
+STATIC GLYPH_CACHE GlyphCache;
+STATIC UINTN GlyphCacheBytes = GLYPH_CACHE_DEFAULT_KB * 1024;
+#define TEXT_CACHE_FG   RGB_COLOUR(255, 255, 255)
+#define TEXT_CACHE_BG   RGB_COLOUR(0, 0, 128)
+// labels of the label tests, drawn in turn at their place in a menu as
+// firmware setup redraws them each frame, every other label on a bar
+STATIC CHAR16 *Labels[] = {
+    L"Continue", L"Boot Manager", L"Device Manager", L"Boot Maintenance Manager",
+    L"Secure Boot Configuration", L"Network Device List", L"Date and Time", L"Language",
+    L"Save Changes", L"Discard Changes", L"Load Defaults", L"Reset"
+};
+#define LABEL_OPAQUE(Label) (((Label) & 1) == 0)
+STATIC UINT32 NextLabel;      // restarted by SeedParams()
+// string cache of the cached label test
+STATIC STRING_CACHE StringCache;
+STATIC UINTN StringCacheBytes = STRING_CACHE_DEFAULT_KB * 1024;
+// clip window of current test, the screen if not clipped
+STATIC INT32 ClipX0, ClipY0, ClipX1, ClipY1;
+// parameter generator state, Park-Miller Rand() is used instead if LegacyRand
+STATIC RAND_STATE ParamRng;
+STATIC BOOLEAN LegacyRand = FALSE;
+// clear screen and fill rectangle tests use the fill kernels, not the library
+STATIC BOOLEAN DirectFill = FALSE;
+
+// per-call latency, shared by all tests
+STATIC HISTOGRAM LatencyHist;
+// per-iteration samples of a trial, if writing raw samples
+STATIC RAW_SAMPLES RawSamples;
+// primitives of a batch test iteration
+STATIC WORKLOAD_ENTRY BatchEntries[BATCH_PRIMS];
+STATIC BATCH_POINT BatchPoints[BATCH_PRIMS];
+STATIC BATCH_LINE BatchLines[BATCH_PRIMS];
+// per-trial results of the current test
+STATIC TEST_RUN_DATA TrialData[MAX_TRIALS];
+STATIC UINT64 TrialRate[MAX_TRIALS];
+STATIC CONST UINT32 PercentilePerMille[NUM_PERCENTILES] = { 500, 900, 990, 999 };
+
+// harness cycles per iteration in OVERHEAD_FP_SHIFT fixed point
+STATIC UINT64 HarnessOverhead = 0;
+// abort seen by a harness check, consumed key is not seen again
+STATIC BOOLEAN AbortRequested = FALSE;
+// cold pass evicts the data cache before each iteration and times the call
+STATIC BOOLEAN ColdPass = FALSE;
+// minimum cycles of an individually timed empty call
+STATIC UINT64 TimedCallOverhead = 0;
+// shadow pass draws to system memory and flushes to the screen with Blt
+STATIC SHADOW_BUFFER Shadow;
+STATIC BOOLEAN ShadowPass = FALSE;
+// frame test present method requested
+STATIC PRESENT_METHOD FramePresent = PRESENT_AUTO;
 
 
 /*
  * RunGraphicTest()
  */
-EFI_STATUS RunGraphicTest(UINT32 Mode, GRAPHIC_TEST_TYPE TestType, UINT32 Duration, UINT32 Iterations, BOOLEAN ClipTest, BOOLEAN Pause, TEST_RESULTS *TestResults)
+EFI_STATUS RunGraphicTest(UINT32 Mode, GRAPHIC_TEST_TYPE TestType, TEST_OPTIONS *Options, TEST_RESULTS *TestResults)
 {
     EFI_STATUS Status = EFI_SUCCESS;
 
-    if (!Duration && !Iterations) {
+    if (!Options->Duration && !Options->Iterations) {
         DbgPrint(DL_WARN, "%s() zero duration and iterations", __func__);
         Status = EFI_INVALID_PARAMETER;
         goto Error_exit;
     }
+    PROFILE_BEGIN(TimerZone);
     InitTimer();
+    PROFILE_END(TimerZone, L"InitTimer");
+    // ticks serviced during timed batches are counted if available
+    BOOLEAN Ticks = !EFI_ERROR(StartTickCounter());
+    AbortRequested = FALSE;
+    LegacyRand = Options->LegacyRand;
+    InitFill();
+    DirectFill = (Options->Fill != FILL_LIBRARY);
+    FramePresent = Options->Present;
+    GlyphCacheBytes = (UINTN)Options->GlyphCacheKb * 1024;
+    StringCacheBytes = (UINTN)Options->StringCacheKb * 1024;
+    if (DirectFill && EFI_ERROR(SetFillKernel(Options->Fill))) {
+        Print(L"WARNING: %s fill kernel not supported, using %s\n", GetFillKernelDesc(Options->Fill), GetFillKernelDesc(GetBestFillKernel()));
+    }
+    // APs are started after the fill kernel is chosen, each must support it
+    if (EFI_ERROR(InitParallel(Options->Cpus)) || GetParallelCpus() < Options->Cpus) {
+        Print(L"WARNING: %u CPUs requested, fills tiled across %u\n", Options->Cpus, GetParallelCpus());
+    }
+    PROFILE_BEGIN(OverheadZone);
+    HarnessOverhead = MeasureHarnessOverhead();
+    PROFILE_END(OverheadZone, L"MeasureHarnessOverhead");
+    if (Options->Cold) {
+        PROFILE_BEGIN(EvictZone);
+        Status = InitCacheEvict();
+        PROFILE_END(EvictZone, L"InitCacheEvict");
+        if (EFI_ERROR(Status)) {
+            Print(L"ERROR: Failed to allocate cache eviction buffer (%r)\n", Status);
+            goto Error_exit;
+        }
+    }
+    PROFILE_BEGIN(InitZone);
     Status = InitGraphics();
+    PROFILE_END(InitZone, L"InitGraphics");
     if (EFI_ERROR(Status)) {
         Print(L"ERROR: Failed to initialise graphics (%r)\n", Status);
         goto Error_exit;
     }
     if (Mode != CURRENT_MODE) {
+        PROFILE_BEGIN(ModeZone);
         Status = SetGraphicsMode(Mode);
+        PROFILE_END(ModeZone, L"SetGraphicsMode");
         if (EFI_ERROR(Status)) {
             Print(L"ERROR: Failed to set graphics mode %u (%r)\n", Mode, Status);
             goto Error_exit;
@@ -76,7 +436,39 @@ EFI_STATUS RunGraphicTest(UINT32 Mode, GRAPHIC_TEST_TYPE TestType, UINT32 Durati
         TestResults->Mode = CurrMode;
         TestResults->HorRes = GetFBHorRes();
         TestResults->VerRes = GetFBVerRes();
+        TestResults->PixelFormat = GetPixelFormat();
+        TestResults->Overhead = HarnessOverhead;
+        TestResults->Ticks = Ticks;
+        TestResults->Quiet = Options->Quiet;
+        TestResults->EvictSize = GetEvictSize();
+        TestResults->LlcSize = GetLlcSize();
+        // formats the batch target doesn't draw stay on the library
+        BATCH_TARGET Probe;
+        InitBatchTarget(&Probe, 0, 0, 0, 0);
+        TestResults->FillKernel = (DirectFill && Probe.FrameBuffer) ? GetFillKernel() : FILL_LIBRARY;
+        // batch calls fill with the selected kernel, the best with -fill lib
+        TestResults->BatchFillKernel = Probe.FrameBuffer ? GetFillKernel() : FILL_LIBRARY;
+        TestResults->Present = GetPresentMethod(FramePresent);
+        TestResults->Cpus = GetParallelCpus();
+    }
+    if (FramePresent == PRESENT_COPY && GetPresentMethod(PRESENT_COPY) != PRESENT_COPY) {
+        Print(L"WARNING: framebuffer can't be copied to in mode %u, frames presented by Blt\n", CurrMode);
+    }
+    if (Options->Shadow) {
+        Status = CreateShadowBuffer(&Shadow);
+        if (EFI_ERROR(Status)) {
+            Print(L"ERROR: Failed to allocate shadow buffer (%r)\n", Status);
+            goto Error_exit;
+        }
+    }
+    if (Options->Raw) {
+        Status = CreateRawSamples(&RawSamples, RAW_MAX_SAMPLES);
+        if (EFI_ERROR(Status)) {
+            Print(L"ERROR: Failed to allocate raw sample buffer (%r)\n", Status);
+            goto Error_exit;
+        }
     }
+    ResetBandwidthResults();
     UINTN start, end;
     if (TestType == ALL_TESTS) {
         start = 0;
@@ -86,476 +478,1560 @@ EFI_STATUS RunGraphicTest(UINT32 Mode, GRAPHIC_TEST_TYPE TestType, UINT32 Durati
     }
     UINTN i = start;
     do {
-        if (ClipTest) {
+        ClipX0 = ClipY0 = 0;
+        ClipX1 = GetFBHorRes() - 1;
+        ClipY1 = GetFBVerRes() - 1;
+        if (Options->ClipTest) {
             INT32 HorOff = GetFBHorRes() / CLIP_FACTOR;
             INT32 VerOff = GetFBVerRes() / CLIP_FACTOR;
-            SetClipping(HorOff, VerOff, GetFBHorRes() - HorOff - 1, GetFBVerRes() - VerOff - 1);
+            ClipX0 = HorOff;
+            ClipY0 = VerOff;
+            ClipX1 = GetFBHorRes() - HorOff - 1;
+            ClipY1 = GetFBVerRes() - VerOff - 1;
+            SetClipping(ClipX0, ClipY0, ClipX1, ClipY1);
         }
-        RunTest(i, Duration, Iterations, Pause, TestResults);
+        SetPixelCountClip(ClipX0, ClipY0, ClipX1, ClipY1);
+        PROFILE_BEGIN(TestZone);
+        RunTest(i, Options, TestResults);
+        PROFILE_END(TestZone, GetTestDesc(i));
         ResetClipping();
-        if (Pause) {
+        if (TestResults) {
+            GetBandwidthResults(&TestResults->Bandwidth);
+        }
+        if (Options->Pause) {
             GPutString(0, 0, L"Press a key to continue...", WHITE, BLACK, TRUE, FONT8x13);
+            PROFILE_BEGIN(PauseZone);
             Status = WaitKeyPress(NULL, NULL, NULL, KEY_NOOPT);
+            PROFILE_END(PauseZone, L"Pause");
             if (EFI_ERROR(Status)) {
                 goto Error_exit;
             }
         }
-        if (CheckProgAbort(FALSE)) {
+        if (AbortRequested || CheckProgAbort(FALSE)) {
             Status = EFI_ABORTED;
             goto Error_exit;
         }
         i++;
     } while (i < end);
+    if (Options->Sweep) {
+        PROFILE_BEGIN(SweepZone);
+        Status = RunSweep(Options, TestResults ? &TestResults->Sweep : NULL);
+        PROFILE_END(SweepZone, L"Sweep");
+        if (EFI_ERROR(Status)) {
+            goto Error_exit;
+        }
+    }
 
 Error_exit:
+    if (TestResults) {
+        TestResults->RawSamples = RawSamples.TotalWritten;
+        TestResults->RawDropped = RawSamples.TotalDropped;
+    }
+    DestroyRawSamples(&RawSamples);
+    DestroyShadowBuffer(&Shadow);
+    FreeParallel();
+    FreeCacheEvict();
+    StopTickCounter();
     RestoreConsole();
     return Status;
 }
 
 /*
- * RunTest()
+ * RunTest() - Run test with inline random parameters, optionally again with
+ *             a cold cache, through the shadow buffer and streaming from a
+ *             pre-generated workload
  */
-STATIC VOID RunTest(GRAPHIC_TEST_TYPE TestType, UINT32 Duration, UINT32 Iterations, BOOLEAN Pause, TEST_RESULTS *TestResults)
+STATIC VOID RunTest(GRAPHIC_TEST_TYPE TestType, TEST_OPTIONS *Options, TEST_RESULTS *TestResults)
 {
-    ClearScreen(BLACK);
-    Srand(1);
-    TEST_RUN_DATA *RunData = TestResults && (TestType < NUM_TESTS) ? &TestResults->Data[TestType] : NULL;
-    switch(TestType) {            
-    case PIXEL_TEST:
-        RunRandPixelTest(Duration, Iterations, RunData);
-        break;
-    case LINE_TEST:
-        RunRandLineTest(Duration, Iterations, RunData);
-        break;            
-    case HLINE_TEST:
-        RunRandHLineTest(Duration, Iterations, RunData);
-        break;            
-    case VLINE_TEST:
-        RunRandVLineTest(Duration, Iterations, RunData);
-        break;            
-    case TRIANGLE_TEST:
-        RunRandTriangleTest(Duration, Iterations, FALSE, RunData);
-        break;            
-    case RECTANGLE_TEST:
-        RunRandRectangleTest(Duration, Iterations, FALSE, RunData);
-        break;            
-    case CIRCLE_TEST:
-        RunRandCircleTest(Duration, Iterations, FALSE, RunData);
-        break;
-    case FILL_TRIANGLE_TEST:
-        RunRandTriangleTest(Duration, Iterations, TRUE, RunData);
-        break;            
-    case FILL_RECTANGLE_TEST:
-        RunRandRectangleTest(Duration, Iterations, TRUE, RunData);
-        break;            
-    case FILL_CIRCLE_TEST:
-        RunRandCircleTest(Duration, Iterations, TRUE, RunData);
-        break;
-    case TEXT1_TEST: // transparent background
-        RunRandTextTest(Duration, Iterations, FALSE, RunData);
-        break;
-    case TEXT2_TEST: // opaque background
-        RunRandTextTest(Duration, Iterations, TRUE, RunData);
-        break;
-    case CLEAR_SCREEN_TEST:
-        RunClearScreenTest(Duration, Iterations, RunData);
-        break;
-    case BOUNCING_BALL_TEST:
-        RunBouncingBallTest(Duration, Iterations, RunData);
-        break;
-    default:
+    TEST_RUN_DATA InlineData = {0};
+
+    if (TestType >= NUM_TESTS) {
         DbgPrint(DL_ERROR, "Invalid graphics test (%u)\n", TestType);
-        break;
+        return;
+    }
+    CONST TEST_DESC *Desc = &TestTable[TestType];
+    // frame times are the per-call latency of the frame test
+    TEST_OPTIONS FrameOptions;
+    if (TestType == FRAME_TEST && !Options->Histogram) {
+        FrameOptions = *Options;
+        FrameOptions.Histogram = TRUE;
+        Options = &FrameOptions;
+    }
+
+    DisplayWidth = GetFBHorRes();
+    DisplayHeight = GetFBVerRes();
+    TextWidth = (INT32)(StrLen(TextMessage) * GetFontWidth(TextFont));
+    TextHeight = GetFontHeight(TextFont);
+
+    ResetPrimStats();
+    RunTrials(Desc, Options, NULL, &InlineData);
+    if (TestResults) {
+        TestResults->Data[TestType] = InlineData;
+        if (Options->PrimStats) {
+            GetPrimStats(&TestResults->PrimStats[TestType]);
+        }
+    }
+    if (Options->Cold && !AbortRequested) {
+        TEST_RUN_DATA ColdData = {0};
+        ColdPass = TRUE;
+        RunTrials(Desc, Options, NULL, &ColdData);
+        ColdPass = FALSE;
+        if (TestResults) {
+            TestResults->ColdData[TestType] = ColdData;
+        }
     }
+    TEST_KERNEL ShadowKernel = GetShadowKernel(TestType);
+    if (Options->Shadow && ShadowKernel && !AbortRequested) {
+        TEST_DESC ShadowDesc = *Desc;
+        ShadowDesc.Setup = ShadowSetup;
+        ShadowDesc.Kernel = ShadowKernel;
+        ShadowDesc.Teardown = NULL;
+        TEST_RUN_DATA ShadowData = {0};
+        ShadowPass = TRUE;
+        RunTrials(&ShadowDesc, Options, NULL, &ShadowData);
+        ShadowPass = FALSE;
+        if (TestResults) {
+            TestResults->ShadowData[TestType] = ShadowData;
+        }
+    }
+    if (!Options->Pregen || !Desc->Gen || AbortRequested) {
+        return;
+    }
+
+    // size workload from iterations, or estimate from the inline run,
+    // the workload is reused from the start if exhausted
+    UINT64 Size = Options->Iterations ? Options->Iterations : (UINT64)InlineData.Count * PREGEN_HEADROOM;
+    Size *= Desc->Prims;
+    if (Size > WL_MAX_ENTRIES) {
+        Size = WL_MAX_ENTRIES;
+    }
+    if (Size == 0) {
+        Size = 1;
+    }
+    WORKLOAD Wl;
+    EFI_STATUS Status = CreateWorkload(&Wl, (UINT32)Size, Desc->NumParams);
+    if (EFI_ERROR(Status)) {
+        DbgPrint(DL_WARN, "Failed to create workload (%r)\n", Status);
+        return;
+    }
+    PROFILE_BEGIN(GenZone);
+    SeedParams();
+    for (UINT32 i = 0; i < Wl.Size; i++) {
+        WORKLOAD_ENTRY Entry;
+        Desc->Gen(&Entry);
+        SetWorkloadEntry(&Wl, i, &Entry);
+    }
+    PROFILE_END(GenZone, L"GenWorkload");
+    TEST_RUN_DATA PregenData = {0};
+    RunTrials(Desc, Options, &Wl, &PregenData);
+    if (TestResults) {
+        TestResults->PregenData[TestType] = PregenData;
+    }
+    DestroyWorkload(&Wl);
 }
 
 /*
- * GetTestDesc()
+ * RunTrials() - Repeated runs of test, discarding warm-up runs
+ *
+ * Statistics are over the iteration rate of each trial, the trial with the
+ * median rate is returned as representative, latency and batch counts cover
+ * all trials.
  */
-CHAR16 *GetTestDesc(GRAPHIC_TEST_TYPE type)
+STATIC VOID RunTrials(CONST TEST_DESC *Desc, TEST_OPTIONS *Options, WORKLOAD *Wl, TEST_RUN_DATA *RunData)
 {
-    switch (type) {
-    case PIXEL_TEST:
-        return L"Pixel";
-    case LINE_TEST:
-        return L"Line";
-    case HLINE_TEST:
-        return L"HorLine";
-    case VLINE_TEST:
-        return L"VerLine";
-    case TRIANGLE_TEST:
-        return L"Triangle";
-    case RECTANGLE_TEST:
-        return L"Rectangle";
-    case CIRCLE_TEST:
-        return L"Circle";
-    case FILL_TRIANGLE_TEST:
-        return L"FillTriangle";
-    case FILL_RECTANGLE_TEST:
-        return L"FillRectangle";
-    case FILL_CIRCLE_TEST:
-        return L"FillCircle";
-    case TEXT1_TEST:
-        return L"Text";
-    case TEXT2_TEST:
-        return L"Text2";
-    case CLEAR_SCREEN_TEST:
-        return L"ClearScreen";
-    case BOUNCING_BALL_TEST:
-        return L"Bouncing Ball";
-    default:
-        break;
+    HISTOGRAM *Hist = NULL;
+    RAW_SAMPLES *Raw = Options->Raw ? &RawSamples : NULL;
+    UINT32 Repeat = Options->Repeat ? Options->Repeat : 1;
+    UINT32 NumTrials = 0;
+    UINT32 Batches = 0, Disturbed = 0, Deferred = 0;
+
+    if (Repeat > MAX_TRIALS) {
+        Repeat = MAX_TRIALS;
+    }
+    if (Options->Histogram) {
+        Hist = &LatencyHist;
+        ResetHistogram(Hist);
+    }
+    for (UINT32 t = 0; t < Options->WarmupRuns + Repeat; t++) {
+        BOOLEAN Timed = (t >= Options->WarmupRuns);
+        TEST_RUN_DATA *Trial = &TrialData[NumTrials];
+        ZeroMem(Trial, sizeof(TEST_RUN_DATA));
+        PROFILE_BEGIN(ClearZone);
+        ClearScreen(BLACK);
+        PROFILE_END(ClearZone, L"ClearScreen");
+        SeedParams();
+        if (Raw) {
+            ResetRawSamples(Raw);
+        }
+        PROFILE_BEGIN(HarnessZone);
+        RunHarness(Desc, Options, Wl, Timed ? Hist : NULL, Timed ? Raw : NULL, Trial);
+        PROFILE_END(HarnessZone, ColdPass ? L"Cold trial" : (ShadowPass ? L"Shadow trial" : (Timed ? L"Trial" : L"Warmup trial")));
+        if (!Trial->Run || AbortRequested) {
+            return;
+        }
+        // raw samples are written between trials, outside the timing
+        if (Timed && Raw) {
+            PROFILE_BEGIN(RawZone);
+            EFI_STATUS Status = WriteRawSamples(Raw, Options->Raw, DisplayWidth, DisplayHeight, Desc->Desc,
+                                                ColdPass ? L"cold" : (ShadowPass ? L"shadow" : (Wl ? L"pregen" : L"inline")), NumTrials);
+            PROFILE_END(RawZone, L"WriteRawSamples");
+            if (EFI_ERROR(Status)) {
+                Print(L"ERROR: Failed to write raw samples (%r)\n", Status);
+                AbortRequested = TRUE;
+                return;
+            }
+        }
+        if (Timed) {
+            TrialRate[NumTrials++] = Trial->TimeNs ? MultU64x64(Trial->Count, 1000000000) / Trial->TimeNs : 0;
+            Batches += Trial->Batches;
+            Disturbed += Trial->Disturbed;
+            Deferred += Trial->Deferred;
+        }
+    }
+
+    // representative trial is the one nearest the median rate
+    STATS Stats;
+    ComputeStats(TrialRate, NumTrials, &Stats);
+    UINT32 Rep = 0;
+    for (UINT32 t = 1; t < NumTrials; t++) {
+        UINT64 Diff = TrialRate[t] > Stats.Median ? TrialRate[t] - Stats.Median : Stats.Median - TrialRate[t];
+        UINT64 RepDiff = TrialRate[Rep] > Stats.Median ? TrialRate[Rep] - Stats.Median : Stats.Median - TrialRate[Rep];
+        if (Diff < RepDiff) {
+            Rep = t;
+        }
+    }
+    *RunData = TrialData[Rep];
+    RunData->Stats = Stats;
+    RunData->Batches = Batches;
+    RunData->Disturbed = Disturbed;
+    RunData->Deferred = Deferred;
+    RunData->Pixels = CountTestPixels(Desc, Wl, RunData->Count);
+    if (Hist && Hist->Total) {
+        TEST_LATENCY *Latency = &RunData->Latency;
+        Latency->Valid = TRUE;
+        Latency->Min = Hist->Min;
+        Latency->Max = Hist->Max;
+        for (UINTN i = 0; i < NUM_PERCENTILES; i++) {
+            Latency->Pct[i] = HistogramPercentile(Hist, PercentilePerMille[i]);
+        }
     }
-    return L"Unknown";
 }
 
 /*
- * RunRandPixelTest()
+ * RunHarness() - Single timed run of test, parameters from workload if not NULL
+ *               and per-call latency added to histogram and raw samples if
+ *               not NULL
+ *
+ * The deadline is a precomputed TSC value only checked every Interval
+ * iterations and the measured harness overhead is subtracted from the time.
+ * Quiet runs each batch at TPL_NOTIFY so timer event notifications are held
+ * off until it ends, only time inside batches is counted and abort is checked
+ * between batches. The timer interrupt itself still runs, TPL_HIGH_LEVEL
+ * would stop it but GOP Blt and pool allocation in the kernels raise to
+ * TPL_NOTIFY, which is not allowed from a higher TPL.
+ *
+ * A cold pass evicts the data cache before every iteration and only counts
+ * the time of each call. When calls are timed for the histogram or raw
+ * samples the time is the sum of the timed calls and parameter fetches, less
+ * the timer reads, so timing them doesn't slow the run. A shadow pass flushes
+ * the shadow buffer every SHADOW_FLUSH_PRIMS primitives and at the end, flush
+ * time is taken out of the run time and reported separately.
  */
-STATIC VOID RunRandPixelTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData)
+STATIC VOID RunHarness(CONST TEST_DESC *Desc, TEST_OPTIONS *Options, WORKLOAD *Wl, HISTOGRAM *Hist, RAW_SAMPLES *Raw, TEST_RUN_DATA *RunData)
 {
-    UINT32 DisplayWidth = GetFBHorRes();
-    UINT32 DisplayHeight = GetFBVerRes();
+    TEST_CONTEXT Ctx;
+    WORKLOAD_ENTRY E;
+
+    ZeroMem(&Ctx, sizeof(TEST_CONTEXT));
+    ZeroMem(&E, sizeof(WORKLOAD_ENTRY));    // unused parameters in raw samples
+    Ctx.Wl = Wl;
+    Ctx.Gen = Desc->Gen ? Desc->Gen : NoopGen;
+    if (Desc->Setup) {
+        Ctx.Status = Desc->Setup(&Ctx);
+        if (EFI_ERROR(Ctx.Status)) {
+            DbgPrint(DL_WARN, "%s setup failed (%r)\n", Desc->Desc, Ctx.Status);
+            goto Error_exit;
+        }
+    }
+
+    // warm-up is untimed, parameters restart from the beginning afterwards
+    if (Options->Warmup) {
+        for (UINT32 i = 0; i < Options->Warmup && !EFI_ERROR(Ctx.Status); i++) {
+            NextParams(&Ctx, &E);
+            Desc->Kernel(&Ctx, &E);
+        }
+        SeedParams();
+        Ctx.Index = 0;
+    }
+    if (Ctx.Circles) {
+        ZeroMem(&Ctx.Circles->Stats, sizeof(CIRCLE_CACHE_STATS));
+    }
+    if (Ctx.Glyphs) {
+        ZeroMem(&Ctx.Glyphs->Stats, sizeof(GLYPH_CACHE_STATS));
+        Ctx.Glyphs->Stats.PeakBytes = Ctx.Glyphs->Bytes;
+    }
+    if (Ctx.Strings) {
+        ZeroMem(&Ctx.Strings->Stats, sizeof(STRING_CACHE_STATS));
+        Ctx.Strings->Stats.PeakBytes = Ctx.Strings->Bytes;
+    }
+
+    UINT64 DurationTicks = Options->Duration ? (UINT64)Options->Duration * GetTimerFreq() / 1000 : 0;
+    UINT64 MinCheckTicks = GetTimerFreq() / DEADLINE_CHECK_RATE;
+    UINT64 AbortCheckTicks = GetTimerFreq() * QUIET_ABORT_CHECK_MS / 1000;
+    UINT32 Limit = Options->Iterations ? Options->Iterations : MAX_UINT32;
+    UINT32 Interval = 1;
     UINT32 Count = 0;
+    UINT32 Batches = 0;
+    UINT32 Disturbed = 0;
+    UINT32 Deferred = 0;
+    UINT64 QuietCycles = 0;
+    UINT64 TimedCycles = 0;
+    UINT64 FlushCycles = 0;
+    UINT32 ShadowPrims = 0;
+    EFI_TPL OldTpl = TPL_APPLICATION;
+    EnablePrimStats(Options->PrimStats);
     UINT64 StartTime = ReadTimer();
+    UINT64 Deadline = DurationTicks ? StartTime + DurationTicks : MAX_UINT64;
     UINT64 EndTime = StartTime;
+    UINT64 LastCheck = StartTime;
+    UINT64 LastAbortCheck = StartTime;
     while (TRUE) {
-        UINT32 colour = Rand() % 0x1000000;
-
-        INT32 x0 = Rand() % DisplayWidth;
-        INT32 y0 = Rand() % DisplayHeight;
-        PutPixel(x0, y0, colour);
-
-        Count++;
+        UINT32 Batch = (Limit - Count < Interval) ? Limit - Count : Interval;
+        UINT64 BatchStart = 0;
+        if (Options->Quiet) {
+            OldTpl = gBS->RaiseTPL(TPL_NOTIFY);
+            BatchStart = ReadTimer();
+        }
+        UINT32 Ticks = GetTickCount();
+        if (ColdPass) {
+            for (UINT32 i = 0; i < Batch; i++) {
+                NextParams(&Ctx, &E);
+                EvictCache();
+                UINT64 CallStart = ReadTimer();
+                Desc->Kernel(&Ctx, &E);
+                UINT64 CallCycles = ReadTimer() - CallStart;
+                CallCycles = (CallCycles > TimedCallOverhead) ? CallCycles - TimedCallOverhead : 0;
+                TimedCycles += CallCycles;
+                if (Hist) {
+                    RecordHistogram(Hist, CallCycles);
+                }
+                if (Raw) {
+                    RecordRawSample(Raw, CallCycles, &E);
+                }
+            }
+        } else if (ShadowPass) {
+            for (UINT32 i = 0; i < Batch; i++) {
+                NextParams(&Ctx, &E);
+                Desc->Kernel(&Ctx, &E);
+                ShadowPrims += Desc->Prims;
+                if (ShadowPrims >= SHADOW_FLUSH_PRIMS) {
+                    ShadowPrims = 0;
+                    UINT64 FlushStart = ReadTimer();
+                    EFI_STATUS Status = FlushShadowBuffer(Ctx.Shadow);
+                    FlushCycles += ReadTimer() - FlushStart;
+                    if (EFI_ERROR(Status)) {
+                        Ctx.Status = Status;
+                        break;
+                    }
+                }
+            }
+        } else if (Hist || Raw) {
+            for (UINT32 i = 0; i < Batch; i++) {
+                // parameters are timed too, as they are in the untimed loop
+                UINT64 ParamStart = ReadTimer();
+                NextParams(&Ctx, &E);
+                UINT64 CallStart = ReadTimer();
+                Desc->Kernel(&Ctx, &E);
+                UINT64 CallCycles = ReadTimer() - CallStart;
+                UINT64 ParamCycles = CallStart - ParamStart;
+                ParamCycles = (ParamCycles > TimedCallOverhead) ? ParamCycles - TimedCallOverhead : 0;
+                CallCycles = (CallCycles > TimedCallOverhead) ? CallCycles - TimedCallOverhead : 0;
+                TimedCycles += ParamCycles + CallCycles;
+                if (Hist) {
+                    RecordHistogram(Hist, CallCycles);
+                }
+                if (Raw) {
+                    RecordRawSample(Raw, CallCycles, &E);
+                }
+            }
+        } else {
+            for (UINT32 i = 0; i < Batch; i++) {
+                NextParams(&Ctx, &E);
+                Desc->Kernel(&Ctx, &E);
+            }
+        }
+        Count += Batch;
         EndTime = ReadTimer();
-        if (Duration && CalcMsTime(EndTime, StartTime) >= Duration) break;
-        if (Iterations && (Count >= Iterations)) break;
+        Batches++;
+        UINT32 EndTicks = GetTickCount();
+        if (EndTicks != Ticks) {
+            Disturbed++;
+        }
+        if (Options->Quiet) {
+            QuietCycles += EndTime - BatchStart;
+            // pending timer events are dispatched here, outside the timing
+            gBS->RestoreTPL(OldTpl);
+            if (GetTickCount() != EndTicks) {
+                Deferred++;
+            }
+        }
+        if (EndTime >= Deadline || Count >= Limit || EFI_ERROR(Ctx.Status)) break;
+        if (Options->Quiet && EndTime - LastAbortCheck >= AbortCheckTicks) {
+            if (CheckProgAbort(FALSE)) {
+                AbortRequested = TRUE;
+                break;
+            }
+            LastAbortCheck = ReadTimer();
+        }
+        if (EndTime - LastCheck < MinCheckTicks && Interval < MAX_CHECK_INTERVAL) {
+            Interval *= 2;
+        }
+        LastCheck = EndTime;
+    }
+    EnablePrimStats(FALSE);
+    // flushes between iterations are inside the batch times, the last isn't
+    UINT64 BatchFlushCycles = FlushCycles;
+    if (ShadowPass && !EFI_ERROR(Ctx.Status)) {
+        UINT64 FlushStart = ReadTimer();
+        FlushShadowBuffer(Ctx.Shadow);
+        FlushCycles += ReadTimer() - FlushStart;
+    }
+
+    UINT64 Elapsed;
+    if (ColdPass || (!ShadowPass && (Hist || Raw))) {
+        // sum of the timed calls, timer reads and recording not counted
+        Elapsed = TimedCycles;
+    } else {
+        Elapsed = Options->Quiet ? QuietCycles : EndTime - StartTime;
+        UINT64 Overhead = RShiftU64(MultU64x64(Count, HarnessOverhead), OVERHEAD_FP_SHIFT) + BatchFlushCycles;
+        Elapsed = (Elapsed > Overhead) ? Elapsed - Overhead : 0;
     }
     if (RunData) {
         RunData->Run = TRUE;
         RunData->Count = Count;
-        RunData->Time =(UINT32) CalcMsTime(EndTime, StartTime);
+        RunData->Time = CalcMsTime(StartTime + Elapsed, StartTime);
+        RunData->TimeNs = CyclesToNs(Elapsed);
+        RunData->Cycles = Elapsed;
+        RunData->Batches = Batches;
+        RunData->Disturbed = Disturbed;
+        RunData->Deferred = Deferred;
+        if (ShadowPass) {
+            RunData->Flush = Ctx.Shadow->Stats;
+            RunData->Flush.TimeNs = CyclesToNs(FlushCycles);
+        }
+        if (Ctx.Circles) {
+            RunData->CircleCache = Ctx.Circles->Stats;
+        }
+        if (Ctx.Glyphs) {
+            RunData->GlyphCache = Ctx.Glyphs->Stats;
+        }
+        if (Ctx.Strings) {
+            RunData->StringCache = Ctx.Strings->Stats;
+        }
+    }
+
+Error_exit:
+    if (Desc->Teardown) {
+        Desc->Teardown(&Ctx);
     }
 }
 
 /*
- * RunRandLineTest()
+ * RunSweep() - Time primitives of each bucket size at random positions and
+ *              fit time per call against pixels per call
+ *
+ * The fit separates fixed call overhead (intercept) from cost per pixel
+ * (slope). Each primitive takes about the test duration over all sizes and
+ * sizes that do not fit the screen are skipped.
  */
-STATIC VOID RunRandLineTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData)
+STATIC EFI_STATUS RunSweep(TEST_OPTIONS *Options, SWEEP_RESULTS *Sweep)
 {
-    INT32 DisplayWidth = GetFBHorRes();
-    INT32 DisplayHeight = GetFBVerRes();
-    UINT32 Count = 0;
-    UINT64 StartTime = ReadTimer();
-    UINT64 EndTime = StartTime;
-    while (TRUE) {
-        UINT32 colour = Rand() % 0x1000000;
-
-        INT32 x0 = Rand() % DisplayWidth;
-        INT32 y0 = Rand() % DisplayHeight;
-        INT32 x1 = Rand() % DisplayWidth;
-        INT32 y1 = Rand() % DisplayHeight;
-        DrawLine(x0, y0, x1, y1, colour);
+    TEST_OPTIONS SweepOptions = *Options;
+    SWEEP_RESULTS Results;
+    UINT64 x[NUM_SWEEP_SIZES];
+    UINT64 y[NUM_SWEEP_SIZES];
 
-        Count++;
-        EndTime = ReadTimer();
-        if (Duration && CalcMsTime(EndTime, StartTime) >= Duration) break;
-        if (Iterations && (Count >= Iterations)) break;
+    ZeroMem(&Results, sizeof(SWEEP_RESULTS));
+    if (Options->Duration) {
+        SweepOptions.Duration = Options->Duration / NUM_SWEEP_SIZES ? Options->Duration / NUM_SWEEP_SIZES : 1;
     }
-    if (RunData) {
-        RunData->Run = TRUE;
-        RunData->Count = Count;
-        RunData->Time = CalcMsTime(EndTime, StartTime);
+    SweepOptions.Histogram = FALSE;
+    DisplayWidth = GetFBHorRes();
+    DisplayHeight = GetFBVerRes();
+    SetPixelCountClip(0, 0, DisplayWidth - 1, DisplayHeight - 1);
+    for (UINTN p = 0; p < NUM_SWEEP_PRIMS; p++) {
+        CONST TEST_DESC *Desc = &SweepTable[p];
+        SWEEP_PRIM_RESULTS *Prim = &Results.Prim[p];
+        UINT32 NumPoints = 0;
+        PROFILE_BEGIN(PrimZone);
+        for (UINTN s = 0; s < NUM_SWEEP_SIZES; s++) {
+            SweepSize = SweepSizes[s];
+            if (SweepSize >= DisplayWidth || SweepSize >= DisplayHeight) {
+                continue;
+            }
+            TEST_RUN_DATA RunData = {0};
+            ClearScreen(BLACK);
+            SeedParams();
+            RunHarness(Desc, &SweepOptions, NULL, NULL, NULL, &RunData);
+            if (!RunData.Run || !RunData.Count) {
+                continue;
+            }
+            SWEEP_POINT *Point = &Prim->Point[s];
+            Point->Run = TRUE;
+            Point->Count = RunData.Count;
+            Point->Pixels = (CountTestPixels(Desc, NULL, RunData.Count) + RunData.Count/2) / RunData.Count;
+            Point->CallPs = (RunData.TimeNs * 1000 + RunData.Count/2) / RunData.Count;
+            x[NumPoints] = Point->Pixels;
+            y[NumPoints] = Point->CallPs;
+            NumPoints++;
+            if (AbortRequested || CheckProgAbort(FALSE)) {
+                return EFI_ABORTED;
+            }
+        }
+        PROFILE_END(PrimZone, Desc->Desc);
+        FitLinear(x, y, NumPoints, &Prim->Fit);
     }
+    Results.Valid = TRUE;
+    if (Sweep) {
+        *Sweep = Results;
+    }
+    return EFI_SUCCESS;
 }
 
 /*
- * RunRandHLineTest()
+ * CountTestPixels() - Replay parameters of a run untimed, summing pixels written
  */
-STATIC VOID RunRandHLineTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData)
+STATIC UINT64 CountTestPixels(CONST TEST_DESC *Desc, WORKLOAD *Wl, UINT32 Count)
 {
-    INT32 DisplayWidth = GetFBHorRes();
-    INT32 DisplayHeight = GetFBVerRes();
-    UINT32 Count = 0;
-    UINT64 StartTime = ReadTimer();
-    UINT64 EndTime = StartTime;
-    while (TRUE) {
-        UINT32 colour = Rand() % 0x1000000;
-
-        INT32 x0 = Rand() % DisplayWidth;
-        INT32 x1 = Rand() % DisplayWidth;
-        INT32 y0 = Rand() % DisplayHeight;
-        UINT32 w = ABS(x0-x1);
-        DrawHLine((x0 > x1) ? x1 : x0, y0, w, colour);
+    TEST_CONTEXT Ctx;
+    WORKLOAD_ENTRY E;
+    UINT64 Pixels = 0;
 
-        Count++;
-        EndTime = ReadTimer();
-        if (Duration && CalcMsTime(EndTime, StartTime) >= Duration) break;
-        if (Iterations && (Count >= Iterations)) break;
+    if (!Desc->Pixels) {
+        return 0;
     }
-    if (RunData) {
-        RunData->Run = TRUE;
-        RunData->Count = Count;
-        RunData->Time = CalcMsTime(EndTime, StartTime);
+    ZeroMem(&Ctx, sizeof(TEST_CONTEXT));
+    Ctx.Wl = Wl;
+    Ctx.Gen = Desc->Gen ? Desc->Gen : NoopGen;
+    SeedParams();
+    UINT64 Num = (UINT64)Count * Desc->Prims;
+    for (UINT64 i = 0; i < Num; i++) {
+        NextParams(&Ctx, &E);
+        Pixels += Desc->Pixels(&E);
     }
+    return Pixels;
 }
 
 /*
- * RunRandVLineTest()
+ * MeasureHarnessOverhead() - Cycles per iteration of an empty test in
+ *                            OVERHEAD_FP_SHIFT fixed point, also sets the
+ *                            overhead of an individually timed call
  */
-STATIC VOID RunRandVLineTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData)
+STATIC UINT64 MeasureHarnessOverhead(VOID)
 {
-    INT32 DisplayWidth = GetFBHorRes();
-    INT32 DisplayHeight = GetFBVerRes();
-    UINT32 Count = 0;
-    UINT64 StartTime = ReadTimer();
-    UINT64 EndTime = StartTime;
-    while (TRUE) {
-        UINT32 colour = Rand() % 0x1000000;
+    TEST_OPTIONS Options;
+    TEST_RUN_DATA RunData;
+    WORKLOAD_ENTRY E;
 
-        INT32 x0 = Rand() % DisplayWidth;
-        INT32 y0 = Rand() % DisplayHeight;
-        INT32 y1 = Rand() % DisplayHeight;
-        UINT32 h = ABS(y0-y1);
-        DrawVLine(x0, (y0 > y1) ? y1 : y0, h, colour);
-
-        Count++;
-        EndTime = ReadTimer();
-        if (Duration && CalcMsTime(EndTime, StartTime) >= Duration) break;
-        if (Iterations && (Count >= Iterations)) break;
-    }
-    if (RunData) {
-        RunData->Run = TRUE;
-        RunData->Count = Count;
-        RunData->Time = CalcMsTime(EndTime, StartTime);
+    TimedCallOverhead = MAX_UINT64;
+    for (UINT32 i = 0; i < CALL_OVERHEAD_SAMPLES; i++) {
+        UINT64 CallStart = ReadTimer();
+        NoopTest.Kernel(NULL, &E);
+        UINT64 CallCycles = ReadTimer() - CallStart;
+        if (CallCycles < TimedCallOverhead) {
+            TimedCallOverhead = CallCycles;
+        }
     }
+
+    ZeroMem(&Options, sizeof(TEST_OPTIONS));
+    ZeroMem(&RunData, sizeof(TEST_RUN_DATA));
+    Options.Iterations = OVERHEAD_ITERATIONS;
+    HarnessOverhead = 0;
+    RunHarness(&NoopTest, &Options, NULL, NULL, NULL, &RunData);
+    UINT64 Cycles = RunData.Cycles;
+    return LShiftU64(Cycles, OVERHEAD_FP_SHIFT) / OVERHEAD_ITERATIONS;
 }
 
 /*
- * RunRandTriangleTest()
+ * GetTestDesc()
  */
-STATIC VOID RunRandTriangleTest(UINT32 Duration, UINT32 Iterations, BOOLEAN Filled, TEST_RUN_DATA *RunData)
+CHAR16 *GetTestDesc(GRAPHIC_TEST_TYPE type)
 {
-    INT32 DisplayWidth = GetFBHorRes();
-    INT32 DisplayHeight = GetFBVerRes();
-    UINT32 Count = 0;
-    UINT64 StartTime = ReadTimer();
-    UINT64 EndTime = StartTime;
-    while (TRUE) {
-        UINT32 colour = Rand() % 0x1000000;
-
-        INT32 x0 = Rand() % DisplayWidth;
-        INT32 y0 = Rand() % DisplayHeight;
-        INT32 x1 = Rand() % DisplayWidth;
-        INT32 y1 = Rand() % DisplayHeight;
-        INT32 x2 = Rand() % DisplayWidth;
-        INT32 y2 = Rand() % DisplayHeight;
-        if (Filled) {
-            DrawFillTriangle(x0, y0, x1, y1, x2, y2, colour);
-        } else {
-            DrawTriangle(x0, y0, x1, y1, x2, y2, colour);
-        }
+    if (type < NUM_TESTS) {
+        return TestTable[type].Desc;
+    }
+    return L"Unknown";
+}
 
-        Count++;
-        EndTime = ReadTimer();
-        if (Duration && CalcMsTime(EndTime, StartTime) >= Duration) break;
-        if (Iterations && (Count >= Iterations)) break;
+/*
+ * GetTestPrims() - Primitives drawn per iteration of a test
+ */
+UINT32 GetTestPrims(GRAPHIC_TEST_TYPE type)
+{
+    if (type < NUM_TESTS) {
+        return TestTable[type].Prims;
     }
-    if (RunData) {
-        RunData->Run = TRUE;
-        RunData->Count = Count;
-        RunData->Time = CalcMsTime(EndTime, StartTime);
+    return 1;
+}
+
+/*
+ * GetSweepDesc()
+ */
+CHAR16 *GetSweepDesc(SWEEP_PRIM Prim)
+{
+    if (Prim < NUM_SWEEP_PRIMS) {
+        return SweepTable[Prim].Desc;
     }
+    return L"Unknown";
 }
 
 /*
- * RunRandRectangleTest()
+ * GetSweepSize() - Primitive extent in pixels of a sweep bucket
  */
-STATIC VOID RunRandRectangleTest(UINT32 Duration, UINT32 Iterations, BOOLEAN Filled, TEST_RUN_DATA *RunData)
+UINT32 GetSweepSize(UINTN Index)
 {
-    INT32 DisplayWidth = GetFBHorRes();
-    INT32 DisplayHeight = GetFBVerRes();
-    UINT32 Count = 0;
-    UINT64 StartTime = ReadTimer();
-    UINT64 EndTime = StartTime;
-    while (TRUE) {
-        UINT32 colour = Rand() % 0x1000000;
-
-        INT32 x0 = Rand() % DisplayWidth;
-        INT32 y0 = Rand() % DisplayHeight;
-        INT32 x1 = Rand() % DisplayWidth;
-        INT32 y1 = Rand() % DisplayHeight;
-        if (Filled) {
-            DrawFillRectangle(x0, y0, x1, y1, colour);
-        } else {
-            DrawRectangle(x0, y0, x1, y1, colour);
-        }
+    return Index < NUM_SWEEP_SIZES ? SweepSizes[Index] : 0;
+}
 
-        Count++;
-        EndTime = ReadTimer();
-        if (Duration && CalcMsTime(EndTime, StartTime) >= Duration) break;
-        if (Iterations && (Count >= Iterations)) break;
-    }
-    if (RunData) {
-        RunData->Run = TRUE;
-        RunData->Count = Count;
-        RunData->Time = CalcMsTime(EndTime, StartTime);
+/*
+ * GetPixelFormat() - Pixel format of the current mode
+ */
+STATIC EFI_GRAPHICS_PIXEL_FORMAT GetPixelFormat(VOID)
+{
+    EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop;
+
+    if (EFI_ERROR(gBS->LocateProtocol(&gEfiGraphicsOutputProtocolGuid, NULL, (VOID **)&Gop))) {
+        return PixelFormatMax;
     }
+    return Gop->Mode->Info->PixelFormat;
 }
 
 /*
- * RunRandCircleTest()
+ * NextParams() - Next entry from workload, or generate inline if no workload
  */
-STATIC VOID RunRandCircleTest(UINT32 Duration, UINT32 Iterations, BOOLEAN Filled, TEST_RUN_DATA *RunData)
+STATIC VOID NextParams(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *Entry)
 {
-    INT32 DisplayWidth = GetFBHorRes();
-    INT32 DisplayHeight = GetFBVerRes();
-    UINT32 Count = 0;
-    UINT64 StartTime = ReadTimer();
-    UINT64 EndTime = StartTime;
-    while (TRUE) {
-        UINT32 colour = Rand() % 0x1000000;
-
-        UINT32 x0 = CIRCLE_MIN_RADIUS + Rand() % (DisplayWidth - CIRCLE_MIN_DIAMETER);
-        UINT32 y0 = CIRCLE_MIN_RADIUS + Rand() % (DisplayHeight - CIRCLE_MIN_DIAMETER);
-        INT32 dist1 = x0 > DisplayWidth-x0 ? DisplayWidth-x0 : x0;
-        INT32 dist2 = y0 > DisplayHeight-y0 ? DisplayHeight-y0 : y0;
-        INT32 r = Rand() % (dist1 > dist2 ? dist2 : dist1);
-        if (Filled) {
-            DrawFillCircle(x0, y0, r, colour);
-        } else {
-            DrawCircle(x0, y0, r, colour);
-        }
+    WORKLOAD *Wl = Ctx->Wl;
 
-        Count++;
-        EndTime = ReadTimer();
-        if (Duration && CalcMsTime(EndTime, StartTime) >= Duration) break;
-        if (Iterations && (Count >= Iterations)) break;
+    if (!Wl) {
+        Ctx->Gen(Entry);
+        return;
     }
-    if (RunData) {
-        RunData->Run = TRUE;
-        RunData->Count = Count;
-        RunData->Time = CalcMsTime(EndTime, StartTime);
+    UINT32 i = Ctx->Index;
+    Entry->Colour = Wl->Colour[i];
+    for (UINT32 n = 0; n < Wl->NumParams; n++) {
+        Entry->P[n] = Wl->Param[n][i];
     }
+    Ctx->Index = (i + 1 == Wl->Size) ? 0 : i + 1;
 }
 
 /*
- * RunRandTextTest()
+ * SeedParams() - Restart parameter generation, same sequence for every run
  */
-STATIC VOID RunRandTextTest(UINT32 Duration, UINT32 Iterations, BOOLEAN SetBackground, TEST_RUN_DATA *RunData)
+STATIC VOID SeedParams(VOID)
 {
-    FONT font = FONT10x20;
-    INT32 DisplayWidth = GetFBHorRes();
-    INT32 DisplayHeight = GetFBVerRes();
-    UINT16 Message[] = L"The quick brown fox jumps over the lazy dog.";
-    INT32 width = (INT32)(StrLen(Message) * GetFontWidth(font));
-    INT32 height = GetFontHeight(font);
-    UINT32 Count = 0;
-    UINT64 StartTime = ReadTimer();
-    UINT64 EndTime = StartTime;
-    while (TRUE) {
-        UINT32 colour = Rand() % 0x1000000;
-
-        INT32 x = Rand() % (DisplayWidth - width);
-        INT32 y = Rand() % (DisplayHeight - height);
-        GPutString(x, y, Message, colour, ~colour, SetBackground, font);
+    Srand(1);
+    RandSeed(&ParamRng, 1, 0);
+    NextLabel = 0;
+}
 
-        Count++;
-        EndTime = ReadTimer();
-        if (Duration && CalcMsTime(EndTime, StartTime) >= Duration) break;
-        if (Iterations && (Count >= Iterations)) break;
-    }
-    if (RunData) {
-        RunData->Run = TRUE;
-        RunData->Count = Count;
-        RunData->Time = CalcMsTime(EndTime, StartTime);
-    }
+/*
+ * RandParam() - Random parameter in [0, Range)
+ */
+STATIC UINT32 RandParam(UINT32 Range)
+{
+    return LegacyRand ? (UINT32)Rand() % Range : RandBounded(&ParamRng, Range);
 }
 
 /*
- * RunClearScreenTest()
+ * Parameter generators - RandParam() call order matches the original inline loops
  */
-STATIC VOID RunClearScreenTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData)
+STATIC VOID GenPixelParams(WORKLOAD_ENTRY *Entry)
 {
-    UINT32 Count = 0;
-    UINT64 StartTime = ReadTimer();
-    UINT64 EndTime = StartTime;
-    while (TRUE) {
-        UINT32 colour = Rand() % 0x1000000;
+    Entry->Colour = RandParam(0x1000000);
+    Entry->P[0] = RandParam(DisplayWidth);    // x0
+    Entry->P[1] = RandParam(DisplayHeight);   // y0
+}
 
-        if (Clipped()) {
-            ClearClipWindow(colour);
-        } else {
-            ClearScreen(colour);
-        }
+STATIC VOID GenLineParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = RandParam(0x1000000);
+    Entry->P[0] = RandParam(DisplayWidth);    // x0
+    Entry->P[1] = RandParam(DisplayHeight);   // y0
+    Entry->P[2] = RandParam(DisplayWidth);    // x1
+    Entry->P[3] = RandParam(DisplayHeight);   // y1
+}
 
-        Count++;
-        EndTime = ReadTimer();
-        if (Duration && CalcMsTime(EndTime, StartTime) >= Duration) break;
-        if (Iterations && (Count >= Iterations)) break;
-    }
-    if (RunData) {
-        RunData->Run = TRUE;
-        RunData->Count = Count;
-        RunData->Time = CalcMsTime(EndTime, StartTime);
+STATIC VOID GenHLineParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = RandParam(0x1000000);
+    INT32 x0 = RandParam(DisplayWidth);
+    INT32 x1 = RandParam(DisplayWidth);
+    Entry->P[0] = (x0 > x1) ? x1 : x0;        // x
+    Entry->P[1] = RandParam(DisplayHeight);   // y
+    Entry->P[2] = ABS(x0-x1);                 // width
+}
+
+STATIC VOID GenVLineParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = RandParam(0x1000000);
+    Entry->P[0] = RandParam(DisplayWidth);    // x
+    INT32 y0 = RandParam(DisplayHeight);
+    INT32 y1 = RandParam(DisplayHeight);
+    Entry->P[1] = (y0 > y1) ? y1 : y0;        // y
+    Entry->P[2] = ABS(y0-y1);                 // height
+}
+
+STATIC VOID GenTriangleParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = RandParam(0x1000000);
+    for (UINTN i = 0; i < 6; i += 2) {
+        Entry->P[i] = RandParam(DisplayWidth);        // x
+        Entry->P[i+1] = RandParam(DisplayHeight);     // y
     }
 }
 
+STATIC VOID GenCircleParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = RandParam(0x1000000);
+    INT32 x0 = CIRCLE_MIN_RADIUS + RandParam(DisplayWidth - CIRCLE_MIN_DIAMETER);
+    INT32 y0 = CIRCLE_MIN_RADIUS + RandParam(DisplayHeight - CIRCLE_MIN_DIAMETER);
+    INT32 dist1 = x0 > DisplayWidth-x0 ? DisplayWidth-x0 : x0;
+    INT32 dist2 = y0 > DisplayHeight-y0 ? DisplayHeight-y0 : y0;
+    Entry->P[0] = x0;
+    Entry->P[1] = y0;
+    Entry->P[2] = RandParam(dist1 > dist2 ? dist2 : dist1);   // radius
+}
+
+STATIC VOID GenTextParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = RandParam(0x1000000);
+    Entry->P[0] = RandParam(DisplayWidth - TextWidth);      // x
+    Entry->P[1] = RandParam(DisplayHeight - TextHeight);    // y
+}
+
+STATIC VOID GenColourParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = RandParam(0x1000000);
+}
+
 /*
- * RunBouncingBallTest()
+ * Sweep generators - Primitives of extent SweepSize placed fully on screen
  */
-STATIC VOID RunBouncingBallTest(UINT32 Duration, UINT32 Iterations, TEST_RUN_DATA *RunData)
+// SweepSize pixels, shallow or steep
+STATIC VOID GenSweepLineParams(WORKLOAD_ENTRY *Entry)
 {
-    EFI_STATUS Status;
+    Entry->Colour = RandParam(0x1000000);
+    INT32 x0 = RandParam(DisplayWidth - SweepSize + 1);
+    INT32 y0 = RandParam(DisplayHeight - SweepSize + 1);
+    INT32 Minor = RandParam(SweepSize);
+    BOOLEAN Steep = RandParam(2);
+    Entry->P[0] = x0;
+    Entry->P[1] = y0;
+    Entry->P[2] = x0 + (Steep ? Minor : SweepSize - 1);
+    Entry->P[3] = y0 + (Steep ? SweepSize - 1 : Minor);
+}
 
-    if (!Duration && !Iterations) {
-        DbgPrint(DL_WARN, "%a() - Zero Duration and Iterations!", __func__);
-        goto error_exit;
-    }
-    RENDER_BUFFER RenBuf;
-    INT32 Radius = 100;
-    INT32 PixSize = (2*Radius + 1) + 2;
-    Status = CreateRenderBuffer(&RenBuf, PixSize, PixSize);
-    if (EFI_ERROR(Status)) goto error_exit;
-    Status = SetRenderBuffer(&RenBuf);
-    if (EFI_ERROR(Status))  goto error_exit;
-    for (INT32 i=Radius; i>=0; i--) {
-        // colour from [55 -> 255] i.e. range of 200
-        DrawFillCircle(Radius+1, Radius+1, i, RGB_COLOUR(0, 255-((200*i + Radius/2)/Radius), 0));
-    }            
-    INT32 x = Radius+1;   // centre of circle
-    INT32 y = Radius+1;
-    INT32 dx = 1;
-    INT32 dy = 1;
-    UINT32 Count = 0;
-    UINT64 StartTime = ReadTimer();
-    UINT64 EndTime = StartTime;
-    while (TRUE) {
-        //gBS->Stall(1000);
-        Status = DisplayRenderBuffer(&RenBuf, x-Radius, y-Radius);
-        if (EFI_ERROR(Status)) break;
-        x += dx;
-        y += dy;
-        if (x-Radius <= 0) dx = 1;
-        if (y-Radius <= 0) dy = 1; 
-        if (x+Radius >= GetFBHorRes()-1) dx = -1;
-        if (y+Radius >= GetFBVerRes()-1) dy = -1;
-        Count++;
-        EndTime = ReadTimer();
-        if (Duration && CalcMsTime(EndTime, StartTime) >= Duration) {
-            break;
-        }
-        if (Iterations && (Count >= Iterations)) {
-            break;
+STATIC VOID GenSweepRectangleParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = RandParam(0x1000000);
+    INT32 x0 = RandParam(DisplayWidth - SweepSize + 1);
+    INT32 y0 = RandParam(DisplayHeight - SweepSize + 1);
+    Entry->P[0] = x0;
+    Entry->P[1] = y0;
+    Entry->P[2] = x0 + SweepSize - 1;
+    Entry->P[3] = y0 + SweepSize - 1;
+}
+
+// diameter SweepSize rounded up to odd
+STATIC VOID GenSweepCircleParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = RandParam(0x1000000);
+    INT32 Radius = SweepSize / 2;
+    Entry->P[0] = Radius + RandParam(DisplayWidth - 2*Radius);
+    Entry->P[1] = Radius + RandParam(DisplayHeight - 2*Radius);
+    Entry->P[2] = Radius;
+}
+
+// right angled with both short sides SweepSize pixels
+STATIC VOID GenSweepTriangleParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = RandParam(0x1000000);
+    INT32 x0 = RandParam(DisplayWidth - SweepSize + 1);
+    INT32 y0 = RandParam(DisplayHeight - SweepSize + 1);
+    Entry->P[0] = x0;
+    Entry->P[1] = y0;
+    Entry->P[2] = x0 + SweepSize - 1;
+    Entry->P[3] = y0;
+    Entry->P[4] = x0;
+    Entry->P[5] = y0 + SweepSize - 1;
+}
+
+// radius from the cached circle test set, placed fully on screen
+STATIC VOID GenRadiusParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = RandParam(0x1000000);
+    INT32 Radius = CircleRadii[RandParam(ARRAY_SIZE(CircleRadii))];
+    Radius = MIN(Radius, (MIN(DisplayWidth, DisplayHeight) - 1) / 2);
+    Entry->P[0] = Radius + RandParam(DisplayWidth - 2*Radius);
+    Entry->P[1] = Radius + RandParam(DisplayHeight - 2*Radius);
+    Entry->P[2] = Radius;
+}
+
+// next label at its menu row, left to a margin of one character height
+STATIC VOID GenLabelParams(WORKLOAD_ENTRY *Entry)
+{
+    Entry->Colour = TEXT_CACHE_FG;
+    Entry->P[0] = TextHeight;
+    Entry->P[1] = TextHeight + NextLabel * (TextHeight + TextHeight/2);
+    Entry->P[2] = NextLabel;
+    NextLabel = (NextLabel + 1) % ARRAY_SIZE(Labels);
+}
+
+STATIC VOID NoopGen(WORKLOAD_ENTRY *Entry)
+{
+}
+
+/*
+ * Test kernels - One iteration of each test
+ */
+STATIC VOID PixelKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    PutPixel(E->P[0], E->P[1], E->Colour);
+}
+
+STATIC VOID LineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    DrawLine(E->P[0], E->P[1], E->P[2], E->P[3], E->Colour);
+}
+
+STATIC VOID HLineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    DrawHLine(E->P[0], E->P[1], E->P[2], E->Colour);
+}
+
+STATIC VOID VLineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    DrawVLine(E->P[0], E->P[1], E->P[2], E->Colour);
+}
+
+STATIC VOID TriangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    DrawTriangle(E->P[0], E->P[1], E->P[2], E->P[3], E->P[4], E->P[5], E->Colour);
+}
+
+STATIC VOID RectangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    DrawRectangle(E->P[0], E->P[1], E->P[2], E->P[3], E->Colour);
+}
+
+STATIC VOID CircleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    DrawCircle(E->P[0], E->P[1], E->P[2], E->Colour);
+}
+
+STATIC VOID FillTriangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    DrawFillTriangle(E->P[0], E->P[1], E->P[2], E->P[3], E->P[4], E->P[5], E->Colour);
+}
+
+STATIC VOID FillRectangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    if (DirectFill) {
+        BATCH_RECT Rect = { E->P[0], E->P[1], E->P[2], E->P[3], E->Colour };
+        BatchDrawFillRectangles(&Ctx->Target, &Rect, 1);
+    } else {
+        DrawFillRectangle(E->P[0], E->P[1], E->P[2], E->P[3], E->Colour);
+    }
+}
+
+STATIC VOID FillCircleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    DrawFillCircle(E->P[0], E->P[1], E->P[2], E->Colour);
+}
+
+// transparent background
+STATIC VOID Text1Kernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    GPutString(E->P[0], E->P[1], TextMessage, E->Colour, ~E->Colour, FALSE, TextFont);
+}
+
+// opaque background
+STATIC VOID Text2Kernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    GPutString(E->P[0], E->P[1], TextMessage, E->Colour, ~E->Colour, TRUE, TextFont);
+}
+
+STATIC VOID ClearScreenKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    if (DirectFill && Ctx->Target.FrameBuffer) {
+        FillTargetClip(&Ctx->Target, E->Colour);
+    } else if (Clipped()) {
+        ClearClipWindow(E->Colour);
+    } else {
+        ClearScreen(E->Colour);
+    }
+}
+
+STATIC VOID NoopKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+}
+
+/*
+ * BatchSetup() - Batch target for the clip window of the test
+ */
+STATIC EFI_STATUS BatchSetup(TEST_CONTEXT *Ctx)
+{
+    return InitBatchTarget(&Ctx->Target, ClipX0, ClipY0, ClipX1, ClipY1);
+}
+
+/*
+ * FillSetup() - Batch target for the fill kernels, if used
+ */
+STATIC EFI_STATUS FillSetup(TEST_CONTEXT *Ctx)
+{
+    return DirectFill ? BatchSetup(Ctx) : EFI_SUCCESS;
+}
+
+/*
+ * ShadowSetup() - Clear the shadow to match the cleared screen and draw to it
+ */
+STATIC EFI_STATUS ShadowSetup(TEST_CONTEXT *Ctx)
+{
+    if (!Shadow.Pixels) {
+        return EFI_NOT_READY;
+    }
+    ResetShadowBuffer(&Shadow, ClipX0, ClipY0, ClipX1, ClipY1);
+    Ctx->Shadow = &Shadow;
+    Ctx->Target = Shadow.Target;
+    return EFI_SUCCESS;
+}
+
+/*
+ * GetShadowKernel() - NULL if test can't draw to the shadow
+ */
+STATIC TEST_KERNEL GetShadowKernel(GRAPHIC_TEST_TYPE TestType)
+{
+    for (UINTN i = 0; i < ARRAY_SIZE(ShadowTests); i++) {
+        if (ShadowTests[i].Test == TestType) {
+            return ShadowTests[i].Kernel;
         }
     }
-    if (RunData) {
-        RunData->Run = TRUE;
-        RunData->Count = Count;
-        RunData->Time = CalcMsTime(EndTime, StartTime);
+    return NULL;
+}
+
+/*
+ * Shadow kernels - Draw through the batch calls to the shadow and mark the
+ *                  bounding box of each primitive dirty
+ */
+STATIC VOID ShadowPixelKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BATCH_POINT Point = { E->P[0], E->P[1], E->Colour };
+    BatchPutPixels(&Ctx->Target, &Point, 1);
+    ShadowMarkDirty(Ctx->Shadow, E->P[0], E->P[1], E->P[0], E->P[1]);
+}
+
+STATIC VOID ShadowLineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BATCH_LINE Line = { E->P[0], E->P[1], E->P[2], E->P[3], E->Colour };
+    BatchDrawLines(&Ctx->Target, &Line, 1);
+    ShadowMarkDirty(Ctx->Shadow, E->P[0], E->P[1], E->P[2], E->P[3]);
+}
+
+STATIC VOID ShadowHLineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    if (E->P[2] > 0) {
+        BATCH_LINE Line = { E->P[0], E->P[1], E->P[0] + E->P[2] - 1, E->P[1], E->Colour };
+        BatchDrawLines(&Ctx->Target, &Line, 1);
+        ShadowMarkDirty(Ctx->Shadow, Line.x0, Line.y0, Line.x1, Line.y1);
+    }
+}
+
+STATIC VOID ShadowVLineKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    if (E->P[2] > 0) {
+        BATCH_LINE Line = { E->P[0], E->P[1], E->P[0], E->P[1] + E->P[2] - 1, E->Colour };
+        BatchDrawLines(&Ctx->Target, &Line, 1);
+        ShadowMarkDirty(Ctx->Shadow, Line.x0, Line.y0, Line.x1, Line.y1);
+    }
+}
+
+STATIC VOID ShadowTriangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    INT32 *P = E->P;
+    BATCH_LINE Lines[3] = {
+        { P[0], P[1], P[2], P[3], E->Colour },
+        { P[2], P[3], P[4], P[5], E->Colour },
+        { P[4], P[5], P[0], P[1], E->Colour }
+    };
+    BatchDrawLines(&Ctx->Target, Lines, 3);
+    ShadowMarkDirty(Ctx->Shadow, MIN(P[0], MIN(P[2], P[4])), MIN(P[1], MIN(P[3], P[5])),
+                    MAX(P[0], MAX(P[2], P[4])), MAX(P[1], MAX(P[3], P[5])));
+}
+
+STATIC VOID ShadowRectangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    INT32 *P = E->P;
+    BATCH_LINE Lines[4] = {
+        { P[0], P[1], P[2], P[1], E->Colour },
+        { P[0], P[3], P[2], P[3], E->Colour },
+        { P[0], P[1], P[0], P[3], E->Colour },
+        { P[2], P[1], P[2], P[3], E->Colour }
+    };
+    BatchDrawLines(&Ctx->Target, Lines, 4);
+    ShadowMarkDirty(Ctx->Shadow, P[0], P[1], P[2], P[3]);
+}
+
+STATIC VOID ShadowFillTriangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    INT32 *P = E->P;
+    BATCH_TRIANGLE Triangle = { P[0], P[1], P[2], P[3], P[4], P[5], E->Colour };
+    BatchDrawFillTriangles(&Ctx->Target, &Triangle, 1);
+    ShadowMarkDirty(Ctx->Shadow, MIN(P[0], MIN(P[2], P[4])), MIN(P[1], MIN(P[3], P[5])),
+                    MAX(P[0], MAX(P[2], P[4])), MAX(P[1], MAX(P[3], P[5])));
+}
+
+STATIC VOID ShadowFillRectangleKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BATCH_RECT Rect = { E->P[0], E->P[1], E->P[2], E->P[3], E->Colour };
+    BatchDrawFillRectangles(&Ctx->Target, &Rect, 1);
+    ShadowMarkDirty(Ctx->Shadow, E->P[0], E->P[1], E->P[2], E->P[3]);
+}
+
+STATIC VOID ShadowClearScreenKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    FillTargetClip(&Ctx->Target, E->Colour);
+    ShadowMarkDirty(Ctx->Shadow, Ctx->Target.ClipX0, Ctx->Target.ClipY0, Ctx->Target.ClipX1, Ctx->Target.ClipY1);
+}
+
+STATIC VOID ShadowPixelBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    PixelBatchKernel(Ctx, E);
+    for (UINT32 i = 0; i < BATCH_PRIMS; i++) {
+        ShadowMarkDirty(Ctx->Shadow, BatchPoints[i].x, BatchPoints[i].y, BatchPoints[i].x, BatchPoints[i].y);
+    }
+}
+
+STATIC VOID ShadowLineBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    LineBatchKernel(Ctx, E);
+    for (UINT32 i = 0; i < BATCH_PRIMS; i++) {
+        ShadowMarkDirty(Ctx->Shadow, BatchLines[i].x0, BatchLines[i].y0, BatchLines[i].x1, BatchLines[i].y1);
+    }
+}
+
+STATIC VOID ShadowFillRectangleBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    FillRectangleBatchKernel(Ctx, E);
+    for (UINT32 i = 0; i < BATCH_PRIMS; i++) {
+        ShadowMarkDirty(Ctx->Shadow, BatchLines[i].x0, BatchLines[i].y0, BatchLines[i].x1, BatchLines[i].y1);
+    }
+}
+
+/*
+ * GatherBatch() - Parameters of the primitives of a batch iteration in the
+ *                 same order as the per-call tests, E holds the first
+ *
+ * All are fetched before any is converted, so the conversion doesn't read
+ * back parameters still being stored.
+ */
+STATIC VOID GatherBatch(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BatchEntries[0] = *E;
+    for (UINT32 i = 1; i < BATCH_PRIMS; i++) {
+        NextParams(Ctx, &BatchEntries[i]);
+    }
+}
+
+/*
+ * Batch kernels - BATCH_PRIMS primitives per iteration from one batch call
+ */
+STATIC VOID PixelBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    GatherBatch(Ctx, E);
+    for (UINT32 i = 0; i < BATCH_PRIMS; i++) {
+        BatchPoints[i].x = BatchEntries[i].P[0];
+        BatchPoints[i].y = BatchEntries[i].P[1];
+        BatchPoints[i].Colour = BatchEntries[i].Colour;
+    }
+    BatchPutPixels(&Ctx->Target, BatchPoints, BATCH_PRIMS);
+}
+
+STATIC VOID GatherBatchLines(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    GatherBatch(Ctx, E);
+    for (UINT32 i = 0; i < BATCH_PRIMS; i++) {
+        BatchLines[i].x0 = BatchEntries[i].P[0];
+        BatchLines[i].y0 = BatchEntries[i].P[1];
+        BatchLines[i].x1 = BatchEntries[i].P[2];
+        BatchLines[i].y1 = BatchEntries[i].P[3];
+        BatchLines[i].Colour = BatchEntries[i].Colour;
+    }
+}
+
+STATIC VOID LineBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    GatherBatchLines(Ctx, E);
+    BatchDrawLines(&Ctx->Target, BatchLines, BATCH_PRIMS);
+}
+
+STATIC VOID FillRectangleBatchKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    GatherBatchLines(Ctx, E);
+    BatchDrawFillRectangles(&Ctx->Target, BatchLines, BATCH_PRIMS);
+}
+
+// same triangles as the fill triangle test, half-space rasterizer
+STATIC VOID HalfSpaceTriKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BATCH_TRIANGLE Triangle = { E->P[0], E->P[1], E->P[2], E->P[3], E->P[4], E->P[5], E->Colour };
+    BatchDrawFillTriangles(&Ctx->Target, &Triangle, 1);
+}
+
+/*
+ * CircleSetup() - Batch target and an empty span cache, so the first
+ *                 circle of each radius in a trial misses
+ */
+STATIC EFI_STATUS CircleSetup(TEST_CONTEXT *Ctx)
+{
+    EFI_STATUS Status = BatchSetup(Ctx);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    Status = CreateCircleCache(&CircleCache, FALSE);
+    if (!EFI_ERROR(Status)) {
+        Ctx->Circles = &CircleCache;
+    }
+    return Status;
+}
+
+/*
+ * SpansSetup() - As CircleSetup() with the span table computed for every
+ *                circle, the baseline of the cached circle tests
+ */
+STATIC EFI_STATUS SpansSetup(TEST_CONTEXT *Ctx)
+{
+    EFI_STATUS Status = BatchSetup(Ctx);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    Status = CreateCircleCache(&CircleCache, TRUE);
+    if (!EFI_ERROR(Status)) {
+        Ctx->Circles = &CircleCache;
+    }
+    return Status;
+}
+
+STATIC VOID CircleCacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BATCH_CIRCLE Circle = { E->P[0], E->P[1], E->P[2], E->Colour };
+    BatchDrawCircles(&Ctx->Target, Ctx->Circles, &Circle, 1);
+}
+
+STATIC VOID FillCircleCacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BATCH_CIRCLE Circle = { E->P[0], E->P[1], E->P[2], E->Colour };
+    BatchDrawFillCircles(&Ctx->Target, Ctx->Circles, &Circle, 1);
+}
+
+/*
+ * CircleTeardown()
+ */
+STATIC VOID CircleTeardown(TEST_CONTEXT *Ctx)
+{
+    if (Ctx->Circles) {
+        DestroyCircleCache(Ctx->Circles);
+        Ctx->Circles = NULL;
+    }
+}
+
+/*
+ * GlyphSetup() - Batch target and a glyph cache holding the message, its
+ *                glyphs are captured here so the timed run doesn't
+ */
+STATIC EFI_STATUS GlyphSetup(TEST_CONTEXT *Ctx)
+{
+    EFI_STATUS Status = BatchSetup(Ctx);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    Status = CreateGlyphCache(&GlyphCache, GlyphCacheBytes, ClipX0, ClipY0);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    Ctx->Glyphs = &GlyphCache;
+    LoadGlyphs(&GlyphCache, TextFont, TextMessage);
+    return EFI_SUCCESS;
+}
+
+// transparent background
+STATIC VOID Text1CacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BatchPutString(&Ctx->Target, Ctx->Glyphs, E->P[0], E->P[1], TextMessage, E->Colour, ~E->Colour, FALSE, TextFont);
+}
+
+// opaque background
+STATIC VOID Text2CacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BatchPutString(&Ctx->Target, Ctx->Glyphs, E->P[0], E->P[1], TextMessage, E->Colour, ~E->Colour, TRUE, TextFont);
+}
+
+// opaque background in fixed colours
+STATIC VOID Text2FixedKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    GPutString(E->P[0], E->P[1], TextMessage, TEXT_CACHE_FG, TEXT_CACHE_BG, TRUE, TextFont);
+}
+
+STATIC VOID Text2FixedCacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BatchPutString(&Ctx->Target, Ctx->Glyphs, E->P[0], E->P[1], TextMessage, TEXT_CACHE_FG, TEXT_CACHE_BG, TRUE, TextFont);
+}
+
+/*
+ * GlyphTeardown()
+ */
+STATIC VOID GlyphTeardown(TEST_CONTEXT *Ctx)
+{
+    if (Ctx->Glyphs) {
+        DestroyGlyphCache(Ctx->Glyphs);
+        Ctx->Glyphs = NULL;
+    }
+}
+
+STATIC VOID LabelKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    GPutString(E->P[0], E->P[1], Labels[E->P[2]], TEXT_CACHE_FG, TEXT_CACHE_BG, LABEL_OPAQUE(E->P[2]), TextFont);
+}
+
+/*
+ * StringSetup() - Batch target, glyph cache holding the labels and an empty
+ *                 string cache, labels are rendered on their first draw
+ */
+STATIC EFI_STATUS StringSetup(TEST_CONTEXT *Ctx)
+{
+    EFI_STATUS Status = BatchSetup(Ctx);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    Status = CreateGlyphCache(&GlyphCache, GlyphCacheBytes, ClipX0, ClipY0);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    for (UINTN i = 0; i < ARRAY_SIZE(Labels); i++) {
+        LoadGlyphs(&GlyphCache, TextFont, Labels[i]);
+    }
+    CreateStringCache(&StringCache, &GlyphCache, StringCacheBytes);
+    Ctx->Strings = &StringCache;
+    return EFI_SUCCESS;
+}
+
+STATIC VOID LabelCacheKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BatchPutCachedString(&Ctx->Target, Ctx->Strings, E->P[0], E->P[1], Labels[E->P[2]], TEXT_CACHE_FG, TEXT_CACHE_BG, LABEL_OPAQUE(E->P[2]), TextFont);
+}
+
+/*
+ * StringTeardown()
+ */
+STATIC VOID StringTeardown(TEST_CONTEXT *Ctx)
+{
+    if (Ctx->Strings) {
+        DestroyStringCache(Ctx->Strings);
+        DestroyGlyphCache(&GlyphCache);
+        Ctx->Strings = NULL;
+    }
+}
+
+/*
+ * BandwidthSetup() - Raw bandwidth probes are run once per mode, the timed
+ *                    test is whole framebuffer writes at the peak store width
+ */
+STATIC EFI_STATUS BandwidthSetup(TEST_CONTEXT *Ctx)
+{
+    EFI_STATUS Status = InitBandwidth();
+    if (!EFI_ERROR(Status)) {
+        RunBandwidthProbes();
+    }
+    return Status;
+}
+
+STATIC VOID BandwidthKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    FillFramebuffer(E->Colour);
+}
+
+STATIC VOID BandwidthTeardown(TEST_CONTEXT *Ctx)
+{
+    FreeBandwidth();
+}
+
+/*
+ * BallSetup() - Render shaded ball into a render buffer
+ */
+STATIC EFI_STATUS BallSetup(TEST_CONTEXT *Ctx)
+{
+    EFI_STATUS Status;
+    BALL_STATE *Ball = &Ctx->Ball;
+
+    Ball->Radius = BALL_RADIUS;
+    INT32 Radius = Ball->Radius;
+    INT32 PixSize = (2*Radius + 1) + 2;
+    Status = CreateRenderBuffer(&Ball->RenBuf, PixSize, PixSize);
+    if (EFI_ERROR(Status)) goto Error_exit;
+    Ball->Created = TRUE;
+    Status = SetRenderBuffer(&Ball->RenBuf);
+    if (EFI_ERROR(Status)) goto Error_exit;
+    for (INT32 i=Radius; i>=0; i--) {
+        // colour from [55 -> 255] i.e. range of 200
+        DrawFillCircle(Radius+1, Radius+1, i, RGB_COLOUR(0, 255-((200*i + Radius/2)/Radius), 0));
+    }            
+    Ball->x = Radius+1;   // centre of circle
+    Ball->y = Radius+1;
+    Ball->dx = 1;
+    Ball->dy = 1;
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * BallKernel() - Display ball and move it, bouncing off the screen edges
+ */
+STATIC VOID BallKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    BALL_STATE *Ball = &Ctx->Ball;
+    INT32 Radius = Ball->Radius;
+
+    EFI_STATUS Status = DisplayRenderBuffer(&Ball->RenBuf, Ball->x-Radius, Ball->y-Radius);
+    if (EFI_ERROR(Status)) {
+        Ctx->Status = Status;
+        return;
     }
+    Ball->x += Ball->dx;
+    Ball->y += Ball->dy;
+    if (Ball->x-Radius <= 0) Ball->dx = 1;
+    if (Ball->y-Radius <= 0) Ball->dy = 1; 
+    if (Ball->x+Radius >= DisplayWidth-1) Ball->dx = -1;
+    if (Ball->y+Radius >= DisplayHeight-1) Ball->dy = -1;
+}
 
-error_exit:    
-    DestroyRenderBuffer(&RenBuf);
+/*
+ * BallTeardown()
+ */
+STATIC VOID BallTeardown(TEST_CONTEXT *Ctx)
+{
+    if (Ctx->Ball.Created) {
+        DestroyRenderBuffer(&Ctx->Ball.RenBuf);
+        Ctx->Ball.Created = FALSE;
+    }
     SetScreenRender();
 }
+
+/*
+ * FrameSetup() - Create the back buffer and render the ball sprite, shaded
+ *                as the bouncing ball test
+ */
+STATIC EFI_STATUS FrameSetup(TEST_CONTEXT *Ctx)
+{
+    EFI_STATUS Status;
+    FRAME_STATE *Frame = &Ctx->Frame;
+
+    Status = CreateFrameBuffers(&Frame->Buffers, FramePresent);
+    if (EFI_ERROR(Status)) goto Error_exit;
+    Frame->Created = TRUE;
+    INT32 Radius = MIN(BALL_RADIUS, (MIN(DisplayWidth, DisplayHeight) - 1) / 4);
+    INT32 Size = 2*Radius + 1;
+    Status = ArenaCreate(&Frame->SpriteArena, (UINTN)Size * Size * sizeof(UINT32) + (UINTN)Size * sizeof(SPRITE_SPAN) + ARENA_DEFAULT_ALIGN);
+    if (EFI_ERROR(Status)) goto Error_exit;
+    Frame->Sprite = (UINT32 *)ArenaAlloc(&Frame->SpriteArena, (UINTN)Size * Size * sizeof(UINT32), 0);
+    Frame->Spans = (SPRITE_SPAN *)ArenaAlloc(&Frame->SpriteArena, (UINTN)Size * sizeof(SPRITE_SPAN), 0);
+    Frame->Size = Size;
+    for (INT32 y = 0; y < Size; y++) {
+        INT32 dy = y - Radius;
+        Frame->Spans[y].x0 = Size;
+        Frame->Spans[y].x1 = -1;
+        for (INT32 x = 0; x < Size; x++) {
+            INT32 dx = x - Radius;
+            // innermost ring holding the pixel sets its colour
+            INT32 d2 = dx*dx + dy*dy;
+            INT32 Ring = 0;
+            while (Ring <= Radius && d2 > Ring*Ring + Ring) {
+                Ring++;
+            }
+            if (Ring > Radius) {
+                continue;
+            }
+            Frame->Sprite[y*Size + x] = RGB_COLOUR(0, 255-((200*Ring + Radius/2)/Radius), 0);
+            Frame->Spans[y].x0 = MIN(Frame->Spans[y].x0, x);
+            Frame->Spans[y].x1 = MAX(Frame->Spans[y].x1, x);
+        }
+    }
+    Frame->x = 0;
+    Frame->y = 0;
+    Frame->dx = 1;
+    Frame->dy = 1;
+    Frame->Count = 0;
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * FrameKernel() - Draw a whole frame to the back buffer and present it
+ *
+ * The frame is the background, a progress bar advancing a pixel per frame
+ * and the ball bouncing off the screen edges, as a boot splash would draw.
+ */
+STATIC VOID FrameKernel(TEST_CONTEXT *Ctx, WORKLOAD_ENTRY *E)
+{
+    FRAME_STATE *Frame = &Ctx->Frame;
+    BATCH_TARGET *Target = &Frame->Buffers.Target;
+
+    FillTargetClip(Target, FRAME_BACKGROUND);
+    INT32 BarX0 = DisplayWidth / 4;
+    INT32 BarX1 = DisplayWidth - BarX0 - 1;
+    INT32 BarY0 = DisplayHeight - DisplayHeight / 8;
+    INT32 BarY1 = BarY0 + DisplayHeight / 64;
+    BATCH_RECT Bar = { BarX0, BarY0, BarX0 + (INT32)(Frame->Count % (UINT32)(BarX1 - BarX0 + 1)), BarY1, FRAME_BAR_COLOUR };
+    BatchDrawFillRectangles(Target, &Bar, 1);
+    for (INT32 y = 0; y < Frame->Size; y++) {
+        SPRITE_SPAN *Span = &Frame->Spans[y];
+        if (Span->x1 >= Span->x0) {
+            CopyMem(&Target->FrameBuffer[(UINTN)(Frame->y + y) * Target->Stride + Frame->x + Span->x0],
+                    &Frame->Sprite[y*Frame->Size + Span->x0], (UINTN)(Span->x1 - Span->x0 + 1) * sizeof(UINT32));
+        }
+    }
+    EFI_STATUS Status = PresentFrame(&Frame->Buffers);
+    if (EFI_ERROR(Status)) {
+        Ctx->Status = Status;
+        return;
+    }
+    Frame->Count++;
+    Frame->x += Frame->dx;
+    Frame->y += Frame->dy;
+    if (Frame->x <= 0) Frame->dx = 1;
+    if (Frame->y <= 0) Frame->dy = 1;
+    if (Frame->x + Frame->Size >= DisplayWidth) Frame->dx = -1;
+    if (Frame->y + Frame->Size >= DisplayHeight) Frame->dy = -1;
+}
+
+/*
+ * FrameTeardown()
+ */
+STATIC VOID FrameTeardown(TEST_CONTEXT *Ctx)
+{
+    if (Ctx->Frame.Created) {
+        DestroyFrameBuffers(&Ctx->Frame.Buffers);
+        Ctx->Frame.Created = FALSE;
+    }
+    ArenaDestroy(&Ctx->Frame.SpriteArena);
+}
+
+/*
+ * Pixel counts - Pixels written by one iteration of each test
+ */
+STATIC UINT64 PixelPixels(WORKLOAD_ENTRY *E)
+{
+    return CountPoint(E->P[0], E->P[1]);
+}
+
+STATIC UINT64 LinePixels(WORKLOAD_ENTRY *E)
+{
+    return CountLine(E->P[0], E->P[1], E->P[2], E->P[3]);
+}
+
+STATIC UINT64 HLinePixels(WORKLOAD_ENTRY *E)
+{
+    return CountHLine(E->P[0], E->P[1], E->P[2]);
+}
+
+STATIC UINT64 VLinePixels(WORKLOAD_ENTRY *E)
+{
+    return CountVLine(E->P[0], E->P[1], E->P[2]);
+}
+
+STATIC UINT64 TrianglePixels(WORKLOAD_ENTRY *E)
+{
+    return CountTriangle(E->P[0], E->P[1], E->P[2], E->P[3], E->P[4], E->P[5], FALSE);
+}
+
+STATIC UINT64 RectanglePixels(WORKLOAD_ENTRY *E)
+{
+    return CountRectangle(E->P[0], E->P[1], E->P[2], E->P[3], FALSE);
+}
+
+STATIC UINT64 CirclePixels(WORKLOAD_ENTRY *E)
+{
+    return CountCircle(E->P[0], E->P[1], E->P[2], FALSE);
+}
+
+STATIC UINT64 FillTrianglePixels(WORKLOAD_ENTRY *E)
+{
+    return CountTriangle(E->P[0], E->P[1], E->P[2], E->P[3], E->P[4], E->P[5], TRUE);
+}
+
+STATIC UINT64 FillRectanglePixels(WORKLOAD_ENTRY *E)
+{
+    return CountRectangle(E->P[0], E->P[1], E->P[2], E->P[3], TRUE);
+}
+
+STATIC UINT64 FillCirclePixels(WORKLOAD_ENTRY *E)
+{
+    return CountCircle(E->P[0], E->P[1], E->P[2], TRUE);
+}
+
+// character cells, transparent text writes fewer pixels than this
+STATIC UINT64 TextPixels(WORKLOAD_ENTRY *E)
+{
+    return CountRectangle(E->P[0], E->P[1], E->P[0] + TextWidth - 1, E->P[1] + TextHeight - 1, TRUE);
+}
+
+// character cells of the label
+STATIC UINT64 LabelPixels(WORKLOAD_ENTRY *E)
+{
+    INT32 Width = (INT32)(StrLen(Labels[E->P[2]]) * GetFontWidth(TextFont));
+    return CountRectangle(E->P[0], E->P[1], E->P[0] + Width - 1, E->P[1] + TextHeight - 1, TRUE);
+}
+
+STATIC UINT64 ClearScreenPixels(WORKLOAD_ENTRY *E)
+{
+    return (UINT64)(ClipX1 - ClipX0 + 1) * (UINT64)(ClipY1 - ClipY0 + 1);
+}
+
+STATIC UINT64 BandwidthPixels(WORKLOAD_ENTRY *E)
+{
+    return FramebufferPixels();
+}
+
+// whole render buffer, ball always stays on screen
+STATIC UINT64 BallPixels(WORKLOAD_ENTRY *E)
+{
+    INT32 PixSize = (2*BALL_RADIUS + 1) + 2;
+    return (UINT64)PixSize * PixSize;
+}
+
+// pixels presented
+STATIC UINT64 FramePixels(WORKLOAD_ENTRY *E)
+{
+    return (UINT64)DisplayWidth * DisplayHeight;
+}
+
+STATIC UINT64 HalfSpaceTriPixels(WORKLOAD_ENTRY *E)
+{
+    return CountHalfSpaceTriangle(E->P[0], E->P[1], E->P[2], E->P[3], E->P[4], E->P[5]);
+}
+
+// radii too large to cache are drawn by the library
+STATIC UINT64 CircleCachePixels(WORKLOAD_ENTRY *E)
+{
+    if (E->P[2] > CIRCLE_CACHE_MAX_RADIUS) {
+        return CountCircle(E->P[0], E->P[1], E->P[2], FALSE);
+    }
+    ComputeCircleSpans(E->P[2], CountCircleTable);
+    return CountCircleSpans(E->P[0], E->P[1], E->P[2], FALSE, CountCircleTable);
+}
+
+STATIC UINT64 FillCircCachePixels(WORKLOAD_ENTRY *E)
+{
+    return CountCircle(E->P[0], E->P[1], E->P[2], TRUE);
+}
@@ -12,6 +12,17 @@
 #define GRAPHICS_TEST_H
 
 #include <Uefi.h>
+#include <Protocol/GraphicsOutput.h>
+#include "Stats.h"
+#include "Bandwidth.h"
+#include "PrimStats.h"
+#include "Sink.h"
+#include "Fill.h"
+#include "Shadow.h"
+#include "Frame.h"
+#include "CircleCache.h"
+#include "GlyphCache.h"
+#include "StringCache.h"
 
 #define CURRENT_MODE 0xFFFF
 
@@ -30,27 +41,146 @@ typedef enum {
     TEXT1_TEST,
     TEXT2_TEST,
     CLEAR_SCREEN_TEST,
+    BANDWIDTH_TEST,
     BOUNCING_BALL_TEST,
+    PIXEL_BATCH_TEST,
+    LINE_BATCH_TEST,
+    FILL_RECTANGLE_BATCH_TEST,
+    FRAME_TEST,
+    FILL_TRIANGLE_HS_TEST,
+    CIRCLE_CACHE_TEST,
+    FILL_CIRCLE_CACHE_TEST,
+    CIRCLE_SPANS_TEST,
+    FILL_CIRCLE_SPANS_TEST,
+    TEXT1_CACHE_TEST,
+    TEXT2_CACHE_TEST,
+    TEXT2_FIXED_TEST,
+    TEXT2_FIXED_CACHE_TEST,
+    LABEL_TEST,
+    LABEL_CACHE_TEST,
     NUM_TESTS,          // number of tests defined
     ALL_TESTS,
     NO_TEST
 } GRAPHIC_TEST_TYPE;
 
+#define SHADOW_FLUSH_PRIMS  64  // primitives drawn to the shadow buffer between flushes
+
+// test options
+typedef struct {
+    UINT32 Duration;    // test duration (ms)
+    UINT32 Iterations;  // number of iterations
+    BOOLEAN ClipTest;   // enable clipping
+    BOOLEAN Pregen;     // also run from pre-generated parameters
+    BOOLEAN Histogram;  // record per-call latency
+    BOOLEAN Pause;      // pause after each test
+    UINT32 Warmup;      // untimed iterations before each test
+    UINT32 Repeat;      // timed trials per test
+    UINT32 WarmupRuns;  // discarded trials before timed trials
+    BOOLEAN Sweep;      // run primitive size sweep
+    BOOLEAN Quiet;      // timed batches at TPL_NOTIFY
+    BOOLEAN Cold;       // also run with data cache evicted before each iteration
+    BOOLEAN PrimStats;  // count primitive calls and pixels in timed runs
+    BOOLEAN LegacyRand; // parameters from Park-Miller Rand() as older versions
+    FILL_KERNEL Fill;   // clear screen and fill rectangle kernel, FILL_LIBRARY for library calls
+    BOOLEAN Shadow;     // also run tests drawing to a shadow buffer flushed with Blt
+    PRESENT_METHOD Present; // frame test present method
+    UINT32 Cpus;        // CPUs large fills are tiled across, 1 for the BSP only
+    UINT32 GlyphCacheKb;    // glyph cache memory cap of the cached text tests (KB)
+    UINT32 StringCacheKb;   // string cache memory cap of the cached label test (KB)
+    OUTPUT_SINK *Raw;   // per-iteration samples of timed trials written here if not NULL
+} TEST_OPTIONS;
+
+// latency percentiles reported
+typedef enum {
+    PCT_50=0,
+    PCT_90,
+    PCT_99,
+    PCT_99_9,
+    NUM_PERCENTILES
+} PERCENTILE;
+
+// per-call latency in TSC cycles
+typedef struct {
+    BOOLEAN Valid;                  // true if latency recorded
+    UINT64 Min;
+    UINT64 Max;
+    UINT64 Pct[NUM_PERCENTILES];
+} TEST_LATENCY;
+
 // test result data
 typedef struct {
     BOOLEAN Run;    // true if test has been run
     UINT32 Count;   // number of iterations
-    UINT64 Time;    // time taken
+    UINT64 Time;    // time taken (ms)
+    UINT64 TimeNs;  // time taken (ns)
+    UINT64 Cycles;  // time taken (TSC cycles)
+    UINT64 Pixels;  // pixels written
+    TEST_LATENCY Latency;
+    STATS Stats;    // iterations per second over repeated trials
+    UINT32 Batches;     // timed batches
+    UINT32 Disturbed;   // batches a timer tick was serviced in
+    UINT32 Deferred;    // batches a timer tick was held off until after (quiet)
+    SHADOW_FLUSH_STATS Flush;   // shadow pass flushes, not included in Time
+    CIRCLE_CACHE_STATS CircleCache; // span table lookups of cached circle tests
+    GLYPH_CACHE_STATS GlyphCache;   // glyph lookups of cached text tests
+    STRING_CACHE_STATS StringCache; // string lookups of the cached label test
 } TEST_RUN_DATA;
+// primitives in size sweep
+typedef enum {
+    SWEEP_LINE=0,
+    SWEEP_FILL_RECTANGLE,
+    SWEEP_FILL_CIRCLE,
+    SWEEP_FILL_TRIANGLE,
+    NUM_SWEEP_PRIMS
+} SWEEP_PRIM;
+#define NUM_SWEEP_SIZES 6
+
+// size sweep results, fit is time per call (ps) against pixels per call
+typedef struct {
+    BOOLEAN Run;        // false if size does not fit the screen
+    UINT32 Count;       // number of iterations
+    UINT64 Pixels;      // pixels per call
+    UINT64 CallPs;      // time per call (ps)
+} SWEEP_POINT;
+typedef struct {
+    SWEEP_POINT Point[NUM_SWEEP_SIZES];
+    LINEAR_FIT Fit;     // fixed cost (ps) + cost per pixel (ps)
+} SWEEP_PRIM_RESULTS;
+typedef struct {
+    BOOLEAN Valid;      // true if sweep has been run
+    SWEEP_PRIM_RESULTS Prim[NUM_SWEEP_PRIMS];
+} SWEEP_RESULTS;
+
 typedef struct {
     UINTN Mode;     // graphics mode used
     UINT32 HorRes;  // horizontial resolution
     UINT32 VerRes;  // vertical resolution
-    TEST_RUN_DATA Data[NUM_TESTS];
+    EFI_GRAPHICS_PIXEL_FORMAT PixelFormat;  // PixelFormatMax if unknown
+    UINT64 Overhead;// harness cycles per iteration subtracted from times (x256)
+    BOOLEAN Ticks;  // true if timer ticks were counted during batches
+    BOOLEAN Quiet;  // true if batches ran at TPL_NOTIFY
+    FILL_KERNEL FillKernel;                 // clear screen and fill rectangle kernel, FILL_LIBRARY if library calls
+    FILL_KERNEL BatchFillKernel;            // kernel of batch and cached drawing spans, FILL_LIBRARY if library calls
+    PRESENT_METHOD Present;                 // frame test present method used
+    UINT32 Cpus;                            // CPUs large fills were tiled across
+    TEST_RUN_DATA Data[NUM_TESTS];          // inline random parameters
+    TEST_RUN_DATA PregenData[NUM_TESTS];    // pre-generated parameters
+    TEST_RUN_DATA ColdData[NUM_TESTS];      // inline parameters, cold cache
+    TEST_RUN_DATA ShadowData[NUM_TESTS];    // inline parameters, drawn to the shadow buffer
+    UINTN EvictSize;                        // cache eviction buffer bytes, 0 if not run
+    UINTN LlcSize;                          // last level cache bytes
+    BANDWIDTH_RESULTS Bandwidth;            // raw bandwidth probes
+    SWEEP_RESULTS Sweep;                    // primitive size sweep
+    PRIM_STATS PrimStats[NUM_TESTS];        // primitive counters over inline trials
+    UINT64 RawSamples;                      // raw samples written
+    UINT64 RawDropped;                      // raw samples dropped, trial buffer full
 } TEST_RESULTS;
 
-EFI_STATUS RunGraphicTest(UINT32 Mode, GRAPHIC_TEST_TYPE TestType, UINT32 Duration, UINT32 Iterations, BOOLEAN ClipTest, BOOLEAN Pause, TEST_RESULTS *TestResults);
+EFI_STATUS RunGraphicTest(UINT32 Mode, GRAPHIC_TEST_TYPE TestType, TEST_OPTIONS *Options, TEST_RESULTS *TestResults);
 CHAR16 *GetTestDesc(GRAPHIC_TEST_TYPE type);
+UINT32 GetTestPrims(GRAPHIC_TEST_TYPE type);
+CHAR16 *GetSweepDesc(SWEEP_PRIM Prim);
+UINT32 GetSweepSize(UINTN Index);
 
 
 #endif // GRAPHICS_TEST_H
@@ -8,6 +8,7 @@
 #include <Library/UefiLib.h>
 #include <Library/ShellCEntryLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/PrintLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include "CmdLineLib/CmdLine.h"
@@ -15,6 +16,11 @@
 #include "Timer.h"
 #include "Rand.h"
 #include "GraphicsTest.h"
+#include "PixelCount.h"
+#include "Profile.h"
+#include "Baseline.h"
+#include "Sink.h"
+#include "Raw.h"
 
 // CmdLine: Enum definition for test types
 ENUMSTR_START(GraphicTestEnumStrs)
@@ -32,11 +38,60 @@ ENUMSTR_ENTRY(FILL_CIRCLE_TEST,     L"fcircle")
 ENUMSTR_ENTRY(TEXT1_TEST,           L"text")
 ENUMSTR_ENTRY(TEXT2_TEST,           L"text2")
 ENUMSTR_ENTRY(CLEAR_SCREEN_TEST,    L"clear")
+ENUMSTR_ENTRY(BANDWIDTH_TEST,       L"bandwidth")
 ENUMSTR_ENTRY(BOUNCING_BALL_TEST,   L"ball")
+ENUMSTR_ENTRY(PIXEL_BATCH_TEST,     L"pixelbatch")
+ENUMSTR_ENTRY(LINE_BATCH_TEST,      L"linebatch")
+ENUMSTR_ENTRY(FILL_RECTANGLE_BATCH_TEST, L"frectbatch")
+ENUMSTR_ENTRY(FRAME_TEST,           L"frame")
+ENUMSTR_ENTRY(FILL_TRIANGLE_HS_TEST, L"halfspace")
+ENUMSTR_ENTRY(CIRCLE_CACHE_TEST,    L"ccircle")
+ENUMSTR_ENTRY(FILL_CIRCLE_CACHE_TEST, L"cfcircle")
+ENUMSTR_ENTRY(CIRCLE_SPANS_TEST,    L"scircle")
+ENUMSTR_ENTRY(FILL_CIRCLE_SPANS_TEST, L"sfcircle")
+ENUMSTR_ENTRY(TEXT1_CACHE_TEST,     L"ctext")
+ENUMSTR_ENTRY(TEXT2_CACHE_TEST,     L"ctext2")
+ENUMSTR_ENTRY(TEXT2_FIXED_TEST,     L"text2fixed")
+ENUMSTR_ENTRY(TEXT2_FIXED_CACHE_TEST, L"ctext2fixed")
+ENUMSTR_ENTRY(LABEL_TEST,           L"labels")
+ENUMSTR_ENTRY(LABEL_CACHE_TEST,     L"clabels")
+ENUMSTR_END
+
+// results output formats
+typedef enum {
+    FORMAT_TEXT=0,
+    FORMAT_CSV,
+    FORMAT_JSON
+} RESULTS_FORMAT;
+
+// CmdLine: Enum definition for results formats
+ENUMSTR_START(FormatEnumStrs)
+ENUMSTR_ENTRY(FORMAT_TEXT,          L"text")
+ENUMSTR_ENTRY(FORMAT_CSV,           L"csv")
+ENUMSTR_ENTRY(FORMAT_JSON,          L"json")
+ENUMSTR_END
+
+// CmdLine: Enum definition for fill kernels
+ENUMSTR_START(FillEnumStrs)
+ENUMSTR_ENTRY(FILL_LIBRARY,         L"lib")
+ENUMSTR_ENTRY(FILL_AUTO,            L"auto")
+ENUMSTR_ENTRY(FILL_SCALAR,          L"scalar")
+ENUMSTR_ENTRY(FILL_SSE2,            L"sse2")
+ENUMSTR_ENTRY(FILL_AVX2,            L"avx2")
+ENUMSTR_END
+
+// CmdLine: Enum definition for frame present methods
+ENUMSTR_START(PresentEnumStrs)
+ENUMSTR_ENTRY(PRESENT_AUTO,         L"auto")
+ENUMSTR_ENTRY(PRESENT_COPY,         L"copy")
+ENUMSTR_ENTRY(PRESENT_BLT,          L"blt")
 ENUMSTR_END
 
 // CmdLine: Variables
 #define MAX_FILENAME_LEN 256
+#define TRACE_FILE_SUFFIX L".trace.json"
+#define DEFAULT_THRESHOLD 5     // % throughput drop flagged against a baseline
+#define RAW_SINK_SIZE (4 * 1024 * 1024)
 STATIC GRAPHIC_TEST_TYPE GraphicTest = ALL_TESTS;
 STATIC BOOLEAN ClipEnable =  FALSE;
 STATIC UINT32 TimeParam = 2000;   // 2 second
@@ -48,6 +103,57 @@ STATIC BOOLEAN AllModes = FALSE;
 STATIC CHAR16 Filename[MAX_FILENAME_LEN];
 STATIC BOOLEAN Pause = FALSE;
 STATIC BOOLEAN DevFlag = FALSE;
+STATIC BOOLEAN Pregen = FALSE;
+STATIC BOOLEAN Histogram = FALSE;
+STATIC UINT32 Warmup = 0;
+STATIC UINT32 Repeat = 1;
+STATIC UINT32 WarmupRuns = 0;
+STATIC BOOLEAN Sweep = FALSE;
+STATIC BOOLEAN Quiet = FALSE;
+STATIC BOOLEAN Cold = FALSE;
+STATIC BOOLEAN Shadow = FALSE;
+STATIC PRESENT_METHOD Present = PRESENT_AUTO;
+STATIC BOOLEAN PrimStats = FALSE;
+STATIC BOOLEAN LegacyRand = FALSE;
+STATIC FILL_KERNEL Fill = FILL_LIBRARY;
+STATIC UINT32 Cpus = 1;
+STATIC UINT32 GlyphKb = GLYPH_CACHE_DEFAULT_KB;
+STATIC UINT32 StringKb = STRING_CACHE_DEFAULT_KB;
+STATIC RESULTS_FORMAT Format = FORMAT_TEXT;
+STATIC CHAR16 BaselineFile[MAX_FILENAME_LEN];
+STATIC CHAR16 RawFilename[MAX_FILENAME_LEN];
+STATIC UINT32 Threshold = DEFAULT_THRESHOLD;
+
+// per-call test each batch test is compared with
+STATIC CONST struct {
+    GRAPHIC_TEST_TYPE Batch;
+    GRAPHIC_TEST_TYPE PerCall;
+} BatchTests[] = {
+    { PIXEL_BATCH_TEST,             PIXEL_TEST },
+    { LINE_BATCH_TEST,              LINE_TEST },
+    { FILL_RECTANGLE_BATCH_TEST,    FILL_RECTANGLE_TEST },
+};
+
+// uncached test each cached circle test is compared with, and the library
+// test given for context
+STATIC CONST struct {
+    GRAPHIC_TEST_TYPE Cached;
+    GRAPHIC_TEST_TYPE Uncached;
+    GRAPHIC_TEST_TYPE Library;
+} CircleCacheTests[] = {
+    { CIRCLE_CACHE_TEST,            CIRCLE_SPANS_TEST,          CIRCLE_TEST },
+    { FILL_CIRCLE_CACHE_TEST,       FILL_CIRCLE_SPANS_TEST,     FILL_CIRCLE_TEST },
+};
+
+// library test each cached text test is compared with
+STATIC CONST struct {
+    GRAPHIC_TEST_TYPE Cached;
+    GRAPHIC_TEST_TYPE Library;
+} GlyphCacheTests[] = {
+    { TEXT1_CACHE_TEST,             TEXT1_TEST },
+    { TEXT2_CACHE_TEST,             TEXT2_TEST },
+    { TEXT2_FIXED_CACHE_TEST,       TEXT2_FIXED_TEST },
+};
 
 // CmdLine: Main program help
 CHAR16 ProgHelpStr[]    = L"Graphics test";
@@ -60,9 +166,29 @@ SWTABLE_OPT_DEC32(  L"-t",  L"-time",       &TimeParam,
 SWTABLE_OPT_DEC32(  L"-n",  L"-number",     &NumParam,                          L"[num]number parameter")
 SWTABLE_OPT_DEC32(  L"-m",  L"-mode",       &Mode,                              L"[num]set graphics mode (0...n)")
 SWTABLE_OPT_FLAG(   L"-a",  L"-allmodes",   &AllModes,                          L"run for all available graphics modes")
+SWTABLE_OPT_FLAG(   NULL,   L"-pregen",     &Pregen,                            L"also run tests from pre-generated parameters")
+SWTABLE_OPT_DEC32(  NULL,   L"-warmup",     &Warmup,                            L"[num]untimed iterations before each test")
+SWTABLE_OPT_DEC32(  NULL,   L"-repeat",     &Repeat,                            L"[num]timed trials per test")
+SWTABLE_OPT_DEC32(  NULL,   L"-warmupruns", &WarmupRuns,                        L"[num]discarded trials before timed trials")
+SWTABLE_OPT_FLAG(   NULL,   L"-hist",       &Histogram,                         L"record per-call latency percentiles")
+SWTABLE_OPT_STR(    NULL,   L"-raw",        RawFilename, MAX_FILENAME_LEN,      L"[filename]write cycles and parameters of every timed call")
+SWTABLE_OPT_FLAG(   NULL,   L"-cold",       &Cold,                              L"also run tests with data cache evicted before each iteration")
+SWTABLE_OPT_FLAG(   NULL,   L"-shadow",     &Shadow,                            L"also run tests drawing to a shadow buffer flushed by dirty rectangles")
+SWTABLE_OPT_ENUM(   NULL,   L"-present",    &Present, PresentEnumStrs,          L"[method]frame test present, auto, copy or blt")
+SWTABLE_OPT_FLAG(   NULL,   L"-quiet",      &Quiet,                             L"hold off timer events during timed batches")
+SWTABLE_OPT_FLAG(   NULL,   L"-sweep",      &Sweep,                             L"fit fixed and per-pixel cost over primitive sizes")
+SWTABLE_OPT_FLAG(   NULL,   L"-stats",      &PrimStats,                         L"count primitive calls and pixels (PRIM_STATS_SUPPORT build)")
+SWTABLE_OPT_FLAG(   NULL,   L"-legacyrand", &LegacyRand,                        L"generate parameters with the original Rand() as older versions")
+SWTABLE_OPT_ENUM(   NULL,   L"-fill",       &Fill, FillEnumStrs,                L"[kernel]clear and fill rectangle kernel, lib, auto, scalar, sse2 or avx2")
+SWTABLE_OPT_DEC32(  NULL,   L"-cpus",       &Cpus,                              L"[num]CPUs to tile large fills and frame copies across")
+SWTABLE_OPT_DEC32(  NULL,   L"-glyphkb",    &GlyphKb,                           L"[num]glyph cache memory cap of the cached text tests (KB, default 64)")
+SWTABLE_OPT_DEC32(  NULL,   L"-stringkb",   &StringKb,                          L"[num]string cache memory cap of the cached label test (KB, default 256)")
 SWTABLE_OPT_FLAG(   L"-p",  L"-pause",      &Pause,                             L"pause after each test")
 SWTABLE_OPT_FLAG(   L"-i",  L"-info",       &GopInfo,                           L"graphics info")
 SWTABLE_OPT_STR(    L"-f",  L" -file",      Filename, MAX_FILENAME_LEN,         L"[filename]Write results to file")
+SWTABLE_OPT_ENUM(   NULL,   L"-format",     &Format, FormatEnumStrs,            L"[fmt]results format, text, csv or json")
+SWTABLE_OPT_STR(    NULL,   L"-baseline",   BaselineFile, MAX_FILENAME_LEN,     L"[filename]compare throughput with JSON results file")
+SWTABLE_OPT_DEC32(  NULL,   L"-threshold",  &Threshold,                         L"[pct]throughput drop failing baseline (default 5)")
 SWTABLE_OPT_FLAG(   NULL,   L"-version",    &ProgVersion,                       L"program version")
 SWTABLE_OPT_FLAG(   NULL,   L"-dev",        &DevFlag,                           L"development")
 SWTABLE_END
@@ -70,8 +196,27 @@ SWTABLE_END
 
 STATIC EFI_STATUS DisplayGopInfo(VOID);
 STATIC EFI_STATUS CheckFile(CHAR16 *Filename);
-STATIC EFI_STATUS OutputTestResults(IN EFI_TIME *StartTime, IN EFI_TIME *EndTime, IN BOOLEAN ClipEnabled, IN TEST_RESULTS *Results, IN UINTN NumResults, IN CHAR16 *Filename);
-STATIC EFI_STATUS EFIAPI OutputString(IN SHELL_FILE_HANDLE FileHandle, IN CONST CHAR16 *FormatString, ...);
+STATIC EFI_STATUS OutputTrace(IN CHAR16 *Filename);
+STATIC EFI_STATUS OutputTestResults(IN EFI_TIME *StartTime, IN EFI_TIME *EndTime, IN BOOLEAN ClipEnabled, IN TEST_RESULTS *Results, IN UINTN NumResults, IN CHAR16 *Filename, IN RESULTS_FORMAT Format);
+STATIC EFI_STATUS OutputCsv(IN OUTPUT_SINK *Sink, IN BOOLEAN ClipEnabled, IN TEST_RESULTS *Results, IN UINTN NumResults);
+STATIC EFI_STATUS OutputJson(IN OUTPUT_SINK *Sink, IN EFI_TIME *StartTime, IN EFI_TIME *EndTime, IN BOOLEAN ClipEnabled, IN TEST_RESULTS *Results, IN UINTN NumResults);
+STATIC BOOLEAN OutputBaseline(IN BASELINE *Baseline, IN TEST_RESULTS *Results, IN UINTN NumResults, IN UINT32 Threshold);
+STATIC EFI_STATUS OutputRunData(IN OUTPUT_SINK *Sink, IN TEST_RUN_DATA *Data, IN UINT64 PeakMBps);
+STATIC EFI_STATUS OutputBandwidth(IN OUTPUT_SINK *Sink, IN BANDWIDTH_RESULTS *Bandwidth);
+STATIC EFI_STATUS OutputCold(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results);
+STATIC EFI_STATUS OutputBatched(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results);
+STATIC EFI_STATUS OutputRasterizers(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results);
+STATIC EFI_STATUS OutputCircleCache(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results);
+STATIC EFI_STATUS OutputGlyphCache(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results);
+STATIC EFI_STATUS OutputStringCache(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results);
+STATIC EFI_STATUS OutputShadow(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results);
+STATIC EFI_STATUS OutputFrames(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results);
+STATIC EFI_STATUS OutputSweep(IN OUTPUT_SINK *Sink, IN SWEEP_RESULTS *Sweep);
+STATIC EFI_STATUS OutputStats(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results);
+STATIC EFI_STATUS OutputBatches(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results);
+STATIC EFI_STATUS OutputPrimStats(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results);
+STATIC EFI_STATUS OutputLatency(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results, IN BOOLEAN Nanosecs);
+STATIC EFI_STATUS EFIAPI OutputString(IN OUTPUT_SINK *Sink, IN CONST CHAR16 *FormatString, ...);
 STATIC VOID DevCode();
 
 /*
@@ -88,8 +233,14 @@ ShellAppMain (
     EFI_STATUS Status = EFI_SUCCESS;
     TEST_RESULTS *TestResults = NULL;
     UINT32 *ModeList = NULL;
+    BOOLEAN Trace = FALSE;
+    BASELINE Baseline = {0};
+    SHELL_FILE_HANDLE RawHandle = NULL;
+    OUTPUT_SINK RawSink = {0};
 
     Filename[0] = '\0';
+    BaselineFile[0] = '\0';
+    RawFilename[0] = '\0';
 
     // Parse command line options
     ShellStatus = ParseCmdLine(NULL, 0, SwitchTable, ProgHelpStr, NO_BREAK, NULL);
@@ -102,8 +253,19 @@ ShellAppMain (
         goto App_exit;
     }
 
+    // Profile zones are recorded from here when results go to a file
+    if (Filename[0]) {
+        Status = CreateProfile();
+        if (EFI_ERROR(Status)) {
+            Print(L"ERROR: Failed to allocate profile buffer (%r)\n", Status);
+            goto App_exit;
+        }
+    }
+
     // Initialise graphics lib so we can determine the number of modes
+    PROFILE_BEGIN(InitZone);
     Status = InitGraphics();
+    PROFILE_END(InitZone, L"InitGraphics");
     if (EFI_ERROR(Status)) {
         Print(L"ERROR: Failed to initialise graphics (%r)\n", Status);
         goto App_exit;
@@ -119,11 +281,41 @@ ShellAppMain (
         goto App_exit;
     }
 
+    // Baseline is loaded first as it may be the results file being replaced
+    if (BaselineFile[0]) {
+        Status = CreateBaseline(BaselineFile, &Baseline);
+        if (EFI_ERROR(Status)) {
+            Print(L"ERROR: Failed to load baseline '%s' (%r)\n", BaselineFile, Status);
+            ShellStatus = SHELL_NOT_FOUND;
+            goto App_exit;
+        }
+    }
+
     // Check we can create file before running tests
     Status = CheckFile(Filename);
     if (EFI_ERROR(Status)) {
         goto App_exit;
     }
+    Trace = gProfileEnabled;
+
+    // Raw samples are streamed to their own file between trials
+    if (RawFilename[0]) {
+        Status = CheckFile(RawFilename);
+        if (EFI_ERROR(Status)) {
+            goto App_exit;
+        }
+        Status = ShellOpenFileByName(RawFilename, &RawHandle, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0);
+        if (EFI_ERROR(Status)) {
+            Print(L"ERROR: Failed to create file '%s' (%r)\n", RawFilename, Status);
+            goto App_exit;
+        }
+        Status = CreateSink(&RawSink, RawHandle, RAW_SINK_SIZE);
+        if (EFI_ERROR(Status)) {
+            Print(L"ERROR: Failed to allocate output buffer (%r)\n", Status);
+            goto App_exit;
+        }
+        WriteRawHeader(&RawSink);
+    }
 
     // Development
     if (DevFlag) {
@@ -135,6 +327,32 @@ ShellAppMain (
     if (GraphicTest != NO_TEST) {
         EFI_TIME StartTime;
         EFI_TIME EndTime;
+        TEST_OPTIONS Options = {
+            .Duration = TimeParam,
+            .Iterations = NumParam,
+            .ClipTest = ClipEnable,
+            .Pregen = Pregen,
+            .Histogram = Histogram,
+            .Pause = Pause,
+            .Warmup = Warmup,
+            .Repeat = Repeat,
+            .WarmupRuns = WarmupRuns,
+            .Sweep = Sweep,
+            .Quiet = Quiet,
+            .Cold = Cold,
+            .Shadow = Shadow,
+            .Present = Present,
+            .PrimStats = PrimStats && PrimStatsSupported(),
+            .LegacyRand = LegacyRand,
+            .Fill = Fill,
+            .Cpus = Cpus,
+            .GlyphCacheKb = GlyphKb,
+            .StringCacheKb = StringKb,
+            .Raw = RawSink.FileHandle ? &RawSink : NULL
+        };
+        if (PrimStats && !PrimStatsSupported()) {
+            Print(L"WARNING: Primitive counters not built, rebuild with PRIM_STATS_SUPPORT=1\n");
+        }
         TestResults = (TEST_RESULTS *)AllocatePool((AllModes ? NumModes : 1) * sizeof(TEST_RESULTS));
         if (!TestResults) {
             Status = EFI_OUT_OF_RESOURCES;
@@ -170,32 +388,72 @@ ShellAppMain (
             }
             // Run test over all modes
             for (UINTN i = 0; i < NumModes; i++) {
-                Status = RunGraphicTest(ModeList[i], GraphicTest, TimeParam, NumParam, ClipEnable, Pause, &TestResults[i]);
+                PROFILE_BEGIN(ModeZone);
+                Status = RunGraphicTest(ModeList[i], GraphicTest, &Options, &TestResults[i]);
+                PROFILE_END(ModeZone, L"RunGraphicTest");
                 if (EFI_ERROR(Status)) {
                     goto App_exit;
                 }
             }
         } else {
             // Current graphic mode
-            Status = RunGraphicTest(Mode, GraphicTest, TimeParam, NumParam, ClipEnable, Pause, &TestResults[0]);
+            PROFILE_BEGIN(ModeZone);
+            Status = RunGraphicTest(Mode, GraphicTest, &Options, &TestResults[0]);
+            PROFILE_END(ModeZone, L"RunGraphicTest");
             if (EFI_ERROR(Status)) {
                 goto App_exit;
             }
         }
         gST->RuntimeServices->GetTime(&EndTime, (EFI_TIME_CAPABILITIES*)NULL);
 
-        // Results to console
-        OutputTestResults(&StartTime, &EndTime, ClipEnable, TestResults, AllModes ? NumModes : 1, NULL);
+        // Results to console, in the results format if not going to a file
+        PROFILE_BEGIN(OutputZone);
+        OutputTestResults(&StartTime, &EndTime, ClipEnable, TestResults, AllModes ? NumModes : 1, NULL, Filename[0] ? FORMAT_TEXT : Format);
         // Results to file if specified
         if (Filename[0]) {
-            Status = OutputTestResults(&StartTime, &EndTime, ClipEnable, TestResults, AllModes ? NumModes : 1, Filename);
+            Status = OutputTestResults(&StartTime, &EndTime, ClipEnable, TestResults, AllModes ? NumModes : 1, Filename, Format);
             if (EFI_ERROR(Status)) {
                 goto App_exit;
             }
         }
+        PROFILE_END(OutputZone, L"OutputTestResults");
+
+        if (Options.Raw) {
+            UINT64 RawSamples = 0;
+            UINT64 RawDropped = 0;
+            for (UINTN i = 0; i < (AllModes ? NumModes : 1); i++) {
+                RawSamples += TestResults[i].RawSamples;
+                RawDropped += TestResults[i].RawDropped;
+            }
+            Print(L"Raw samples: %lu written to '%s'\n", RawSamples, RawFilename);
+            if (RawDropped) {
+                Print(L"WARNING: %lu raw samples dropped, trials over %u iterations\n", RawDropped, RAW_MAX_SAMPLES);
+            }
+        }
+
+        // Non-zero shell status on regression to gate scripts
+        if (Baseline.Num && !OutputBaseline(&Baseline, TestResults, AllModes ? NumModes : 1, Threshold)) {
+            ShellStatus = SHELL_ABORTED;
+        }
     }
 
 App_exit:
+    // Trace covers aborted and failed runs too
+    if (Trace) {
+        OutputTrace(Filename);
+    }
+    DestroyProfile();
+    DestroyBaseline(&Baseline);
+    if (RawSink.FileHandle) {
+        EFI_STATUS RawStatus = FlushSink(&RawSink);
+        if (EFI_ERROR(RawStatus)) {
+            Print(L"ERROR: Failed to write to file '%s' (%r)\n", RawFilename, RawStatus);
+        }
+        DestroySink(&RawSink);
+    }
+    if (RawHandle) {
+        ShellCloseFile(&RawHandle);
+    }
     SHELL_FREE_NON_NULL(TestResults);
     SHELL_FREE_NON_NULL(ModeList);
 
@@ -271,13 +529,48 @@ Error_exit:
     return Status;
 }
 
+/*
+ * OutputTrace() - Write profile zones next to the results file, the results
+ *                 extension is replaced by TRACE_FILE_SUFFIX
+ */
+STATIC EFI_STATUS OutputTrace(IN CHAR16 *Filename)
+{
+    EFI_STATUS Status;
+    CHAR16 TraceFilename[MAX_FILENAME_LEN];
+    UINTN Len = StrLen(Filename);
+    UINTN MaxLen = MAX_FILENAME_LEN - sizeof(TRACE_FILE_SUFFIX) / sizeof(CHAR16);
+
+    for (UINTN i = Len; i > 0; i--) {
+        if (Filename[i - 1] == L'.') {
+            Len = i - 1;
+            break;
+        }
+        if (Filename[i - 1] == L'\\' || Filename[i - 1] == L'/' || Filename[i - 1] == L':') {
+            break;
+        }
+    }
+    if (Len > MaxLen) {
+        Len = MaxLen;
+    }
+    CopyMem(TraceFilename, Filename, Len * sizeof(CHAR16));
+    CopyMem(&TraceFilename[Len], TRACE_FILE_SUFFIX, sizeof(TRACE_FILE_SUFFIX));
+
+    Status = WriteProfileTrace(TraceFilename);
+    if (EFI_ERROR(Status)) {
+        Print(L"ERROR: Failed to write trace file '%s' (%r)\n", TraceFilename, Status);
+    }
+    return Status;
+}
+
 /*
  * OutputTestResults() - Output results to file or console
  */
-STATIC EFI_STATUS OutputTestResults(IN EFI_TIME *StartTime, IN EFI_TIME *EndTime, IN BOOLEAN ClipEnabled, IN TEST_RESULTS *Results, IN UINTN NumResults, IN CHAR16 *Filename)
+STATIC EFI_STATUS OutputTestResults(IN EFI_TIME *StartTime, IN EFI_TIME *EndTime, IN BOOLEAN ClipEnabled, IN TEST_RESULTS *Results, IN UINTN NumResults, IN CHAR16 *Filename, IN RESULTS_FORMAT Format)
 {
     EFI_STATUS Status = EFI_SUCCESS;
     SHELL_FILE_HANDLE FileHandle = NULL;
+    OUTPUT_SINK FileSink;
+    OUTPUT_SINK *Sink = NULL;   // console
 
     if (Filename && Filename[0]) {
         Status = ShellOpenFileByName(Filename, &FileHandle, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0);
@@ -285,31 +578,107 @@ STATIC EFI_STATUS OutputTestResults(IN EFI_TIME *StartTime, IN EFI_TIME *EndTime
             Print(L"ERROR: Failed to create file '%s' (%r)\n", Filename, Status);
             goto Error_exit;
         }
+        Status = CreateSink(&FileSink, FileHandle, SINK_DEFAULT_SIZE);
+        if (EFI_ERROR(Status)) {
+            Print(L"ERROR: Failed to allocate output buffer (%r)\n", Status);
+            goto Error_exit;
+        }
+        Sink = &FileSink;
+    }
+    if (Format == FORMAT_CSV) {
+        Status = OutputCsv(Sink, ClipEnabled, Results, NumResults);
+        goto Error_exit;
+    }
+    if (Format == FORMAT_JSON) {
+        Status = OutputJson(Sink, StartTime, EndTime, ClipEnabled, Results, NumResults);
+        goto Error_exit;
     }
 
-    Status = OutputString(FileHandle, L"Start: %04u/%02u/%02u %02u:%02u:%02u\n", StartTime->Year, StartTime->Month, StartTime->Day, StartTime->Hour, StartTime->Minute, StartTime->Second);
+    Status = OutputString(Sink, L"Start: %04u/%02u/%02u %02u:%02u:%02u\n", StartTime->Year, StartTime->Month, StartTime->Day, StartTime->Hour, StartTime->Minute, StartTime->Second);
+    if (EFI_ERROR(Status)) goto Error_exit;
+    Status = OutputString(Sink, L"End  : %04u/%02u/%02u %02u:%02u:%02u\n", EndTime->Year, EndTime->Month, EndTime->Day, EndTime->Hour, EndTime->Minute, EndTime->Second);
     if (EFI_ERROR(Status)) goto Error_exit;
-    Status = OutputString(FileHandle, L"End  : %04u/%02u/%02u %02u:%02u:%02u\n", EndTime->Year, EndTime->Month, EndTime->Day, EndTime->Hour, EndTime->Minute, EndTime->Second);
+    Status = OutputString(Sink, L"Timer: %lu Hz (%s, +/-%u ppm)\n", GetTimerFreq(), GetTimerSourceDesc(GetTimerSource()), GetTimerErrorPpm());
     if (EFI_ERROR(Status)) goto Error_exit;
-    Status = OutputString(FileHandle, L"Clipped: %s\n\n", ClipEnabled ? L"Yes":L"No");
+    Status = OutputString(Sink, L"Clipped: %s\n\n", ClipEnabled ? L"Yes":L"No");
     if (EFI_ERROR(Status)) goto Error_exit;
 
     for (UINT32 m = 0; m < NumResults; m++) {
-        Status = OutputString(FileHandle, L"%ux%u - Mode %u\n", Results[m].HorRes, Results[m].VerRes, Results[m].Mode);
+        Status = OutputString(Sink, L"%ux%u - Mode %u\n", Results[m].HorRes, Results[m].VerRes, Results[m].Mode);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputString(Sink, L"Harness overhead: %lu.%02lu cycles/iteration\n", Results[m].Overhead >> 8, ((Results[m].Overhead & 0xFF) * 100) >> 8);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputString(Sink, L"Fill kernel: %s, batch %s\n", GetFillKernelDesc(Results[m].FillKernel), GetFillKernelDesc(Results[m].BatchFillKernel));
         if (EFI_ERROR(Status)) goto Error_exit;
-        Status = OutputString(FileHandle, L"Test           Iterations  Time\n");
+        Status = OutputString(Sink, L"CPUs: %u\n", Results[m].Cpus);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        BOOLEAN PregenRun = FALSE;
+        for (UINTN i=0; i<NUM_TESTS; i++) {
+            PregenRun |= Results[m].PregenData[i].Run;
+        }
+        UINT64 PeakMBps = Results[m].Bandwidth.PeakMBps;
+        Status = OutputString(Sink, L"Test           Iterations  Time(ms)     Mpix/s   GB/s%s%s\n", PeakMBps ? L"  %Peak" : L"",
+                              PregenRun ? (PeakMBps ? L" PregenIter  Time(ms)     Mpix/s   GB/s  %Peak" : L" PregenIter  Time(ms)     Mpix/s   GB/s") : L"");
         if (EFI_ERROR(Status)) goto Error_exit;
         for (UINTN i=0; i<NUM_TESTS; i++) {
             if (Results[m].Data[i].Run) {
-                Status = OutputString(FileHandle, L"%-13s : %9u %5u\n", GetTestDesc(i), Results[m].Data[i].Count, Results[m].Data[i].Time);
+                Status = OutputString(Sink, L"%-13s : ", GetTestDesc(i));
+                if (EFI_ERROR(Status)) goto Error_exit;
+                Status = OutputRunData(Sink, &Results[m].Data[i], PeakMBps);
+                if (EFI_ERROR(Status)) goto Error_exit;
+                if (Results[m].PregenData[i].Run) {
+                    Status = OutputString(Sink, L"  ");
+                    if (EFI_ERROR(Status)) goto Error_exit;
+                    Status = OutputRunData(Sink, &Results[m].PregenData[i], PeakMBps);
+                    if (EFI_ERROR(Status)) goto Error_exit;
+                }
+                Status = OutputString(Sink, L"\n");
                 if (EFI_ERROR(Status)) goto Error_exit;
             }
         }
-        Status = OutputString(FileHandle, L"\n");
+        Status = OutputString(Sink, L"\n");
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputBandwidth(Sink, &Results[m].Bandwidth);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputCold(Sink, &Results[m]);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputBatched(Sink, &Results[m]);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputRasterizers(Sink, &Results[m]);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputCircleCache(Sink, &Results[m]);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputGlyphCache(Sink, &Results[m]);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputStringCache(Sink, &Results[m]);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputShadow(Sink, &Results[m]);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputFrames(Sink, &Results[m]);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputSweep(Sink, &Results[m].Sweep);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputStats(Sink, &Results[m]);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputBatches(Sink, &Results[m]);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputPrimStats(Sink, &Results[m]);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputLatency(Sink, &Results[m], FALSE);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputLatency(Sink, &Results[m], TRUE);
         if (EFI_ERROR(Status)) goto Error_exit;
     }
 
 Error_exit:
+    if (Sink) {
+        EFI_STATUS FlushStatus = FlushSink(Sink);
+        if (!EFI_ERROR(Status) && EFI_ERROR(FlushStatus)) {
+            Print(L"ERROR: Failed to write to file '%s' (%r)\n", Filename, FlushStatus);
+            Status = FlushStatus;
+        }
+        DestroySink(Sink);
+    }
     if (FileHandle) {
         ShellCloseFile(&FileHandle); 
     }
@@ -317,26 +686,850 @@ Error_exit:
 }
 
 /*
- * OutputString() - Ouput string to file or console
+ * OutputRunData() - Iterations, time and throughput columns for a test run
+ */
+STATIC EFI_STATUS OutputRunData(IN OUTPUT_SINK *Sink, IN TEST_RUN_DATA *Data, IN UINT64 PeakMBps)
+{
+    EFI_STATUS Status;
+    UINT64 TimeNs = Data->TimeNs;
+    UINT64 MpixTenths = 0;      // Mpixels/s x 10
+    UINT64 GbHundredths = 0;    // GB/s x 100
+    UINT64 MBps = 0;
+    if (TimeNs) {
+        MpixTenths = (Data->Pixels * 10000 + TimeNs/2) / TimeNs;
+        GbHundredths = (Data->Pixels * BYTES_PER_PIXEL * 100 + TimeNs/2) / TimeNs;
+        MBps = (Data->Pixels * BYTES_PER_PIXEL * 1000 + TimeNs/2) / TimeNs;
+    }
+    Status = OutputString(Sink, L"%9u %5lu.%03lu %8lu.%01lu %3lu.%02lu", Data->Count, TimeNs / 1000000, (TimeNs / 1000) % 1000,
+                          MpixTenths / 10, MpixTenths % 10, GbHundredths / 100, GbHundredths % 100);
+    if (!EFI_ERROR(Status) && PeakMBps) {
+        Status = OutputString(Sink, L" %5lu%%", (MBps * 100 + PeakMBps/2) / PeakMBps);
+    }
+    return Status;
+}
+
+/*
+ * OutputBandwidth() - Output raw bandwidth probes for a mode if run
+ */
+STATIC EFI_STATUS OutputBandwidth(IN OUTPUT_SINK *Sink, IN BANDWIDTH_RESULTS *Bandwidth)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    STATIC CHAR16 *TargetDesc[NUM_BW_TARGETS] = { L"Framebuffer", L"System mem" };
+    STATIC CHAR16 *OpDesc[NUM_BW_OPS] = { L"write", L"read", L"copy" };
+
+    if (!Bandwidth->Valid) {
+        goto Error_exit;
+    }
+    Status = OutputString(Sink, L"Bandwidth (MB/s)  ");
+    if (EFI_ERROR(Status)) goto Error_exit;
+    for (UINTN w=0; w<NUM_BW_WIDTHS; w++) {
+        Status = OutputString(Sink, L" %11s", GetBwWidthDesc(w));
+        if (EFI_ERROR(Status)) goto Error_exit;
+    }
+    Status = OutputString(Sink, L"\n");
+    if (EFI_ERROR(Status)) goto Error_exit;
+    for (UINTN t=0; t<NUM_BW_TARGETS; t++) {
+        for (UINTN o=0; o<NUM_BW_OPS; o++) {
+            Status = OutputString(Sink, L"%-11s %-6s", TargetDesc[t], OpDesc[o]);
+            if (EFI_ERROR(Status)) goto Error_exit;
+            for (UINTN w=0; w<NUM_BW_WIDTHS; w++) {
+                if (Bandwidth->MBps[t][o][w]) {
+                    Status = OutputString(Sink, L" %11lu", Bandwidth->MBps[t][o][w]);
+                } else {
+                    Status = OutputString(Sink, L"           -");
+                }
+                if (EFI_ERROR(Status)) goto Error_exit;
+            }
+            Status = OutputString(Sink, L"\n");
+            if (EFI_ERROR(Status)) goto Error_exit;
+        }
+    }
+    Status = OutputString(Sink, L"Peak framebuffer write: %lu MB/s (%s)\n\n", Bandwidth->PeakMBps, GetBwWidthDesc(Bandwidth->PeakWidth));
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputCold() - Output warm and cold cache time per call side by side for a
+ *                mode if run, with the test slowed most by a cold cache
+ */
+STATIC EFI_STATUS OutputCold(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    BOOLEAN Header = FALSE;
+    UINT64 WorstRatio = 0;  // hundredths
+    UINTN WorstTest = 0;
+
+    for (UINTN i=0; i<NUM_TESTS; i++) {
+        TEST_RUN_DATA *Warm = &Results->Data[i];
+        TEST_RUN_DATA *Cold = &Results->ColdData[i];
+        if (!Warm->Run || !Cold->Run || !Warm->Count || !Cold->Count) {
+            continue;
+        }
+        if (!Header) {
+            Status = OutputString(Sink, L"Cache (LLC %lu KB, eviction buffer %lu KB)\n", (UINT64)Results->LlcSize / 1024, (UINT64)Results->EvictSize / 1024);
+            if (EFI_ERROR(Status)) goto Error_exit;
+            Status = OutputString(Sink, L"Test            Warm(ns/call)  Cold(ns/call)   Cold/Warm\n");
+            if (EFI_ERROR(Status)) goto Error_exit;
+            Header = TRUE;
+        }
+        UINT64 WarmPs = (Warm->TimeNs * 1000 + Warm->Count/2) / Warm->Count;
+        UINT64 ColdPs = (Cold->TimeNs * 1000 + Cold->Count/2) / Cold->Count;
+        UINT64 Ratio = WarmPs ? (ColdPs * 100 + WarmPs/2) / WarmPs : 0;
+        Status = OutputString(Sink, L"%-13s : %11lu.%01lu  %11lu.%01lu  %6lu.%02lux\n", GetTestDesc(i),
+                              WarmPs / 1000, (WarmPs % 1000) / 100, ColdPs / 1000, (ColdPs % 1000) / 100, Ratio / 100, Ratio % 100);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        if (Ratio > WorstRatio) {
+            WorstRatio = Ratio;
+            WorstTest = i;
+        }
+    }
+    if (Header) {
+        Status = OutputString(Sink, L"Most affected: %s (%lu.%02lux)\n\n", GetTestDesc(WorstTest), WorstRatio / 100, WorstRatio % 100);
+    }
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * PrimPs() - Time per primitive (ps) of a test run, 0 if not run
+ */
+STATIC UINT64 PrimPs(IN TEST_RUN_DATA *Data, IN GRAPHIC_TEST_TYPE Test)
+{
+    UINT64 Prims = (UINT64)Data->Count * GetTestPrims(Test);
+    return (Data->Run && Prims) ? (Data->TimeNs * 1000 + Prims/2) / Prims : 0;
+}
+
+/*
+ * OutputBatched() - Output time per primitive of the batch tests beside their
+ *                   per-call tests for a mode if run
+ */
+STATIC EFI_STATUS OutputBatched(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    BOOLEAN Header = FALSE;
+
+    for (UINTN i=0; i<ARRAY_SIZE(BatchTests); i++) {
+        GRAPHIC_TEST_TYPE Batch = BatchTests[i].Batch;
+        GRAPHIC_TEST_TYPE PerCall = BatchTests[i].PerCall;
+        UINT64 BatchPs = PrimPs(&Results->Data[Batch], Batch);
+        UINT64 CallPs = PrimPs(&Results->Data[PerCall], PerCall);
+        if (!BatchPs) {
+            continue;
+        }
+        if (!Header) {
+            Status = OutputString(Sink, L"Batched submission (ns/primitive, %u per batch)\n", GetTestPrims(Batch));
+            if (EFI_ERROR(Status)) goto Error_exit;
+            Status = OutputString(Sink, L"Test              Per call     Batched    Speedup\n");
+            if (EFI_ERROR(Status)) goto Error_exit;
+            Header = TRUE;
+        }
+        Status = OutputString(Sink, L"%-13s : ", GetTestDesc(Batch));
+        if (EFI_ERROR(Status)) goto Error_exit;
+        if (CallPs) {
+            UINT64 Speedup = (CallPs * 100 + BatchPs/2) / BatchPs;
+            Status = OutputString(Sink, L"%8lu.%02lu %8lu.%02lu %8lu.%02lux\n", CallPs / 1000, (CallPs % 1000) / 10,
+                                  BatchPs / 1000, (BatchPs % 1000) / 10, Speedup / 100, Speedup % 100);
+        } else {
+            Status = OutputString(Sink, L"       - %8lu.%02lu          -\n", BatchPs / 1000, (BatchPs % 1000) / 10);
+        }
+        if (EFI_ERROR(Status)) goto Error_exit;
+    }
+    if (Header) {
+        Status = OutputString(Sink, L"\n");
+    }
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputRasterizers() - Output time per triangle of the library and
+ *                       half-space fill triangle rasterizers for a mode if
+ *                       the half-space test was run
+ */
+STATIC EFI_STATUS OutputRasterizers(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    UINT64 LibPs = PrimPs(&Results->Data[FILL_TRIANGLE_TEST], FILL_TRIANGLE_TEST);
+    UINT64 HsPs = PrimPs(&Results->Data[FILL_TRIANGLE_HS_TEST], FILL_TRIANGLE_HS_TEST);
+
+    if (!HsPs) {
+        goto Error_exit;
+    }
+    Status = OutputString(Sink, L"Fill triangle rasterizers (ns/triangle)\n");
+    if (EFI_ERROR(Status)) goto Error_exit;
+    Status = OutputString(Sink, L"Test               Library  Half-space    Speedup\n");
+    if (EFI_ERROR(Status)) goto Error_exit;
+    Status = OutputString(Sink, L"%-13s : ", GetTestDesc(FILL_TRIANGLE_TEST));
+    if (EFI_ERROR(Status)) goto Error_exit;
+    if (LibPs) {
+        UINT64 Speedup = (LibPs * 100 + HsPs/2) / HsPs;
+        Status = OutputString(Sink, L"%8lu.%02lu %8lu.%02lu %8lu.%02lux\n\n", LibPs / 1000, (LibPs % 1000) / 10,
+                              HsPs / 1000, (HsPs % 1000) / 10, Speedup / 100, Speedup % 100);
+    } else {
+        Status = OutputString(Sink, L"       - %8lu.%02lu          -\n\n", HsPs / 1000, (HsPs % 1000) / 10);
+    }
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputCircleCache() - Output time per circle of the cached circle tests
+ *                       beside the same circles with the span table computed
+ *                       every circle, with span cache lookups, for a mode if
+ *                       run
+ *
+ * The library tests draw random radii up to half the screen, so are only
+ * given as pixel rates for context.
+ */
+STATIC EFI_STATUS OutputCircleCache(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    BOOLEAN Header = FALSE;
+
+    for (UINTN i=0; i<ARRAY_SIZE(CircleCacheTests); i++) {
+        GRAPHIC_TEST_TYPE Cached = CircleCacheTests[i].Cached;
+        GRAPHIC_TEST_TYPE Uncached = CircleCacheTests[i].Uncached;
+        TEST_RUN_DATA *CachedData = &Results->Data[Cached];
+        TEST_RUN_DATA *Library = &Results->Data[CircleCacheTests[i].Library];
+        UINT64 CachedPs = PrimPs(CachedData, Cached);
+        UINT64 UncachedPs = PrimPs(&Results->Data[Uncached], Uncached);
+        if (!CachedPs) {
+            continue;
+        }
+        if (!Header) {
+            Status = OutputString(Sink, L"Circle span cache (ns/circle)\n");
+            if (EFI_ERROR(Status)) goto Error_exit;
+            Status = OutputString(Sink, L"Test               Uncached      Cached    Speedup Hit rate    Misses  Lib Mpix/s   Mpix/s\n");
+            if (EFI_ERROR(Status)) goto Error_exit;
+            Header = TRUE;
+        }
+        UINT64 Lookups = CachedData->CircleCache.Hits + CachedData->CircleCache.Misses;
+        UINT64 HitTenths = Lookups ? (CachedData->CircleCache.Hits * 1000 + Lookups/2) / Lookups : 0;
+        UINT64 CachedTenths = (CachedData->Pixels * 10000 + CachedData->TimeNs/2) / CachedData->TimeNs;
+        Status = OutputString(Sink, L"%-13s : ", GetTestDesc(Cached));
+        if (EFI_ERROR(Status)) goto Error_exit;
+        if (UncachedPs) {
+            UINT64 Speedup = (UncachedPs * 100 + CachedPs/2) / CachedPs;
+            Status = OutputString(Sink, L"%8lu.%02lu %8lu.%02lu %6lu.%02lux", UncachedPs / 1000, (UncachedPs % 1000) / 10,
+                                  CachedPs / 1000, (CachedPs % 1000) / 10, Speedup / 100, Speedup % 100);
+        } else {
+            Status = OutputString(Sink, L"          - %8lu.%02lu          -", CachedPs / 1000, (CachedPs % 1000) / 10);
+        }
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputString(Sink, L" %5lu.%01lu%% %9lu", HitTenths / 10, HitTenths % 10, CachedData->CircleCache.Misses);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        UINT64 LibraryTenths = (Library->Run && Library->TimeNs) ? (Library->Pixels * 10000 + Library->TimeNs/2) / Library->TimeNs : 0;
+        if (LibraryTenths) {
+            Status = OutputString(Sink, L" %9lu.%01lu", LibraryTenths / 10, LibraryTenths % 10);
+        } else {
+            Status = OutputString(Sink, L"           -");
+        }
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputString(Sink, L" %6lu.%01lu\n", CachedTenths / 10, CachedTenths % 10);
+        if (EFI_ERROR(Status)) goto Error_exit;
+    }
+    if (Header) {
+        Status = OutputString(Sink, L"\n");
+    }
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputGlyphCache() - Output time per string of the cached text tests
+ *                      beside the library tests, with glyph cache use, for
+ *                      a mode if run
+ */
+STATIC EFI_STATUS OutputGlyphCache(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    BOOLEAN Header = FALSE;
+
+    for (UINTN i=0; i<ARRAY_SIZE(GlyphCacheTests); i++) {
+        GRAPHIC_TEST_TYPE Cached = GlyphCacheTests[i].Cached;
+        GRAPHIC_TEST_TYPE Library = GlyphCacheTests[i].Library;
+        GLYPH_CACHE_STATS *Glyphs = &Results->Data[Cached].GlyphCache;
+        UINT64 CachedPs = PrimPs(&Results->Data[Cached], Cached);
+        UINT64 LibraryPs = PrimPs(&Results->Data[Library], Library);
+        if (!CachedPs) {
+            continue;
+        }
+        if (!Header) {
+            Status = OutputString(Sink, L"Glyph cache (ns/string)\n");
+            if (EFI_ERROR(Status)) goto Error_exit;
+            Status = OutputString(Sink, L"Test                Library      Cached    Speedup Hit rate  Expanded   Evicted  Peak KB\n");
+            if (EFI_ERROR(Status)) goto Error_exit;
+            Header = TRUE;
+        }
+        UINT64 Lookups = Glyphs->Hits + Glyphs->Misses;
+        UINT64 HitTenths = Lookups ? (Glyphs->Hits * 1000 + Lookups/2) / Lookups : 0;
+        Status = OutputString(Sink, L"%-13s : ", GetTestDesc(Library));
+        if (EFI_ERROR(Status)) goto Error_exit;
+        if (LibraryPs) {
+            UINT64 Speedup = (LibraryPs * 100 + CachedPs/2) / CachedPs;
+            Status = OutputString(Sink, L"%8lu.%02lu %8lu.%02lu %6lu.%02lux", LibraryPs / 1000, (LibraryPs % 1000) / 10,
+                                  CachedPs / 1000, (CachedPs % 1000) / 10, Speedup / 100, Speedup % 100);
+        } else {
+            Status = OutputString(Sink, L"          - %8lu.%02lu          -", CachedPs / 1000, (CachedPs % 1000) / 10);
+        }
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputString(Sink, L" %5lu.%01lu%% %9lu %9lu %8lu\n", HitTenths / 10, HitTenths % 10,
+                              Glyphs->Expansions, Glyphs->Evictions, (Glyphs->PeakBytes + 1023) / 1024);
+        if (EFI_ERROR(Status)) goto Error_exit;
+    }
+    if (Header) {
+        Status = OutputString(Sink, L"\n");
+    }
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputStringCache() - Output time per label of the cached label test
+ *                       beside the library test, with string cache use, for
+ *                       a mode if run
+ */
+STATIC EFI_STATUS OutputStringCache(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    STRING_CACHE_STATS *Strings = &Results->Data[LABEL_CACHE_TEST].StringCache;
+    UINT64 CachedPs = PrimPs(&Results->Data[LABEL_CACHE_TEST], LABEL_CACHE_TEST);
+    UINT64 LibraryPs = PrimPs(&Results->Data[LABEL_TEST], LABEL_TEST);
+
+    if (!CachedPs) {
+        return EFI_SUCCESS;
+    }
+    Status = OutputString(Sink, L"String cache (ns/label)\n");
+    if (EFI_ERROR(Status)) goto Error_exit;
+    Status = OutputString(Sink, L"Test                Library      Cached    Speedup Hit rate   Evicted  Uncached  Peak KB\n");
+    if (EFI_ERROR(Status)) goto Error_exit;
+    UINT64 Lookups = Strings->Hits + Strings->Misses;
+    UINT64 HitTenths = Lookups ? (Strings->Hits * 1000 + Lookups/2) / Lookups : 0;
+    Status = OutputString(Sink, L"%-13s : ", GetTestDesc(LABEL_TEST));
+    if (EFI_ERROR(Status)) goto Error_exit;
+    if (LibraryPs) {
+        UINT64 Speedup = (LibraryPs * 100 + CachedPs/2) / CachedPs;
+        Status = OutputString(Sink, L"%8lu.%02lu %8lu.%02lu %6lu.%02lux", LibraryPs / 1000, (LibraryPs % 1000) / 10,
+                              CachedPs / 1000, (CachedPs % 1000) / 10, Speedup / 100, Speedup % 100);
+    } else {
+        Status = OutputString(Sink, L"          - %8lu.%02lu          -", CachedPs / 1000, (CachedPs % 1000) / 10);
+    }
+    if (EFI_ERROR(Status)) goto Error_exit;
+    Status = OutputString(Sink, L" %5lu.%01lu%% %9lu %9lu %8lu\n\n", HitTenths / 10, HitTenths % 10,
+                          Strings->Evictions, Strings->Uncached, (Strings->PeakBytes + 1023) / 1024);
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputShadow() - Output time per primitive drawing directly and to the
+ *                  shadow buffer, with the flush cost, for a mode if run
+ */
+STATIC EFI_STATUS OutputShadow(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    BOOLEAN Header = FALSE;
+
+    for (UINTN i=0; i<NUM_TESTS; i++) {
+        TEST_RUN_DATA *Data = &Results->ShadowData[i];
+        UINT64 Prims = (UINT64)Data->Count * GetTestPrims(i);
+        if (!Data->Run || !Prims) {
+            continue;
+        }
+        if (!Header) {
+            Status = OutputString(Sink, L"Shadow buffer (ns/primitive, flushed every %u primitives)\n", SHADOW_FLUSH_PRIMS);
+            if (EFI_ERROR(Status)) goto Error_exit;
+            Status = OutputString(Sink, L"Test                Direct      Shadow       Flush       Total  Blts/flush  Kpix/flush\n");
+            if (EFI_ERROR(Status)) goto Error_exit;
+            Header = TRUE;
+        }
+        UINT64 DirectPs = PrimPs(&Results->Data[i], i);
+        UINT64 ShadowPs = PrimPs(Data, i);
+        UINT64 FlushPs = (Data->Flush.TimeNs * 1000 + Prims/2) / Prims;
+        UINT64 TotalPs = ShadowPs + FlushPs;
+        UINT32 Flushes = Data->Flush.Flushes ? Data->Flush.Flushes : 1;
+        UINT64 BltsTenths = ((UINT64)Data->Flush.Blts * 10 + Flushes/2) / Flushes;
+        UINT64 KpixPerFlush = (Data->Flush.Pixels + (UINT64)Flushes * 500) / ((UINT64)Flushes * 1000);
+        Status = OutputString(Sink, L"%-13s : ", GetTestDesc(i));
+        if (EFI_ERROR(Status)) goto Error_exit;
+        if (DirectPs) {
+            Status = OutputString(Sink, L"%8lu.%02lu ", DirectPs / 1000, (DirectPs % 1000) / 10);
+        } else {
+            Status = OutputString(Sink, L"       -    ");
+        }
+        if (EFI_ERROR(Status)) goto Error_exit;
+        Status = OutputString(Sink, L"%8lu.%02lu %8lu.%02lu %8lu.%02lu %9lu.%01lu %11lu\n", ShadowPs / 1000, (ShadowPs % 1000) / 10,
+                              FlushPs / 1000, (FlushPs % 1000) / 10, TotalPs / 1000, (TotalPs % 1000) / 10,
+                              BltsTenths / 10, BltsTenths % 10, KpixPerFlush);
+        if (EFI_ERROR(Status)) goto Error_exit;
+    }
+    if (Header) {
+        Status = OutputString(Sink, L"\n");
+    }
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputFrames() - Output frame rate and frame times of the frame test for a
+ *                  mode if run
  */
-#define BUFFLEN 1024
+STATIC EFI_STATUS OutputFrames(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    TEST_RUN_DATA *Data = &Results->Data[FRAME_TEST];
+
+    if (!Data->Run || !Data->TimeNs || !Data->Latency.Valid) {
+        goto Error_exit;
+    }
+    UINT64 FpsTenths = ((UINT64)Data->Count * 10000000000 + Data->TimeNs/2) / Data->TimeNs;
+    // frame times in hundredths of a ms
+    UINT64 P50 = (CyclesToNs(Data->Latency.Pct[PCT_50]) + 5000) / 10000;
+    UINT64 P99 = (CyclesToNs(Data->Latency.Pct[PCT_99]) + 5000) / 10000;
+    UINT64 Max = (CyclesToNs(Data->Latency.Max) + 5000) / 10000;
+    Status = OutputString(Sink, L"Frames (%ux%u, present by %s)\n", Results->HorRes, Results->VerRes, GetPresentDesc(Results->Present));
+    if (EFI_ERROR(Status)) goto Error_exit;
+    Status = OutputString(Sink, L"   Frames       FPS   p50(ms)   p99(ms)   Max(ms)\n");
+    if (EFI_ERROR(Status)) goto Error_exit;
+    Status = OutputString(Sink, L"%9u %7lu.%01lu %6lu.%02lu %6lu.%02lu %6lu.%02lu\n\n", Data->Count, FpsTenths / 10, FpsTenths % 10,
+                          P50 / 100, P50 % 100, P99 / 100, P99 % 100, Max / 100, Max % 100);
+
+Error_exit:
+    return Status;
+}
 
-STATIC EFI_STATUS EFIAPI OutputString(IN SHELL_FILE_HANDLE FileHandle, IN CONST CHAR16 *FormatString, ...)
+/*
+ * OutputSweep() - Output time per call over primitive sizes and the fitted
+ *                 fixed and per-pixel cost for a mode if run
+ */
+STATIC EFI_STATUS OutputSweep(IN OUTPUT_SINK *Sink, IN SWEEP_RESULTS *Sweep)
 {
     EFI_STATUS Status = EFI_SUCCESS;
+
+    if (!Sweep->Valid) {
+        goto Error_exit;
+    }
+    Status = OutputString(Sink, L"Size sweep (ns/call)");
+    if (EFI_ERROR(Status)) goto Error_exit;
+    for (UINTN s=0; s<NUM_SWEEP_SIZES; s++) {
+        Status = OutputString(Sink, L" %9u", GetSweepSize(s));
+        if (EFI_ERROR(Status)) goto Error_exit;
+    }
+    Status = OutputString(Sink, L"  Fixed(ns)  ps/pixel    R2\n");
+    if (EFI_ERROR(Status)) goto Error_exit;
+    for (UINTN p=0; p<NUM_SWEEP_PRIMS; p++) {
+        SWEEP_PRIM_RESULTS *Prim = &Sweep->Prim[p];
+        Status = OutputString(Sink, L"%-18s: ", GetSweepDesc(p));
+        if (EFI_ERROR(Status)) goto Error_exit;
+        for (UINTN s=0; s<NUM_SWEEP_SIZES; s++) {
+            if (Prim->Point[s].Run) {
+                UINT64 CallPs = Prim->Point[s].CallPs;
+                Status = OutputString(Sink, L" %7lu.%01lu", CallPs / 1000, (CallPs % 1000) / 100);
+            } else {
+                Status = OutputString(Sink, L"         -");
+            }
+            if (EFI_ERROR(Status)) goto Error_exit;
+        }
+        LINEAR_FIT *Fit = &Prim->Fit;
+        if (Fit->Points < 2) {
+            Status = OutputString(Sink, L"          -         -     -\n");
+            if (EFI_ERROR(Status)) goto Error_exit;
+            continue;
+        }
+        // fixed cost in tenths of ns, per-pixel cost in hundredths of ps
+        INT64 Fixed = Fit->Intercept / 100;
+        INT64 PerPixel = Fit->Slope * 100 / (1 << FIT_FP_SHIFT);
+        UINT64 AbsFixed = Fixed < 0 ? -Fixed : Fixed;
+        UINT64 AbsPerPixel = PerPixel < 0 ? -PerPixel : PerPixel;
+        Status = OutputString(Sink, L" %c%7lu.%01lu %c%5lu.%02lu %1u.%03u\n",
+                              Fixed < 0 ? L'-' : L' ', AbsFixed / 10, AbsFixed % 10,
+                              PerPixel < 0 ? L'-' : L' ', AbsPerPixel / 100, AbsPerPixel % 100,
+                              Fit->R2 / 1000, Fit->R2 % 1000);
+        if (EFI_ERROR(Status)) goto Error_exit;
+    }
+    Status = OutputString(Sink, L"\n");
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputStats() - Output repeated trial statistics for a mode if more than one trial,
+ *                 the coefficient of variation (CV) summarises the mode
+ *
+ * Mean, StdDev, CI and CV leave out the rejected outlier trials.
+ */
+STATIC EFI_STATUS OutputStats(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    BOOLEAN Header = FALSE;
+    UINT64 CvSum = 0;       // CV in hundredths of a percent
+    UINT64 CvMax = 0;
+    UINTN CvMaxTest = 0;
+    UINT32 NumCv = 0;
+
+    for (UINTN i=0; i<NUM_TESTS; i++) {
+        for (UINTN p=0; p<2; p++) {
+            STATS *Stats = p ? &Results->PregenData[i].Stats : &Results->Data[i].Stats;
+            if (Stats->Trials < 2) {
+                continue;
+            }
+            if (!Header) {
+                Status = OutputString(Sink, L"Iterations/s over %u trials\n", Stats->Trials);
+                if (EFI_ERROR(Status)) goto Error_exit;
+                Status = OutputString(Sink, L"Test                          Mean      StdDev         Min      Median  Rejected  95%% CI\n");
+                if (EFI_ERROR(Status)) goto Error_exit;
+                Header = TRUE;
+            }
+            Status = OutputString(Sink, L"%-13s%-7s: %11lu %11lu %11lu %11lu %9u  +/-%lu\n", GetTestDesc(i), p ? L" pregen" : L"",
+                                  Stats->Mean, Stats->StdDev, Stats->Min, Stats->Median, Stats->Rejected, Stats->Ci95);
+            if (EFI_ERROR(Status)) goto Error_exit;
+            if (Stats->Mean) {
+                UINT64 Cv = (Stats->StdDev * 10000 + Stats->Mean/2) / Stats->Mean;
+                CvSum += Cv;
+                NumCv++;
+                if (Cv > CvMax) {
+                    CvMax = Cv;
+                    CvMaxTest = i;
+                }
+            }
+        }
+    }
+    if (NumCv) {
+        UINT64 CvMean = (CvSum + NumCv/2) / NumCv;
+        Status = OutputString(Sink, L"Mode CV: mean %lu.%02lu%%, max %lu.%02lu%% (%s)\n",
+                              CvMean / 100, CvMean % 100, CvMax / 100, CvMax % 100, GetTestDesc(CvMaxTest));
+        if (EFI_ERROR(Status)) goto Error_exit;
+    }
+    if (Header) {
+        Status = OutputString(Sink, L"\n");
+    }
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputBatches() - Output timed batches with a timer tick serviced inside
+ *                   (disturbed) or held off until after (deferred) for a mode
+ */
+STATIC EFI_STATUS OutputBatches(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    BOOLEAN Header = FALSE;
+
+    if (!Results->Ticks) {
+        goto Error_exit;
+    }
+    for (UINTN i=0; i<NUM_TESTS; i++) {
+        for (UINTN p=0; p<2; p++) {
+            TEST_RUN_DATA *Data = p ? &Results->PregenData[i] : &Results->Data[i];
+            if (!Data->Batches) {
+                continue;
+            }
+            if (!Header) {
+                Status = OutputString(Sink, L"Timed batches (%s)\n", Results->Quiet ? L"quiet" : L"application TPL");
+                if (EFI_ERROR(Status)) goto Error_exit;
+                Status = OutputString(Sink, L"Test                      Batches  Disturbed   Deferred\n");
+                if (EFI_ERROR(Status)) goto Error_exit;
+                Header = TRUE;
+            }
+            Status = OutputString(Sink, L"%-13s%-7s: %10u %10u %10u\n", GetTestDesc(i), p ? L" pregen" : L"",
+                                  Data->Batches, Data->Disturbed, Data->Deferred);
+            if (EFI_ERROR(Status)) goto Error_exit;
+        }
+    }
+    if (Header) {
+        Status = OutputString(Sink, L"\n");
+    }
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputPrimStats() - Output primitive counters of the inline trials for a
+ *                     mode if counted, totals over all trials
+ */
+STATIC EFI_STATUS OutputPrimStats(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    BOOLEAN Header = FALSE;
+
+    for (UINTN i=0; i<NUM_TESTS; i++) {
+        for (UINTN p=0; p<NUM_PRIMS; p++) {
+            PRIM_COUNTERS *c = &Results->PrimStats[i].Prim[p];
+            if (!c->Calls) {
+                continue;
+            }
+            if (!Header) {
+                Status = OutputString(Sink, L"Primitive counters\n");
+                if (EFI_ERROR(Status)) goto Error_exit;
+                Status = OutputString(Sink, L"Test            Primitive                Calls       Pixels      Clipped   Rejected Blt calls     Blt bytes\n");
+                if (EFI_ERROR(Status)) goto Error_exit;
+                Header = TRUE;
+            }
+            Status = OutputString(Sink, L"%-13s : %-19s %10lu %12lu %12lu %10lu %9lu %13lu\n", GetTestDesc(i), GetPrimDesc((PRIM_TYPE)p),
+                                  c->Calls, c->Pixels, c->Clipped, c->Rejected, c->BltCalls, c->BltBytes);
+            if (EFI_ERROR(Status)) goto Error_exit;
+        }
+    }
+    if (Header) {
+        Status = OutputString(Sink, L"\n");
+    }
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputLatency() - Output per-call latency table for a mode if recorded
+ */
+STATIC EFI_STATUS OutputLatency(IN OUTPUT_SINK *Sink, IN TEST_RESULTS *Results, IN BOOLEAN Nanosecs)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    BOOLEAN Header = FALSE;
+
+    for (UINTN i=0; i<NUM_TESTS; i++) {
+        for (UINTN p=0; p<2; p++) {
+            TEST_LATENCY *Latency = p ? &Results->PregenData[i].Latency : &Results->Data[i].Latency;
+            if (!Latency->Valid) {
+                continue;
+            }
+            if (!Header) {
+                Status = OutputString(Sink, L"Latency (%s)\n", Nanosecs ? L"ns" : L"cycles");
+                if (EFI_ERROR(Status)) goto Error_exit;
+                Status = OutputString(Sink, L"Test                         Min       p50       p90       p99     p99.9       Max\n");
+                if (EFI_ERROR(Status)) goto Error_exit;
+                Header = TRUE;
+            }
+            UINT64 Value[NUM_PERCENTILES + 2];
+            Value[0] = Latency->Min;
+            for (UINTN n=0; n<NUM_PERCENTILES; n++) {
+                Value[n + 1] = Latency->Pct[n];
+            }
+            Value[NUM_PERCENTILES + 1] = Latency->Max;
+            if (Nanosecs) {
+                for (UINTN n=0; n<ARRAY_SIZE(Value); n++) {
+                    Value[n] = CyclesToNs(Value[n]);
+                }
+            }
+            Status = OutputString(Sink, L"%-13s%-7s: %9lu %9lu %9lu %9lu %9lu %9lu\n", GetTestDesc(i), p ? L" pregen" : L"",
+                                  Value[0], Value[1], Value[2], Value[3], Value[4], Value[5]);
+            if (EFI_ERROR(Status)) goto Error_exit;
+        }
+    }
+    if (Header) {
+        Status = OutputString(Sink, L"\n");
+    }
+
+Error_exit:
+    return Status;
+}
+
+// runs of each test in machine readable results
+#define NUM_RUNS 4
+STATIC CHAR16 *RunDesc[NUM_RUNS] = { L"inline", L"pregen", L"cold", L"shadow" };
+
+/*
+ * IterPerSec() - Iterations per second of a test run, 0 if not timed
+ */
+STATIC UINT64 IterPerSec(IN TEST_RUN_DATA *Data)
+{
+    return Data->TimeNs ? ((UINT64)Data->Count * 1000000000 + Data->TimeNs/2) / Data->TimeNs : 0;
+}
+
+/*
+ * GetPixelFormatDesc()
+ */
+STATIC CHAR16 *GetPixelFormatDesc(IN EFI_GRAPHICS_PIXEL_FORMAT PixelFormat)
+{
+    STATIC CHAR16 *PixelFormatDesc[PixelFormatMax] = { L"rgb", L"bgr", L"bitmask", L"bltonly" };
+
+    return PixelFormat < PixelFormatMax ? PixelFormatDesc[PixelFormat] : L"unknown";
+}
+
+/*
+ * OutputCsv() - Output a row per test run of each mode
+ */
+STATIC EFI_STATUS OutputCsv(IN OUTPUT_SINK *Sink, IN BOOLEAN ClipEnabled, IN TEST_RESULTS *Results, IN UINTN NumResults)
+{
+    EFI_STATUS Status;
+
+    Status = OutputString(Sink, L"mode,hor_res,ver_res,pixel_format,clip,test,run,count,time_ns,pixels,iter_per_s,mpix_per_s,timer_hz\n");
+    if (EFI_ERROR(Status)) goto Error_exit;
+    for (UINTN m = 0; m < NumResults; m++) {
+        TEST_RUN_DATA *Runs[NUM_RUNS] = { Results[m].Data, Results[m].PregenData, Results[m].ColdData, Results[m].ShadowData };
+        for (UINTN i=0; i<NUM_TESTS; i++) {
+            for (UINTN r=0; r<NUM_RUNS; r++) {
+                TEST_RUN_DATA *Data = &Runs[r][i];
+                if (!Data->Run) {
+                    continue;
+                }
+                UINT64 MpixTenths = Data->TimeNs ? (Data->Pixels * 10000 + Data->TimeNs/2) / Data->TimeNs : 0;
+                Status = OutputString(Sink, L"%u,%u,%u,%s,%u,%s,%s,%u,%lu,%lu,%lu,%lu.%01lu,%lu\n",
+                                      (UINT32)Results[m].Mode, Results[m].HorRes, Results[m].VerRes, GetPixelFormatDesc(Results[m].PixelFormat),
+                                      ClipEnabled ? 1 : 0, GetTestDesc(i), RunDesc[r], Data->Count, Data->TimeNs, Data->Pixels,
+                                      IterPerSec(Data), MpixTenths / 10, MpixTenths % 10, GetTimerFreq());
+                if (EFI_ERROR(Status)) goto Error_exit;
+            }
+        }
+    }
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputJson() - Output run details and an entry per test run of each mode
+ *
+ * This is the format read back by -baseline.
+ */
+STATIC EFI_STATUS OutputJson(IN OUTPUT_SINK *Sink, IN EFI_TIME *StartTime, IN EFI_TIME *EndTime, IN BOOLEAN ClipEnabled, IN TEST_RESULTS *Results, IN UINTN NumResults)
+{
+    EFI_STATUS Status;
+
+    Status = OutputString(Sink, L"{\"start\":\"%04u-%02u-%02uT%02u:%02u:%02u\",\"end\":\"%04u-%02u-%02uT%02u:%02u:%02u\",\n",
+                          StartTime->Year, StartTime->Month, StartTime->Day, StartTime->Hour, StartTime->Minute, StartTime->Second,
+                          EndTime->Year, EndTime->Month, EndTime->Day, EndTime->Hour, EndTime->Minute, EndTime->Second);
+    if (EFI_ERROR(Status)) goto Error_exit;
+    Status = OutputString(Sink, L"\"timerHz\":%lu,\"timerSource\":\"%s\",\"clip\":%s,\n\"modes\":[",
+                          GetTimerFreq(), GetTimerSourceDesc(GetTimerSource()), ClipEnabled ? L"true" : L"false");
+    if (EFI_ERROR(Status)) goto Error_exit;
+    for (UINTN m = 0; m < NumResults; m++) {
+        TEST_RUN_DATA *Runs[NUM_RUNS] = { Results[m].Data, Results[m].PregenData, Results[m].ColdData, Results[m].ShadowData };
+        BOOLEAN First = TRUE;
+        Status = OutputString(Sink, L"%s\n{\"mode\":%u,\"horRes\":%u,\"verRes\":%u,\"pixelFormat\":\"%s\",\"fillKernel\":\"%s\",\"batchFillKernel\":\"%s\",\"present\":\"%s\",\"cpus\":%u,\"tests\":[",
+                              m ? L"," : L"", (UINT32)Results[m].Mode, Results[m].HorRes, Results[m].VerRes, GetPixelFormatDesc(Results[m].PixelFormat),
+                              GetFillKernelDesc(Results[m].FillKernel), GetFillKernelDesc(Results[m].BatchFillKernel),
+                              GetPresentDesc(Results[m].Present), Results[m].Cpus);
+        if (EFI_ERROR(Status)) goto Error_exit;
+        for (UINTN i=0; i<NUM_TESTS; i++) {
+            for (UINTN r=0; r<NUM_RUNS; r++) {
+                TEST_RUN_DATA *Data = &Runs[r][i];
+                if (!Data->Run) {
+                    continue;
+                }
+                UINT64 MpixTenths = Data->TimeNs ? (Data->Pixels * 10000 + Data->TimeNs/2) / Data->TimeNs : 0;
+                Status = OutputString(Sink, L"%s\n{\"test\":\"%s\",\"run\":\"%s\",\"count\":%u,\"timeNs\":%lu,\"pixels\":%lu,\"iterPerSec\":%lu,\"mpixPerSec\":%lu.%01lu",
+                                      First ? L"" : L",", GetTestDesc(i), RunDesc[r], Data->Count, Data->TimeNs, Data->Pixels,
+                                      IterPerSec(Data), MpixTenths / 10, MpixTenths % 10);
+                if (EFI_ERROR(Status)) goto Error_exit;
+                if (Data->Latency.Valid) {
+                    Status = OutputString(Sink, L",\"p50Ns\":%lu,\"p99Ns\":%lu",
+                                          CyclesToNs(Data->Latency.Pct[PCT_50]), CyclesToNs(Data->Latency.Pct[PCT_99]));
+                    if (EFI_ERROR(Status)) goto Error_exit;
+                }
+                if (Data->Flush.Flushes) {
+                    Status = OutputString(Sink, L",\"flushNs\":%lu,\"flushes\":%u,\"blts\":%u,\"bltPixels\":%lu",
+                                          Data->Flush.TimeNs, Data->Flush.Flushes, Data->Flush.Blts, Data->Flush.Pixels);
+                    if (EFI_ERROR(Status)) goto Error_exit;
+                }
+                if (Data->CircleCache.Hits || Data->CircleCache.Misses) {
+                    Status = OutputString(Sink, L",\"cacheHits\":%lu,\"cacheMisses\":%lu,\"cacheEvictions\":%lu",
+                                          Data->CircleCache.Hits, Data->CircleCache.Misses, Data->CircleCache.Evictions);
+                    if (EFI_ERROR(Status)) goto Error_exit;
+                }
+                if (Data->GlyphCache.Hits || Data->GlyphCache.Misses) {
+                    Status = OutputString(Sink, L",\"glyphHits\":%lu,\"glyphMisses\":%lu,\"glyphEvictions\":%lu,\"glyphExpansions\":%lu,\"glyphPeakBytes\":%lu",
+                                          Data->GlyphCache.Hits, Data->GlyphCache.Misses, Data->GlyphCache.Evictions,
+                                          Data->GlyphCache.Expansions, Data->GlyphCache.PeakBytes);
+                    if (EFI_ERROR(Status)) goto Error_exit;
+                }
+                if (Data->StringCache.Hits || Data->StringCache.Misses) {
+                    Status = OutputString(Sink, L",\"stringHits\":%lu,\"stringMisses\":%lu,\"stringEvictions\":%lu,\"stringUncached\":%lu,\"stringPeakBytes\":%lu",
+                                          Data->StringCache.Hits, Data->StringCache.Misses, Data->StringCache.Evictions,
+                                          Data->StringCache.Uncached, Data->StringCache.PeakBytes);
+                    if (EFI_ERROR(Status)) goto Error_exit;
+                }
+                Status = OutputString(Sink, L"}");
+                if (EFI_ERROR(Status)) goto Error_exit;
+                First = FALSE;
+            }
+        }
+        Status = OutputString(Sink, L"\n]}");
+        if (EFI_ERROR(Status)) goto Error_exit;
+    }
+    Status = OutputString(Sink, L"\n]}\n");
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * OutputBaseline() - Output change in iterations/s of test runs found in the
+ *                    baseline, FALSE if any dropped beyond Threshold percent
+ *                    or none were found
+ */
+STATIC BOOLEAN OutputBaseline(IN BASELINE *Baseline, IN TEST_RESULTS *Results, IN UINTN NumResults, IN UINT32 Threshold)
+{
+    UINT32 Compared = 0;
+    UINT32 Regressed = 0;
+
+    if (Threshold > 100) {
+        Threshold = 100;
+    }
+    OutputString(NULL, L"Baseline comparison (iterations/s, regression beyond -%u%%)\n", Threshold);
+    OutputString(NULL, L"Test          Run     Resolution      Baseline      Current  Change\n");
+    for (UINTN m = 0; m < NumResults; m++) {
+        TEST_RUN_DATA *Runs[NUM_RUNS] = { Results[m].Data, Results[m].PregenData, Results[m].ColdData, Results[m].ShadowData };
+        for (UINTN i=0; i<NUM_TESTS; i++) {
+            for (UINTN r=0; r<NUM_RUNS; r++) {
+                TEST_RUN_DATA *Data = &Runs[r][i];
+                if (!Data->Run) {
+                    continue;
+                }
+                BASELINE_ENTRY *Entry = FindBaseline(Baseline, Results[m].HorRes, Results[m].VerRes, GetTestDesc(i), RunDesc[r]);
+                if (!Entry || !Entry->IterPerSec) {
+                    continue;
+                }
+                UINT64 Current = IterPerSec(Data);
+                BOOLEAN Slower = Current < Entry->IterPerSec;
+                UINT64 Diff = Slower ? Entry->IterPerSec - Current : Current - Entry->IterPerSec;
+                UINT64 Change = (Diff * 10000 + Entry->IterPerSec/2) / Entry->IterPerSec;  // hundredths of a percent
+                BOOLEAN Regression = Current * 100 < Entry->IterPerSec * (100 - Threshold);
+                OutputString(NULL, L"%-13s %-7s %5ux%-5u %12lu %12lu  %s%lu.%02lu%%%s\n", GetTestDesc(i), RunDesc[r],
+                             Results[m].HorRes, Results[m].VerRes, Entry->IterPerSec, Current,
+                             Slower ? L"-" : L"+", Change / 100, Change % 100, Regression ? L"  REGRESSION" : L"");
+                Compared++;
+                if (Regression) {
+                    Regressed++;
+                }
+            }
+        }
+    }
+    if (!Compared) {
+        OutputString(NULL, L"FAIL: no test runs found in baseline\n");
+    } else if (Regressed) {
+        OutputString(NULL, L"FAIL: %u of %u test runs regressed\n", Regressed, Compared);
+    } else {
+        OutputString(NULL, L"PASS: %u test runs compared\n", Compared);
+    }
+    return Compared && !Regressed;
+}
+
+/*
+ * OutputString() - Ouput string to file sink, or console if Sink is NULL
+ */
+STATIC EFI_STATUS EFIAPI OutputString(IN OUTPUT_SINK *Sink, IN CONST CHAR16 *FormatString, ...)
+{
+    EFI_STATUS Status;
     VA_LIST  Marker;
-    CHAR8 buffer[BUFFLEN];
  
     VA_START (Marker, FormatString);
-    UINTN buffSize = AsciiVSPrintUnicodeFormat (buffer, BUFFLEN, FormatString, Marker);
+    Status = SinkVPrint(Sink, FormatString, Marker);
     VA_END (Marker);
-    if (FileHandle) {
-        Status = ShellWriteFile (FileHandle, &buffSize, (VOID *)buffer);
-        if (EFI_ERROR(Status)) {
-            Print(L"ERROR: Failed to write to file '%s' (%r)\n", Filename, Status);
-        }
-    } else {
-        AsciiPrint(buffer);
+    if (EFI_ERROR(Status)) {
+        Print(L"ERROR: Failed to write to file '%s' (%r)\n", Filename, Status);
     }
     return Status;
 }
@@ -0,0 +1,86 @@
+/*
+ * File:    Histogram.c
+ * 
+ * Author:  David Petrovic
+ * 
+ * Description:
+ * 
+ * Fixed memory log-linear histogram for latency values
+ */
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include "Histogram.h"
+
+/*
+ * ValueToBucket()
+ */
+STATIC UINTN ValueToBucket(UINT64 Value)
+{
+    if (Value < HIST_SUB_COUNT) {
+        return (UINTN)Value;
+    }
+    UINTN Shift = (UINTN)HighBitSet64(Value) - (HIST_SUB_BITS - 1);
+    UINTN Sub = (UINTN)RShiftU64(Value, Shift);    // HIST_HALF_COUNT ... HIST_SUB_COUNT-1
+    return HIST_SUB_COUNT + (Shift - 1) * HIST_HALF_COUNT + (Sub - HIST_HALF_COUNT);
+}
+
+/*
+ * BucketToValue() - Midpoint of values covered by bucket
+ */
+STATIC UINT64 BucketToValue(UINTN Bucket)
+{
+    if (Bucket < HIST_SUB_COUNT) {
+        return Bucket;
+    }
+    UINTN Shift = (Bucket - HIST_SUB_COUNT) / HIST_HALF_COUNT + 1;
+    UINT64 Sub = HIST_HALF_COUNT + (Bucket - HIST_SUB_COUNT) % HIST_HALF_COUNT;
+    return LShiftU64(Sub, Shift) + LShiftU64(1, Shift - 1);
+}
+
+/*
+ * ResetHistogram()
+ */
+VOID ResetHistogram(HISTOGRAM *Hist)
+{
+    ZeroMem(Hist, sizeof(HISTOGRAM));
+    Hist->Min = MAX_UINT64;
+}
+
+/*
+ * RecordHistogram()
+ */
+VOID RecordHistogram(HISTOGRAM *Hist, UINT64 Value)
+{
+    Hist->Bucket[ValueToBucket(Value)]++;
+    Hist->Total++;
+    if (Value < Hist->Min) Hist->Min = Value;
+    if (Value > Hist->Max) Hist->Max = Value;
+}
+
+/*
+ * HistogramPercentile() - Value at percentile given in tenths of a percent,
+ *                         clamped to the exact min/max
+ */
+UINT64 HistogramPercentile(HISTOGRAM *Hist, UINT32 PerMille)
+{
+    if (!Hist->Total) {
+        return 0;
+    }
+    UINT64 Rank = (Hist->Total * PerMille + 999) / 1000;
+    if (Rank == 0) {
+        Rank = 1;
+    }
+    UINT64 Cumulative = 0;
+    for (UINTN i = 0; i < HIST_NUM_BUCKETS; i++) {
+        Cumulative += Hist->Bucket[i];
+        if (Cumulative >= Rank) {
+            UINT64 Value = BucketToValue(i);
+            if (Value < Hist->Min) Value = Hist->Min;
+            if (Value > Hist->Max) Value = Hist->Max;
+            return Value;
+        }
+    }
+    return Hist->Max;
+}
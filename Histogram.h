@@ -0,0 +1,34 @@
+/*
+ * File:    Histogram.h
+ * 
+ * Author:  David Petrovic
+ *
+ * Description:
+ * 
+ * Fixed memory log-linear histogram for latency values
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <Uefi.h>
+
+// values below HIST_SUB_COUNT have their own bucket, above that each power of
+// two range is split into HIST_HALF_COUNT buckets giving ~3% resolution
+#define HIST_SUB_BITS       6
+#define HIST_SUB_COUNT      (1 << HIST_SUB_BITS)
+#define HIST_HALF_COUNT     (HIST_SUB_COUNT / 2)
+#define HIST_NUM_BUCKETS    (HIST_SUB_COUNT + (64 - HIST_SUB_BITS) * HIST_HALF_COUNT)
+
+typedef struct {
+    UINT32 Bucket[HIST_NUM_BUCKETS];
+    UINT64 Total;   // number of values recorded
+    UINT64 Min;     // exact minimum
+    UINT64 Max;     // exact maximum
+} HISTOGRAM;
+
+VOID ResetHistogram(HISTOGRAM *Hist);
+VOID RecordHistogram(HISTOGRAM *Hist, UINT64 Value);
+UINT64 HistogramPercentile(HISTOGRAM *Hist, UINT32 PerMille);
+
+#endif // HISTOGRAM_H
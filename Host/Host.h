@@ -0,0 +1,36 @@
+/*
+ * File:    Host.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - Shared definitions between the host firmware shims
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <Uefi.h>
+#include <Protocol/GraphicsOutput.h>
+#include <Protocol/MpService.h>
+
+#define HOST_ENV_MODES      "GRAPHICSTEST_MODES"
+#define HOST_ENV_FORMAT     "GRAPHICSTEST_FORMAT"
+#define HOST_ENV_PAD        "GRAPHICSTEST_PAD"
+#define HOST_ENV_CPUS       "GRAPHICSTEST_CPUS"
+
+/*
+ * HostGop.c
+ */
+EFI_STATUS CreateHostGop(VOID);
+VOID DestroyHostGop(VOID);
+EFI_GRAPHICS_OUTPUT_PROTOCOL *GetHostGop(VOID);
+
+/*
+ * HostMp.c
+ */
+EFI_MP_SERVICES_PROTOCOL *GetHostMp(VOID);
+VOID DestroyHostMp(VOID);
+
+#endif // HOST_H
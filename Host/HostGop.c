@@ -0,0 +1,313 @@
+/*
+ * File:    HostGop.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - Graphics Output Protocol over a memory framebuffer
+ *
+ * The mode list and pixel format are taken from the environment so any
+ * resolution and layout can be tested without the hardware:
+ *
+ *  GRAPHICSTEST_MODES   Comma separated WxH list, default 1024x768,1920x1080
+ *  GRAPHICSTEST_FORMAT  bgr, rgb, bitmask or bltonly, default bgr
+ *  GRAPHICSTEST_PAD     Extra pixels per scanline, default 0
+ *
+ * The framebuffer is cache line aligned system memory so it measures the
+ * host memory system rather than a write combined aperture.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include "Host.h"
+
+#define HOST_GOP_MAX_MODES      16
+#define HOST_GOP_DEFAULT_MODES  "1024x768,1920x1080"
+#define HOST_GOP_ALIGN          64
+
+// 10 bit channels so the bitmask path can't assume byte sized components
+#define HOST_BITMASK_RED        0x3FF00000
+#define HOST_BITMASK_GREEN      0x000FFC00
+#define HOST_BITMASK_BLUE       0x000003FF
+#define HOST_BITMASK_RESERVED   0xC0000000
+
+typedef struct {
+    UINT32 Shift;
+    UINT32 Max;
+} CHANNEL;
+
+typedef struct {
+    EFI_GRAPHICS_OUTPUT_PROTOCOL Gop;
+    EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE Mode;
+    EFI_GRAPHICS_OUTPUT_MODE_INFORMATION Info[HOST_GOP_MAX_MODES];
+    UINT32 *FrameBuffer;        // also backs BltOnly modes, which don't expose it
+    CHANNEL Red;
+    CHANNEL Green;
+    CHANNEL Blue;
+} HOST_GOP;
+
+STATIC HOST_GOP HostGop;
+
+/*
+ * MaskToChannel() - Get the position and range of a pixel component
+ */
+STATIC VOID MaskToChannel(IN UINT32 Mask, OUT CHANNEL *Channel)
+{
+    Channel->Shift = (UINT32)LowBitSet32(Mask);
+    Channel->Max = Mask >> Channel->Shift;
+}
+
+/*
+ * BltToNative() - Convert a Blt pixel to the framebuffer format
+ */
+STATIC UINT32 BltToNative(IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Pixel)
+{
+    return (((UINT32)Pixel->Red * HostGop.Red.Max + 127) / 255) << HostGop.Red.Shift |
+           (((UINT32)Pixel->Green * HostGop.Green.Max + 127) / 255) << HostGop.Green.Shift |
+           (((UINT32)Pixel->Blue * HostGop.Blue.Max + 127) / 255) << HostGop.Blue.Shift;
+}
+
+/*
+ * NativeToBlt() - Convert a framebuffer pixel to Blt format
+ */
+STATIC VOID NativeToBlt(IN UINT32 Native, OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Pixel)
+{
+    Pixel->Red = (UINT8)((((Native >> HostGop.Red.Shift) & HostGop.Red.Max) * 255 + HostGop.Red.Max / 2) / HostGop.Red.Max);
+    Pixel->Green = (UINT8)((((Native >> HostGop.Green.Shift) & HostGop.Green.Max) * 255 + HostGop.Green.Max / 2) / HostGop.Green.Max);
+    Pixel->Blue = (UINT8)((((Native >> HostGop.Blue.Shift) & HostGop.Blue.Max) * 255 + HostGop.Blue.Max / 2) / HostGop.Blue.Max);
+    Pixel->Reserved = 0;
+}
+
+/*
+ * HostQueryMode() - EFI_GRAPHICS_OUTPUT_PROTOCOL.QueryMode
+ */
+STATIC EFI_STATUS EFIAPI HostQueryMode(IN EFI_GRAPHICS_OUTPUT_PROTOCOL *This, IN UINT32 ModeNumber, OUT UINTN *SizeOfInfo, OUT EFI_GRAPHICS_OUTPUT_MODE_INFORMATION **Info)
+{
+    if (!SizeOfInfo || !Info || ModeNumber >= HostGop.Mode.MaxMode) {
+        return EFI_INVALID_PARAMETER;
+    }
+    *Info = AllocateCopyPool(sizeof(EFI_GRAPHICS_OUTPUT_MODE_INFORMATION), &HostGop.Info[ModeNumber]);
+    if (!*Info) {
+        return EFI_OUT_OF_RESOURCES;
+    }
+    *SizeOfInfo = sizeof(EFI_GRAPHICS_OUTPUT_MODE_INFORMATION);
+    return EFI_SUCCESS;
+}
+
+/*
+ * HostSetMode() - EFI_GRAPHICS_OUTPUT_PROTOCOL.SetMode
+ */
+STATIC EFI_STATUS EFIAPI HostSetMode(IN EFI_GRAPHICS_OUTPUT_PROTOCOL *This, IN UINT32 ModeNumber)
+{
+    EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *Info;
+    UINTN Size;
+    VOID *FrameBuffer;
+
+    if (ModeNumber >= HostGop.Mode.MaxMode) {
+        return EFI_UNSUPPORTED;
+    }
+    Info = &HostGop.Info[ModeNumber];
+    Size = (UINTN)Info->PixelsPerScanLine * Info->VerticalResolution * sizeof(UINT32);
+    if (posix_memalign(&FrameBuffer, HOST_GOP_ALIGN, Size)) {
+        return EFI_OUT_OF_RESOURCES;
+    }
+    ZeroMem(FrameBuffer, Size);
+    free(HostGop.FrameBuffer);
+    HostGop.FrameBuffer = FrameBuffer;
+
+    HostGop.Mode.Mode = ModeNumber;
+    HostGop.Mode.Info = Info;
+    if (Info->PixelFormat == PixelBltOnly) {
+        HostGop.Mode.FrameBufferBase = 0;
+        HostGop.Mode.FrameBufferSize = 0;
+    } else {
+        HostGop.Mode.FrameBufferBase = (EFI_PHYSICAL_ADDRESS)(UINTN)FrameBuffer;
+        HostGop.Mode.FrameBufferSize = Size;
+    }
+    return EFI_SUCCESS;
+}
+
+/*
+ * HostBlt() - EFI_GRAPHICS_OUTPUT_PROTOCOL.Blt
+ */
+STATIC EFI_STATUS EFIAPI HostBlt(IN EFI_GRAPHICS_OUTPUT_PROTOCOL *This, IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL *BltBuffer OPTIONAL, IN EFI_GRAPHICS_OUTPUT_BLT_OPERATION BltOperation,
+                                 IN UINTN SourceX, IN UINTN SourceY, IN UINTN DestinationX, IN UINTN DestinationY, IN UINTN Width, IN UINTN Height, IN UINTN Delta OPTIONAL)
+{
+    EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *Info = HostGop.Mode.Info;
+    UINT32 *Fb = HostGop.FrameBuffer;
+    UINTN Stride = Info->PixelsPerScanLine;
+    UINTN x, y;
+
+    if (!Width || !Height || BltOperation >= EfiGraphicsOutputBltOperationMax) {
+        return EFI_INVALID_PARAMETER;
+    }
+    if (!Delta) {
+        Delta = Width * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+    }
+    // Validate the framebuffer side of the transfer
+    if (BltOperation == EfiBltVideoToBltBuffer || BltOperation == EfiBltVideoToVideo) {
+        if (SourceX + Width > Info->HorizontalResolution || SourceY + Height > Info->VerticalResolution) {
+            return EFI_INVALID_PARAMETER;
+        }
+    }
+    if (BltOperation != EfiBltVideoToBltBuffer) {
+        if (DestinationX + Width > Info->HorizontalResolution || DestinationY + Height > Info->VerticalResolution) {
+            return EFI_INVALID_PARAMETER;
+        }
+    }
+    if (BltOperation != EfiBltVideoToVideo && !BltBuffer) {
+        return EFI_INVALID_PARAMETER;
+    }
+
+    switch (BltOperation) {
+    case EfiBltVideoFill: {
+        UINT32 Native = BltToNative(BltBuffer);
+        for (y = 0; y < Height; y++) {
+            SetMem32(&Fb[(DestinationY + y) * Stride + DestinationX], Width * sizeof(UINT32), Native);
+        }
+        break;
+    }
+    case EfiBltVideoToBltBuffer:
+        for (y = 0; y < Height; y++) {
+            EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Row = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)((UINT8 *)BltBuffer + (DestinationY + y) * Delta);
+            for (x = 0; x < Width; x++) {
+                NativeToBlt(Fb[(SourceY + y) * Stride + SourceX + x], &Row[DestinationX + x]);
+            }
+        }
+        break;
+    case EfiBltBufferToVideo:
+        for (y = 0; y < Height; y++) {
+            EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Row = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)((UINT8 *)BltBuffer + (SourceY + y) * Delta);
+            for (x = 0; x < Width; x++) {
+                Fb[(DestinationY + y) * Stride + DestinationX + x] = BltToNative(&Row[SourceX + x]);
+            }
+        }
+        break;
+    case EfiBltVideoToVideo:
+        // Overlapping copies must run in the direction away from the overlap
+        if (DestinationY > SourceY) {
+            for (y = Height; y-- > 0; ) {
+                CopyMem(&Fb[(DestinationY + y) * Stride + DestinationX], &Fb[(SourceY + y) * Stride + SourceX], Width * sizeof(UINT32));
+            }
+        } else {
+            for (y = 0; y < Height; y++) {
+                CopyMem(&Fb[(DestinationY + y) * Stride + DestinationX], &Fb[(SourceY + y) * Stride + SourceX], Width * sizeof(UINT32));
+            }
+        }
+        break;
+    default:
+        return EFI_INVALID_PARAMETER;
+    }
+    return EFI_SUCCESS;
+}
+
+/*
+ * ParseFormat() - Get the pixel format and component masks from the environment
+ */
+STATIC EFI_STATUS ParseFormat(OUT EFI_GRAPHICS_PIXEL_FORMAT *Format, OUT EFI_PIXEL_BITMASK *Mask)
+{
+    CONST CHAR8 *Env = getenv(HOST_ENV_FORMAT);
+
+    ZeroMem(Mask, sizeof(*Mask));
+    if (!Env || !strcmp(Env, "bgr")) {
+        *Format = PixelBlueGreenRedReserved8BitPerColor;
+        *Mask = (EFI_PIXEL_BITMASK){ 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000 };
+    } else if (!strcmp(Env, "rgb")) {
+        *Format = PixelRedGreenBlueReserved8BitPerColor;
+        *Mask = (EFI_PIXEL_BITMASK){ 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000 };
+    } else if (!strcmp(Env, "bitmask")) {
+        *Format = PixelBitMask;
+        *Mask = (EFI_PIXEL_BITMASK){ HOST_BITMASK_RED, HOST_BITMASK_GREEN, HOST_BITMASK_BLUE, HOST_BITMASK_RESERVED };
+    } else if (!strcmp(Env, "bltonly")) {
+        // Blt still converts through a BGR store behind the protocol
+        *Format = PixelBltOnly;
+        *Mask = (EFI_PIXEL_BITMASK){ 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000 };
+    } else {
+        return EFI_INVALID_PARAMETER;
+    }
+    return EFI_SUCCESS;
+}
+
+/*
+ * CreateHostGop() - Build the mode list and set the first mode
+ */
+EFI_STATUS CreateHostGop(VOID)
+{
+    EFI_STATUS Status;
+    EFI_GRAPHICS_PIXEL_FORMAT Format;
+    EFI_PIXEL_BITMASK Mask;
+    CONST CHAR8 *Modes;
+    CONST CHAR8 *Pad;
+    CHAR8 *End;
+    UINT32 NumModes = 0;
+
+    Status = ParseFormat(&Format, &Mask);
+    if (EFI_ERROR(Status)) {
+        goto Error_exit;
+    }
+    Modes = getenv(HOST_ENV_MODES);
+    if (!Modes || !*Modes) {
+        Modes = HOST_GOP_DEFAULT_MODES;
+    }
+    Pad = getenv(HOST_ENV_PAD);
+
+    while (*Modes && NumModes < HOST_GOP_MAX_MODES) {
+        EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *Info = &HostGop.Info[NumModes];
+        UINT32 Width = (UINT32)strtoul(Modes, &End, 10);
+        UINT32 Height = 0;
+        if (*End == 'x' || *End == 'X') {
+            Height = (UINT32)strtoul(End + 1, &End, 10);
+        }
+        if (!Width || !Height || (*End && *End != ',')) {
+            Status = EFI_INVALID_PARAMETER;
+            goto Error_exit;
+        }
+        Info->Version = 0;
+        Info->HorizontalResolution = Width;
+        Info->VerticalResolution = Height;
+        Info->PixelFormat = Format;
+        Info->PixelInformation = Mask;
+        Info->PixelsPerScanLine = Width + (Pad ? (UINT32)strtoul(Pad, NULL, 10) : 0);
+        NumModes++;
+        Modes = *End ? End + 1 : End;
+    }
+
+    MaskToChannel(Mask.RedMask, &HostGop.Red);
+    MaskToChannel(Mask.GreenMask, &HostGop.Green);
+    MaskToChannel(Mask.BlueMask, &HostGop.Blue);
+
+    HostGop.Gop.QueryMode = HostQueryMode;
+    HostGop.Gop.SetMode = HostSetMode;
+    HostGop.Gop.Blt = HostBlt;
+    HostGop.Gop.Mode = &HostGop.Mode;
+    HostGop.Mode.MaxMode = NumModes;
+    HostGop.Mode.SizeOfInfo = sizeof(EFI_GRAPHICS_OUTPUT_MODE_INFORMATION);
+
+    Status = HostSetMode(&HostGop.Gop, 0);
+
+Error_exit:
+    return Status;
+}
+
+/*
+ * DestroyHostGop()
+ */
+VOID DestroyHostGop(VOID)
+{
+    free(HostGop.FrameBuffer);
+    HostGop.FrameBuffer = NULL;
+    HostGop.Mode.FrameBufferBase = 0;
+}
+
+/*
+ * GetHostGop()
+ */
+EFI_GRAPHICS_OUTPUT_PROTOCOL *GetHostGop(VOID)
+{
+    return HostGop.FrameBuffer ? &HostGop.Gop : NULL;
+}
@@ -0,0 +1,851 @@
+/*
+ * File:    HostLib.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - EDK2 base library functions on the C library
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cpuid.h>
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PrintLib.h>
+#include <Library/DebugLib.h>
+#include <Library/SynchronizationLib.h>
+
+#define PRINT_MAX_DIGITS    24
+
+/*
+ * Memory
+ */
+VOID * EFIAPI CopyMem(OUT VOID *DestinationBuffer, IN CONST VOID *SourceBuffer, IN UINTN Length)
+{
+    return memmove(DestinationBuffer, SourceBuffer, Length);
+}
+
+VOID * EFIAPI SetMem(OUT VOID *Buffer, IN UINTN Length, IN UINT8 Value)
+{
+    return memset(Buffer, Value, Length);
+}
+
+VOID * EFIAPI SetMem16(OUT VOID *Buffer, IN UINTN Length, IN UINT16 Value)
+{
+    UINT16 *p = (UINT16 *)Buffer;
+    for (UINTN i = 0; i < Length / sizeof(UINT16); i++) p[i] = Value;
+    return Buffer;
+}
+
+VOID * EFIAPI SetMem32(OUT VOID *Buffer, IN UINTN Length, IN UINT32 Value)
+{
+    UINT32 *p = (UINT32 *)Buffer;
+    for (UINTN i = 0; i < Length / sizeof(UINT32); i++) p[i] = Value;
+    return Buffer;
+}
+
+VOID * EFIAPI SetMem64(OUT VOID *Buffer, IN UINTN Length, IN UINT64 Value)
+{
+    UINT64 *p = (UINT64 *)Buffer;
+    for (UINTN i = 0; i < Length / sizeof(UINT64); i++) p[i] = Value;
+    return Buffer;
+}
+
+VOID * EFIAPI ZeroMem(OUT VOID *Buffer, IN UINTN Length)
+{
+    return memset(Buffer, 0, Length);
+}
+
+INTN EFIAPI CompareMem(IN CONST VOID *DestinationBuffer, IN CONST VOID *SourceBuffer, IN UINTN Length)
+{
+    CONST UINT8 *d = (CONST UINT8 *)DestinationBuffer;
+    CONST UINT8 *s = (CONST UINT8 *)SourceBuffer;
+    for (UINTN i = 0; i < Length; i++) {
+        if (d[i] != s[i]) {
+            return (INTN)d[i] - (INTN)s[i];
+        }
+    }
+    return 0;
+}
+
+VOID * EFIAPI ScanMem8(IN CONST VOID *Buffer, IN UINTN Length, IN UINT8 Value)
+{
+    return memchr(Buffer, Value, Length);
+}
+
+EFI_GUID * EFIAPI CopyGuid(OUT EFI_GUID *DestinationGuid, IN CONST EFI_GUID *SourceGuid)
+{
+    return memcpy(DestinationGuid, SourceGuid, sizeof(EFI_GUID));
+}
+
+BOOLEAN EFIAPI CompareGuid(IN CONST EFI_GUID *Guid1, IN CONST EFI_GUID *Guid2)
+{
+    return memcmp(Guid1, Guid2, sizeof(EFI_GUID)) == 0;
+}
+
+/*
+ * Memory allocation - Pages are page aligned, alignment is a power of 2
+ */
+VOID * EFIAPI AllocatePool(IN UINTN AllocationSize)
+{
+    return malloc(AllocationSize ? AllocationSize : 1);
+}
+
+VOID * EFIAPI AllocateZeroPool(IN UINTN AllocationSize)
+{
+    return calloc(1, AllocationSize ? AllocationSize : 1);
+}
+
+VOID * EFIAPI AllocateCopyPool(IN UINTN AllocationSize, IN CONST VOID *Buffer)
+{
+    VOID *p = AllocatePool(AllocationSize);
+    if (p) {
+        memcpy(p, Buffer, AllocationSize);
+    }
+    return p;
+}
+
+VOID * EFIAPI ReallocatePool(IN UINTN OldSize, IN UINTN NewSize, IN VOID *OldBuffer OPTIONAL)
+{
+    VOID *p = AllocateZeroPool(NewSize);
+    if (p && OldBuffer) {
+        memcpy(p, OldBuffer, MIN(OldSize, NewSize));
+        free(OldBuffer);
+    }
+    return p;
+}
+
+VOID EFIAPI FreePool(IN VOID *Buffer)
+{
+    free(Buffer);
+}
+
+VOID * EFIAPI AllocateAlignedPages(IN UINTN Pages, IN UINTN Alignment)
+{
+    VOID *p = NULL;
+    if (Alignment < EFI_PAGE_SIZE) {
+        Alignment = EFI_PAGE_SIZE;
+    }
+    if (!Pages || posix_memalign(&p, Alignment, EFI_PAGES_TO_SIZE(Pages))) {
+        return NULL;
+    }
+    return p;
+}
+
+VOID * EFIAPI AllocatePages(IN UINTN Pages)
+{
+    return AllocateAlignedPages(Pages, EFI_PAGE_SIZE);
+}
+
+VOID EFIAPI FreePages(IN VOID *Buffer, IN UINTN Pages)
+{
+    free(Buffer);
+}
+
+VOID EFIAPI FreeAlignedPages(IN VOID *Buffer, IN UINTN Pages)
+{
+    free(Buffer);
+}
+
+/*
+ * Strings
+ */
+UINTN EFIAPI StrLen(IN CONST CHAR16 *String)
+{
+    UINTN Len = 0;
+    while (String[Len]) Len++;
+    return Len;
+}
+
+UINTN EFIAPI StrSize(IN CONST CHAR16 *String)
+{
+    return (StrLen(String) + 1) * sizeof(CHAR16);
+}
+
+INTN EFIAPI StrCmp(IN CONST CHAR16 *FirstString, IN CONST CHAR16 *SecondString)
+{
+    while (*FirstString && *FirstString == *SecondString) {
+        FirstString++;
+        SecondString++;
+    }
+    return (INTN)*FirstString - (INTN)*SecondString;
+}
+
+INTN EFIAPI StrnCmp(IN CONST CHAR16 *FirstString, IN CONST CHAR16 *SecondString, IN UINTN Length)
+{
+    if (!Length) {
+        return 0;
+    }
+    while (*FirstString && *FirstString == *SecondString && Length > 1) {
+        FirstString++;
+        SecondString++;
+        Length--;
+    }
+    return (INTN)*FirstString - (INTN)*SecondString;
+}
+
+RETURN_STATUS EFIAPI StrnCpyS(OUT CHAR16 *Destination, IN UINTN DestMax, IN CONST CHAR16 *Source, IN UINTN Length)
+{
+    UINTN i;
+    if (!Destination || !Source || !DestMax) {
+        return EFI_INVALID_PARAMETER;
+    }
+    for (i = 0; i < Length && Source[i]; i++) {
+        if (i + 1 >= DestMax) {
+            Destination[0] = 0;
+            return EFI_BUFFER_TOO_SMALL;
+        }
+        Destination[i] = Source[i];
+    }
+    Destination[i] = 0;
+    return EFI_SUCCESS;
+}
+
+RETURN_STATUS EFIAPI StrCpyS(OUT CHAR16 *Destination, IN UINTN DestMax, IN CONST CHAR16 *Source)
+{
+    return StrnCpyS(Destination, DestMax, Source, MAX_UINTN);
+}
+
+RETURN_STATUS EFIAPI StrCatS(IN OUT CHAR16 *Destination, IN UINTN DestMax, IN CONST CHAR16 *Source)
+{
+    UINTN Len = StrLen(Destination);
+    if (Len >= DestMax) {
+        return EFI_INVALID_PARAMETER;
+    }
+    return StrCpyS(Destination + Len, DestMax - Len, Source);
+}
+
+CHAR16 * EFIAPI StrStr(IN CONST CHAR16 *String, IN CONST CHAR16 *SearchString)
+{
+    UINTN Len = StrLen(SearchString);
+    for (; *String; String++) {
+        if (!StrnCmp(String, SearchString, Len)) {
+            return (CHAR16 *)String;
+        }
+    }
+    return Len ? NULL : (CHAR16 *)String;
+}
+
+CHAR16 EFIAPI CharToUpper(IN CHAR16 Char)
+{
+    return (Char >= L'a' && Char <= L'z') ? (CHAR16)(Char - (L'a' - L'A')) : Char;
+}
+
+/*
+ * StrToValue() - Parse leading whitespace and digits in Base, as the EDK2
+ *                conversions do
+ */
+STATIC UINT64 StrToValue(IN CONST CHAR16 *String, IN UINT32 Base, OUT CHAR16 **EndPointer)
+{
+    UINT64 Value = 0;
+
+    while (*String == L' ' || *String == L'\t') String++;
+    if (Base == 16 && String[0] == L'0' && (String[1] == L'x' || String[1] == L'X')) {
+        String += 2;
+    }
+    while (TRUE) {
+        CHAR16 c = CharToUpper(*String);
+        UINT32 Digit;
+        if (c >= L'0' && c <= L'9') {
+            Digit = c - L'0';
+        } else if (Base == 16 && c >= L'A' && c <= L'F') {
+            Digit = c - L'A' + 10;
+        } else {
+            break;
+        }
+        Value = Value * Base + Digit;
+        String++;
+    }
+    if (EndPointer) {
+        *EndPointer = (CHAR16 *)String;
+    }
+    return Value;
+}
+
+UINTN EFIAPI StrDecimalToUintn(IN CONST CHAR16 *String)
+{
+    return (UINTN)StrToValue(String, 10, NULL);
+}
+
+UINT64 EFIAPI StrDecimalToUint64(IN CONST CHAR16 *String)
+{
+    return StrToValue(String, 10, NULL);
+}
+
+UINTN EFIAPI StrHexToUintn(IN CONST CHAR16 *String)
+{
+    return (UINTN)StrToValue(String, 16, NULL);
+}
+
+UINT64 EFIAPI StrHexToUint64(IN CONST CHAR16 *String)
+{
+    return StrToValue(String, 16, NULL);
+}
+
+RETURN_STATUS EFIAPI StrDecimalToUintnS(IN CONST CHAR16 *String, OUT CHAR16 **EndPointer, OUT UINTN *Data)
+{
+    if (!String || !Data) {
+        return EFI_INVALID_PARAMETER;
+    }
+    *Data = (UINTN)StrToValue(String, 10, EndPointer);
+    return EFI_SUCCESS;
+}
+
+RETURN_STATUS EFIAPI StrHexToUintnS(IN CONST CHAR16 *String, OUT CHAR16 **EndPointer, OUT UINTN *Data)
+{
+    if (!String || !Data) {
+        return EFI_INVALID_PARAMETER;
+    }
+    *Data = (UINTN)StrToValue(String, 16, EndPointer);
+    return EFI_SUCCESS;
+}
+
+UINTN EFIAPI AsciiStrLen(IN CONST CHAR8 *String)
+{
+    return strlen(String);
+}
+
+UINTN EFIAPI AsciiStrSize(IN CONST CHAR8 *String)
+{
+    return strlen(String) + 1;
+}
+
+INTN EFIAPI AsciiStrCmp(IN CONST CHAR8 *FirstString, IN CONST CHAR8 *SecondString)
+{
+    return strcmp(FirstString, SecondString);
+}
+
+INTN EFIAPI AsciiStrnCmp(IN CONST CHAR8 *FirstString, IN CONST CHAR8 *SecondString, IN UINTN Length)
+{
+    return strncmp(FirstString, SecondString, Length);
+}
+
+RETURN_STATUS EFIAPI AsciiStrCpyS(OUT CHAR8 *Destination, IN UINTN DestMax, IN CONST CHAR8 *Source)
+{
+    if (!Destination || !Source || !DestMax) {
+        return EFI_INVALID_PARAMETER;
+    }
+    if (strlen(Source) >= DestMax) {
+        Destination[0] = 0;
+        return EFI_BUFFER_TOO_SMALL;
+    }
+    strcpy(Destination, Source);
+    return EFI_SUCCESS;
+}
+
+UINTN EFIAPI AsciiStrDecimalToUintn(IN CONST CHAR8 *String)
+{
+    return strtoul(String, NULL, 10);
+}
+
+RETURN_STATUS EFIAPI UnicodeStrToAsciiStrS(IN CONST CHAR16 *Source, OUT CHAR8 *Destination, IN UINTN DestMax)
+{
+    UINTN Len = StrLen(Source);
+    if (Len >= DestMax) {
+        return EFI_BUFFER_TOO_SMALL;
+    }
+    for (UINTN i = 0; i <= Len; i++) {
+        Destination[i] = (CHAR8)Source[i];
+    }
+    return EFI_SUCCESS;
+}
+
+RETURN_STATUS EFIAPI AsciiStrToUnicodeStrS(IN CONST CHAR8 *Source, OUT CHAR16 *Destination, IN UINTN DestMax)
+{
+    UINTN Len = strlen(Source);
+    if (Len >= DestMax) {
+        return EFI_BUFFER_TOO_SMALL;
+    }
+    for (UINTN i = 0; i <= Len; i++) {
+        Destination[i] = (UINT8)Source[i];
+    }
+    return EFI_SUCCESS;
+}
+
+/*
+ * Arithmetic
+ */
+UINT64 EFIAPI LShiftU64(IN UINT64 Operand, IN UINTN Count)
+{
+    return Operand << Count;
+}
+
+UINT64 EFIAPI RShiftU64(IN UINT64 Operand, IN UINTN Count)
+{
+    return Operand >> Count;
+}
+
+UINT64 EFIAPI ARShiftU64(IN UINT64 Operand, IN UINTN Count)
+{
+    return (UINT64)((INT64)Operand >> Count);
+}
+
+UINT64 EFIAPI MultU64x32(IN UINT64 Multiplicand, IN UINT32 Multiplier)
+{
+    return Multiplicand * Multiplier;
+}
+
+UINT64 EFIAPI MultU64x64(IN UINT64 Multiplicand, IN UINT64 Multiplier)
+{
+    return Multiplicand * Multiplier;
+}
+
+INT64 EFIAPI MultS64x64(IN INT64 Multiplicand, IN INT64 Multiplier)
+{
+    return Multiplicand * Multiplier;
+}
+
+UINT64 EFIAPI DivU64x32(IN UINT64 Dividend, IN UINT32 Divisor)
+{
+    return Dividend / Divisor;
+}
+
+UINT32 EFIAPI ModU64x32(IN UINT64 Dividend, IN UINT32 Divisor)
+{
+    return (UINT32)(Dividend % Divisor);
+}
+
+UINT64 EFIAPI DivU64x32Remainder(IN UINT64 Dividend, IN UINT32 Divisor, OUT UINT32 *Remainder)
+{
+    if (Remainder) {
+        *Remainder = (UINT32)(Dividend % Divisor);
+    }
+    return Dividend / Divisor;
+}
+
+UINT64 EFIAPI DivU64x64Remainder(IN UINT64 Dividend, IN UINT64 Divisor, OUT UINT64 *Remainder)
+{
+    if (Remainder) {
+        *Remainder = Dividend % Divisor;
+    }
+    return Dividend / Divisor;
+}
+
+INT64 EFIAPI DivS64x64Remainder(IN INT64 Dividend, IN INT64 Divisor, OUT INT64 *Remainder)
+{
+    if (Remainder) {
+        *Remainder = Dividend % Divisor;
+    }
+    return Dividend / Divisor;
+}
+
+INTN EFIAPI HighBitSet32(IN UINT32 Operand)
+{
+    return Operand ? 31 - __builtin_clz(Operand) : -1;
+}
+
+INTN EFIAPI HighBitSet64(IN UINT64 Operand)
+{
+    return Operand ? 63 - __builtin_clzll(Operand) : -1;
+}
+
+INTN EFIAPI LowBitSet32(IN UINT32 Operand)
+{
+    return Operand ? __builtin_ctz(Operand) : -1;
+}
+
+INTN EFIAPI LowBitSet64(IN UINT64 Operand)
+{
+    return Operand ? __builtin_ctzll(Operand) : -1;
+}
+
+UINT32 EFIAPI GetPowerOfTwo32(IN UINT32 Operand)
+{
+    return Operand ? 1U << HighBitSet32(Operand) : 0;
+}
+
+UINT64 EFIAPI GetPowerOfTwo64(IN UINT64 Operand)
+{
+    return Operand ? 1ULL << HighBitSet64(Operand) : 0;
+}
+
+UINT16 EFIAPI SwapBytes16(IN UINT16 Value)
+{
+    return __builtin_bswap16(Value);
+}
+
+UINT32 EFIAPI SwapBytes32(IN UINT32 Value)
+{
+    return __builtin_bswap32(Value);
+}
+
+UINT64 EFIAPI SwapBytes64(IN UINT64 Value)
+{
+    return __builtin_bswap64(Value);
+}
+
+/*
+ * Processor - CPUID and TSC are available to user mode, interrupt state is
+ *             owned by the host kernel so is only tracked
+ */
+UINT32 EFIAPI AsmCpuidEx(IN UINT32 Index, IN UINT32 SubIndex, OUT UINT32 *Eax, OUT UINT32 *Ebx, OUT UINT32 *Ecx, OUT UINT32 *Edx)
+{
+    UINT32 a, b, c, d;
+    __cpuid_count(Index, SubIndex, a, b, c, d);
+    if (Eax) *Eax = a;
+    if (Ebx) *Ebx = b;
+    if (Ecx) *Ecx = c;
+    if (Edx) *Edx = d;
+    return Index;
+}
+
+UINT32 EFIAPI AsmCpuid(IN UINT32 Index, OUT UINT32 *Eax, OUT UINT32 *Ebx, OUT UINT32 *Ecx, OUT UINT32 *Edx)
+{
+    return AsmCpuidEx(Index, 0, Eax, Ebx, Ecx, Edx);
+}
+
+UINT64 EFIAPI AsmReadTsc(VOID)
+{
+    return __builtin_ia32_rdtsc();
+}
+
+UINT64 EFIAPI AsmXGetBv(IN UINT32 Index)
+{
+    UINT32 Eax, Edx;
+    asm volatile ("xgetbv" : "=a" (Eax), "=d" (Edx) : "c" (Index));
+    return ((UINT64)Edx << 32) | Eax;
+}
+
+VOID EFIAPI CpuPause(VOID)
+{
+    __builtin_ia32_pause();
+}
+
+VOID EFIAPI MemoryFence(VOID)
+{
+    __sync_synchronize();
+}
+
+VOID EFIAPI CpuBreakpoint(VOID)
+{
+    __builtin_trap();
+}
+
+STATIC BOOLEAN InterruptState = TRUE;
+
+BOOLEAN EFIAPI SaveAndDisableInterrupts(VOID)
+{
+    return SetInterruptState(FALSE);
+}
+
+BOOLEAN EFIAPI SetInterruptState(IN BOOLEAN State)
+{
+    BOOLEAN Old = InterruptState;
+    InterruptState = State;
+    return Old;
+}
+
+/*
+ * Synchronization
+ */
+UINT32 EFIAPI InterlockedIncrement(IN volatile UINT32 *Value)
+{
+    return __sync_add_and_fetch(Value, 1);
+}
+
+UINT32 EFIAPI InterlockedDecrement(IN volatile UINT32 *Value)
+{
+    return __sync_sub_and_fetch(Value, 1);
+}
+
+UINT32 EFIAPI InterlockedCompareExchange32(IN OUT volatile UINT32 *Value, IN UINT32 CompareValue, IN UINT32 ExchangeValue)
+{
+    return __sync_val_compare_and_swap(Value, CompareValue, ExchangeValue);
+}
+
+UINT64 EFIAPI InterlockedCompareExchange64(IN OUT volatile UINT64 *Value, IN UINT64 CompareValue, IN UINT64 ExchangeValue)
+{
+    return __sync_val_compare_and_swap(Value, CompareValue, ExchangeValue);
+}
+
+/*
+ * DebugAssert()
+ */
+VOID EFIAPI DebugAssert(IN CONST CHAR8 *FileName, IN UINTN LineNumber, IN CONST CHAR8 *Description)
+{
+    fprintf(stderr, "ASSERT %s(%lu): %s\n", FileName, LineNumber, Description);
+    abort();
+}
+
+/*
+ * Print formatting - UEFI syntax, %s and %c are CHAR16 and %a is ASCII,
+ *                    values are 32 bit unless the l flag is given
+ */
+typedef struct {
+    VOID *Buffer;       // NULL to only count
+    BOOLEAN Wide;       // CHAR16 buffer
+    UINTN Max;          // characters including terminator
+    UINTN Len;
+} PRINT_STATE;
+
+STATIC CONST CHAR8 *StatusStr[] = {
+    "Success",              "Load Error",           "Invalid Parameter",    "Unsupported",
+    "Bad Buffer Size",      "Buffer Too Small",     "Not Ready",            "Device Error",
+    "Write Protected",      "Out of Resources",     "Volume Corrupt",       "Volume Full",
+    "No Media",             "Media changed",        "Not Found",            "Access Denied",
+    "No Response",          "No mapping",           "Time out",             "Not started",
+    "Already started",      "Aborted",              "ICMP Error",           "TFTP Error",
+    "Protocol Error",       "Incompatible Version", "Security Violation",   "CRC Error",
+    "End of Media",         "Reserved (29)",        "Reserved (30)",        "End of File",
+    "Invalid Language",     "Compromised Data"
+};
+
+STATIC VOID PutChar(PRINT_STATE *State, UINT16 c)
+{
+    if (State->Len + 1 < State->Max) {
+        if (State->Wide) {
+            ((CHAR16 *)State->Buffer)[State->Len] = c;
+        } else {
+            ((CHAR8 *)State->Buffer)[State->Len] = (CHAR8)c;
+        }
+        State->Len++;
+    }
+}
+
+STATIC VOID PutField(PRINT_STATE *State, CONST VOID *Str, BOOLEAN WideStr, UINTN Count, UINTN Width, BOOLEAN Left, UINT16 Pad)
+{
+    UINTN Fill = Width > Count ? Width - Count : 0;
+    if (!Left) {
+        for (UINTN i = 0; i < Fill; i++) PutChar(State, Pad);
+    }
+    for (UINTN i = 0; i < Count; i++) {
+        PutChar(State, WideStr ? ((CONST CHAR16 *)Str)[i] : (UINT8)((CONST CHAR8 *)Str)[i]);
+    }
+    if (Left) {
+        for (UINTN i = 0; i < Fill; i++) PutChar(State, L' ');
+    }
+}
+
+STATIC UINTN FormatPrint(PRINT_STATE *State, CONST VOID *Format, BOOLEAN WideFormat, VA_LIST Marker)
+{
+    CHAR8 Digits[PRINT_MAX_DIGITS + 4];
+
+    for (UINTN f = 0; ; f++) {
+        UINT16 c = WideFormat ? ((CONST CHAR16 *)Format)[f] : (UINT8)((CONST CHAR8 *)Format)[f];
+        if (!c) {
+            break;
+        }
+        if (c != L'%') {
+            PutChar(State, c);
+            continue;
+        }
+        BOOLEAN Left = FALSE, Long = FALSE, Comma = FALSE, Sign = FALSE, Space = FALSE;
+        UINT16 Pad = L' ';
+        UINTN Width = 0, Precision = MAX_UINTN;
+        for (f++; ; f++) {
+            c = WideFormat ? ((CONST CHAR16 *)Format)[f] : (UINT8)((CONST CHAR8 *)Format)[f];
+            if (c == L'-') Left = TRUE;
+            else if (c == L'0' && !Width) Pad = L'0';
+            else if (c == L',') Comma = TRUE;
+            else if (c == L'+') Sign = TRUE;
+            else if (c == L' ') Space = TRUE;
+            else if (c == L'l' || c == L'L') Long = TRUE;
+            else if (c == L'*') Width = VA_ARG(Marker, UINTN);
+            else if (c >= L'1' && c <= L'9' && Precision == MAX_UINTN) {
+                while (c >= L'0' && c <= L'9') {
+                    Width = Width * 10 + (c - L'0');
+                    f++;
+                    c = WideFormat ? ((CONST CHAR16 *)Format)[f] : (UINT8)((CONST CHAR8 *)Format)[f];
+                }
+                f--;
+            } else if (c == L'.') {
+                Precision = 0;
+                f++;
+                c = WideFormat ? ((CONST CHAR16 *)Format)[f] : (UINT8)((CONST CHAR8 *)Format)[f];
+                if (c == L'*') {
+                    Precision = VA_ARG(Marker, UINTN);
+                } else {
+                    while (c >= L'0' && c <= L'9') {
+                        Precision = Precision * 10 + (c - L'0');
+                        f++;
+                        c = WideFormat ? ((CONST CHAR16 *)Format)[f] : (UINT8)((CONST CHAR8 *)Format)[f];
+                    }
+                    f--;
+                }
+            } else break;
+        }
+        switch (c) {
+        case L'd':
+        case L'i':
+        case L'u':
+        case L'x':
+        case L'X':
+        case L'p': {
+            UINT64 Value;
+            BOOLEAN Negative = FALSE;
+            UINT32 Base = (c == L'x' || c == L'X' || c == L'p') ? 16 : 10;
+            if (c == L'p') {
+                Value = (UINTN)VA_ARG(Marker, VOID *);
+                if (!Width) {
+                    Width = 16;
+                    Pad = L'0';
+                }
+            } else if (c == L'd' || c == L'i') {
+                INT64 s = Long ? VA_ARG(Marker, INT64) : (INT64)VA_ARG(Marker, INT32);
+                Negative = s < 0;
+                Value = Negative ? (UINT64)-s : (UINT64)s;
+            } else {
+                Value = Long ? VA_ARG(Marker, UINT64) : (UINT64)VA_ARG(Marker, UINT32);
+            }
+            CONST CHAR8 *Hex = (c == L'x') ? "0123456789abcdef" : "0123456789ABCDEF";
+            UINTN n = 0;
+            UINTN Group = 0;
+            do {
+                if (Comma && Base == 10 && Group == 3) {
+                    Digits[PRINT_MAX_DIGITS + 3 - n++] = ',';
+                    Group = 0;
+                }
+                Digits[PRINT_MAX_DIGITS + 3 - n++] = Hex[Value % Base];
+                Value /= Base;
+                Group++;
+            } while (Value && n < PRINT_MAX_DIGITS);
+            CHAR8 SignChar = Negative ? '-' : (Sign ? '+' : (Space ? ' ' : 0));
+            if (SignChar) {
+                if (Pad == L'0') {
+                    PutChar(State, SignChar);
+                    Width = Width ? Width - 1 : 0;
+                } else {
+                    Digits[PRINT_MAX_DIGITS + 3 - n++] = SignChar;
+                }
+            }
+            PutField(State, &Digits[PRINT_MAX_DIGITS + 4 - n], FALSE, n, Width, Left, Left ? L' ' : Pad);
+            break;
+        }
+        case L'c': {
+            CHAR16 Ch = (CHAR16)VA_ARG(Marker, UINTN);
+            PutField(State, &Ch, TRUE, 1, Width, Left, L' ');
+            break;
+        }
+        case L's':
+        case L'S':
+        case L'a': {
+            BOOLEAN WideStr = (c != L'a');
+            CONST VOID *Str = VA_ARG(Marker, VOID *);
+            if (!Str) {
+                Str = "<null string>";
+                WideStr = FALSE;
+            }
+            UINTN Count = 0;
+            while (Count < Precision && (WideStr ? ((CONST CHAR16 *)Str)[Count] : ((CONST CHAR8 *)Str)[Count])) Count++;
+            PutField(State, Str, WideStr, Count, Width, Left, L' ');
+            break;
+        }
+        case L'r': {
+            EFI_STATUS Status = VA_ARG(Marker, EFI_STATUS);
+            UINTN Index = Status & ~MAX_BIT;
+            if ((!EFI_ERROR(Status) && Status) || Index >= ARRAY_SIZE(StatusStr)) {
+                CHAR8 Unknown[24];
+                snprintf(Unknown, sizeof(Unknown), "%016lX", Status);
+                PutField(State, Unknown, FALSE, strlen(Unknown), Width, Left, L' ');
+            } else {
+                PutField(State, StatusStr[Index], FALSE, strlen(StatusStr[Index]), Width, Left, L' ');
+            }
+            break;
+        }
+        case L'g': {
+            EFI_GUID *Guid = VA_ARG(Marker, EFI_GUID *);
+            CHAR8 GuidStr[40];
+            snprintf(GuidStr, sizeof(GuidStr), "%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+                     Guid->Data1, Guid->Data2, Guid->Data3, Guid->Data4[0], Guid->Data4[1], Guid->Data4[2],
+                     Guid->Data4[3], Guid->Data4[4], Guid->Data4[5], Guid->Data4[6], Guid->Data4[7]);
+            PutField(State, GuidStr, FALSE, strlen(GuidStr), Width, Left, L' ');
+            break;
+        }
+        case L'%':
+            PutChar(State, L'%');
+            break;
+        case 0:
+            f--;
+            break;
+        default:
+            PutChar(State, c);
+            break;
+        }
+    }
+    if (State->Max) {
+        PutChar(State, 0);
+        State->Len--;
+    }
+    return State->Len;
+}
+
+STATIC UINTN VPrintTo(VOID *Buffer, BOOLEAN Wide, UINTN BufferSize, CONST VOID *Format, BOOLEAN WideFormat, VA_LIST Marker)
+{
+    PRINT_STATE State = { Buffer, Wide, Wide ? BufferSize / sizeof(CHAR16) : BufferSize, 0 };
+    if (!Buffer || !State.Max) {
+        return 0;
+    }
+    // terminator is always written
+    State.Max++;
+    UINTN Len = FormatPrint(&State, Format, WideFormat, Marker);
+    if (Len + 1 >= State.Max - 1) {
+        Len = State.Max - 2;
+    }
+    if (Wide) {
+        ((CHAR16 *)Buffer)[Len] = 0;
+    } else {
+        ((CHAR8 *)Buffer)[Len] = 0;
+    }
+    return Len;
+}
+
+UINTN EFIAPI UnicodeVSPrint(OUT CHAR16 *StartOfBuffer, IN UINTN BufferSize, IN CONST CHAR16 *FormatString, IN VA_LIST Marker)
+{
+    return VPrintTo(StartOfBuffer, TRUE, BufferSize, FormatString, TRUE, Marker);
+}
+
+UINTN EFIAPI UnicodeSPrint(OUT CHAR16 *StartOfBuffer, IN UINTN BufferSize, IN CONST CHAR16 *FormatString, ...)
+{
+    VA_LIST Marker;
+    VA_START(Marker, FormatString);
+    UINTN Len = UnicodeVSPrint(StartOfBuffer, BufferSize, FormatString, Marker);
+    VA_END(Marker);
+    return Len;
+}
+
+UINTN EFIAPI UnicodeVSPrintAsciiFormat(OUT CHAR16 *StartOfBuffer, IN UINTN BufferSize, IN CONST CHAR8 *FormatString, IN VA_LIST Marker)
+{
+    return VPrintTo(StartOfBuffer, TRUE, BufferSize, FormatString, FALSE, Marker);
+}
+
+UINTN EFIAPI UnicodeSPrintAsciiFormat(OUT CHAR16 *StartOfBuffer, IN UINTN BufferSize, IN CONST CHAR8 *FormatString, ...)
+{
+    VA_LIST Marker;
+    VA_START(Marker, FormatString);
+    UINTN Len = UnicodeVSPrintAsciiFormat(StartOfBuffer, BufferSize, FormatString, Marker);
+    VA_END(Marker);
+    return Len;
+}
+
+UINTN EFIAPI AsciiVSPrint(OUT CHAR8 *StartOfBuffer, IN UINTN BufferSize, IN CONST CHAR8 *FormatString, IN VA_LIST Marker)
+{
+    return VPrintTo(StartOfBuffer, FALSE, BufferSize, FormatString, FALSE, Marker);
+}
+
+UINTN EFIAPI AsciiSPrint(OUT CHAR8 *StartOfBuffer, IN UINTN BufferSize, IN CONST CHAR8 *FormatString, ...)
+{
+    VA_LIST Marker;
+    VA_START(Marker, FormatString);
+    UINTN Len = AsciiVSPrint(StartOfBuffer, BufferSize, FormatString, Marker);
+    VA_END(Marker);
+    return Len;
+}
+
+UINTN EFIAPI AsciiVSPrintUnicodeFormat(OUT CHAR8 *StartOfBuffer, IN UINTN BufferSize, IN CONST CHAR16 *FormatString, IN VA_LIST Marker)
+{
+    return VPrintTo(StartOfBuffer, FALSE, BufferSize, FormatString, TRUE, Marker);
+}
+
+UINTN EFIAPI AsciiSPrintUnicodeFormat(OUT CHAR8 *StartOfBuffer, IN UINTN BufferSize, IN CONST CHAR16 *FormatString, ...)
+{
+    VA_LIST Marker;
+    VA_START(Marker, FormatString);
+    UINTN Len = AsciiVSPrintUnicodeFormat(StartOfBuffer, BufferSize, FormatString, Marker);
+    VA_END(Marker);
+    return Len;
+}
@@ -0,0 +1,226 @@
+/*
+ * File:    HostMp.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - MP Services Protocol over pthreads
+ *
+ * Each AP is a thread, started the first time a procedure is sent to it,
+ * that waits for procedures from StartupThisAP(). The processor count is
+ * the number of online host CPUs, or GRAPHICSTEST_CPUS, so scaling code can
+ * be exercised on any machine. Only what GraphicsTest uses is provided:
+ * StartupAllAPs(), SwitchBSP() and EnableDisableAP() are unsupported and
+ * the timeout is ignored.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include "Host.h"
+
+#define HOST_MP_MAX_CPUS    256
+
+typedef struct {
+    pthread_t Thread;
+    BOOLEAN Started;
+    BOOLEAN Busy;           // procedure sent and not finished
+    BOOLEAN Exit;
+    EFI_AP_PROCEDURE Procedure;
+    VOID *Argument;
+    EFI_EVENT WaitEvent;
+} HOST_AP;
+
+STATIC EFI_MP_SERVICES_PROTOCOL HostMp;
+STATIC UINTN NumProcessors;
+STATIC HOST_AP *Aps;
+STATIC pthread_mutex_t Lock = PTHREAD_MUTEX_INITIALIZER;
+STATIC pthread_cond_t Cond = PTHREAD_COND_INITIALIZER;
+STATIC __thread UINTN ThisProcessor;
+
+/*
+ * ApThread() - Run procedures sent to one AP until told to exit
+ */
+STATIC VOID *ApThread(IN VOID *Arg)
+{
+    HOST_AP *Ap = (HOST_AP *)Arg;
+
+    ThisProcessor = Ap - Aps;
+    pthread_mutex_lock(&Lock);
+    while (TRUE) {
+        while (!Ap->Busy && !Ap->Exit) {
+            pthread_cond_wait(&Cond, &Lock);
+        }
+        if (Ap->Exit) {
+            break;
+        }
+        pthread_mutex_unlock(&Lock);
+        Ap->Procedure(Ap->Argument);
+        pthread_mutex_lock(&Lock);
+        EFI_EVENT WaitEvent = Ap->WaitEvent;
+        Ap->Busy = FALSE;
+        pthread_cond_broadcast(&Cond);
+        if (WaitEvent) {
+            // the procedure's stores are seen before the event, as on an AP
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            gBS->SignalEvent(WaitEvent);
+        }
+    }
+    pthread_mutex_unlock(&Lock);
+    return NULL;
+}
+
+STATIC EFI_STATUS EFIAPI HostGetNumberOfProcessors(IN EFI_MP_SERVICES_PROTOCOL *This, OUT UINTN *NumberOfProcessors, OUT UINTN *NumberOfEnabledProcessors)
+{
+    if (!NumberOfProcessors || !NumberOfEnabledProcessors) {
+        return EFI_INVALID_PARAMETER;
+    }
+    *NumberOfProcessors = NumProcessors;
+    *NumberOfEnabledProcessors = NumProcessors;
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostGetProcessorInfo(IN EFI_MP_SERVICES_PROTOCOL *This, IN UINTN ProcessorNumber, OUT EFI_PROCESSOR_INFORMATION *ProcessorInfoBuffer)
+{
+    if (!ProcessorInfoBuffer) {
+        return EFI_INVALID_PARAMETER;
+    }
+    if (ProcessorNumber >= NumProcessors) {
+        return EFI_NOT_FOUND;
+    }
+    ZeroMem(ProcessorInfoBuffer, sizeof(EFI_PROCESSOR_INFORMATION));
+    ProcessorInfoBuffer->ProcessorId = ProcessorNumber;
+    ProcessorInfoBuffer->StatusFlag = PROCESSOR_ENABLED_BIT | PROCESSOR_HEALTH_STATUS_BIT | (ProcessorNumber ? 0 : PROCESSOR_AS_BSP_BIT);
+    ProcessorInfoBuffer->Location.Core = (UINT32)ProcessorNumber;
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostStartupAllAPs(IN EFI_MP_SERVICES_PROTOCOL *This, IN EFI_AP_PROCEDURE Procedure, IN BOOLEAN SingleThread, IN EFI_EVENT WaitEvent, IN UINTN TimeoutInMicroSeconds, IN VOID *ProcedureArgument, OUT UINTN **FailedCpuList)
+{
+    return EFI_UNSUPPORTED;
+}
+
+/*
+ * HostStartupThisAP() - Blocking without a WaitEvent, else WaitEvent is
+ *                       signalled when the procedure returns
+ */
+STATIC EFI_STATUS EFIAPI HostStartupThisAP(IN EFI_MP_SERVICES_PROTOCOL *This, IN EFI_AP_PROCEDURE Procedure, IN UINTN ProcessorNumber, IN EFI_EVENT WaitEvent, IN UINTN TimeoutInMicroseconds, IN VOID *ProcedureArgument, OUT BOOLEAN *Finished)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+
+    if (ThisProcessor) {
+        return EFI_DEVICE_ERROR;
+    }
+    if (!Procedure || !ProcessorNumber) {
+        return EFI_INVALID_PARAMETER;
+    }
+    if (ProcessorNumber >= NumProcessors) {
+        return EFI_NOT_FOUND;
+    }
+    HOST_AP *Ap = &Aps[ProcessorNumber];
+    pthread_mutex_lock(&Lock);
+    if (Ap->Busy) {
+        Status = EFI_NOT_READY;
+        goto Error_exit;
+    }
+    if (!Ap->Started) {
+        if (pthread_create(&Ap->Thread, NULL, ApThread, Ap)) {
+            Status = EFI_DEVICE_ERROR;
+            goto Error_exit;
+        }
+        Ap->Started = TRUE;
+    }
+    Ap->Procedure = Procedure;
+    Ap->Argument = ProcedureArgument;
+    Ap->WaitEvent = WaitEvent;
+    Ap->Busy = TRUE;
+    pthread_cond_broadcast(&Cond);
+    if (!WaitEvent) {
+        while (Ap->Busy) {
+            pthread_cond_wait(&Cond, &Lock);
+        }
+        if (Finished) {
+            *Finished = TRUE;
+        }
+    }
+
+Error_exit:
+    pthread_mutex_unlock(&Lock);
+    return Status;
+}
+
+STATIC EFI_STATUS EFIAPI HostSwitchBSP(IN EFI_MP_SERVICES_PROTOCOL *This, IN UINTN ProcessorNumber, IN BOOLEAN EnableOldBSP)
+{
+    return EFI_UNSUPPORTED;
+}
+
+STATIC EFI_STATUS EFIAPI HostEnableDisableAP(IN EFI_MP_SERVICES_PROTOCOL *This, IN UINTN ProcessorNumber, IN BOOLEAN EnableAP, IN UINT32 *HealthFlag)
+{
+    return EFI_UNSUPPORTED;
+}
+
+STATIC EFI_STATUS EFIAPI HostWhoAmI(IN EFI_MP_SERVICES_PROTOCOL *This, OUT UINTN *ProcessorNumber)
+{
+    if (!ProcessorNumber) {
+        return EFI_INVALID_PARAMETER;
+    }
+    *ProcessorNumber = ThisProcessor;
+    return EFI_SUCCESS;
+}
+
+/*
+ * GetHostMp() - Protocol instance, the processor count is set on first use
+ */
+EFI_MP_SERVICES_PROTOCOL *GetHostMp(VOID)
+{
+    if (!NumProcessors) {
+        CONST CHAR8 *Env = getenv(HOST_ENV_CPUS);
+        long Cpus = Env ? strtol(Env, NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+        Aps = AllocateZeroPool(HOST_MP_MAX_CPUS * sizeof(HOST_AP));
+        if (!Aps) {
+            return NULL;
+        }
+        NumProcessors = (UINTN)MIN(MAX(Cpus, 1), HOST_MP_MAX_CPUS);
+        HostMp.GetNumberOfProcessors = HostGetNumberOfProcessors;
+        HostMp.GetProcessorInfo = HostGetProcessorInfo;
+        HostMp.StartupAllAPs = HostStartupAllAPs;
+        HostMp.StartupThisAP = HostStartupThisAP;
+        HostMp.SwitchBSP = HostSwitchBSP;
+        HostMp.EnableDisableAP = HostEnableDisableAP;
+        HostMp.WhoAmI = HostWhoAmI;
+    }
+    return &HostMp;
+}
+
+/*
+ * DestroyHostMp() - Wait for procedures to finish and stop the AP threads
+ */
+VOID DestroyHostMp(VOID)
+{
+    if (!Aps) {
+        return;
+    }
+    pthread_mutex_lock(&Lock);
+    for (UINTN i = 1; i < NumProcessors; i++) {
+        while (Aps[i].Busy) {
+            pthread_cond_wait(&Cond, &Lock);
+        }
+        Aps[i].Exit = TRUE;
+    }
+    pthread_cond_broadcast(&Cond);
+    pthread_mutex_unlock(&Lock);
+    for (UINTN i = 1; i < NumProcessors; i++) {
+        if (Aps[i].Started) {
+            pthread_join(Aps[i].Thread, NULL);
+        }
+    }
+    FreePool(Aps);
+    Aps = NULL;
+    NumProcessors = 0;
+}
@@ -0,0 +1,740 @@
+/*
+ * File:    HostUefi.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - System table, boot services, console and shell shims
+ *
+ * Only what GraphicsTest and its libraries use is provided. There is no
+ * asynchronous event delivery, so signal notify timers are unsupported and
+ * the TPL is tracked but doesn't mask anything.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/stat.h>
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PrintLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/ShellCEntryLib.h>
+#include <Library/ShellLib.h>
+#include "Host.h"
+
+#define HOST_PRINT_BUFFER   4096
+#define HOST_PATH_MAX       1024
+#define HOST_KEY_POLL_NS    1000000
+
+typedef struct {
+    UINT32 Type;
+    UINT64 Deadline;        // ns, 0 when the timer isn't armed
+    UINT64 Period;          // ns, 0 for a one shot timer
+    volatile BOOLEAN Signaled;  // also set by AP threads, see HostMp.c
+} HOST_EVENT;
+
+EFI_GUID gEfiGraphicsOutputProtocolGuid = EFI_GRAPHICS_OUTPUT_PROTOCOL_GUID;
+EFI_GUID gEfiShellParametersProtocolGuid = { 0x752f3136, 0x4e16, 0x4fdc, { 0xa2, 0x2a, 0xe5, 0xf4, 0x68, 0x12, 0xf4, 0xca } };
+EFI_GUID gEfiMpServiceProtocolGuid = EFI_MP_SERVICES_PROTOCOL_GUID;
+
+STATIC HOST_EVENT KeyEvent;
+STATIC EFI_TPL CurrentTpl = TPL_APPLICATION;
+STATIC BOOLEAN KeyWaited;
+STATIC struct termios SavedTermios;
+STATIC BOOLEAN TermiosSaved;
+
+/*
+ * NowNs() - Monotonic host time
+ */
+STATIC UINT64 NowNs(VOID)
+{
+    struct timespec Ts;
+    clock_gettime(CLOCK_MONOTONIC, &Ts);
+    return (UINT64)Ts.tv_sec * 1000000000ULL + Ts.tv_nsec;
+}
+
+/*
+ * Console output - CHAR16 is written as UTF-8, CR is dropped before LF
+ */
+STATIC VOID WriteChar16(IN FILE *File, IN CONST CHAR16 *String)
+{
+    for (; *String; String++) {
+        CHAR16 c = *String;
+        if (c == L'\r' && String[1] == L'\n') {
+            continue;
+        }
+        if (c < 0x80) {
+            fputc(c, File);
+        } else if (c < 0x800) {
+            fputc(0xC0 | (c >> 6), File);
+            fputc(0x80 | (c & 0x3F), File);
+        } else {
+            fputc(0xE0 | (c >> 12), File);
+            fputc(0x80 | ((c >> 6) & 0x3F), File);
+            fputc(0x80 | (c & 0x3F), File);
+        }
+    }
+    fflush(File);
+}
+
+STATIC EFI_SIMPLE_TEXT_OUTPUT_MODE ConOutMode = { 1, 0, EFI_TEXT_ATTR(EFI_LIGHTGRAY, EFI_BLACK), 0, 0, TRUE };
+
+STATIC EFI_STATUS EFIAPI ConOutReset(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN BOOLEAN ExtendedVerification)
+{
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI ConOutOutputString(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN CHAR16 *String)
+{
+    WriteChar16(This == gST->StdErr ? stderr : stdout, String);
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI ConOutTestString(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN CHAR16 *String)
+{
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI ConOutQueryMode(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN UINTN ModeNumber, OUT UINTN *Columns, OUT UINTN *Rows)
+{
+    if (ModeNumber) {
+        return EFI_UNSUPPORTED;
+    }
+    *Columns = 80;
+    *Rows = 25;
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI ConOutSetMode(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN UINTN ModeNumber)
+{
+    return ModeNumber ? EFI_UNSUPPORTED : EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI ConOutSetAttribute(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN UINTN Attribute)
+{
+    This->Mode->Attribute = (INT32)Attribute;
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI ConOutClearScreen(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This)
+{
+    if (isatty(STDOUT_FILENO)) {
+        fputs("\033[2J\033[H", stdout);
+        fflush(stdout);
+    }
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI ConOutSetCursorPosition(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN UINTN Column, IN UINTN Row)
+{
+    if (isatty(STDOUT_FILENO)) {
+        fprintf(stdout, "\033[%lu;%luH", Row + 1, Column + 1);
+        fflush(stdout);
+    }
+    This->Mode->CursorColumn = (INT32)Column;
+    This->Mode->CursorRow = (INT32)Row;
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI ConOutEnableCursor(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN BOOLEAN Visible)
+{
+    This->Mode->CursorVisible = Visible;
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL ConOut = {
+    ConOutReset, ConOutOutputString, ConOutTestString, ConOutQueryMode, ConOutSetMode,
+    ConOutSetAttribute, ConOutClearScreen, ConOutSetCursorPosition, ConOutEnableCursor, &ConOutMode
+};
+
+STATIC EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL StdErr = {
+    ConOutReset, ConOutOutputString, ConOutTestString, ConOutQueryMode, ConOutSetMode,
+    ConOutSetAttribute, ConOutClearScreen, ConOutSetCursorPosition, ConOutEnableCursor, &ConOutMode
+};
+
+/*
+ * Console input - stdin is switched to unbuffered no echo when it's a
+ * terminal. A closed or redirected stdin has no keys, except that waiting
+ * for a key is answered with Enter so prompts don't hang.
+ */
+STATIC VOID RestoreTerminal(VOID)
+{
+    if (TermiosSaved) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &SavedTermios);
+    }
+}
+
+STATIC VOID SetupTerminal(VOID)
+{
+    struct termios Raw;
+
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &SavedTermios)) {
+        return;
+    }
+    TermiosSaved = TRUE;
+    atexit(RestoreTerminal);
+    Raw = SavedTermios;
+    Raw.c_lflag &= ~(ICANON | ECHO);
+    Raw.c_cc[VMIN] = 1;
+    Raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &Raw);
+}
+
+/*
+ * KeyPending() - Check for stdin input, without blocking when TimeoutMs is 0
+ */
+STATIC BOOLEAN KeyPending(IN INT32 TimeoutMs)
+{
+    struct pollfd Fd = { STDIN_FILENO, POLLIN, 0 };
+    return poll(&Fd, 1, TimeoutMs) > 0 && (Fd.revents & POLLIN);
+}
+
+STATIC EFI_STATUS EFIAPI ConInReset(IN EFI_SIMPLE_TEXT_INPUT_PROTOCOL *This, IN BOOLEAN ExtendedVerification)
+{
+    UINT8 Byte;
+    while (KeyPending(0) && read(STDIN_FILENO, &Byte, 1) == 1);
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI ConInReadKeyStroke(IN EFI_SIMPLE_TEXT_INPUT_PROTOCOL *This, OUT EFI_INPUT_KEY *Key)
+{
+    UINT8 Byte;
+
+    Key->ScanCode = SCAN_NULL;
+    Key->UnicodeChar = CHAR_NULL;
+    if (!KeyPending(0) || read(STDIN_FILENO, &Byte, 1) != 1) {
+        if (KeyWaited) {
+            KeyWaited = FALSE;
+            Key->UnicodeChar = CHAR_CARRIAGE_RETURN;
+            return EFI_SUCCESS;
+        }
+        return EFI_NOT_READY;
+    }
+    KeyWaited = FALSE;
+    if (Byte == 0x1B) {
+        UINT8 Seq[2];
+        Key->ScanCode = SCAN_ESC;
+        // Cursor keys arrive as ESC [ A..D
+        if (KeyPending(10) && read(STDIN_FILENO, &Seq[0], 1) == 1 && Seq[0] == '[' &&
+            KeyPending(10) && read(STDIN_FILENO, &Seq[1], 1) == 1 && Seq[1] >= 'A' && Seq[1] <= 'D') {
+            Key->ScanCode = SCAN_UP + (Seq[1] - 'A');
+        }
+    } else if (Byte == '\n') {
+        Key->UnicodeChar = CHAR_CARRIAGE_RETURN;
+    } else if (Byte == 0x7F) {
+        Key->UnicodeChar = CHAR_BACKSPACE;
+    } else {
+        Key->UnicodeChar = Byte;
+    }
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_SIMPLE_TEXT_INPUT_PROTOCOL ConIn = { ConInReset, ConInReadKeyStroke, &KeyEvent };
+
+/*
+ * Events - timers are polled, there is no asynchronous notification
+ */
+STATIC BOOLEAN PollEvent(IN HOST_EVENT *Event)
+{
+    if (Event == &KeyEvent) {
+        return KeyPending(0);
+    }
+    if (Event->Deadline && NowNs() >= Event->Deadline) {
+        Event->Signaled = TRUE;
+        Event->Deadline = Event->Period ? Event->Deadline + Event->Period : 0;
+    }
+    return Event->Signaled;
+}
+
+STATIC EFI_STATUS EFIAPI HostCreateEvent(IN UINT32 Type, IN EFI_TPL NotifyTpl, IN EFI_EVENT_NOTIFY NotifyFunction, IN VOID *NotifyContext, OUT EFI_EVENT *Event)
+{
+    HOST_EVENT *NewEvent;
+
+    if (!Event) {
+        return EFI_INVALID_PARAMETER;
+    }
+    if (Type & (EVT_NOTIFY_SIGNAL | EVT_NOTIFY_WAIT)) {
+        return EFI_UNSUPPORTED;
+    }
+    NewEvent = AllocateZeroPool(sizeof(HOST_EVENT));
+    if (!NewEvent) {
+        return EFI_OUT_OF_RESOURCES;
+    }
+    NewEvent->Type = Type;
+    *Event = NewEvent;
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostSetTimer(IN EFI_EVENT Event, IN EFI_TIMER_DELAY Type, IN UINT64 TriggerTime)
+{
+    HOST_EVENT *Timer = (HOST_EVENT *)Event;
+
+    if (!Timer || Timer == &KeyEvent || !(Timer->Type & EVT_TIMER)) {
+        return EFI_INVALID_PARAMETER;
+    }
+    // TriggerTime is in 100ns units
+    Timer->Signaled = FALSE;
+    Timer->Period = Type == TimerPeriodic ? MAX(TriggerTime, 1) * 100 : 0;
+    Timer->Deadline = Type == TimerCancel ? 0 : NowNs() + TriggerTime * 100;
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostWaitForEvent(IN UINTN NumberOfEvents, IN EFI_EVENT *Event, OUT UINTN *Index)
+{
+    struct timespec Poll = { 0, HOST_KEY_POLL_NS };
+
+    if (!NumberOfEvents || !Event || !Index) {
+        return EFI_INVALID_PARAMETER;
+    }
+    while (TRUE) {
+        for (UINTN i = 0; i < NumberOfEvents; i++) {
+            HOST_EVENT *Wait = (HOST_EVENT *)Event[i];
+            if (PollEvent(Wait)) {
+                Wait->Signaled = FALSE;
+                *Index = i;
+                return EFI_SUCCESS;
+            }
+            if (Wait == &KeyEvent && !isatty(STDIN_FILENO)) {
+                KeyWaited = TRUE;
+                *Index = i;
+                return EFI_SUCCESS;
+            }
+        }
+        nanosleep(&Poll, NULL);
+    }
+}
+
+STATIC EFI_STATUS EFIAPI HostSignalEvent(IN EFI_EVENT Event)
+{
+    ((HOST_EVENT *)Event)->Signaled = TRUE;
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostCloseEvent(IN EFI_EVENT Event)
+{
+    if (Event != &KeyEvent) {
+        FreePool(Event);
+    }
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostCheckEvent(IN EFI_EVENT Event)
+{
+    HOST_EVENT *Check = (HOST_EVENT *)Event;
+
+    if (PollEvent(Check)) {
+        Check->Signaled = FALSE;
+        return EFI_SUCCESS;
+    }
+    return EFI_NOT_READY;
+}
+
+/*
+ * Boot services
+ */
+STATIC EFI_TPL EFIAPI HostRaiseTPL(IN EFI_TPL NewTpl)
+{
+    EFI_TPL OldTpl = CurrentTpl;
+    CurrentTpl = NewTpl;
+    return OldTpl;
+}
+
+STATIC VOID EFIAPI HostRestoreTPL(IN EFI_TPL OldTpl)
+{
+    CurrentTpl = OldTpl;
+}
+
+STATIC EFI_STATUS EFIAPI HostAllocatePages(IN EFI_ALLOCATE_TYPE Type, IN EFI_MEMORY_TYPE MemoryType, IN UINTN Pages, IN OUT EFI_PHYSICAL_ADDRESS *Memory)
+{
+    VOID *Buffer;
+
+    if (Type != AllocateAnyPages) {
+        return EFI_UNSUPPORTED;
+    }
+    Buffer = AllocatePages(Pages);
+    if (!Buffer) {
+        return EFI_OUT_OF_RESOURCES;
+    }
+    *Memory = (EFI_PHYSICAL_ADDRESS)(UINTN)Buffer;
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostFreePages(IN EFI_PHYSICAL_ADDRESS Memory, IN UINTN Pages)
+{
+    FreePages((VOID *)(UINTN)Memory, Pages);
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostAllocatePool(IN EFI_MEMORY_TYPE PoolType, IN UINTN Size, OUT VOID **Buffer)
+{
+    *Buffer = AllocatePool(Size);
+    return *Buffer ? EFI_SUCCESS : EFI_OUT_OF_RESOURCES;
+}
+
+STATIC EFI_STATUS EFIAPI HostFreePool(IN VOID *Buffer)
+{
+    FreePool(Buffer);
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostHandleProtocol(IN EFI_HANDLE Handle, IN EFI_GUID *Protocol, OUT VOID **Interface)
+{
+    if (CompareGuid(Protocol, &gEfiGraphicsOutputProtocolGuid)) {
+        *Interface = GetHostGop();
+    } else if (CompareGuid(Protocol, &gEfiShellParametersProtocolGuid) && Handle == gImageHandle) {
+        *Interface = gEfiShellParametersProtocol;
+    } else if (CompareGuid(Protocol, &gEfiMpServiceProtocolGuid)) {
+        *Interface = GetHostMp();
+    } else {
+        *Interface = NULL;
+    }
+    return *Interface ? EFI_SUCCESS : EFI_UNSUPPORTED;
+}
+
+STATIC EFI_STATUS EFIAPI HostOpenProtocol(IN EFI_HANDLE Handle, IN EFI_GUID *Protocol, OUT VOID **Interface, IN EFI_HANDLE AgentHandle, IN EFI_HANDLE ControllerHandle, IN UINT32 Attributes)
+{
+    return HostHandleProtocol(Handle, Protocol, Interface);
+}
+
+STATIC EFI_STATUS EFIAPI HostCloseProtocol(IN EFI_HANDLE Handle, IN EFI_GUID *Protocol, IN EFI_HANDLE AgentHandle, IN EFI_HANDLE ControllerHandle)
+{
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostLocateHandleBuffer(IN EFI_LOCATE_SEARCH_TYPE SearchType, IN EFI_GUID *Protocol, IN VOID *SearchKey, OUT UINTN *NoHandles, OUT EFI_HANDLE **Buffer)
+{
+    if (SearchType != ByProtocol || !CompareGuid(Protocol, &gEfiGraphicsOutputProtocolGuid) || !GetHostGop()) {
+        return EFI_NOT_FOUND;
+    }
+    *Buffer = AllocatePool(sizeof(EFI_HANDLE));
+    if (!*Buffer) {
+        return EFI_OUT_OF_RESOURCES;
+    }
+    // The GOP instance doubles as its handle
+    (*Buffer)[0] = GetHostGop();
+    *NoHandles = 1;
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostLocateProtocol(IN EFI_GUID *Protocol, IN VOID *Registration, OUT VOID **Interface)
+{
+    return HostHandleProtocol(NULL, Protocol, Interface) == EFI_SUCCESS ? EFI_SUCCESS : EFI_NOT_FOUND;
+}
+
+STATIC EFI_STATUS EFIAPI HostStall(IN UINTN Microseconds)
+{
+    struct timespec Ts = { Microseconds / 1000000, (Microseconds % 1000000) * 1000 };
+    nanosleep(&Ts, NULL);
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostSetWatchdogTimer(IN UINTN Timeout, IN UINT64 WatchdogCode, IN UINTN DataSize, IN CHAR16 *WatchdogData)
+{
+    return EFI_SUCCESS;
+}
+
+STATIC VOID EFIAPI HostCopyMem(IN VOID *Destination, IN VOID *Source, IN UINTN Length)
+{
+    CopyMem(Destination, Source, Length);
+}
+
+STATIC VOID EFIAPI HostSetMem(IN VOID *Buffer, IN UINTN Size, IN UINT8 Value)
+{
+    SetMem(Buffer, Size, Value);
+}
+
+STATIC EFI_BOOT_SERVICES BootServices = {
+    HostRaiseTPL, HostRestoreTPL, HostAllocatePages, HostFreePages, HostAllocatePool, HostFreePool,
+    HostCreateEvent, HostSetTimer, HostWaitForEvent, HostSignalEvent, HostCloseEvent, HostCheckEvent,
+    HostHandleProtocol, HostStall, HostSetWatchdogTimer, HostOpenProtocol, HostCloseProtocol,
+    HostLocateHandleBuffer, HostLocateProtocol, HostCopyMem, HostSetMem
+};
+
+/*
+ * Runtime services
+ */
+STATIC EFI_STATUS EFIAPI HostGetTime(OUT EFI_TIME *Time, OUT EFI_TIME_CAPABILITIES *Capabilities)
+{
+    struct timespec Ts;
+    struct tm Tm;
+
+    if (!Time) {
+        return EFI_INVALID_PARAMETER;
+    }
+    clock_gettime(CLOCK_REALTIME, &Ts);
+    localtime_r(&Ts.tv_sec, &Tm);
+    ZeroMem(Time, sizeof(*Time));
+    Time->Year = (UINT16)(Tm.tm_year + 1900);
+    Time->Month = (UINT8)(Tm.tm_mon + 1);
+    Time->Day = (UINT8)Tm.tm_mday;
+    Time->Hour = (UINT8)Tm.tm_hour;
+    Time->Minute = (UINT8)Tm.tm_min;
+    Time->Second = (UINT8)Tm.tm_sec;
+    Time->Nanosecond = (UINT32)Ts.tv_nsec;
+    Time->TimeZone = 0x07FF;
+    if (Capabilities) {
+        Capabilities->Resolution = 1;
+        Capabilities->Accuracy = 0;
+        Capabilities->SetsToZero = FALSE;
+    }
+    return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS EFIAPI HostSetTime(IN EFI_TIME *Time)
+{
+    return EFI_UNSUPPORTED;
+}
+
+STATIC EFI_RUNTIME_SERVICES RuntimeServices = { HostGetTime, HostSetTime };
+
+STATIC EFI_SYSTEM_TABLE SystemTable = {
+    L"Host", 0, NULL, &ConIn, NULL, &ConOut, NULL, &StdErr, &RuntimeServices, &BootServices
+};
+
+EFI_HANDLE gImageHandle = &SystemTable;
+EFI_SYSTEM_TABLE *gST = &SystemTable;
+EFI_BOOT_SERVICES *gBS = &BootServices;
+EFI_RUNTIME_SERVICES *gRT = &RuntimeServices;
+
+/*
+ * UefiLib print functions
+ */
+STATIC UINTN VPrintCon(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *Con, IN CONST VOID *Format, IN BOOLEAN Ascii, IN VA_LIST Marker)
+{
+    CHAR16 Buffer[HOST_PRINT_BUFFER];
+    UINTN Len;
+
+    if (Ascii) {
+        Len = UnicodeVSPrintAsciiFormat(Buffer, sizeof(Buffer), Format, Marker);
+    } else {
+        Len = UnicodeVSPrint(Buffer, sizeof(Buffer), Format, Marker);
+    }
+    Con->OutputString(Con, Buffer);
+    return Len;
+}
+
+UINTN EFIAPI Print(IN CONST CHAR16 *Format, ...)
+{
+    VA_LIST Marker;
+    VA_START(Marker, Format);
+    UINTN Len = VPrintCon(gST->ConOut, Format, FALSE, Marker);
+    VA_END(Marker);
+    return Len;
+}
+
+UINTN EFIAPI ErrorPrint(IN CONST CHAR16 *Format, ...)
+{
+    VA_LIST Marker;
+    VA_START(Marker, Format);
+    UINTN Len = VPrintCon(gST->StdErr, Format, FALSE, Marker);
+    VA_END(Marker);
+    return Len;
+}
+
+UINTN EFIAPI AsciiPrint(IN CONST CHAR8 *Format, ...)
+{
+    VA_LIST Marker;
+    VA_START(Marker, Format);
+    UINTN Len = VPrintCon(gST->ConOut, Format, TRUE, Marker);
+    VA_END(Marker);
+    return Len;
+}
+
+UINTN EFIAPI AsciiErrorPrint(IN CONST CHAR8 *Format, ...)
+{
+    VA_LIST Marker;
+    VA_START(Marker, Format);
+    UINTN Len = VPrintCon(gST->StdErr, Format, TRUE, Marker);
+    VA_END(Marker);
+    return Len;
+}
+
+/*
+ * Shell file functions - SHELL_FILE_HANDLE is a stdio FILE
+ */
+STATIC EFI_SHELL_PARAMETERS_PROTOCOL ShellParameters;
+EFI_SHELL_PARAMETERS_PROTOCOL *gEfiShellParametersProtocol = &ShellParameters;
+
+/*
+ * HostPath() - Convert a shell path, \ separators become /
+ */
+STATIC EFI_STATUS HostPath(IN CONST CHAR16 *FileName, OUT CHAR8 *Path)
+{
+    UINTN i;
+
+    if (!FileName) {
+        return EFI_INVALID_PARAMETER;
+    }
+    for (i = 0; FileName[i]; i++) {
+        if (i + 1 >= HOST_PATH_MAX || FileName[i] >= 0x80) {
+            return EFI_INVALID_PARAMETER;
+        }
+        Path[i] = FileName[i] == L'\\' ? '/' : (CHAR8)FileName[i];
+    }
+    Path[i] = 0;
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS EFIAPI ShellOpenFileByName(IN CONST CHAR16 *FileName, OUT SHELL_FILE_HANDLE *FileHandle, IN UINT64 OpenMode, IN UINT64 Attributes)
+{
+    CHAR8 Path[HOST_PATH_MAX];
+    EFI_STATUS Status;
+    FILE *File;
+    INT32 Fd;
+    INT32 Flags;
+
+    Status = HostPath(FileName, Path);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    // Create opens without truncating, as the shell does
+    Flags = (OpenMode & EFI_FILE_MODE_WRITE) ? O_RDWR : O_RDONLY;
+    if (OpenMode & EFI_FILE_MODE_CREATE) {
+        Flags |= O_CREAT;
+    }
+    Fd = open(Path, Flags, 0644);
+    if (Fd < 0) {
+        return EFI_NOT_FOUND;
+    }
+    File = fdopen(Fd, (OpenMode & EFI_FILE_MODE_WRITE) ? "r+b" : "rb");
+    if (!File) {
+        close(Fd);
+        return EFI_DEVICE_ERROR;
+    }
+    *FileHandle = File;
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS EFIAPI ShellCloseFile(IN SHELL_FILE_HANDLE *FileHandle)
+{
+    if (!FileHandle || !*FileHandle) {
+        return EFI_INVALID_PARAMETER;
+    }
+    fclose((FILE *)*FileHandle);
+    *FileHandle = NULL;
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS EFIAPI ShellReadFile(IN SHELL_FILE_HANDLE FileHandle, IN OUT UINTN *ReadSize, OUT VOID *Buffer)
+{
+    *ReadSize = fread(Buffer, 1, *ReadSize, (FILE *)FileHandle);
+    return ferror((FILE *)FileHandle) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+}
+
+EFI_STATUS EFIAPI ShellWriteFile(IN SHELL_FILE_HANDLE FileHandle, IN OUT UINTN *BufferSize, IN VOID *Buffer)
+{
+    UINTN Size = *BufferSize;
+    *BufferSize = fwrite(Buffer, 1, Size, (FILE *)FileHandle);
+    return *BufferSize == Size ? EFI_SUCCESS : EFI_DEVICE_ERROR;
+}
+
+EFI_STATUS EFIAPI ShellFlushFile(IN SHELL_FILE_HANDLE FileHandle)
+{
+    return fflush((FILE *)FileHandle) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+}
+
+EFI_STATUS EFIAPI ShellGetFileSize(IN SHELL_FILE_HANDLE FileHandle, OUT UINT64 *Size)
+{
+    struct stat St;
+
+    fflush((FILE *)FileHandle);
+    if (fstat(fileno((FILE *)FileHandle), &St)) {
+        return EFI_DEVICE_ERROR;
+    }
+    *Size = (UINT64)St.st_size;
+    return EFI_SUCCESS;
+}
+
+EFI_STATUS EFIAPI ShellSetFilePosition(IN SHELL_FILE_HANDLE FileHandle, IN UINT64 Position)
+{
+    // MAX_UINT64 is end of file
+    if (Position == MAX_UINT64) {
+        return fseeko((FILE *)FileHandle, 0, SEEK_END) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+    }
+    return fseeko((FILE *)FileHandle, (off_t)Position, SEEK_SET) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+}
+
+EFI_STATUS EFIAPI ShellFileExists(IN CONST CHAR16 *Name)
+{
+    CHAR8 Path[HOST_PATH_MAX];
+    EFI_STATUS Status;
+
+    Status = HostPath(Name, Path);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    return access(Path, F_OK) ? EFI_NOT_FOUND : EFI_SUCCESS;
+}
+
+EFI_STATUS EFIAPI ShellDeleteFileByName(IN CONST CHAR16 *FileName)
+{
+    CHAR8 Path[HOST_PATH_MAX];
+    EFI_STATUS Status;
+
+    Status = HostPath(FileName, Path);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    return remove(Path) ? EFI_ACCESS_DENIED : EFI_SUCCESS;
+}
+
+EFI_STATUS EFIAPI ShellDeleteFile(IN SHELL_FILE_HANDLE *FileHandle)
+{
+    return EFI_UNSUPPORTED;
+}
+
+/*
+ * main() - Host entry point, runs the shell application entry
+ */
+int main(int argc, char **argv)
+{
+    CHAR16 **Argv;
+    INTN Result;
+    EFI_STATUS Status;
+
+    Status = CreateHostGop();
+    if (EFI_ERROR(Status)) {
+        fprintf(stderr, "%s: invalid %s or %s\n", argv[0], HOST_ENV_MODES, HOST_ENV_FORMAT);
+        return 1;
+    }
+
+    Argv = AllocateZeroPool((argc + 1) * sizeof(CHAR16 *));
+    if (!Argv) {
+        return 1;
+    }
+    for (int i = 0; i < argc; i++) {
+        UINTN Len = strlen(argv[i]);
+        Argv[i] = AllocatePool((Len + 1) * sizeof(CHAR16));
+        if (!Argv[i]) {
+            return 1;
+        }
+        AsciiStrToUnicodeStrS(argv[i], Argv[i], Len + 1);
+    }
+    ShellParameters.Argv = Argv;
+    ShellParameters.Argc = argc;
+    ShellParameters.StdIn = stdin;
+    ShellParameters.StdOut = stdout;
+    ShellParameters.StdErr = stderr;
+
+    SetupTerminal();
+    Result = ShellAppMain(argc, Argv);
+
+    DestroyHostMp();
+    DestroyHostGop();
+    for (int i = 0; i < argc; i++) {
+        FreePool(Argv[i]);
+    }
+    FreePool(Argv);
+    return (int)Result;
+}
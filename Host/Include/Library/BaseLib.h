@@ -0,0 +1,74 @@
+/*
+ * File:    BaseLib.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - BaseLib subset implemented in HostLib.c
+ */
+
+#ifndef HOST_BASE_LIB_H
+#define HOST_BASE_LIB_H
+
+#include <Uefi.h>
+
+// strings
+UINTN EFIAPI StrLen(IN CONST CHAR16 *String);
+UINTN EFIAPI StrSize(IN CONST CHAR16 *String);
+INTN EFIAPI StrCmp(IN CONST CHAR16 *FirstString, IN CONST CHAR16 *SecondString);
+INTN EFIAPI StrnCmp(IN CONST CHAR16 *FirstString, IN CONST CHAR16 *SecondString, IN UINTN Length);
+RETURN_STATUS EFIAPI StrCpyS(OUT CHAR16 *Destination, IN UINTN DestMax, IN CONST CHAR16 *Source);
+RETURN_STATUS EFIAPI StrnCpyS(OUT CHAR16 *Destination, IN UINTN DestMax, IN CONST CHAR16 *Source, IN UINTN Length);
+RETURN_STATUS EFIAPI StrCatS(IN OUT CHAR16 *Destination, IN UINTN DestMax, IN CONST CHAR16 *Source);
+CHAR16 * EFIAPI StrStr(IN CONST CHAR16 *String, IN CONST CHAR16 *SearchString);
+UINTN EFIAPI StrDecimalToUintn(IN CONST CHAR16 *String);
+UINT64 EFIAPI StrDecimalToUint64(IN CONST CHAR16 *String);
+UINTN EFIAPI StrHexToUintn(IN CONST CHAR16 *String);
+UINT64 EFIAPI StrHexToUint64(IN CONST CHAR16 *String);
+RETURN_STATUS EFIAPI StrDecimalToUintnS(IN CONST CHAR16 *String, OUT CHAR16 **EndPointer, OUT UINTN *Data);
+RETURN_STATUS EFIAPI StrHexToUintnS(IN CONST CHAR16 *String, OUT CHAR16 **EndPointer, OUT UINTN *Data);
+CHAR16 EFIAPI CharToUpper(IN CHAR16 Char);
+UINTN EFIAPI AsciiStrLen(IN CONST CHAR8 *String);
+UINTN EFIAPI AsciiStrSize(IN CONST CHAR8 *String);
+INTN EFIAPI AsciiStrCmp(IN CONST CHAR8 *FirstString, IN CONST CHAR8 *SecondString);
+INTN EFIAPI AsciiStrnCmp(IN CONST CHAR8 *FirstString, IN CONST CHAR8 *SecondString, IN UINTN Length);
+RETURN_STATUS EFIAPI AsciiStrCpyS(OUT CHAR8 *Destination, IN UINTN DestMax, IN CONST CHAR8 *Source);
+UINTN EFIAPI AsciiStrDecimalToUintn(IN CONST CHAR8 *String);
+RETURN_STATUS EFIAPI UnicodeStrToAsciiStrS(IN CONST CHAR16 *Source, OUT CHAR8 *Destination, IN UINTN DestMax);
+RETURN_STATUS EFIAPI AsciiStrToUnicodeStrS(IN CONST CHAR8 *Source, OUT CHAR16 *Destination, IN UINTN DestMax);
+
+// arithmetic
+UINT64 EFIAPI LShiftU64(IN UINT64 Operand, IN UINTN Count);
+UINT64 EFIAPI RShiftU64(IN UINT64 Operand, IN UINTN Count);
+UINT64 EFIAPI ARShiftU64(IN UINT64 Operand, IN UINTN Count);
+UINT64 EFIAPI MultU64x32(IN UINT64 Multiplicand, IN UINT32 Multiplier);
+UINT64 EFIAPI MultU64x64(IN UINT64 Multiplicand, IN UINT64 Multiplier);
+INT64 EFIAPI MultS64x64(IN INT64 Multiplicand, IN INT64 Multiplier);
+UINT64 EFIAPI DivU64x32(IN UINT64 Dividend, IN UINT32 Divisor);
+UINT32 EFIAPI ModU64x32(IN UINT64 Dividend, IN UINT32 Divisor);
+UINT64 EFIAPI DivU64x32Remainder(IN UINT64 Dividend, IN UINT32 Divisor, OUT UINT32 *Remainder);
+UINT64 EFIAPI DivU64x64Remainder(IN UINT64 Dividend, IN UINT64 Divisor, OUT UINT64 *Remainder);
+INT64 EFIAPI DivS64x64Remainder(IN INT64 Dividend, IN INT64 Divisor, OUT INT64 *Remainder);
+INTN EFIAPI HighBitSet32(IN UINT32 Operand);
+INTN EFIAPI HighBitSet64(IN UINT64 Operand);
+INTN EFIAPI LowBitSet32(IN UINT32 Operand);
+INTN EFIAPI LowBitSet64(IN UINT64 Operand);
+UINT32 EFIAPI GetPowerOfTwo32(IN UINT32 Operand);
+UINT64 EFIAPI GetPowerOfTwo64(IN UINT64 Operand);
+UINT16 EFIAPI SwapBytes16(IN UINT16 Value);
+UINT32 EFIAPI SwapBytes32(IN UINT32 Value);
+UINT64 EFIAPI SwapBytes64(IN UINT64 Value);
+
+// processor
+UINT32 EFIAPI AsmCpuid(IN UINT32 Index, OUT UINT32 *Eax, OUT UINT32 *Ebx, OUT UINT32 *Ecx, OUT UINT32 *Edx);
+UINT32 EFIAPI AsmCpuidEx(IN UINT32 Index, IN UINT32 SubIndex, OUT UINT32 *Eax, OUT UINT32 *Ebx, OUT UINT32 *Ecx, OUT UINT32 *Edx);
+UINT64 EFIAPI AsmReadTsc(VOID);
+UINT64 EFIAPI AsmXGetBv(IN UINT32 Index);
+VOID EFIAPI CpuPause(VOID);
+VOID EFIAPI MemoryFence(VOID);
+VOID EFIAPI CpuBreakpoint(VOID);
+BOOLEAN EFIAPI SaveAndDisableInterrupts(VOID);
+BOOLEAN EFIAPI SetInterruptState(IN BOOLEAN InterruptState);
+
+#endif // HOST_BASE_LIB_H
@@ -0,0 +1,27 @@
+/*
+ * File:    BaseMemoryLib.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - BaseMemoryLib implemented in HostLib.c
+ */
+
+#ifndef HOST_BASE_MEMORY_LIB_H
+#define HOST_BASE_MEMORY_LIB_H
+
+#include <Uefi.h>
+
+VOID * EFIAPI CopyMem(OUT VOID *DestinationBuffer, IN CONST VOID *SourceBuffer, IN UINTN Length);
+VOID * EFIAPI SetMem(OUT VOID *Buffer, IN UINTN Length, IN UINT8 Value);
+VOID * EFIAPI SetMem16(OUT VOID *Buffer, IN UINTN Length, IN UINT16 Value);
+VOID * EFIAPI SetMem32(OUT VOID *Buffer, IN UINTN Length, IN UINT32 Value);
+VOID * EFIAPI SetMem64(OUT VOID *Buffer, IN UINTN Length, IN UINT64 Value);
+VOID * EFIAPI ZeroMem(OUT VOID *Buffer, IN UINTN Length);
+INTN EFIAPI CompareMem(IN CONST VOID *DestinationBuffer, IN CONST VOID *SourceBuffer, IN UINTN Length);
+VOID * EFIAPI ScanMem8(IN CONST VOID *Buffer, IN UINTN Length, IN UINT8 Value);
+EFI_GUID * EFIAPI CopyGuid(OUT EFI_GUID *DestinationGuid, IN CONST EFI_GUID *SourceGuid);
+BOOLEAN EFIAPI CompareGuid(IN CONST EFI_GUID *Guid1, IN CONST EFI_GUID *Guid2);
+
+#endif // HOST_BASE_MEMORY_LIB_H
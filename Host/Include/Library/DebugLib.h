@@ -0,0 +1,35 @@
+/*
+ * File:    DebugLib.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - DebugLib, DEBUG output is discarded and ASSERT aborts
+ */
+
+#ifndef HOST_DEBUG_LIB_H
+#define HOST_DEBUG_LIB_H
+
+#include <Uefi.h>
+
+#define DEBUG_INIT      0x00000001
+#define DEBUG_WARN      0x00000002
+#define DEBUG_INFO      0x00000040
+#define DEBUG_VERBOSE   0x00400000
+#define DEBUG_ERROR     0x80000000
+
+VOID EFIAPI DebugAssert(IN CONST CHAR8 *FileName, IN UINTN LineNumber, IN CONST CHAR8 *Description);
+
+#define DEBUG(Expression)
+#define DEBUG_CODE_BEGIN()  if (FALSE) {
+#define DEBUG_CODE_END()    }
+#define ASSERT(Expression) \
+    do { \
+        if (!(Expression)) { \
+            DebugAssert(__FILE__, __LINE__, #Expression); \
+        } \
+    } while (FALSE)
+#define ASSERT_EFI_ERROR(StatusParameter)   ASSERT(!EFI_ERROR(StatusParameter))
+
+#endif // HOST_DEBUG_LIB_H
@@ -0,0 +1,26 @@
+/*
+ * File:    MemoryAllocationLib.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - MemoryAllocationLib on the C library heap
+ */
+
+#ifndef HOST_MEMORY_ALLOCATION_LIB_H
+#define HOST_MEMORY_ALLOCATION_LIB_H
+
+#include <Uefi.h>
+
+VOID * EFIAPI AllocatePool(IN UINTN AllocationSize);
+VOID * EFIAPI AllocateZeroPool(IN UINTN AllocationSize);
+VOID * EFIAPI AllocateCopyPool(IN UINTN AllocationSize, IN CONST VOID *Buffer);
+VOID * EFIAPI ReallocatePool(IN UINTN OldSize, IN UINTN NewSize, IN VOID *OldBuffer OPTIONAL);
+VOID EFIAPI FreePool(IN VOID *Buffer);
+VOID * EFIAPI AllocatePages(IN UINTN Pages);
+VOID EFIAPI FreePages(IN VOID *Buffer, IN UINTN Pages);
+VOID * EFIAPI AllocateAlignedPages(IN UINTN Pages, IN UINTN Alignment);
+VOID EFIAPI FreeAlignedPages(IN VOID *Buffer, IN UINTN Pages);
+
+#endif // HOST_MEMORY_ALLOCATION_LIB_H
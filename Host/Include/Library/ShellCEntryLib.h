@@ -0,0 +1,18 @@
+/*
+ * File:    ShellCEntryLib.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - Entry point called from main() in HostUefi.c
+ */
+
+#ifndef HOST_SHELL_C_ENTRY_LIB_H
+#define HOST_SHELL_C_ENTRY_LIB_H
+
+#include <Uefi.h>
+
+INTN EFIAPI ShellAppMain(IN UINTN Argc, IN CHAR16 **Argv);
+
+#endif // HOST_SHELL_C_ENTRY_LIB_H
@@ -0,0 +1,69 @@
+/*
+ * File:    ShellLib.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - ShellLib file functions on C library streams
+ */
+
+#ifndef HOST_SHELL_LIB_H
+#define HOST_SHELL_LIB_H
+
+#include <Uefi.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Protocol/ShellParameters.h>
+
+typedef enum {
+    SHELL_SUCCESS               = 0,
+    SHELL_LOAD_ERROR            = 1,
+    SHELL_INVALID_PARAMETER     = 2,
+    SHELL_UNSUPPORTED           = 3,
+    SHELL_BAD_BUFFER_SIZE       = 4,
+    SHELL_BUFFER_TOO_SMALL      = 5,
+    SHELL_NOT_READY             = 6,
+    SHELL_DEVICE_ERROR          = 7,
+    SHELL_WRITE_PROTECTED       = 8,
+    SHELL_OUT_OF_RESOURCES      = 9,
+    SHELL_VOLUME_CORRUPTED      = 10,
+    SHELL_VOLUME_FULL           = 11,
+    SHELL_NO_MEDIA              = 12,
+    SHELL_MEDIA_CHANGED         = 13,
+    SHELL_NOT_FOUND             = 14,
+    SHELL_ACCESS_DENIED         = 15,
+    SHELL_TIMEOUT               = 18,
+    SHELL_NOT_STARTED           = 19,
+    SHELL_ALREADY_STARTED       = 20,
+    SHELL_ABORTED               = 21,
+    SHELL_INCOMPATIBLE_VERSION  = 25,
+    SHELL_SECURITY_VIOLATION    = 26,
+    SHELL_NOT_EQUAL             = 27
+} SHELL_STATUS;
+
+#define EFI_FILE_MODE_READ      0x0000000000000001ULL
+#define EFI_FILE_MODE_WRITE     0x0000000000000002ULL
+#define EFI_FILE_MODE_CREATE    0x8000000000000000ULL
+
+#define SHELL_FREE_NON_NULL(Pointer) \
+    do { \
+        if ((Pointer) != NULL) { \
+            FreePool((Pointer)); \
+            (Pointer) = NULL; \
+        } \
+    } while (FALSE)
+
+extern EFI_SHELL_PARAMETERS_PROTOCOL *gEfiShellParametersProtocol;
+
+EFI_STATUS EFIAPI ShellOpenFileByName(IN CONST CHAR16 *FileName, OUT SHELL_FILE_HANDLE *FileHandle, IN UINT64 OpenMode, IN UINT64 Attributes);
+EFI_STATUS EFIAPI ShellCloseFile(IN SHELL_FILE_HANDLE *FileHandle);
+EFI_STATUS EFIAPI ShellReadFile(IN SHELL_FILE_HANDLE FileHandle, IN OUT UINTN *ReadSize, OUT VOID *Buffer);
+EFI_STATUS EFIAPI ShellWriteFile(IN SHELL_FILE_HANDLE FileHandle, IN OUT UINTN *BufferSize, IN VOID *Buffer);
+EFI_STATUS EFIAPI ShellFlushFile(IN SHELL_FILE_HANDLE FileHandle);
+EFI_STATUS EFIAPI ShellGetFileSize(IN SHELL_FILE_HANDLE FileHandle, OUT UINT64 *Size);
+EFI_STATUS EFIAPI ShellSetFilePosition(IN SHELL_FILE_HANDLE FileHandle, IN UINT64 Position);
+EFI_STATUS EFIAPI ShellFileExists(IN CONST CHAR16 *Name);
+EFI_STATUS EFIAPI ShellDeleteFileByName(IN CONST CHAR16 *FileName);
+EFI_STATUS EFIAPI ShellDeleteFile(IN SHELL_FILE_HANDLE *FileHandle);
+
+#endif // HOST_SHELL_LIB_H
@@ -0,0 +1,21 @@
+/*
+ * File:    SynchronizationLib.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - SynchronizationLib on compiler atomics
+ */
+
+#ifndef HOST_SYNCHRONIZATION_LIB_H
+#define HOST_SYNCHRONIZATION_LIB_H
+
+#include <Uefi.h>
+
+UINT32 EFIAPI InterlockedIncrement(IN volatile UINT32 *Value);
+UINT32 EFIAPI InterlockedDecrement(IN volatile UINT32 *Value);
+UINT32 EFIAPI InterlockedCompareExchange32(IN OUT volatile UINT32 *Value, IN UINT32 CompareValue, IN UINT32 ExchangeValue);
+UINT64 EFIAPI InterlockedCompareExchange64(IN OUT volatile UINT64 *Value, IN UINT64 CompareValue, IN UINT64 ExchangeValue);
+
+#endif // HOST_SYNCHRONIZATION_LIB_H
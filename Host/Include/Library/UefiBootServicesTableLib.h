@@ -0,0 +1,20 @@
+/*
+ * File:    UefiBootServicesTableLib.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - System table globals set up by HostUefi.c
+ */
+
+#ifndef HOST_UEFI_BOOT_SERVICES_TABLE_LIB_H
+#define HOST_UEFI_BOOT_SERVICES_TABLE_LIB_H
+
+#include <Uefi.h>
+
+extern EFI_HANDLE gImageHandle;
+extern EFI_SYSTEM_TABLE *gST;
+extern EFI_BOOT_SERVICES *gBS;
+
+#endif // HOST_UEFI_BOOT_SERVICES_TABLE_LIB_H
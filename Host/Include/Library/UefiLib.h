@@ -0,0 +1,24 @@
+/*
+ * File:    UefiLib.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - UefiLib console output to stdout
+ */
+
+#ifndef HOST_UEFI_LIB_H
+#define HOST_UEFI_LIB_H
+
+#include <Uefi.h>
+// EDK2 callers get the base libraries through the UefiLib dependencies
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+
+UINTN EFIAPI Print(IN CONST CHAR16 *Format, ...);
+UINTN EFIAPI ErrorPrint(IN CONST CHAR16 *Format, ...);
+UINTN EFIAPI AsciiPrint(IN CONST CHAR8 *Format, ...);
+UINTN EFIAPI AsciiErrorPrint(IN CONST CHAR8 *Format, ...);
+
+#endif // HOST_UEFI_LIB_H
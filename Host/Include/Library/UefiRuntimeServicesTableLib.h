@@ -0,0 +1,18 @@
+/*
+ * File:    UefiRuntimeServicesTableLib.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - Runtime services global set up by HostUefi.c
+ */
+
+#ifndef HOST_UEFI_RUNTIME_SERVICES_TABLE_LIB_H
+#define HOST_UEFI_RUNTIME_SERVICES_TABLE_LIB_H
+
+#include <Uefi.h>
+
+extern EFI_RUNTIME_SERVICES *gRT;
+
+#endif // HOST_UEFI_RUNTIME_SERVICES_TABLE_LIB_H
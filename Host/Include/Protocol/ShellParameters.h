@@ -0,0 +1,28 @@
+/*
+ * File:    ShellParameters.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - Shell parameters filled in from the process arguments
+ */
+
+#ifndef HOST_SHELL_PARAMETERS_H
+#define HOST_SHELL_PARAMETERS_H
+
+#include <Uefi.h>
+
+typedef VOID *SHELL_FILE_HANDLE;
+
+typedef struct {
+    CHAR16 **Argv;
+    UINTN Argc;
+    SHELL_FILE_HANDLE StdIn;
+    SHELL_FILE_HANDLE StdOut;
+    SHELL_FILE_HANDLE StdErr;
+} EFI_SHELL_PARAMETERS_PROTOCOL;
+
+extern EFI_GUID gEfiShellParametersProtocolGuid;
+
+#endif // HOST_SHELL_PARAMETERS_H
@@ -0,0 +1,362 @@
+/*
+ * File:    Uefi.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Host build - UEFI base types, status codes and system table subset
+ * sufficient to build GraphicsTest as a Linux executable
+ */
+
+#ifndef HOST_UEFI_H
+#define HOST_UEFI_H
+
+//
+// Base types
+//
+typedef unsigned char       UINT8;
+typedef signed char         INT8;
+typedef unsigned short      UINT16;
+typedef signed short        INT16;
+typedef unsigned int        UINT32;
+typedef signed int          INT32;
+typedef unsigned long long  UINT64;
+typedef signed long long    INT64;
+typedef unsigned long       UINTN;
+typedef signed long         INTN;
+typedef unsigned char       BOOLEAN;
+typedef char                CHAR8;
+typedef unsigned short      CHAR16;     // requires -fshort-wchar for L"" strings
+#define VOID                void
+
+#define TRUE    ((BOOLEAN)(1==1))
+#define FALSE   ((BOOLEAN)(0==1))
+#ifndef NULL
+#define NULL    ((VOID *)0)
+#endif
+
+#define IN
+#define OUT
+#define OPTIONAL
+#define CONST   const
+#define STATIC  static
+#define EFIAPI
+#define GLOBAL_REMOVE_IF_UNREFERENCED
+
+#define MAX_INT8    ((INT8)0x7F)
+#define MAX_UINT8   ((UINT8)0xFF)
+#define MAX_INT16   ((INT16)0x7FFF)
+#define MAX_UINT16  ((UINT16)0xFFFF)
+#define MAX_INT32   ((INT32)0x7FFFFFFF)
+#define MAX_UINT32  ((UINT32)0xFFFFFFFF)
+#define MAX_INT64   ((INT64)0x7FFFFFFFFFFFFFFFULL)
+#define MAX_UINT64  ((UINT64)0xFFFFFFFFFFFFFFFFULL)
+#define MAX_INTN    ((INTN)0x7FFFFFFFFFFFFFFFULL)
+#define MAX_UINTN   ((UINTN)0xFFFFFFFFFFFFFFFFULL)
+#define MAX_ADDRESS MAX_UINTN
+
+#define BIT0    0x00000001
+#define BIT1    0x00000002
+#define BIT2    0x00000004
+#define BIT3    0x00000008
+#define BIT4    0x00000010
+#define BIT5    0x00000020
+#define BIT6    0x00000040
+#define BIT7    0x00000080
+#define BIT8    0x00000100
+#define BIT9    0x00000200
+#define BIT10   0x00000400
+#define BIT11   0x00000800
+#define BIT12   0x00001000
+#define BIT13   0x00002000
+#define BIT14   0x00004000
+#define BIT15   0x00008000
+#define BIT16   0x00010000
+#define BIT17   0x00020000
+#define BIT18   0x00040000
+#define BIT19   0x00080000
+#define BIT20   0x00100000
+#define BIT21   0x00200000
+#define BIT22   0x00400000
+#define BIT23   0x00800000
+#define BIT24   0x01000000
+#define BIT25   0x02000000
+#define BIT26   0x04000000
+#define BIT27   0x08000000
+#define BIT28   0x10000000
+#define BIT29   0x20000000
+#define BIT30   0x40000000
+#define BIT31   0x80000000
+
+#define ABS(a)          (((a) < 0) ? (-(a)) : (a))
+#define MIN(a, b)       (((a) < (b)) ? (a) : (b))
+#define MAX(a, b)       (((a) > (b)) ? (a) : (b))
+#define ARRAY_SIZE(Array)   (sizeof (Array) / sizeof ((Array)[0]))
+#define OFFSET_OF(TYPE, Field)  ((UINTN) __builtin_offsetof(TYPE, Field))
+#define ALIGN_VALUE(Value, Alignment)   ((Value) + (((Alignment) - (Value)) & ((Alignment) - 1U)))
+#define ALIGN_POINTER(Pointer, Alignment)   ((VOID *) (ALIGN_VALUE ((UINTN)(Pointer), (Alignment))))
+#define BASE_CR(Record, TYPE, Field)    ((TYPE *) ((CHAR8 *) (Record) - OFFSET_OF (TYPE, Field)))
+#define SIGNATURE_16(A, B)          ((A) | (B << 8))
+#define SIGNATURE_32(A, B, C, D)    (SIGNATURE_16 (A, B) | (SIGNATURE_16 (C, D) << 16))
+
+typedef __builtin_va_list VA_LIST;
+#define VA_START(Marker, Parameter) __builtin_va_start (Marker, Parameter)
+#define VA_ARG(Marker, TYPE)        ((sizeof (TYPE) < sizeof (UINTN)) ? (TYPE)(__builtin_va_arg (Marker, UINTN)) : (TYPE)(__builtin_va_arg (Marker, TYPE)))
+#define VA_END(Marker)              __builtin_va_end (Marker)
+#define VA_COPY(Dest, Start)        __builtin_va_copy (Dest, Start)
+
+//
+// Status codes
+//
+typedef UINTN   RETURN_STATUS;
+typedef UINTN   EFI_STATUS;
+
+#define MAX_BIT                 0x8000000000000000ULL
+#define ENCODE_ERROR(StatusCode)    ((RETURN_STATUS)(MAX_BIT | (StatusCode)))
+#define ENCODE_WARNING(StatusCode)  ((RETURN_STATUS)(StatusCode))
+#define RETURN_ERROR(StatusCode)    (((INTN)(RETURN_STATUS)(StatusCode)) < 0)
+#define EFI_ERROR(A)                RETURN_ERROR(A)
+
+#define EFI_SUCCESS                 0
+#define EFI_LOAD_ERROR              ENCODE_ERROR (1)
+#define EFI_INVALID_PARAMETER       ENCODE_ERROR (2)
+#define EFI_UNSUPPORTED             ENCODE_ERROR (3)
+#define EFI_BAD_BUFFER_SIZE         ENCODE_ERROR (4)
+#define EFI_BUFFER_TOO_SMALL        ENCODE_ERROR (5)
+#define EFI_NOT_READY               ENCODE_ERROR (6)
+#define EFI_DEVICE_ERROR            ENCODE_ERROR (7)
+#define EFI_WRITE_PROTECTED         ENCODE_ERROR (8)
+#define EFI_OUT_OF_RESOURCES        ENCODE_ERROR (9)
+#define EFI_VOLUME_CORRUPTED        ENCODE_ERROR (10)
+#define EFI_VOLUME_FULL             ENCODE_ERROR (11)
+#define EFI_NO_MEDIA                ENCODE_ERROR (12)
+#define EFI_MEDIA_CHANGED           ENCODE_ERROR (13)
+#define EFI_NOT_FOUND               ENCODE_ERROR (14)
+#define EFI_ACCESS_DENIED           ENCODE_ERROR (15)
+#define EFI_NO_RESPONSE             ENCODE_ERROR (16)
+#define EFI_NO_MAPPING              ENCODE_ERROR (17)
+#define EFI_TIMEOUT                 ENCODE_ERROR (18)
+#define EFI_NOT_STARTED             ENCODE_ERROR (19)
+#define EFI_ALREADY_STARTED         ENCODE_ERROR (20)
+#define EFI_ABORTED                 ENCODE_ERROR (21)
+#define EFI_ICMP_ERROR              ENCODE_ERROR (22)
+#define EFI_TFTP_ERROR              ENCODE_ERROR (23)
+#define EFI_PROTOCOL_ERROR          ENCODE_ERROR (24)
+#define EFI_INCOMPATIBLE_VERSION    ENCODE_ERROR (25)
+#define EFI_SECURITY_VIOLATION      ENCODE_ERROR (26)
+#define EFI_CRC_ERROR               ENCODE_ERROR (27)
+#define EFI_END_OF_MEDIA            ENCODE_ERROR (28)
+#define EFI_END_OF_FILE             ENCODE_ERROR (31)
+#define EFI_INVALID_LANGUAGE        ENCODE_ERROR (32)
+#define EFI_COMPROMISED_DATA        ENCODE_ERROR (33)
+#define EFI_WARN_UNKNOWN_GLYPH      ENCODE_WARNING (1)
+#define EFI_WARN_DELETE_FAILURE     ENCODE_WARNING (2)
+#define EFI_WARN_WRITE_FAILURE      ENCODE_WARNING (3)
+#define EFI_WARN_BUFFER_TOO_SMALL   ENCODE_WARNING (4)
+
+//
+// Common UEFI types
+//
+typedef struct {
+    UINT32 Data1;
+    UINT16 Data2;
+    UINT16 Data3;
+    UINT8 Data4[8];
+} EFI_GUID;
+
+typedef VOID    *EFI_HANDLE;
+typedef VOID    *EFI_EVENT;
+typedef UINTN   EFI_TPL;
+typedef UINT64  EFI_LBA;
+typedef UINT64  EFI_PHYSICAL_ADDRESS;
+typedef UINT64  EFI_VIRTUAL_ADDRESS;
+
+#define EFI_PAGE_SIZE               0x1000
+#define EFI_PAGE_MASK               0xFFF
+#define EFI_PAGE_SHIFT              12
+#define EFI_SIZE_TO_PAGES(Size)     (((Size) >> EFI_PAGE_SHIFT) + (((Size) & EFI_PAGE_MASK) ? 1 : 0))
+#define EFI_PAGES_TO_SIZE(Pages)    ((Pages) << EFI_PAGE_SHIFT)
+
+typedef struct {
+    UINT16 Year;
+    UINT8 Month;
+    UINT8 Day;
+    UINT8 Hour;
+    UINT8 Minute;
+    UINT8 Second;
+    UINT8 Pad1;
+    UINT32 Nanosecond;
+    INT16 TimeZone;
+    UINT8 Daylight;
+    UINT8 Pad2;
+} EFI_TIME;
+
+typedef struct {
+    UINT32 Resolution;
+    UINT32 Accuracy;
+    BOOLEAN SetsToZero;
+} EFI_TIME_CAPABILITIES;
+
+//
+// Task priority levels and events
+//
+#define TPL_APPLICATION     4
+#define TPL_CALLBACK        8
+#define TPL_NOTIFY          16
+#define TPL_HIGH_LEVEL      31
+
+#define EVT_TIMER                           0x80000000
+#define EVT_RUNTIME                         0x40000000
+#define EVT_NOTIFY_WAIT                     0x00000100
+#define EVT_NOTIFY_SIGNAL                   0x00000200
+
+typedef VOID (EFIAPI *EFI_EVENT_NOTIFY)(IN EFI_EVENT Event, IN VOID *Context);
+
+typedef enum {
+    TimerCancel,
+    TimerPeriodic,
+    TimerRelative
+} EFI_TIMER_DELAY;
+
+typedef enum {
+    AllocateAnyPages,
+    AllocateMaxAddress,
+    AllocateAddress,
+    MaxAllocateType
+} EFI_ALLOCATE_TYPE;
+
+typedef enum {
+    EfiReservedMemoryType,
+    EfiLoaderCode,
+    EfiLoaderData,
+    EfiBootServicesCode,
+    EfiBootServicesData,
+    EfiRuntimeServicesCode,
+    EfiRuntimeServicesData,
+    EfiConventionalMemory,
+    EfiMaxMemoryType = 16
+} EFI_MEMORY_TYPE;
+
+typedef enum {
+    AllHandles,
+    ByRegisterNotify,
+    ByProtocol
+} EFI_LOCATE_SEARCH_TYPE;
+
+#define EFI_OPEN_PROTOCOL_BY_HANDLE_PROTOCOL    0x00000001
+#define EFI_OPEN_PROTOCOL_GET_PROTOCOL          0x00000002
+#define EFI_OPEN_PROTOCOL_TEST_PROTOCOL         0x00000004
+#define EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER   0x00000008
+#define EFI_OPEN_PROTOCOL_BY_DRIVER             0x00000010
+#define EFI_OPEN_PROTOCOL_EXCLUSIVE             0x00000020
+
+//
+// Console protocols
+//
+typedef struct {
+    UINT16 ScanCode;
+    CHAR16 UnicodeChar;
+} EFI_INPUT_KEY;
+
+#define CHAR_NULL               0x0000
+#define CHAR_BACKSPACE          0x0008
+#define CHAR_TAB                0x0009
+#define CHAR_LINEFEED           0x000A
+#define CHAR_CARRIAGE_RETURN    0x000D
+#define SCAN_NULL               0x0000
+#define SCAN_UP                 0x0001
+#define SCAN_DOWN               0x0002
+#define SCAN_RIGHT              0x0003
+#define SCAN_LEFT               0x0004
+#define SCAN_ESC                0x0017
+
+typedef struct _EFI_SIMPLE_TEXT_INPUT_PROTOCOL EFI_SIMPLE_TEXT_INPUT_PROTOCOL;
+struct _EFI_SIMPLE_TEXT_INPUT_PROTOCOL {
+    EFI_STATUS (EFIAPI *Reset)(IN EFI_SIMPLE_TEXT_INPUT_PROTOCOL *This, IN BOOLEAN ExtendedVerification);
+    EFI_STATUS (EFIAPI *ReadKeyStroke)(IN EFI_SIMPLE_TEXT_INPUT_PROTOCOL *This, OUT EFI_INPUT_KEY *Key);
+    EFI_EVENT WaitForKey;
+};
+
+typedef struct {
+    INT32 MaxMode;
+    INT32 Mode;
+    INT32 Attribute;
+    INT32 CursorColumn;
+    INT32 CursorRow;
+    BOOLEAN CursorVisible;
+} EFI_SIMPLE_TEXT_OUTPUT_MODE;
+
+#define EFI_BLACK           0x00
+#define EFI_BLUE            0x01
+#define EFI_GREEN           0x02
+#define EFI_CYAN            0x03
+#define EFI_RED             0x04
+#define EFI_MAGENTA         0x05
+#define EFI_BROWN           0x06
+#define EFI_LIGHTGRAY       0x07
+#define EFI_DARKGRAY        0x08
+#define EFI_YELLOW          0x0E
+#define EFI_WHITE           0x0F
+#define EFI_TEXT_ATTR(Foreground, Background)   ((Foreground) | ((Background) << 4))
+
+typedef struct _EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL;
+struct _EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL {
+    EFI_STATUS (EFIAPI *Reset)(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN BOOLEAN ExtendedVerification);
+    EFI_STATUS (EFIAPI *OutputString)(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN CHAR16 *String);
+    EFI_STATUS (EFIAPI *TestString)(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN CHAR16 *String);
+    EFI_STATUS (EFIAPI *QueryMode)(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN UINTN ModeNumber, OUT UINTN *Columns, OUT UINTN *Rows);
+    EFI_STATUS (EFIAPI *SetMode)(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN UINTN ModeNumber);
+    EFI_STATUS (EFIAPI *SetAttribute)(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN UINTN Attribute);
+    EFI_STATUS (EFIAPI *ClearScreen)(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This);
+    EFI_STATUS (EFIAPI *SetCursorPosition)(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN UINTN Column, IN UINTN Row);
+    EFI_STATUS (EFIAPI *EnableCursor)(IN EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *This, IN BOOLEAN Visible);
+    EFI_SIMPLE_TEXT_OUTPUT_MODE *Mode;
+};
+
+//
+// Boot and runtime services, members not provided by the host are NULL
+//
+typedef struct {
+    EFI_TPL (EFIAPI *RaiseTPL)(IN EFI_TPL NewTpl);
+    VOID (EFIAPI *RestoreTPL)(IN EFI_TPL OldTpl);
+    EFI_STATUS (EFIAPI *AllocatePages)(IN EFI_ALLOCATE_TYPE Type, IN EFI_MEMORY_TYPE MemoryType, IN UINTN Pages, IN OUT EFI_PHYSICAL_ADDRESS *Memory);
+    EFI_STATUS (EFIAPI *FreePages)(IN EFI_PHYSICAL_ADDRESS Memory, IN UINTN Pages);
+    EFI_STATUS (EFIAPI *AllocatePool)(IN EFI_MEMORY_TYPE PoolType, IN UINTN Size, OUT VOID **Buffer);
+    EFI_STATUS (EFIAPI *FreePool)(IN VOID *Buffer);
+    EFI_STATUS (EFIAPI *CreateEvent)(IN UINT32 Type, IN EFI_TPL NotifyTpl, IN EFI_EVENT_NOTIFY NotifyFunction, IN VOID *NotifyContext, OUT EFI_EVENT *Event);
+    EFI_STATUS (EFIAPI *SetTimer)(IN EFI_EVENT Event, IN EFI_TIMER_DELAY Type, IN UINT64 TriggerTime);
+    EFI_STATUS (EFIAPI *WaitForEvent)(IN UINTN NumberOfEvents, IN EFI_EVENT *Event, OUT UINTN *Index);
+    EFI_STATUS (EFIAPI *SignalEvent)(IN EFI_EVENT Event);
+    EFI_STATUS (EFIAPI *CloseEvent)(IN EFI_EVENT Event);
+    EFI_STATUS (EFIAPI *CheckEvent)(IN EFI_EVENT Event);
+    EFI_STATUS (EFIAPI *HandleProtocol)(IN EFI_HANDLE Handle, IN EFI_GUID *Protocol, OUT VOID **Interface);
+    EFI_STATUS (EFIAPI *Stall)(IN UINTN Microseconds);
+    EFI_STATUS (EFIAPI *SetWatchdogTimer)(IN UINTN Timeout, IN UINT64 WatchdogCode, IN UINTN DataSize, IN CHAR16 *WatchdogData);
+    EFI_STATUS (EFIAPI *OpenProtocol)(IN EFI_HANDLE Handle, IN EFI_GUID *Protocol, OUT VOID **Interface, IN EFI_HANDLE AgentHandle, IN EFI_HANDLE ControllerHandle, IN UINT32 Attributes);
+    EFI_STATUS (EFIAPI *CloseProtocol)(IN EFI_HANDLE Handle, IN EFI_GUID *Protocol, IN EFI_HANDLE AgentHandle, IN EFI_HANDLE ControllerHandle);
+    EFI_STATUS (EFIAPI *LocateHandleBuffer)(IN EFI_LOCATE_SEARCH_TYPE SearchType, IN EFI_GUID *Protocol, IN VOID *SearchKey, OUT UINTN *NoHandles, OUT EFI_HANDLE **Buffer);
+    EFI_STATUS (EFIAPI *LocateProtocol)(IN EFI_GUID *Protocol, IN VOID *Registration, OUT VOID **Interface);
+    VOID (EFIAPI *CopyMem)(IN VOID *Destination, IN VOID *Source, IN UINTN Length);
+    VOID (EFIAPI *SetMem)(IN VOID *Buffer, IN UINTN Size, IN UINT8 Value);
+} EFI_BOOT_SERVICES;
+
+typedef struct {
+    EFI_STATUS (EFIAPI *GetTime)(OUT EFI_TIME *Time, OUT EFI_TIME_CAPABILITIES *Capabilities);
+    EFI_STATUS (EFIAPI *SetTime)(IN EFI_TIME *Time);
+} EFI_RUNTIME_SERVICES;
+
+typedef struct {
+    CHAR16 *FirmwareVendor;
+    UINT32 FirmwareRevision;
+    EFI_HANDLE ConsoleInHandle;
+    EFI_SIMPLE_TEXT_INPUT_PROTOCOL *ConIn;
+    EFI_HANDLE ConsoleOutHandle;
+    EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *ConOut;
+    EFI_HANDLE StandardErrorHandle;
+    EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *StdErr;
+    EFI_RUNTIME_SERVICES *RuntimeServices;
+    EFI_BOOT_SERVICES *BootServices;
+} EFI_SYSTEM_TABLE;
+
+#endif // HOST_UEFI_H
@@ -0,0 +1,248 @@
+/*
+ * File:    Parallel.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Screen tiles of large fills spread across the APs with work stealing
+ */
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Protocol/MpService.h>
+#include "Parallel.h"
+#include "Fill.h"
+
+#define PROBE_TIMEOUT_US    100000
+
+// run of tile indices, next taken from the front and end stolen from the
+// back, packed so both ends are updated with one compare exchange
+typedef struct {
+    volatile UINT64 Range;      // next in bits 0-31, end in bits 32-63
+    UINT8 Pad[56];              // a cache line each
+} TILE_QUEUE;
+
+typedef struct {
+    FILL_KERNEL Kernel;
+    BOOLEAN Supported;
+} AP_PROBE;
+
+STATIC EFI_MP_SERVICES_PROTOCOL *Mp = NULL;
+STATIC UINT32 NumCpus = 1;                          // BSP and APs in use
+STATIC UINTN ApNumber[MAX_PARALLEL_CPUS];           // MP Services number of each AP
+STATIC EFI_EVENT ApDone[MAX_PARALLEL_CPUS];         // signalled when its worker exits
+STATIC TILE_QUEUE Queue[MAX_PARALLEL_CPUS];
+
+// current job, written by the BSP before bumping JobGeneration
+STATIC TILE_FUNC JobFunc;
+STATIC VOID *JobContext;
+STATIC INT32 JobX0, JobY0, JobX1, JobY1;
+STATIC INT32 JobTileX, JobTileY;                    // first tile column and row
+STATIC UINT32 JobTilesAcross;
+STATIC volatile UINT32 JobGeneration;
+STATIC volatile UINT32 JobPending;                  // APs still working on the job
+STATIC volatile BOOLEAN ApExit;
+
+STATIC VOID EFIAPI ApProbe(IN OUT VOID *Buffer);
+STATIC VOID EFIAPI ApWorker(IN OUT VOID *Buffer);
+STATIC BOOLEAN TakeTile(IN UINT32 Cpu, IN BOOLEAN Steal, OUT UINT32 *Tile);
+STATIC VOID RunTiles(IN UINT32 Cpu);
+
+/*
+ * ApProbe() - Check the AP supports the fill kernel in use, the firmware
+ *             may not have enabled AVX on it
+ */
+STATIC VOID EFIAPI ApProbe(IN OUT VOID *Buffer)
+{
+    AP_PROBE *Probe = (AP_PROBE *)Buffer;
+
+    Probe->Supported = CpuFillKernelSupported(Probe->Kernel);
+}
+
+/*
+ * InitParallel() - Start workers on up to Cpus - 1 APs, fewer if there
+ *                  aren't enough usable, none without MP Services
+ */
+EFI_STATUS InitParallel(IN UINT32 Cpus)
+{
+    EFI_STATUS Status;
+    UINTN NumProcessors, NumEnabled, Bsp;
+    AP_PROBE Probe;
+
+    FreeParallel();
+    if (Cpus <= 1) {
+        return EFI_SUCCESS;
+    }
+    Status = gBS->LocateProtocol(&gEfiMpServiceProtocolGuid, NULL, (VOID **)&Mp);
+    if (EFI_ERROR(Status)) {
+        Mp = NULL;
+        return Status;
+    }
+    Status = Mp->GetNumberOfProcessors(Mp, &NumProcessors, &NumEnabled);
+    if (EFI_ERROR(Status)) {
+        goto Error_exit;
+    }
+    Status = Mp->WhoAmI(Mp, &Bsp);
+    if (EFI_ERROR(Status)) {
+        goto Error_exit;
+    }
+    Cpus = MIN(Cpus, MAX_PARALLEL_CPUS);
+    ApExit = FALSE;
+    JobGeneration = 0;
+    Probe.Kernel = GetFillKernel();
+    for (UINTN n = 0; n < NumProcessors && NumCpus < Cpus; n++) {
+        EFI_PROCESSOR_INFORMATION Info;
+        if (n == Bsp || EFI_ERROR(Mp->GetProcessorInfo(Mp, n, &Info)) || !(Info.StatusFlag & PROCESSOR_ENABLED_BIT)) {
+            continue;
+        }
+        Probe.Supported = FALSE;
+        if (EFI_ERROR(Mp->StartupThisAP(Mp, ApProbe, n, NULL, PROBE_TIMEOUT_US, &Probe, NULL)) || !Probe.Supported) {
+            continue;
+        }
+        Status = gBS->CreateEvent(0, 0, NULL, NULL, &ApDone[NumCpus]);
+        if (EFI_ERROR(Status)) {
+            goto Error_exit;
+        }
+        Status = Mp->StartupThisAP(Mp, ApWorker, n, ApDone[NumCpus], 0, (VOID *)(UINTN)NumCpus, NULL);
+        if (EFI_ERROR(Status)) {
+            gBS->CloseEvent(ApDone[NumCpus]);
+            continue;
+        }
+        ApNumber[NumCpus++] = n;
+    }
+    return EFI_SUCCESS;
+
+Error_exit:
+    FreeParallel();
+    return Status;
+}
+
+/*
+ * FreeParallel() - Stop the workers, after which everything runs on the BSP
+ */
+VOID FreeParallel(VOID)
+{
+    UINTN Index;
+
+    ApExit = TRUE;
+    for (UINT32 Cpu = 1; Cpu < NumCpus; Cpu++) {
+        gBS->WaitForEvent(1, &ApDone[Cpu], &Index);
+        gBS->CloseEvent(ApDone[Cpu]);
+    }
+    NumCpus = 1;
+    Mp = NULL;
+}
+
+/*
+ * GetParallelCpus() - CPUs fills are spread across, the BSP included
+ */
+UINT32 GetParallelCpus(VOID)
+{
+    return NumCpus;
+}
+
+/*
+ * TakeTile() - Next tile from the front of a CPU's run, or the last from
+ *              the back when stealing, FALSE once the run is empty
+ */
+STATIC BOOLEAN TakeTile(IN UINT32 Cpu, IN BOOLEAN Steal, OUT UINT32 *Tile)
+{
+    UINT64 Old, New;
+
+    do {
+        Old = Queue[Cpu].Range;
+        UINT32 Next = (UINT32)Old;
+        UINT32 End = (UINT32)(Old >> 32);
+        if (Next >= End) {
+            return FALSE;
+        }
+        if (Steal) {
+            *Tile = End - 1;
+            New = LShiftU64(End - 1, 32) | Next;
+        } else {
+            *Tile = Next;
+            New = LShiftU64(End, 32) | (Next + 1);
+        }
+    } while (InterlockedCompareExchange64(&Queue[Cpu].Range, Old, New) != Old);
+    return TRUE;
+}
+
+/*
+ * RunTiles() - Draw tiles from a CPU's own run, then steal from the others
+ *              in turn until every run is empty
+ */
+STATIC VOID RunTiles(IN UINT32 Cpu)
+{
+    UINT32 Tile;
+
+    for (UINT32 i = 0; i < NumCpus; i++) {
+        UINT32 Victim = (Cpu + i) % NumCpus;
+        while (TakeTile(Victim, Victim != Cpu, &Tile)) {
+            INT32 tx = JobTileX + (INT32)(Tile % JobTilesAcross);
+            INT32 ty = JobTileY + (INT32)(Tile / JobTilesAcross);
+            JobFunc(JobContext, MAX(tx * TILE_WIDTH, JobX0), MAX(ty * TILE_HEIGHT, JobY0),
+                    MIN(tx * TILE_WIDTH + TILE_WIDTH - 1, JobX1), MIN(ty * TILE_HEIGHT + TILE_HEIGHT - 1, JobY1));
+        }
+    }
+}
+
+/*
+ * ApWorker() - Spin until a job is published, run it and wait for the next
+ */
+STATIC VOID EFIAPI ApWorker(IN OUT VOID *Buffer)
+{
+    UINT32 Cpu = (UINT32)(UINTN)Buffer;
+    UINT32 Seen = 0;    // generation when the workers were started
+
+    while (!ApExit) {
+        if (JobGeneration == Seen) {
+            CpuPause();
+            continue;
+        }
+        Seen = JobGeneration;
+        RunTiles(Cpu);
+        InterlockedDecrement(&JobPending);
+    }
+}
+
+/*
+ * ParallelTiles() - Call Func for each screen tile of an inclusive rectangle
+ *                   on the screen across the CPUs in use, returns once all
+ *                   are drawn
+ */
+VOID ParallelTiles(IN INT32 x0, IN INT32 y0, IN INT32 x1, IN INT32 y1, IN TILE_FUNC Func, IN VOID *Context)
+{
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+    if (NumCpus <= 1 || (UINT64)(x1 - x0 + 1) * (UINT64)(y1 - y0 + 1) < PARALLEL_MIN_PIXELS) {
+        Func(Context, x0, y0, x1, y1);
+        return;
+    }
+    JobFunc = Func;
+    JobContext = Context;
+    JobX0 = x0;
+    JobY0 = y0;
+    JobX1 = x1;
+    JobY1 = y1;
+    JobTileX = x0 / TILE_WIDTH;
+    JobTileY = y0 / TILE_HEIGHT;
+    JobTilesAcross = (UINT32)(x1 / TILE_WIDTH - JobTileX + 1);
+    UINT32 Tiles = JobTilesAcross * (UINT32)(y1 / TILE_HEIGHT - JobTileY + 1);
+    // contiguous runs keep each CPU on neighbouring scanlines
+    for (UINT32 Cpu = 0; Cpu < NumCpus; Cpu++) {
+        UINT32 Start = (UINT32)DivU64x32((UINT64)Tiles * Cpu, NumCpus);
+        UINT32 End = (UINT32)DivU64x32((UINT64)Tiles * (Cpu + 1), NumCpus);
+        Queue[Cpu].Range = LShiftU64(End, 32) | Start;
+    }
+    JobPending = NumCpus - 1;
+    // a locked increment orders the job before its generation
+    InterlockedIncrement(&JobGeneration);
+    RunTiles(0);
+    while (JobPending) {
+        CpuPause();
+    }
+}
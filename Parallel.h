@@ -0,0 +1,38 @@
+/*
+ * File:    Parallel.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Screen tiles of large fills spread across the APs with work stealing
+ *
+ * InitParallel() starts a worker on each AP in use with MP Services, which
+ * spins until the BSP publishes a job. ParallelTiles() cuts a rectangle into
+ * screen aligned tiles, gives each CPU a contiguous run of them and joins
+ * in on the BSP. A CPU takes tiles from the front of its own run and, once
+ * that is empty, steals from the back of another CPU's run, so a slow or
+ * late CPU doesn't hold up the job. Areas under PARALLEL_MIN_PIXELS aren't
+ * worth waking the APs for and are done on the BSP. Tile functions run on
+ * the APs, so they may only touch memory, not call boot services.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <Uefi.h>
+
+#define MAX_PARALLEL_CPUS       64
+#define TILE_WIDTH              256             // pixels, tiles are aligned to the screen
+#define TILE_HEIGHT             32
+#define PARALLEL_MIN_PIXELS     (128 * 1024)    // smaller areas are done on the BSP
+
+// draw the part of a job in an inclusive tile rectangle
+typedef VOID (*TILE_FUNC)(IN VOID *Context, IN INT32 x0, IN INT32 y0, IN INT32 x1, IN INT32 y1);
+
+EFI_STATUS InitParallel(IN UINT32 Cpus);
+VOID FreeParallel(VOID);
+UINT32 GetParallelCpus(VOID);
+VOID ParallelTiles(IN INT32 x0, IN INT32 y0, IN INT32 x1, IN INT32 y1, IN TILE_FUNC Func, IN VOID *Context);
+
+#endif // PARALLEL_H
@@ -0,0 +1,303 @@
+/*
+ * File:    PixelCount.c
+ * 
+ * Author:  David Petrovic
+ * 
+ * Description:
+ * 
+ * Pixels written by the graphics primitives, counted with reference
+ * rasterization against the clip window
+ */
+
+#include <Uefi.h>
+#include "PixelCount.h"
+#include "Stats.h"
+
+// clip window, inclusive
+STATIC INT32 ClipX0 = 0;
+STATIC INT32 ClipY0 = 0;
+STATIC INT32 ClipX1 = 0;
+STATIC INT32 ClipY1 = 0;
+
+/*
+ * SetPixelCountClip() - Must match the graphics library clip window or the screen
+ */
+VOID SetPixelCountClip(INT32 x0, INT32 y0, INT32 x1, INT32 y1)
+{
+    ClipX0 = x0;
+    ClipY0 = y0;
+    ClipX1 = x1;
+    ClipY1 = y1;
+}
+
+/*
+ * GetPixelCountClip()
+ */
+VOID GetPixelCountClip(INT32 *x0, INT32 *y0, INT32 *x1, INT32 *y1)
+{
+    *x0 = ClipX0;
+    *y0 = ClipY0;
+    *x1 = ClipX1;
+    *y1 = ClipY1;
+}
+
+/*
+ * CountSpan() - Pixels of horizontal span x0...x1 inclusive inside clip window
+ */
+STATIC UINT64 CountSpan(INT32 x0, INT32 x1, INT32 y)
+{
+    if (y < ClipY0 || y > ClipY1) return 0;
+    if (x0 > x1) {
+        INT32 t = x0; x0 = x1; x1 = t;
+    }
+    if (x0 < ClipX0) x0 = ClipX0;
+    if (x1 > ClipX1) x1 = ClipX1;
+    return (x1 >= x0) ? (UINT64)(x1 - x0 + 1) : 0;
+}
+
+/*
+ * CountColumn() - Pixels of vertical span y0...y1 inclusive inside clip window
+ */
+STATIC UINT64 CountColumn(INT32 x, INT32 y0, INT32 y1)
+{
+    if (x < ClipX0 || x > ClipX1) return 0;
+    if (y0 > y1) {
+        INT32 t = y0; y0 = y1; y1 = t;
+    }
+    if (y0 < ClipY0) y0 = ClipY0;
+    if (y1 > ClipY1) y1 = ClipY1;
+    return (y1 >= y0) ? (UINT64)(y1 - y0 + 1) : 0;
+}
+
+/*
+ * CountPoint()
+ */
+UINT64 CountPoint(INT32 x, INT32 y)
+{
+    return (x >= ClipX0 && x <= ClipX1 && y >= ClipY0 && y <= ClipY1) ? 1 : 0;
+}
+
+/*
+ * CountHLine() - w pixels from x
+ */
+UINT64 CountHLine(INT32 x, INT32 y, INT32 w)
+{
+    return w > 0 ? CountSpan(x, x + w - 1, y) : 0;
+}
+
+/*
+ * CountVLine() - h pixels from y
+ */
+UINT64 CountVLine(INT32 x, INT32 y, INT32 h)
+{
+    return h > 0 ? CountColumn(x, y, y + h - 1) : 0;
+}
+
+/*
+ * CountLine() - Bresenham, one pixel per step along the major axis
+ */
+UINT64 CountLine(INT32 x0, INT32 y0, INT32 x1, INT32 y1)
+{
+    if (y0 == y1) return CountSpan(x0, x1, y0);
+    if (x0 == x1) return CountColumn(x0, y0, y1);
+    INT32 dx = ABS(x1 - x0);
+    INT32 dy = -ABS(y1 - y0);
+    INT32 sx = x0 < x1 ? 1 : -1;
+    INT32 sy = y0 < y1 ? 1 : -1;
+    INT32 err = dx + dy;
+    UINT64 Count = 0;
+    while (TRUE) {
+        Count += CountPoint(x0, y0);
+        if (x0 == x1 && y0 == y1) break;
+        INT32 e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+    return Count;
+}
+
+/*
+ * CountRectangle() - Corners inclusive
+ */
+UINT64 CountRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, BOOLEAN Filled)
+{
+    INT32 ymin = MIN(y0, y1);
+    INT32 ymax = MAX(y0, y1);
+    if (Filled) {
+        if (ymin < ClipY0) ymin = ClipY0;
+        if (ymax > ClipY1) ymax = ClipY1;
+        return (ymax >= ymin) ? CountSpan(x0, x1, ymin) * (UINT64)(ymax - ymin + 1) : 0;
+    }
+    UINT64 Count = CountSpan(x0, x1, ymin);
+    if (ymax == ymin) return Count;
+    Count += CountSpan(x0, x1, ymax);
+    if (ymax - ymin > 1) {
+        Count += CountColumn(x0, ymin + 1, ymax - 1);
+        if (x1 != x0) {
+            Count += CountColumn(x1, ymin + 1, ymax - 1);
+        }
+    }
+    return Count;
+}
+
+/*
+ * EdgeX() - x where edge a->b crosses row y, rounded to nearest
+ */
+STATIC INT32 EdgeX(INT32 xa, INT32 ya, INT32 xb, INT32 yb, INT32 y)
+{
+    INT64 Num = (INT64)(y - ya) * (xb - xa);
+    INT64 Den = yb - ya;
+    INT64 Half = Den / 2;
+    return xa + (INT32)((Num >= 0 ? Num + Half : Num - Half) / Den);
+}
+
+/*
+ * CountTriangle() - Outline is three lines, fill is one span per row
+ */
+UINT64 CountTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, BOOLEAN Filled)
+{
+    if (!Filled) {
+        return CountLine(x0, y0, x1, y1) + CountLine(x1, y1, x2, y2) + CountLine(x2, y2, x0, y0);
+    }
+    // sort vertices by y
+    INT32 t;
+    if (y0 > y1) { t = y0; y0 = y1; y1 = t; t = x0; x0 = x1; x1 = t; }
+    if (y1 > y2) { t = y1; y1 = y2; y2 = t; t = x1; x1 = x2; x2 = t; }
+    if (y0 > y1) { t = y0; y0 = y1; y1 = t; t = x0; x0 = x1; x1 = t; }
+    if (y0 == y2) {
+        return CountSpan(MIN(x0, MIN(x1, x2)), MAX(x0, MAX(x1, x2)), y0);
+    }
+    INT32 ystart = MAX(y0, ClipY0);
+    INT32 yend = MIN(y2, ClipY1);
+    UINT64 Count = 0;
+    for (INT32 y = ystart; y <= yend; y++) {
+        INT32 xa = EdgeX(x0, y0, x2, y2, y);
+        INT32 xb;
+        if (y < y1) {
+            xb = EdgeX(x0, y0, x1, y1, y);
+        } else if (y1 == y2) {
+            xb = x1;
+        } else {
+            xb = EdgeX(x1, y1, x2, y2, y);
+        }
+        Count += CountSpan(xa, xb, y);
+    }
+    return Count;
+}
+
+/*
+ * FloorDiv() - n / d rounded down, d is positive
+ */
+STATIC INT64 FloorDiv(INT64 n, INT64 d)
+{
+    return n >= 0 ? n / d : -((-n + d - 1) / d);
+}
+
+/*
+ * EdgeSpan() - Narrow span x0...x1 of row y to the pixels inside edge a->b
+ *              of a clockwise triangle, pixels on the edge are inside only
+ *              if it is a top or left edge
+ */
+STATIC VOID EdgeSpan(INT64 xa, INT64 ya, INT64 xb, INT64 yb, INT64 y, INT64 *x0, INT64 *x1)
+{
+    INT64 A = ya - yb;
+    INT64 B = xb - xa;
+    INT64 Bias = (A > 0 || (A == 0 && B > 0)) ? 0 : 1;
+    // inside where A x + K >= 0
+    INT64 K = B * (y - ya) - A * xa - Bias;
+
+    if (A > 0) {
+        *x0 = MAX(*x0, FloorDiv(-K + A - 1, A));
+    } else if (A < 0) {
+        *x1 = MIN(*x1, FloorDiv(K, -A));
+    } else if (K < 0) {
+        *x1 = *x0 - 1;
+    }
+}
+
+/*
+ * CountHalfSpaceTriangle() - Fill by the half-space rasterizer of the batch
+ *                            calls, one span per row inside all three edges
+ */
+UINT64 CountHalfSpaceTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2)
+{
+    INT64 Area = (INT64)(x1 - x0) * (y2 - y0) - (INT64)(y1 - y0) * (x2 - x0);
+    INT32 t;
+
+    if (Area == 0) {
+        return 0;
+    }
+    if (Area < 0) {
+        t = x1; x1 = x2; x2 = t;
+        t = y1; y1 = y2; y2 = t;
+    }
+    INT32 ystart = MAX(MIN(y0, MIN(y1, y2)), ClipY0);
+    INT32 yend = MIN(MAX(y0, MAX(y1, y2)), ClipY1);
+    UINT64 Count = 0;
+    for (INT32 y = ystart; y <= yend; y++) {
+        INT64 xs = MAX(MIN(x0, MIN(x1, x2)), ClipX0);
+        INT64 xe = MIN(MAX(x0, MAX(x1, x2)), ClipX1);
+        EdgeSpan(x0, y0, x1, y1, y, &xs, &xe);
+        EdgeSpan(x1, y1, x2, y2, y, &xs, &xe);
+        EdgeSpan(x2, y2, x0, y0, y, &xs, &xe);
+        if (xe >= xs) {
+            Count += (UINT64)(xe - xs + 1);
+        }
+    }
+    return Count;
+}
+
+/*
+ * CountCircle() - Outline is midpoint circle with eight points per step,
+ *                 fill is one span per row
+ */
+UINT64 CountCircle(INT32 xc, INT32 yc, INT32 r, BOOLEAN Filled)
+{
+    UINT64 Count = 0;
+
+    if (r < 0) return 0;
+    if (Filled) {
+        for (INT32 dy = -r; dy <= r; dy++) {
+            INT32 dx = (INT32)ISqrt64((UINT64)((INT64)r * r - (INT64)dy * dy));
+            Count += CountSpan(xc - dx, xc + dx, yc + dy);
+        }
+        return Count;
+    }
+    INT32 x = r;
+    INT32 y = 0;
+    INT32 err = 1 - r;
+    while (x >= y) {
+        Count += CountPoint(xc + x, yc + y) + CountPoint(xc - x, yc + y);
+        Count += CountPoint(xc + x, yc - y) + CountPoint(xc - x, yc - y);
+        Count += CountPoint(xc + y, yc + x) + CountPoint(xc - y, yc + x);
+        Count += CountPoint(xc + y, yc - x) + CountPoint(xc - y, yc - x);
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+    return Count;
+}
+
+/*
+ * CountCircleSpans() - Circle drawn from a span table, each pixel once
+ */
+UINT64 CountCircleSpans(INT32 xc, INT32 yc, INT32 r, BOOLEAN Filled, CONST CIRCLE_SPAN *Spans)
+{
+    UINT64 Count = 0;
+
+    for (INT32 dy = -r; dy <= r; dy++) {
+        CONST CIRCLE_SPAN *s = &Spans[ABS(dy)];
+        if (Filled) {
+            Count += CountSpan(xc - s->Fill, xc + s->Fill, yc + dy);
+        } else if (s->Inner == 0) {
+            Count += CountSpan(xc - s->Outer, xc + s->Outer, yc + dy);
+        } else {
+            Count += CountSpan(xc - s->Outer, xc - s->Inner, yc + dy) + CountSpan(xc + s->Inner, xc + s->Outer, yc + dy);
+        }
+    }
+    return Count;
+}
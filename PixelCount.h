@@ -0,0 +1,32 @@
+/*
+ * File:    PixelCount.h
+ * 
+ * Author:  David Petrovic
+ *
+ * Description:
+ * 
+ * Pixels written by the graphics primitives, counted with reference
+ * rasterization against the clip window
+ */
+
+#ifndef PIXEL_COUNT_H
+#define PIXEL_COUNT_H
+
+#include <Uefi.h>
+#include "CircleCache.h"
+
+#define BYTES_PER_PIXEL 4
+
+VOID SetPixelCountClip(INT32 x0, INT32 y0, INT32 x1, INT32 y1);
+VOID GetPixelCountClip(INT32 *x0, INT32 *y0, INT32 *x1, INT32 *y1);
+UINT64 CountPoint(INT32 x, INT32 y);
+UINT64 CountHLine(INT32 x, INT32 y, INT32 w);
+UINT64 CountVLine(INT32 x, INT32 y, INT32 h);
+UINT64 CountLine(INT32 x0, INT32 y0, INT32 x1, INT32 y1);
+UINT64 CountRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, BOOLEAN Filled);
+UINT64 CountTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, BOOLEAN Filled);
+UINT64 CountHalfSpaceTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2);
+UINT64 CountCircle(INT32 xc, INT32 yc, INT32 r, BOOLEAN Filled);
+UINT64 CountCircleSpans(INT32 xc, INT32 yc, INT32 r, BOOLEAN Filled, CONST CIRCLE_SPAN *Spans);
+
+#endif // PIXEL_COUNT_H
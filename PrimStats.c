@@ -0,0 +1,257 @@
+/*
+ * File:    PrimStats.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Per-primitive work counters, compiled in with PRIM_STATS_SUPPORT=1
+ */
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include "PrimStats.h"
+#include "PixelCount.h"
+
+STATIC PRIM_STATS Counters;
+STATIC BOOLEAN Counting = FALSE;
+
+STATIC CHAR16 *PrimDesc[NUM_PRIMS] = {
+    L"PutPixel",
+    L"DrawLine",
+    L"DrawHLine",
+    L"DrawVLine",
+    L"DrawTriangle",
+    L"DrawRectangle",
+    L"DrawCircle",
+    L"DrawFillTriangle",
+    L"DrawFillRectangle",
+    L"DrawFillCircle",
+    L"ClearScreen",
+    L"ClearClipWindow",
+    L"GPutString",
+    L"DisplayRenderBuffer"
+};
+
+/*
+ * PrimStatsSupported() - TRUE if the counting wrappers are built
+ */
+BOOLEAN PrimStatsSupported(VOID)
+{
+    return PRIM_STATS_SUPPORT;
+}
+
+/*
+ * EnablePrimStats() - Start or stop counting, counts are kept
+ */
+VOID EnablePrimStats(BOOLEAN Enable)
+{
+    Counting = Enable && PRIM_STATS_SUPPORT;
+}
+
+/*
+ * ResetPrimStats()
+ */
+VOID ResetPrimStats(VOID)
+{
+    ZeroMem(&Counters, sizeof(PRIM_STATS));
+}
+
+/*
+ * GetPrimStats()
+ */
+VOID GetPrimStats(OUT PRIM_STATS *Stats)
+{
+    *Stats = Counters;
+}
+
+/*
+ * GetPrimDesc()
+ */
+CHAR16 *GetPrimDesc(PRIM_TYPE Prim)
+{
+    return Prim < NUM_PRIMS ? PrimDesc[Prim] : L"Unknown";
+}
+
+#if PRIM_STATS_SUPPORT
+#define MAX_RENDER_BUFFERS  8
+
+// render buffer sizes, the library type is opaque here
+typedef struct {
+    RENDER_BUFFER *RenBuf;
+    UINT32 Width;
+    UINT32 Height;
+} RENDER_BUFFER_SIZE;
+
+STATIC RENDER_BUFFER_SIZE RenderSizes[MAX_RENDER_BUFFERS];
+
+/*
+ * RecordPrim() - Count a call from its pixels inside the clip window and on
+ *                the screen
+ */
+STATIC VOID RecordPrim(PRIM_TYPE Prim, UINT64 Pixels, UINT64 OnScreen)
+{
+    PRIM_COUNTERS *c = &Counters.Prim[Prim];
+
+    c->Calls++;
+    c->Pixels += Pixels;
+    c->Clipped += OnScreen > Pixels ? OnScreen - Pixels : 0;
+    if (!Pixels) {
+        c->Rejected++;
+    }
+}
+
+// reference count against the screen then the clip window in force
+#define COUNT_PRIM(Prim, CountExpr) \
+    do { \
+        if (Counting) { \
+            INT32 cx0, cy0, cx1, cy1; \
+            GetPixelCountClip(&cx0, &cy0, &cx1, &cy1); \
+            SetPixelCountClip(0, 0, GetFBHorRes() - 1, GetFBVerRes() - 1); \
+            UINT64 OnScreen = (CountExpr); \
+            SetPixelCountClip(cx0, cy0, cx1, cy1); \
+            RecordPrim(Prim, (CountExpr), OnScreen); \
+        } \
+    } while (FALSE)
+
+VOID StatPutPixel(INT32 x, INT32 y, UINT32 Colour)
+{
+    COUNT_PRIM(PRIM_PUT_PIXEL, CountPoint(x, y));
+    PutPixel(x, y, Colour);
+}
+
+VOID StatDrawLine(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 Colour)
+{
+    COUNT_PRIM(PRIM_DRAW_LINE, CountLine(x0, y0, x1, y1));
+    DrawLine(x0, y0, x1, y1, Colour);
+}
+
+VOID StatDrawHLine(INT32 x, INT32 y, UINT32 w, UINT32 Colour)
+{
+    COUNT_PRIM(PRIM_DRAW_HLINE, CountHLine(x, y, (INT32)w));
+    DrawHLine(x, y, w, Colour);
+}
+
+VOID StatDrawVLine(INT32 x, INT32 y, UINT32 h, UINT32 Colour)
+{
+    COUNT_PRIM(PRIM_DRAW_VLINE, CountVLine(x, y, (INT32)h));
+    DrawVLine(x, y, h, Colour);
+}
+
+VOID StatDrawTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 Colour)
+{
+    COUNT_PRIM(PRIM_DRAW_TRIANGLE, CountTriangle(x0, y0, x1, y1, x2, y2, FALSE));
+    DrawTriangle(x0, y0, x1, y1, x2, y2, Colour);
+}
+
+VOID StatDrawRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 Colour)
+{
+    COUNT_PRIM(PRIM_DRAW_RECTANGLE, CountRectangle(x0, y0, x1, y1, FALSE));
+    DrawRectangle(x0, y0, x1, y1, Colour);
+}
+
+VOID StatDrawCircle(INT32 xc, INT32 yc, INT32 r, UINT32 Colour)
+{
+    COUNT_PRIM(PRIM_DRAW_CIRCLE, CountCircle(xc, yc, r, FALSE));
+    DrawCircle(xc, yc, r, Colour);
+}
+
+VOID StatDrawFillTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 Colour)
+{
+    COUNT_PRIM(PRIM_FILL_TRIANGLE, CountTriangle(x0, y0, x1, y1, x2, y2, TRUE));
+    DrawFillTriangle(x0, y0, x1, y1, x2, y2, Colour);
+}
+
+VOID StatDrawFillRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 Colour)
+{
+    COUNT_PRIM(PRIM_FILL_RECTANGLE, CountRectangle(x0, y0, x1, y1, TRUE));
+    DrawFillRectangle(x0, y0, x1, y1, Colour);
+}
+
+VOID StatDrawFillCircle(INT32 xc, INT32 yc, INT32 r, UINT32 Colour)
+{
+    COUNT_PRIM(PRIM_FILL_CIRCLE, CountCircle(xc, yc, r, TRUE));
+    DrawFillCircle(xc, yc, r, Colour);
+}
+
+// whole screen regardless of the clip window
+VOID StatClearScreen(UINT32 Colour)
+{
+    if (Counting) {
+        UINT64 Pixels = (UINT64)GetFBHorRes() * GetFBVerRes();
+        RecordPrim(PRIM_CLEAR_SCREEN, Pixels, Pixels);
+    }
+    ClearScreen(Colour);
+}
+
+VOID StatClearClipWindow(UINT32 Colour)
+{
+    if (Counting) {
+        INT32 cx0, cy0, cx1, cy1;
+        GetPixelCountClip(&cx0, &cy0, &cx1, &cy1);
+        UINT64 Pixels = (UINT64)(cx1 - cx0 + 1) * (UINT64)(cy1 - cy0 + 1);
+        RecordPrim(PRIM_CLEAR_CLIP_WINDOW, Pixels, Pixels);
+    }
+    ClearClipWindow(Colour);
+}
+
+// character cells, transparent text writes fewer pixels than this
+VOID StatGPutString(INT32 x, INT32 y, CHAR16 *String, UINT32 FgColour, UINT32 BgColour, BOOLEAN Opaque, FONT Font)
+{
+    INT32 Width = (INT32)(StrLen(String) * GetFontWidth(Font));
+    INT32 Height = (INT32)GetFontHeight(Font);
+    COUNT_PRIM(PRIM_PUT_STRING, Width ? CountRectangle(x, y, x + Width - 1, y + Height - 1, TRUE) : 0);
+    GPutString(x, y, String, FgColour, BgColour, Opaque, Font);
+}
+
+EFI_STATUS StatCreateRenderBuffer(RENDER_BUFFER *RenBuf, UINT32 Width, UINT32 Height)
+{
+    EFI_STATUS Status = CreateRenderBuffer(RenBuf, Width, Height);
+    if (!EFI_ERROR(Status)) {
+        for (UINTN i = 0; i < MAX_RENDER_BUFFERS; i++) {
+            if (!RenderSizes[i].RenBuf) {
+                RenderSizes[i].RenBuf = RenBuf;
+                RenderSizes[i].Width = Width;
+                RenderSizes[i].Height = Height;
+                break;
+            }
+        }
+    }
+    return Status;
+}
+
+VOID StatDestroyRenderBuffer(RENDER_BUFFER *RenBuf)
+{
+    for (UINTN i = 0; i < MAX_RENDER_BUFFERS; i++) {
+        if (RenderSizes[i].RenBuf == RenBuf) {
+            RenderSizes[i].RenBuf = NULL;
+        }
+    }
+    DestroyRenderBuffer(RenBuf);
+}
+
+// Blt bytes are the on screen part of the buffer
+EFI_STATUS StatDisplayRenderBuffer(RENDER_BUFFER *RenBuf, INT32 x, INT32 y)
+{
+    if (Counting) {
+        for (UINTN i = 0; i < MAX_RENDER_BUFFERS; i++) {
+            RENDER_BUFFER_SIZE *Size = &RenderSizes[i];
+            if (Size->RenBuf == RenBuf) {
+                INT32 x1 = x + (INT32)Size->Width - 1;
+                INT32 y1 = y + (INT32)Size->Height - 1;
+                INT32 cx0, cy0, cx1, cy1;
+                GetPixelCountClip(&cx0, &cy0, &cx1, &cy1);
+                SetPixelCountClip(0, 0, GetFBHorRes() - 1, GetFBVerRes() - 1);
+                UINT64 OnScreen = CountRectangle(x, y, x1, y1, TRUE);
+                SetPixelCountClip(cx0, cy0, cx1, cy1);
+                RecordPrim(PRIM_DISPLAY_RENDER_BUFFER, CountRectangle(x, y, x1, y1, TRUE), OnScreen);
+                Counters.Prim[PRIM_DISPLAY_RENDER_BUFFER].BltCalls++;
+                Counters.Prim[PRIM_DISPLAY_RENDER_BUFFER].BltBytes += OnScreen * BYTES_PER_PIXEL;
+                break;
+            }
+        }
+    }
+    return DisplayRenderBuffer(RenBuf, x, y);
+}
+#endif // PRIM_STATS_SUPPORT
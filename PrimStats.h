@@ -0,0 +1,106 @@
+/*
+ * File:    PrimStats.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Per-primitive work counters, compiled in with PRIM_STATS_SUPPORT=1
+ *
+ * With support built, a file defining PRIM_STATS_HOOK has the graphics
+ * primitives redirected to counting wrappers, so the counters sit on every
+ * call without changing the callers. Counting only happens between
+ * EnablePrimStats(TRUE) and EnablePrimStats(FALSE). Without support the
+ * primitives are called directly and the counters stay zero.
+ */
+
+#ifndef PRIM_STATS_H
+#define PRIM_STATS_H
+
+#include <Uefi.h>
+#include "GraphicsLib/Graphics.h"
+
+#ifndef PRIM_STATS_SUPPORT
+#define PRIM_STATS_SUPPORT 0
+#endif
+
+typedef enum {
+    PRIM_PUT_PIXEL,
+    PRIM_DRAW_LINE,
+    PRIM_DRAW_HLINE,
+    PRIM_DRAW_VLINE,
+    PRIM_DRAW_TRIANGLE,
+    PRIM_DRAW_RECTANGLE,
+    PRIM_DRAW_CIRCLE,
+    PRIM_FILL_TRIANGLE,
+    PRIM_FILL_RECTANGLE,
+    PRIM_FILL_CIRCLE,
+    PRIM_CLEAR_SCREEN,
+    PRIM_CLEAR_CLIP_WINDOW,
+    PRIM_PUT_STRING,
+    PRIM_DISPLAY_RENDER_BUFFER,
+    NUM_PRIMS
+} PRIM_TYPE;
+
+typedef struct {
+    UINT64 Calls;
+    UINT64 Pixels;      // written inside the clip window
+    UINT64 Clipped;     // on screen but outside the clip window
+    UINT64 Rejected;    // calls writing no pixels
+    UINT64 BltCalls;    // render buffer copies to the screen
+    UINT64 BltBytes;
+} PRIM_COUNTERS;
+
+typedef struct {
+    PRIM_COUNTERS Prim[NUM_PRIMS];
+} PRIM_STATS;
+
+BOOLEAN PrimStatsSupported(VOID);
+VOID EnablePrimStats(BOOLEAN Enable);
+VOID ResetPrimStats(VOID);
+VOID GetPrimStats(OUT PRIM_STATS *Stats);
+CHAR16 *GetPrimDesc(PRIM_TYPE Prim);
+
+#if PRIM_STATS_SUPPORT
+VOID StatPutPixel(INT32 x, INT32 y, UINT32 Colour);
+VOID StatDrawLine(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 Colour);
+VOID StatDrawHLine(INT32 x, INT32 y, UINT32 w, UINT32 Colour);
+VOID StatDrawVLine(INT32 x, INT32 y, UINT32 h, UINT32 Colour);
+VOID StatDrawTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 Colour);
+VOID StatDrawRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 Colour);
+VOID StatDrawCircle(INT32 xc, INT32 yc, INT32 r, UINT32 Colour);
+VOID StatDrawFillTriangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, INT32 x2, INT32 y2, UINT32 Colour);
+VOID StatDrawFillRectangle(INT32 x0, INT32 y0, INT32 x1, INT32 y1, UINT32 Colour);
+VOID StatDrawFillCircle(INT32 xc, INT32 yc, INT32 r, UINT32 Colour);
+VOID StatClearScreen(UINT32 Colour);
+VOID StatClearClipWindow(UINT32 Colour);
+VOID StatGPutString(INT32 x, INT32 y, CHAR16 *String, UINT32 FgColour, UINT32 BgColour, BOOLEAN Opaque, FONT Font);
+EFI_STATUS StatCreateRenderBuffer(RENDER_BUFFER *RenBuf, UINT32 Width, UINT32 Height);
+VOID StatDestroyRenderBuffer(RENDER_BUFFER *RenBuf);
+EFI_STATUS StatDisplayRenderBuffer(RENDER_BUFFER *RenBuf, INT32 x, INT32 y);
+
+#endif // PRIM_STATS_SUPPORT
+
+#endif // PRIM_STATS_H
+
+// Redirect the primitives to the wrappers in a file that defines
+// PRIM_STATS_HOOK before including this header after the library headers
+#if PRIM_STATS_SUPPORT && defined(PRIM_STATS_HOOK) && !defined(PRIM_STATS_HOOKED)
+#define PRIM_STATS_HOOKED
+#define PutPixel                StatPutPixel
+#define DrawLine                StatDrawLine
+#define DrawHLine               StatDrawHLine
+#define DrawVLine               StatDrawVLine
+#define DrawTriangle            StatDrawTriangle
+#define DrawRectangle           StatDrawRectangle
+#define DrawCircle              StatDrawCircle
+#define DrawFillTriangle        StatDrawFillTriangle
+#define DrawFillRectangle       StatDrawFillRectangle
+#define DrawFillCircle          StatDrawFillCircle
+#define ClearScreen             StatClearScreen
+#define ClearClipWindow         StatClearClipWindow
+#define GPutString              StatGPutString
+#define CreateRenderBuffer      StatCreateRenderBuffer
+#define DestroyRenderBuffer     StatDestroyRenderBuffer
+#define DisplayRenderBuffer     StatDisplayRenderBuffer
+#endif
@@ -0,0 +1,155 @@
+/*
+ * File:    Profile.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * TSC stamped zone profiler recorded to a ring buffer and written as a
+ * Chrome trace-event JSON file
+ */
+
+#include <Uefi.h>
+#include <Library/UefiLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/ShellLib.h>
+#include "Profile.h"
+#include "Sink.h"
+
+#define PROFILE_NAME_LEN    64
+
+BOOLEAN gProfileEnabled = FALSE;
+
+STATIC PROFILE_ZONE *Zones = NULL;
+STATIC UINT32 NextZone = 0;     // ring index of the next zone
+STATIC UINT64 TotalZones = 0;   // recorded since creation, including overwritten
+
+/*
+ * CreateProfile() - Allocate the ring buffer and start recording
+ */
+EFI_STATUS CreateProfile(VOID)
+{
+    if (Zones) {
+        return EFI_SUCCESS;
+    }
+    Zones = (PROFILE_ZONE *)AllocateZeroPool(PROFILE_MAX_ZONES * sizeof(PROFILE_ZONE));
+    if (!Zones) {
+        return EFI_OUT_OF_RESOURCES;
+    }
+    NextZone = 0;
+    TotalZones = 0;
+    gProfileEnabled = TRUE;
+    return EFI_SUCCESS;
+}
+
+/*
+ * DestroyProfile()
+ */
+VOID DestroyProfile(VOID)
+{
+    gProfileEnabled = FALSE;
+    if (Zones) {
+        FreePool(Zones);
+        Zones = NULL;
+    }
+}
+
+/*
+ * RecordProfileZone() - Add a completed zone, overwriting the oldest when full
+ */
+VOID RecordProfileZone(IN CONST CHAR16 *Name, IN UINT64 Start, IN UINT64 End)
+{
+    PROFILE_ZONE *Zone = &Zones[NextZone];
+
+    Zone->Name = Name;
+    Zone->Start = Start;
+    Zone->End = End;
+    NextZone = (NextZone + 1) % PROFILE_MAX_ZONES;
+    TotalZones++;
+}
+
+/*
+ * JsonName() - ASCII copy of a zone name with JSON string escapes
+ */
+STATIC VOID JsonName(IN CONST CHAR16 *Name, OUT CHAR8 *Buffer, IN UINTN Size)
+{
+    UINTN n = 0;
+
+    for (; *Name && n + 3 < Size; Name++) {
+        CHAR16 c = *Name;
+        if (c == L'"' || c == L'\\') {
+            Buffer[n++] = '\\';
+        }
+        Buffer[n++] = (c >= 0x20 && c < 0x7F) ? (CHAR8)c : '?';
+    }
+    Buffer[n] = '\0';
+}
+
+/*
+ * WriteProfileTrace() - Write recorded zones as Chrome trace-event complete
+ *                       events, times in us relative to the earliest zone
+ */
+EFI_STATUS WriteProfileTrace(IN CHAR16 *Filename)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+    SHELL_FILE_HANDLE FileHandle = NULL;
+    OUTPUT_SINK Sink;
+    CHAR8 Name[PROFILE_NAME_LEN];
+
+    ZeroMem(&Sink, sizeof(OUTPUT_SINK));
+
+    if (!Zones) {
+        Status = EFI_NOT_READY;
+        goto Error_exit;
+    }
+    // file is replaced, opening with create doesn't truncate
+    if (ShellFileExists(Filename) == EFI_SUCCESS) {
+        Status = ShellDeleteFileByName(Filename);
+        if (EFI_ERROR(Status)) {
+            goto Error_exit;
+        }
+    }
+    Status = ShellOpenFileByName(Filename, &FileHandle, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0);
+    if (EFI_ERROR(Status)) {
+        goto Error_exit;
+    }
+    Status = CreateSink(&Sink, FileHandle, SINK_DEFAULT_SIZE);
+    if (EFI_ERROR(Status)) {
+        goto Error_exit;
+    }
+
+    UINT32 Num = TotalZones < PROFILE_MAX_ZONES ? (UINT32)TotalZones : PROFILE_MAX_ZONES;
+    UINT32 First = TotalZones < PROFILE_MAX_ZONES ? 0 : NextZone;
+    UINT64 Base = MAX_UINT64;
+    for (UINT32 i = 0; i < Num; i++) {
+        if (Zones[i].Start < Base) {
+            Base = Zones[i].Start;
+        }
+    }
+
+    Status = SinkPrint(&Sink, L"{\"displayTimeUnit\":\"ns\",\"otherData\":{\"timerHz\":%lu,\"droppedZones\":%lu},\n\"traceEvents\":[\n",
+                      GetTimerFreq(), TotalZones - Num);
+    if (EFI_ERROR(Status)) goto Error_exit;
+    for (UINT32 i = 0; i < Num; i++) {
+        PROFILE_ZONE *Zone = &Zones[(First + i) % PROFILE_MAX_ZONES];
+        UINT64 Ts = CyclesToNs(Zone->Start - Base);
+        UINT64 Dur = CyclesToNs(Zone->End - Zone->Start);
+        JsonName(Zone->Name, Name, sizeof(Name));
+        Status = SinkPrint(&Sink, L"{\"name\":\"%a\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%lu.%03lu,\"dur\":%lu.%03lu}%s\n",
+                          Name, Ts / 1000, Ts % 1000, Dur / 1000, Dur % 1000, i + 1 < Num ? L"," : L"");
+        if (EFI_ERROR(Status)) goto Error_exit;
+    }
+    Status = SinkPrint(&Sink, L"]}\n");
+    if (!EFI_ERROR(Status)) {
+        Status = FlushSink(&Sink);
+    }
+
+Error_exit:
+    DestroySink(&Sink);
+    if (FileHandle) {
+        ShellCloseFile(&FileHandle);
+    }
+    return Status;
+}
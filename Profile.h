@@ -0,0 +1,56 @@
+/*
+ * File:    Profile.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * TSC stamped zone profiler recorded to a ring buffer and written as a
+ * Chrome trace-event JSON file
+ *
+ * A zone is timed between PROFILE_BEGIN and PROFILE_END in the same block:
+ *
+ *     PROFILE_BEGIN(ModeZone);
+ *     Status = SetGraphicsMode(Mode);
+ *     PROFILE_END(ModeZone, L"SetGraphicsMode");
+ *
+ * Zones nest by time so only the end is recorded. The name must be a static
+ * string as only the pointer is kept. Recording is off until CreateProfile()
+ * and the ring keeps the most recent PROFILE_MAX_ZONES zones. Defining
+ * PROFILE_SUPPORT as 0 compiles the zones out.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <Uefi.h>
+#include "Timer.h"
+
+#ifndef PROFILE_SUPPORT
+#define PROFILE_SUPPORT 1
+#endif
+
+#define PROFILE_MAX_ZONES   16384
+
+typedef struct {
+    CONST CHAR16 *Name;
+    UINT64 Start;       // TSC
+    UINT64 End;         // TSC
+} PROFILE_ZONE;
+
+extern BOOLEAN gProfileEnabled;
+
+#if PROFILE_SUPPORT
+#define PROFILE_BEGIN(Zone)         UINT64 Zone = gProfileEnabled ? ReadTimer() : 0
+#define PROFILE_END(Zone, Name)     do { if (gProfileEnabled) RecordProfileZone(Name, Zone, ReadTimer()); } while (FALSE)
+#else
+#define PROFILE_BEGIN(Zone)
+#define PROFILE_END(Zone, Name)
+#endif
+
+EFI_STATUS CreateProfile(VOID);
+VOID DestroyProfile(VOID);
+VOID RecordProfileZone(IN CONST CHAR16 *Name, IN UINT64 Start, IN UINT64 End);
+EFI_STATUS WriteProfileTrace(IN CHAR16 *Filename);
+
+#endif // PROFILE_H
@@ -8,9 +8,12 @@
  * EDK2 Pseudo-random number generator
  * 
  * Ref: https://opensource.apple.com/source/Libc/Libc-1353.11.2/stdlib/FreeBSD/rand.c
+ *      https://prng.di.unimi.it/xoshiro128plus.c
+ *      https://arxiv.org/abs/1805.10941 (multiply-shift range reduction)
  */
  
 #include <Uefi.h>
+#include <Library/BaseLib.h>
 #include "Rand.h"
 
 STATIC UINT32 next = 1;
@@ -44,3 +47,118 @@ void Srand(UINT32 seed)
 {
     next = seed;
 }
+
+/*
+ * SplitMix64() - Seed sequence, distinct outputs for each state
+ */
+STATIC UINT64 SplitMix64(UINT64 *x)
+{
+    UINT64 z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = MultU64x64(z ^ (z >> 30), 0xBF58476D1CE4E5B9ULL);
+    z = MultU64x64(z ^ (z >> 27), 0x94D049BB133111EBULL);
+    return z ^ (z >> 31);
+}
+
+/*
+ * RandSeed() - Seed a generator, each Stream of a Seed is independent
+ */
+VOID RandSeed(RAND_STATE *Rng, UINT64 Seed, UINT64 Stream)
+{
+    UINT64 x = Seed ^ MultU64x64(Stream + 1, 0xD1B54A32D192ED03ULL);
+
+    for (UINTN l = 0; l < RAND_LANES; l++) {
+        UINT64 a = SplitMix64(&x);
+        UINT64 b = SplitMix64(&x);
+        Rng->S[0][l] = (UINT32)a;
+        Rng->S[1][l] = (UINT32)(a >> 32);
+        Rng->S[2][l] = (UINT32)b;
+        Rng->S[3][l] = (UINT32)(b >> 32) | 1;   // state can't be all zero
+    }
+    Rng->Next = RAND_LANES;
+}
+
+/*
+ * RandLanes() - Step every lane, one output each
+ */
+STATIC VOID RandLanes(RAND_STATE *Rng, UINT32 *Out)
+{
+    for (UINTN l = 0; l < RAND_LANES; l++) {
+        UINT32 s0 = Rng->S[0][l];
+        UINT32 s1 = Rng->S[1][l];
+        UINT32 s2 = Rng->S[2][l];
+        UINT32 s3 = Rng->S[3][l];
+        UINT32 t = s1 << 9;
+        Out[l] = s0 + s3;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        Rng->S[0][l] = s0;
+        Rng->S[1][l] = s1;
+        Rng->S[2][l] = s2;
+        Rng->S[3][l] = (s3 << 11) | (s3 >> 21);
+    }
+}
+
+/*
+ * RandNext() - Random 32-bit value
+ */
+UINT32 RandNext(RAND_STATE *Rng)
+{
+    if (Rng->Next >= RAND_LANES) {
+        RandLanes(Rng, Rng->Buffer);
+        Rng->Next = 0;
+    }
+    return Rng->Buffer[Rng->Next++];
+}
+
+/*
+ * RandBounded() - Random value in [0, Range), 0 if Range is 0
+ *
+ * The high half of value * Range is the result. The low half is only below
+ * Range for a small fraction of values, and only then is the division for
+ * the rejection threshold needed.
+ */
+UINT32 RandBounded(RAND_STATE *Rng, UINT32 Range)
+{
+    UINT64 m = (UINT64)RandNext(Rng) * Range;
+
+    if ((UINT32)m < Range) {
+        UINT32 Threshold = (0U - Range) % Range;
+        while ((UINT32)m < Threshold) {
+            m = (UINT64)RandNext(Rng) * Range;
+        }
+    }
+    return (UINT32)(m >> 32);
+}
+
+/*
+ * RandFill() - Fill an array with random values in [0, Range), or full 32-bit
+ *              values if Range is 0
+ *
+ * Whole steps of all lanes go straight to the array, then values are reduced
+ * in a second pass with one division per call for the rejection threshold.
+ */
+VOID RandFill(RAND_STATE *Rng, UINT32 *Values, UINTN Num, UINT32 Range)
+{
+    UINTN i = 0;
+
+    for (; i + RAND_LANES <= Num; i += RAND_LANES) {
+        RandLanes(Rng, &Values[i]);
+    }
+    for (; i < Num; i++) {
+        Values[i] = RandNext(Rng);
+    }
+    if (!Range) {
+        return;
+    }
+    UINT32 Threshold = (0U - Range) % Range;
+    for (i = 0; i < Num; i++) {
+        UINT64 m = (UINT64)Values[i] * Range;
+        while ((UINT32)m < Threshold) {
+            m = (UINT64)RandNext(Rng) * Range;
+        }
+        Values[i] = (UINT32)(m >> 32);
+    }
+}
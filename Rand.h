@@ -6,6 +6,13 @@
  * Description:
  * 
  * EDK2 Pseudo-random number generator
+ *
+ * Rand() is the original Park-Miller generator, kept to reproduce earlier
+ * runs. RAND_STATE is a faster xoshiro128+ generator with explicit state so
+ * streams are independent. Its state is RAND_LANES generators interleaved so
+ * each step is a loop over lanes the compiler can vectorise. Bounded values
+ * use multiply-shift range reduction, with rejection of the rare biased
+ * values so there is no modulo bias.
  */
 
 #ifndef RAND_H
@@ -22,4 +29,17 @@ extern INT32 Rand(VOID);
 /* Seed the random number generator with the given number */
 extern VOID Srand(UINT32 seed);
 
+#define RAND_LANES  4
+
+typedef struct {
+    UINT32 S[4][RAND_LANES];    // xoshiro128+ state words of each lane
+    UINT32 Buffer[RAND_LANES];  // output of the last step
+    UINT32 Next;                // next unused output in Buffer
+} RAND_STATE;
+
+VOID RandSeed(RAND_STATE *Rng, UINT64 Seed, UINT64 Stream);
+UINT32 RandNext(RAND_STATE *Rng);
+UINT32 RandBounded(RAND_STATE *Rng, UINT32 Range);
+VOID RandFill(RAND_STATE *Rng, UINT32 *Values, UINTN Num, UINT32 Range);
+
 #endif // RAND_H
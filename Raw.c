@@ -0,0 +1,88 @@
+/*
+ * File:    Raw.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Per-iteration raw samples, cycles and parameters of each call
+ */
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+#include "Raw.h"
+
+/*
+ * CreateRawSamples()
+ */
+EFI_STATUS CreateRawSamples(RAW_SAMPLES *Raw, UINT32 Size)
+{
+    EFI_STATUS Status;
+
+    ZeroMem(Raw, sizeof(RAW_SAMPLES));
+    Status = ArenaCreate(&Raw->Arena, (UINTN)Size * sizeof(RAW_SAMPLE));
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    Raw->Samples = (RAW_SAMPLE *)ArenaAlloc(&Raw->Arena, (UINTN)Size * sizeof(RAW_SAMPLE), 0);
+    Raw->Size = Size;
+    return EFI_SUCCESS;
+}
+
+/*
+ * DestroyRawSamples()
+ */
+VOID DestroyRawSamples(RAW_SAMPLES *Raw)
+{
+    ArenaDestroy(&Raw->Arena);
+    ZeroMem(Raw, sizeof(RAW_SAMPLES));
+}
+
+/*
+ * ResetRawSamples() - Start a trial, totals are kept
+ */
+VOID ResetRawSamples(RAW_SAMPLES *Raw)
+{
+    Raw->Num = 0;
+    Raw->Dropped = 0;
+}
+
+/*
+ * RecordRawSample()
+ */
+VOID RecordRawSample(RAW_SAMPLES *Raw, UINT64 Cycles, WORKLOAD_ENTRY *Entry)
+{
+    if (Raw->Num < Raw->Size) {
+        RAW_SAMPLE *Sample = &Raw->Samples[Raw->Num++];
+        Sample->Cycles = Cycles;
+        Sample->Entry = *Entry;
+    } else {
+        Raw->Dropped++;
+    }
+}
+
+/*
+ * WriteRawHeader() - CSV column names
+ */
+EFI_STATUS WriteRawHeader(OUTPUT_SINK *Sink)
+{
+    return SinkPrint(Sink, L"hor_res,ver_res,test,run,trial,iteration,cycles,p0,p1,p2,p3,p4,p5,colour\n");
+}
+
+/*
+ * WriteRawSamples() - CSV row per sample of the current trial
+ */
+EFI_STATUS WriteRawSamples(RAW_SAMPLES *Raw, OUTPUT_SINK *Sink, UINT32 HorRes, UINT32 VerRes, CONST CHAR16 *Test, CONST CHAR16 *Run, UINT32 Trial)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+
+    for (UINT32 i = 0; i < Raw->Num && !EFI_ERROR(Status); i++) {
+        RAW_SAMPLE *Sample = &Raw->Samples[i];
+        INT32 *P = Sample->Entry.P;
+        Status = SinkPrint(Sink, L"%u,%u,%s,%s,%u,%u,%lu,%d,%d,%d,%d,%d,%d,%u\n", HorRes, VerRes, Test, Run, Trial, i,
+                           Sample->Cycles, P[0], P[1], P[2], P[3], P[4], P[5], Sample->Entry.Colour);
+    }
+    Raw->TotalWritten += Raw->Num;
+    Raw->TotalDropped += Raw->Dropped;
+    return Status;
+}
@@ -0,0 +1,50 @@
+/*
+ * File:    Raw.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Per-iteration raw samples, cycles and parameters of each call
+ *
+ * Samples are kept in a preallocated buffer during a timed trial and written
+ * to an output sink after it, so no output happens inside the timed loop.
+ * Samples past the buffer size are counted as dropped. The cycles of a call
+ * have the minimum overhead of a timed call subtracted, and neither timer
+ * reads nor recording a sample count toward the run time, though the stores
+ * still take data cache from the calls.
+ */
+
+#ifndef RAW_H
+#define RAW_H
+
+#include <Uefi.h>
+#include "Arena.h"
+#include "Workload.h"
+#include "Sink.h"
+
+#define RAW_MAX_SAMPLES 0x100000    // per trial (1M)
+
+typedef struct {
+    UINT64 Cycles;          // TSC cycles of the call less the timer reads
+    WORKLOAD_ENTRY Entry;   // call parameters
+} RAW_SAMPLE;
+
+typedef struct {
+    ARENA Arena;
+    RAW_SAMPLE *Samples;
+    UINT32 Size;            // buffer size in samples
+    UINT32 Num;             // samples in current trial
+    UINT32 Dropped;         // samples not kept in current trial
+    UINT64 TotalWritten;    // samples written since creation
+    UINT64 TotalDropped;    // samples dropped since creation
+} RAW_SAMPLES;
+
+EFI_STATUS CreateRawSamples(RAW_SAMPLES *Raw, UINT32 Size);
+VOID DestroyRawSamples(RAW_SAMPLES *Raw);
+VOID ResetRawSamples(RAW_SAMPLES *Raw);
+VOID RecordRawSample(RAW_SAMPLES *Raw, UINT64 Cycles, WORKLOAD_ENTRY *Entry);
+EFI_STATUS WriteRawHeader(OUTPUT_SINK *Sink);
+EFI_STATUS WriteRawSamples(RAW_SAMPLES *Raw, OUTPUT_SINK *Sink, UINT32 HorRes, UINT32 VerRes, CONST CHAR16 *Test, CONST CHAR16 *Run, UINT32 Trial);
+
+#endif // RAW_H
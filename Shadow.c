@@ -0,0 +1,184 @@
+/*
+ * File:    Shadow.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * System memory shadow of the screen with dirty rectangle flush
+ */
+
+#include <Uefi.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/BaseMemoryLib.h>
+#include "Shadow.h"
+
+STATIC UINT64 RectArea(IN CONST SHADOW_RECT *r);
+STATIC VOID RectUnion(IN CONST SHADOW_RECT *a, IN CONST SHADOW_RECT *b, OUT SHADOW_RECT *u);
+STATIC VOID CoalesceDirty(IN SHADOW_BUFFER *Shadow);
+
+/*
+ * CreateShadowBuffer() - Shadow of the whole screen in the current mode
+ */
+EFI_STATUS CreateShadowBuffer(OUT SHADOW_BUFFER *Shadow)
+{
+    EFI_STATUS Status;
+
+    ZeroMem(Shadow, sizeof(SHADOW_BUFFER));
+    Status = gBS->LocateProtocol(&gEfiGraphicsOutputProtocolGuid, NULL, (VOID **)&Shadow->Gop);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    Shadow->Width = Shadow->Gop->Mode->Info->HorizontalResolution;
+    Shadow->Height = Shadow->Gop->Mode->Info->VerticalResolution;
+    UINTN Size = (UINTN)Shadow->Width * Shadow->Height * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+    Status = ArenaCreate(&Shadow->Arena, Size);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    Shadow->Pixels = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)ArenaAlloc(&Shadow->Arena, Size, 0);
+    ResetShadowBuffer(Shadow, 0, 0, Shadow->Width - 1, Shadow->Height - 1);
+    return EFI_SUCCESS;
+}
+
+/*
+ * DestroyShadowBuffer()
+ */
+VOID DestroyShadowBuffer(IN SHADOW_BUFFER *Shadow)
+{
+    ArenaDestroy(&Shadow->Arena);
+    ZeroMem(Shadow, sizeof(SHADOW_BUFFER));
+}
+
+/*
+ * ResetShadowBuffer() - Clear to black with nothing dirty, as a cleared
+ *                       screen, and set the clip window
+ */
+VOID ResetShadowBuffer(IN SHADOW_BUFFER *Shadow, IN INT32 ClipX0, IN INT32 ClipY0, IN INT32 ClipX1, IN INT32 ClipY1)
+{
+    ZeroMem(Shadow->Pixels, (UINTN)Shadow->Width * Shadow->Height * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    ZeroMem(&Shadow->Stats, sizeof(SHADOW_FLUSH_STATS));
+    Shadow->NumDirty = 0;
+    // Blt pixels are 32-bit BGR
+    Shadow->Target.FrameBuffer = (UINT32 *)Shadow->Pixels;
+    Shadow->Target.Stride = Shadow->Width;
+    Shadow->Target.SwapRB = FALSE;
+    Shadow->Target.ClipX0 = MAX(ClipX0, 0);
+    Shadow->Target.ClipY0 = MAX(ClipY0, 0);
+    Shadow->Target.ClipX1 = MIN(ClipX1, (INT32)Shadow->Width - 1);
+    Shadow->Target.ClipY1 = MIN(ClipY1, (INT32)Shadow->Height - 1);
+}
+
+/*
+ * RectArea()
+ */
+STATIC UINT64 RectArea(IN CONST SHADOW_RECT *r)
+{
+    return (UINT64)(r->x1 - r->x0 + 1) * (UINT64)(r->y1 - r->y0 + 1);
+}
+
+/*
+ * RectUnion() - Bounding box of two rectangles
+ */
+STATIC VOID RectUnion(IN CONST SHADOW_RECT *a, IN CONST SHADOW_RECT *b, OUT SHADOW_RECT *u)
+{
+    u->x0 = MIN(a->x0, b->x0);
+    u->y0 = MIN(a->y0, b->y0);
+    u->x1 = MAX(a->x1, b->x1);
+    u->y1 = MAX(a->y1, b->y1);
+}
+
+/*
+ * ShadowMarkDirty() - Add a drawn bounding box, corners in any order
+ */
+VOID ShadowMarkDirty(IN SHADOW_BUFFER *Shadow, IN INT32 x0, IN INT32 y0, IN INT32 x1, IN INT32 y1)
+{
+    SHADOW_RECT r;
+
+    r.x0 = MAX(MIN(x0, x1), Shadow->Target.ClipX0);
+    r.y0 = MAX(MIN(y0, y1), Shadow->Target.ClipY0);
+    r.x1 = MIN(MAX(x0, x1), Shadow->Target.ClipX1);
+    r.y1 = MIN(MAX(y0, y1), Shadow->Target.ClipY1);
+    if (r.x0 > r.x1 || r.y0 > r.y1) {
+        return;
+    }
+    // a rectangle needing no extra pixels already holds it, once full grow
+    // the one that needs the fewest
+    UINT32 Best = 0;
+    UINT64 BestGrowth = MAX_UINT64;
+    for (UINT32 i = 0; i < Shadow->NumDirty; i++) {
+        SHADOW_RECT u;
+        RectUnion(&Shadow->Dirty[i], &r, &u);
+        UINT64 Growth = RectArea(&u) - RectArea(&Shadow->Dirty[i]);
+        if (Growth < BestGrowth) {
+            BestGrowth = Growth;
+            Best = i;
+        }
+    }
+    if (BestGrowth == 0) {
+        return;
+    }
+    if (Shadow->NumDirty < MAX_DIRTY_RECTS) {
+        Shadow->Dirty[Shadow->NumDirty++] = r;
+        return;
+    }
+    RectUnion(&Shadow->Dirty[Best], &r, &Shadow->Dirty[Best]);
+}
+
+/*
+ * CoalesceDirty() - Merge pairs of dirty rectangles until no merge copies
+ *                   fewer pixels than a Blt call costs
+ *
+ * Overlapping rectangles are always merged, since the sum of their areas
+ * counts the overlap twice.
+ */
+STATIC VOID CoalesceDirty(IN SHADOW_BUFFER *Shadow)
+{
+    BOOLEAN Merged = TRUE;
+
+    while (Merged) {
+        Merged = FALSE;
+        for (UINT32 i = 0; i < Shadow->NumDirty; i++) {
+            UINT32 j = i + 1;
+            while (j < Shadow->NumDirty) {
+                SHADOW_RECT u;
+                RectUnion(&Shadow->Dirty[i], &Shadow->Dirty[j], &u);
+                if (RectArea(&u) <= RectArea(&Shadow->Dirty[i]) + RectArea(&Shadow->Dirty[j]) + SHADOW_BLT_PIXELS) {
+                    Shadow->Dirty[i] = u;
+                    Shadow->Dirty[j] = Shadow->Dirty[--Shadow->NumDirty];
+                    Merged = TRUE;
+                } else {
+                    j++;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * FlushShadowBuffer() - Copy dirty rectangles to the screen, one Blt each
+ */
+EFI_STATUS FlushShadowBuffer(IN SHADOW_BUFFER *Shadow)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+
+    if (!Shadow->NumDirty) {
+        return EFI_SUCCESS;
+    }
+    CoalesceDirty(Shadow);
+    UINTN Delta = (UINTN)Shadow->Width * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+    for (UINT32 i = 0; i < Shadow->NumDirty; i++) {
+        SHADOW_RECT *r = &Shadow->Dirty[i];
+        UINTN Width = r->x1 - r->x0 + 1;
+        UINTN Height = r->y1 - r->y0 + 1;
+        Status = Shadow->Gop->Blt(Shadow->Gop, Shadow->Pixels, EfiBltBufferToVideo, r->x0, r->y0, r->x0, r->y0, Width, Height, Delta);
+        if (EFI_ERROR(Status)) {
+            break;
+        }
+        Shadow->Stats.Blts++;
+        Shadow->Stats.Pixels += (UINT64)Width * Height;
+    }
+    Shadow->Stats.Flushes++;
+    Shadow->NumDirty = 0;
+    return Status;
+}
@@ -0,0 +1,59 @@
+/*
+ * File:    Shadow.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * System memory shadow of the screen with dirty rectangle flush
+ *
+ * Drawing goes to the shadow through its batch target and each primitive
+ * marks its bounding box dirty. FlushShadowBuffer() merges dirty rectangles
+ * where the pixels wasted by the merge cost less than another Blt call, then
+ * copies each to the screen with one GOP Blt. Once MAX_DIRTY_RECTS are held
+ * a new rectangle is merged into the one it grows least. The shadow holds
+ * Blt pixels, so it can be flushed in any pixel format, BltOnly included.
+ */
+
+#ifndef SHADOW_H
+#define SHADOW_H
+
+#include <Uefi.h>
+#include <Protocol/GraphicsOutput.h>
+#include "Arena.h"
+#include "Batch.h"
+
+#define MAX_DIRTY_RECTS     32
+#define SHADOW_BLT_PIXELS   4096    // cost of a Blt call in pixels copied
+
+// dirty rectangle, inclusive
+typedef struct {
+    INT32 x0, y0, x1, y1;
+} SHADOW_RECT;
+
+typedef struct {
+    UINT32 Flushes;     // flushes with dirty rectangles
+    UINT32 Blts;        // Blt calls
+    UINT64 Pixels;      // pixels copied to the screen
+    UINT64 TimeNs;      // time taken by flushes (ns), set by the caller
+} SHADOW_FLUSH_STATS;
+
+typedef struct {
+    EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop;
+    ARENA Arena;
+    EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Pixels;
+    UINT32 Width;
+    UINT32 Height;
+    BATCH_TARGET Target;    // draws to the shadow, its clip window also bounds dirty rectangles
+    SHADOW_RECT Dirty[MAX_DIRTY_RECTS];
+    UINT32 NumDirty;
+    SHADOW_FLUSH_STATS Stats;
+} SHADOW_BUFFER;
+
+EFI_STATUS CreateShadowBuffer(OUT SHADOW_BUFFER *Shadow);
+VOID DestroyShadowBuffer(IN SHADOW_BUFFER *Shadow);
+VOID ResetShadowBuffer(IN SHADOW_BUFFER *Shadow, IN INT32 ClipX0, IN INT32 ClipY0, IN INT32 ClipX1, IN INT32 ClipY1);
+VOID ShadowMarkDirty(IN SHADOW_BUFFER *Shadow, IN INT32 x0, IN INT32 y0, IN INT32 x1, IN INT32 y1);
+EFI_STATUS FlushShadowBuffer(IN SHADOW_BUFFER *Shadow);
+
+#endif // SHADOW_H
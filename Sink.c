@@ -0,0 +1,102 @@
+/*
+ * File:    Sink.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Buffered text output to a file, or unbuffered to the console
+ */
+
+#include <Uefi.h>
+#include <Library/UefiLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/PrintLib.h>
+#include <Library/ShellLib.h>
+#include "Sink.h"
+
+/*
+ * CreateSink() - Sink writing to an open file, or the console if FileHandle
+ *                is NULL in which case Size is ignored
+ */
+EFI_STATUS CreateSink(OUT OUTPUT_SINK *Sink, IN SHELL_FILE_HANDLE FileHandle, IN UINTN Size)
+{
+    EFI_STATUS Status;
+
+    ZeroMem(Sink, sizeof(OUTPUT_SINK));
+    if (!FileHandle) {
+        return EFI_SUCCESS;
+    }
+    if (Size < SINK_MAX_LINE) {
+        Size = SINK_MAX_LINE;
+    }
+    Status = ArenaCreate(&Sink->Arena, Size);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    Sink->Buffer = (CHAR8 *)ArenaAlloc(&Sink->Arena, Size, 0);
+    Sink->Size = Size;
+    Sink->FileHandle = FileHandle;
+    return EFI_SUCCESS;
+}
+
+/*
+ * DestroySink() - Free the buffer, unflushed output is lost and the file is
+ *                 left open
+ */
+VOID DestroySink(IN OUTPUT_SINK *Sink)
+{
+    ArenaDestroy(&Sink->Arena);
+    ZeroMem(Sink, sizeof(OUTPUT_SINK));
+}
+
+/*
+ * FlushSink() - Write buffered output to the file
+ */
+EFI_STATUS FlushSink(IN OUTPUT_SINK *Sink)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+
+    if (Sink && Sink->Used) {
+        UINTN Len = Sink->Used;
+        Sink->Used = 0;
+        Status = ShellWriteFile(Sink->FileHandle, &Len, Sink->Buffer);
+        Sink->Written += Len;
+    }
+    return Status;
+}
+
+/*
+ * SinkVPrint() - Format to the buffer, or the console if Sink is NULL or has
+ *                no file
+ */
+EFI_STATUS SinkVPrint(IN OUTPUT_SINK *Sink, IN CONST CHAR16 *FormatString, IN VA_LIST Marker)
+{
+    EFI_STATUS Status = EFI_SUCCESS;
+
+    if (!Sink || !Sink->FileHandle) {
+        CHAR8 Line[SINK_MAX_LINE];
+        AsciiVSPrintUnicodeFormat(Line, sizeof(Line), FormatString, Marker);
+        AsciiPrint("%a", Line);
+        return EFI_SUCCESS;
+    }
+    if (Sink->Size - Sink->Used < SINK_MAX_LINE) {
+        Status = FlushSink(Sink);
+    }
+    Sink->Used += AsciiVSPrintUnicodeFormat(&Sink->Buffer[Sink->Used], SINK_MAX_LINE, FormatString, Marker);
+    return Status;
+}
+
+/*
+ * SinkPrint()
+ */
+EFI_STATUS EFIAPI SinkPrint(IN OUTPUT_SINK *Sink, IN CONST CHAR16 *FormatString, ...)
+{
+    EFI_STATUS Status;
+    VA_LIST Marker;
+
+    VA_START(Marker, FormatString);
+    Status = SinkVPrint(Sink, FormatString, Marker);
+    VA_END(Marker);
+    return Status;
+}
@@ -0,0 +1,40 @@
+/*
+ * File:    Sink.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Buffered text output to a file, or unbuffered to the console
+ *
+ * Formatting goes straight into a large arena buffer which is written to the
+ * file in one call when it can't hold another SINK_MAX_LINE bytes, and on
+ * FlushSink(). Formats are Unicode as for Print(), output is ASCII.
+ */
+
+#ifndef SINK_H
+#define SINK_H
+
+#include <Uefi.h>
+#include <Library/ShellLib.h>
+#include "Arena.h"
+
+#define SINK_DEFAULT_SIZE   (1024 * 1024)
+#define SINK_MAX_LINE       1024        // longest single formatted write
+
+typedef struct {
+    SHELL_FILE_HANDLE FileHandle;       // NULL for console
+    ARENA Arena;
+    CHAR8 *Buffer;
+    UINTN Size;
+    UINTN Used;
+    UINT64 Written;                     // bytes written to the file
+} OUTPUT_SINK;
+
+EFI_STATUS CreateSink(OUT OUTPUT_SINK *Sink, IN SHELL_FILE_HANDLE FileHandle, IN UINTN Size);
+VOID DestroySink(IN OUTPUT_SINK *Sink);
+EFI_STATUS FlushSink(IN OUTPUT_SINK *Sink);
+EFI_STATUS SinkVPrint(IN OUTPUT_SINK *Sink, IN CONST CHAR16 *FormatString, IN VA_LIST Marker);
+EFI_STATUS EFIAPI SinkPrint(IN OUTPUT_SINK *Sink, IN CONST CHAR16 *FormatString, ...);
+
+#endif // SINK_H
@@ -0,0 +1,193 @@
+/*
+ * File:    Stats.c
+ * 
+ * Author:  David Petrovic
+ * 
+ * Description:
+ * 
+ * Summary statistics over repeated trials and least squares line fit
+ */
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include "Stats.h"
+
+// Student's t two-sided 95% critical values (x1000) indexed by degrees of
+// freedom 1..30, the normal value is used beyond that
+STATIC CONST UINT16 TTable[] = {
+    12706, 4303, 3182, 2776, 2571, 2447, 2365, 2306, 2262, 2228,
+     2201, 2179, 2160, 2145, 2131, 2120, 2110, 2101, 2093, 2086,
+     2080, 2074, 2069, 2064, 2060, 2056, 2052, 2048, 2045, 2042
+};
+#define T_NORMAL 1960
+
+STATIC VOID SortValues(IN UINT64 *Values, IN UINT32 Num, OUT UINT64 *Sorted);
+STATIC UINT64 MedianOfSorted(IN UINT64 *Sorted, IN UINT32 Num);
+
+/*
+ * ISqrt64() - Integer square root, rounded down
+ */
+UINT64 ISqrt64(UINT64 Value)
+{
+    if (Value < 2) {
+        return Value;
+    }
+    UINT64 x = LShiftU64(1, (HighBitSet64(Value) / 2) + 1);    // >= sqrt(Value)
+    while (TRUE) {
+        UINT64 y = (x + Value / x) / 2;
+        if (y >= x) {
+            return x;
+        }
+        x = y;
+    }
+}
+
+/*
+ * SortValues() - Insertion sort a copy of Num values
+ */
+STATIC VOID SortValues(IN UINT64 *Values, IN UINT32 Num, OUT UINT64 *Sorted)
+{
+    for (UINT32 i = 0; i < Num; i++) {
+        UINT64 v = Values[i];
+        UINT32 j = i;
+        while (j > 0 && Sorted[j-1] > v) {
+            Sorted[j] = Sorted[j-1];
+            j--;
+        }
+        Sorted[j] = v;
+    }
+}
+
+/*
+ * MedianOfSorted()
+ */
+STATIC UINT64 MedianOfSorted(IN UINT64 *Sorted, IN UINT32 Num)
+{
+    return (Num & 1) ? Sorted[Num/2] : (Sorted[Num/2 - 1] + Sorted[Num/2] + 1) / 2;
+}
+
+/*
+ * ComputeStats() - Values is not modified
+ *
+ * Outliers, such as a trial disturbed by an SMI, are rejected by the median
+ * absolute deviation, which one outlier can't inflate as it does the
+ * standard deviation. With a MAD of 0, when most trials are equal, nothing
+ * is rejected.
+ */
+VOID ComputeStats(IN UINT64 *Values, IN UINT32 Num, OUT STATS *Stats)
+{
+    UINT64 Sorted[MAX_TRIALS];
+
+    ZeroMem(Stats, sizeof(STATS));
+    if (!Num) {
+        return;
+    }
+    if (Num > MAX_TRIALS) {
+        Num = MAX_TRIALS;
+    }
+    Stats->Trials = Num;
+
+    // sorted copy for min/max/median
+    SortValues(Values, Num, Sorted);
+    Stats->Min = Sorted[0];
+    Stats->Max = Sorted[Num-1];
+    Stats->Median = MedianOfSorted(Sorted, Num);
+
+    // values kept within OUTLIER_MADS scaled MADs of the median
+    UINT64 Kept[MAX_TRIALS];
+    UINT32 NumKept = Num;
+    CopyMem(Kept, Values, Num * sizeof(UINT64));
+    if (Num >= MIN_OUTLIER_TRIALS) {
+        UINT64 Dev[MAX_TRIALS];
+        for (UINT32 i = 0; i < Num; i++) {
+            Dev[i] = Values[i] > Stats->Median ? Values[i] - Stats->Median : Stats->Median - Values[i];
+        }
+        SortValues(Dev, Num, Sorted);
+        UINT64 Mad = MedianOfSorted(Sorted, Num);
+        UINT64 Limit = (Mad * OUTLIER_MADS * MAD_SCALE_X10000 + 5000) / 10000;
+        if (Mad) {
+            NumKept = 0;
+            for (UINT32 i = 0; i < Num; i++) {
+                if (Dev[i] <= Limit) {
+                    Kept[NumKept++] = Values[i];
+                }
+            }
+        }
+    }
+    Stats->Rejected = Num - NumKept;
+
+    UINT64 Sum = 0;
+    for (UINT32 i = 0; i < NumKept; i++) {
+        Sum += Kept[i];
+    }
+    Stats->Mean = (Sum + NumKept/2) / NumKept;
+    if (NumKept < 2) {
+        return;
+    }
+
+    // sum of squared deviations, Values are iteration rates so well within range
+    UINT64 SumSq = 0;
+    for (UINT32 i = 0; i < NumKept; i++) {
+        UINT64 Dev = Kept[i] > Stats->Mean ? Kept[i] - Stats->Mean : Stats->Mean - Kept[i];
+        SumSq += Dev * Dev;
+    }
+    Stats->StdDev = ISqrt64(SumSq / (NumKept - 1));
+    UINT32 Df = NumKept - 1;
+    UINT64 T = Df <= ARRAY_SIZE(TTable) ? TTable[Df - 1] : T_NORMAL;
+    Stats->Ci95 = Stats->StdDev * T / ISqrt64((UINT64)NumKept * 1000000);    // t x s / sqrt(n)
+}
+
+/*
+ * FitLinear() - Ordinary least squares for a handful of points
+ *
+ * Sums are exact in 64 bits for up to 8 points with x up to 2^22 and y up to
+ * 2^34 (e.g. pixels and picoseconds per call), the slope keeps its fraction
+ * from the remainder of the division.
+ */
+VOID FitLinear(IN UINT64 *x, IN UINT64 *y, IN UINT32 Num, OUT LINEAR_FIT *Fit)
+{
+    ZeroMem(Fit, sizeof(LINEAR_FIT));
+    Fit->Points = Num;
+    if (!Num) {
+        return;
+    }
+
+    INT64 Sx = 0, Sy = 0, Sxx = 0, Sxy = 0;
+    UINT64 MaxY = 0;
+    for (UINT32 i = 0; i < Num; i++) {
+        Sx += (INT64)x[i];
+        Sy += (INT64)y[i];
+        Sxx += (INT64)(x[i] * x[i]);
+        Sxy += (INT64)(x[i] * y[i]);
+        if (y[i] > MaxY) {
+            MaxY = y[i];
+        }
+    }
+    INT64 Den = (INT64)Num * Sxx - Sx * Sx;
+    if (Den <= 0) {
+        // all x equal, no slope
+        Fit->Intercept = Sy / Num;
+        return;
+    }
+    INT64 Numer = (INT64)Num * Sxy - Sx * Sy;
+    Fit->Slope = (Numer / Den) * (1 << FIT_FP_SHIFT) + (Numer % Den) * (1 << FIT_FP_SHIFT) / Den;
+    Fit->Intercept = (Sy - Fit->Slope * Sx / (1 << FIT_FP_SHIFT)) / Num;
+
+    // residuals scaled so squares of up to MAX_TRIALS points stay in range
+    INT64 Scale = (INT64)(MaxY >> 24) + 1;
+    INT64 MeanY = Sy / Num;
+    UINT64 SsRes = 0, SsTot = 0;
+    for (UINT32 i = 0; i < Num; i++) {
+        INT64 Pred = Fit->Intercept + Fit->Slope * (INT64)x[i] / (1 << FIT_FP_SHIFT);
+        INT64 Res = ((INT64)y[i] - Pred) / Scale;
+        INT64 Dev = ((INT64)y[i] - MeanY) / Scale;
+        SsRes += (UINT64)(Res * Res);
+        SsTot += (UINT64)(Dev * Dev);
+    }
+    if (!SsTot) {
+        Fit->R2 = 1000;
+    } else if (SsRes < SsTot) {
+        Fit->R2 = (UINT32)(1000 - SsRes * 1000 / SsTot);
+    }
+}
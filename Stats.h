@@ -0,0 +1,50 @@
+/*
+ * File:    Stats.h
+ * 
+ * Author:  David Petrovic
+ *
+ * Description:
+ * 
+ * Summary statistics over repeated trials and least squares line fit
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <Uefi.h>
+
+#define MAX_TRIALS  100
+
+// trials further than this many scaled MADs from the median are outliers,
+// the MAD is scaled by 1.4826 to estimate the standard deviation
+#define OUTLIER_MADS        3
+#define MAD_SCALE_X10000    14826
+#define MIN_OUTLIER_TRIALS  5       // fewer trials are all kept
+
+// Min, Max and Median are over all values, Mean, StdDev and Ci95 over the
+// values kept after rejecting outliers
+typedef struct {
+    UINT32 Trials;      // number of values
+    UINT32 Rejected;    // outliers left out of Mean, StdDev and Ci95
+    UINT64 Mean;
+    UINT64 StdDev;      // sample standard deviation
+    UINT64 Min;
+    UINT64 Max;
+    UINT64 Median;
+    UINT64 Ci95;        // half width of 95% confidence interval of the mean
+} STATS;
+
+// least squares fit of y = Intercept + Slope * x
+#define FIT_FP_SHIFT    10      // slope fixed point fraction bits
+typedef struct {
+    UINT32 Points;      // number of points fitted
+    INT64 Intercept;    // y units
+    INT64 Slope;        // y units per x unit in FIT_FP_SHIFT fixed point
+    UINT32 R2;          // coefficient of determination x1000
+} LINEAR_FIT;
+
+VOID ComputeStats(IN UINT64 *Values, IN UINT32 Num, OUT STATS *Stats);
+VOID FitLinear(IN UINT64 *x, IN UINT64 *y, IN UINT32 Num, OUT LINEAR_FIT *Fit);
+UINT64 ISqrt64(UINT64 Value);
+
+#endif // STATS_H
@@ -0,0 +1,291 @@
+/*
+ * File:    StringCache.c
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Least recently used cache of rendered strings
+ */
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include "StringCache.h"
+
+STATIC UINT32 HashString(IN FONT Font, IN CONST CHAR16 *String, IN UINT32 Fg, IN UINT32 Bg, IN BOOLEAN Opaque);
+STATIC VOID UnlinkEntry(IN STRING_CACHE *Cache, IN STRING_ENTRY *Entry);
+STATIC VOID LinkNewest(IN STRING_CACHE *Cache, IN STRING_ENTRY *Entry);
+STATIC VOID FreeEntry(IN STRING_CACHE *Cache, IN STRING_ENTRY *Entry);
+STATIC BOOLEAN MakeRoom(IN STRING_CACHE *Cache, IN UINTN Bytes);
+STATIC VOID DrawGlyphRuns(IN STRING_ENTRY *Entry, IN GLYPH *Glyph, IN UINT32 x, IN UINT32 *RowEnd);
+STATIC STRING_ENTRY *RenderString(IN STRING_CACHE *Cache, IN UINT32 Hash, IN FONT Font, IN CONST CHAR16 *String, IN UINT32 Fg, IN UINT32 Bg, IN BOOLEAN Opaque);
+
+/*
+ * CreateStringCache() - Empty cache holding up to MaxBytes of strings
+ *                       rendered from glyphs of Glyphs
+ */
+VOID CreateStringCache(OUT STRING_CACHE *Cache, IN GLYPH_CACHE *Glyphs, IN UINTN MaxBytes)
+{
+    ZeroMem(Cache, sizeof(STRING_CACHE));
+    Cache->Glyphs = Glyphs;
+    Cache->MaxBytes = MaxBytes;
+}
+
+/*
+ * DestroyStringCache()
+ */
+VOID DestroyStringCache(IN STRING_CACHE *Cache)
+{
+    while (Cache->Oldest) {
+        FreeEntry(Cache, Cache->Oldest);
+    }
+    ZeroMem(Cache, sizeof(STRING_CACHE));
+}
+
+/*
+ * HashString() - FNV-1a of the characters, then the font and colours
+ */
+STATIC UINT32 HashString(IN FONT Font, IN CONST CHAR16 *String, IN UINT32 Fg, IN UINT32 Bg, IN BOOLEAN Opaque)
+{
+    UINT32 Hash = 2166136261u;
+
+    for (; *String; String++) {
+        Hash = (Hash ^ *String) * 16777619u;
+    }
+    Hash = (Hash ^ (UINT32)Font) * 16777619u;
+    Hash = (Hash ^ Fg) * 16777619u;
+    Hash = (Hash ^ Bg) * 16777619u;
+    return (Hash ^ Opaque) * 16777619u;
+}
+
+/*
+ * UnlinkEntry() - Take an entry out of the least recently used list
+ */
+STATIC VOID UnlinkEntry(IN STRING_CACHE *Cache, IN STRING_ENTRY *Entry)
+{
+    if (Entry->Newer) {
+        Entry->Newer->Older = Entry->Older;
+    } else {
+        Cache->Newest = Entry->Older;
+    }
+    if (Entry->Older) {
+        Entry->Older->Newer = Entry->Newer;
+    } else {
+        Cache->Oldest = Entry->Newer;
+    }
+}
+
+/*
+ * LinkNewest() - Put an entry at the most recently used end of the list
+ */
+STATIC VOID LinkNewest(IN STRING_CACHE *Cache, IN STRING_ENTRY *Entry)
+{
+    Entry->Newer = NULL;
+    Entry->Older = Cache->Newest;
+    if (Cache->Newest) {
+        Cache->Newest->Newer = Entry;
+    } else {
+        Cache->Oldest = Entry;
+    }
+    Cache->Newest = Entry;
+}
+
+/*
+ * FreeEntry() - Remove an entry from the cache and free it
+ */
+STATIC VOID FreeEntry(IN STRING_CACHE *Cache, IN STRING_ENTRY *Entry)
+{
+    STRING_ENTRY **Link = &Cache->Hash[Entry->Hash & (STRING_HASH_BUCKETS - 1)];
+
+    while (*Link != Entry) {
+        Link = &(*Link)->HashNext;
+    }
+    *Link = Entry->HashNext;
+    UnlinkEntry(Cache, Entry);
+    Cache->Bytes -= Entry->Bytes;
+    FreePool(Entry);
+}
+
+/*
+ * MakeRoom() - Free the least recently used strings until Bytes more fit
+ *              under the cap, FALSE if they never would
+ */
+STATIC BOOLEAN MakeRoom(IN STRING_CACHE *Cache, IN UINTN Bytes)
+{
+    if (Bytes > Cache->MaxBytes) {
+        return FALSE;
+    }
+    while (Cache->Bytes + Bytes > Cache->MaxBytes) {
+        FreeEntry(Cache, Cache->Oldest);
+        Cache->Stats.Evictions++;
+    }
+    return TRUE;
+}
+
+/*
+ * DrawGlyphRuns() - Add the runs of a glyph at column x of a string, into
+ *                   the pixels if opaque or after the runs so far of each
+ *                   row, joined to a run ending at x
+ */
+STATIC VOID DrawGlyphRuns(IN STRING_ENTRY *Entry, IN GLYPH *Glyph, IN UINT32 x, IN UINT32 *RowEnd)
+{
+    for (UINT32 gy = 0; gy < Glyph->Height; gy++) {
+        for (UINT16 r = Glyph->RowRun[gy]; r < Glyph->RowRun[gy+1]; r++) {
+            UINT32 rx = x + Glyph->Runs[r].x;
+            UINT32 Length = Glyph->Runs[r].Length;
+            if (Entry->Pixels) {
+                UINT32 *Row = &Entry->Pixels[gy * Entry->Width];
+                for (UINT32 i = rx; i < rx + Length; i++) {
+                    Row[i] = Entry->Fg;
+                }
+                continue;
+            }
+            STRING_RUN *Last = (RowEnd[gy] > Entry->RowRun[gy]) ? &Entry->Runs[RowEnd[gy] - 1] : NULL;
+            if (Last && Last->x + Last->Length == rx) {
+                Last->Length += (UINT16)Length;
+            } else {
+                Entry->Runs[RowEnd[gy]].x = (UINT16)rx;
+                Entry->Runs[RowEnd[gy]].Length = (UINT16)Length;
+                RowEnd[gy]++;
+            }
+        }
+    }
+}
+
+/*
+ * RenderString() - Draw a string from its glyphs into a new entry, NULL if
+ *                  it can't be cached
+ *
+ * The glyphs are looked up twice, to size the entry then draw it, rather
+ * than held, as the glyph cache may free them between lookups.
+ */
+STATIC STRING_ENTRY *RenderString(IN STRING_CACHE *Cache, IN UINT32 Hash, IN FONT Font, IN CONST CHAR16 *String, IN UINT32 Fg, IN UINT32 Bg, IN BOOLEAN Opaque)
+{
+    UINT32 RowRuns[GLYPH_MAX_HEIGHT] = { 0 };
+    UINT32 Width = 0;
+    UINT32 Height = 0;
+    UINTN Length = StrLen(String);
+
+    for (UINTN i = 0; i < Length; i++) {
+        GLYPH *Glyph = GetGlyph(Cache->Glyphs, Font, String[i]);
+        if (!Glyph) {
+            return NULL;
+        }
+        Width += Glyph->Width;
+        Height = MAX(Height, Glyph->Height);
+        for (UINT32 gy = 0; gy < Glyph->Height; gy++) {
+            RowRuns[gy] += Glyph->RowRun[gy+1] - Glyph->RowRun[gy];
+        }
+    }
+    if (!Width || Width > STRING_MAX_WIDTH) {
+        return NULL;
+    }
+
+    // pixels or runs, then the characters, after the entry
+    UINTN NumRuns = 0;
+    for (UINT32 gy = 0; gy < Height; gy++) {
+        NumRuns += RowRuns[gy];
+    }
+    UINTN DataBytes = Opaque ? (UINTN)Width * Height * sizeof(UINT32) : NumRuns * sizeof(STRING_RUN);
+    UINTN Bytes = sizeof(STRING_ENTRY) + DataBytes + (Length + 1) * sizeof(CHAR16);
+    if (!MakeRoom(Cache, Bytes)) {
+        return NULL;
+    }
+    STRING_ENTRY *Entry = AllocateZeroPool(Bytes);
+    if (!Entry) {
+        return NULL;
+    }
+    Entry->Hash = Hash;
+    Entry->Font = Font;
+    Entry->Fg = Fg;
+    Entry->Bg = Bg;
+    Entry->Opaque = Opaque;
+    Entry->Width = Width;
+    Entry->Height = Height;
+    Entry->String = (CHAR16 *)((UINT8 *)(Entry + 1) + DataBytes);
+    Entry->Bytes = Bytes;
+    CopyMem(Entry->String, String, (Length + 1) * sizeof(CHAR16));
+    if (Opaque) {
+        Entry->Pixels = (UINT32 *)(Entry + 1);
+        for (UINTN i = 0; i < (UINTN)Width * Height; i++) {
+            Entry->Pixels[i] = Bg;
+        }
+    } else {
+        // each row has room for the runs of all its glyphs unjoined
+        Entry->Runs = (STRING_RUN *)(Entry + 1);
+        for (UINT32 gy = 0; gy < Height; gy++) {
+            Entry->RowRun[gy+1] = Entry->RowRun[gy] + RowRuns[gy];
+        }
+    }
+
+    UINT32 RowEnd[GLYPH_MAX_HEIGHT];
+    CopyMem(RowEnd, Entry->RowRun, sizeof(RowEnd));
+    UINT32 x = 0;
+    for (UINTN i = 0; i < Length; i++) {
+        GLYPH *Glyph = GetGlyph(Cache->Glyphs, Font, String[i]);
+        if (!Glyph) {
+            FreePool(Entry);
+            return NULL;
+        }
+        DrawGlyphRuns(Entry, Glyph, x, RowEnd);
+        x += Glyph->Width;
+    }
+
+    // close the gaps left by joined runs
+    if (!Opaque) {
+        UINT32 Run = 0;
+        for (UINT32 gy = 0; gy < Height; gy++) {
+            UINT32 Start = Run;
+            for (UINT32 r = Entry->RowRun[gy]; r < RowEnd[gy]; r++) {
+                Entry->Runs[Run++] = Entry->Runs[r];
+            }
+            Entry->RowRun[gy] = Start;
+        }
+        Entry->RowRun[Height] = Run;
+    }
+
+    Cache->Bytes += Bytes;
+    if (Cache->Bytes > Cache->Stats.PeakBytes) {
+        Cache->Stats.PeakBytes = Cache->Bytes;
+    }
+    return Entry;
+}
+
+/*
+ * GetStringEntry() - Cached rendering of a string in framebuffer pixel
+ *                    colours, rendered on a miss, NULL if it can't be cached
+ */
+CONST STRING_ENTRY *GetStringEntry(IN STRING_CACHE *Cache, IN FONT Font, IN CONST CHAR16 *String, IN UINT32 Fg, IN UINT32 Bg, IN BOOLEAN Opaque)
+{
+    STRING_ENTRY *Entry;
+
+    Opaque = Opaque ? TRUE : FALSE;
+    if (!Opaque) {
+        Bg = 0;
+    }
+    UINT32 Hash = HashString(Font, String, Fg, Bg, Opaque);
+    STRING_ENTRY **Bucket = &Cache->Hash[Hash & (STRING_HASH_BUCKETS - 1)];
+    for (Entry = *Bucket; Entry; Entry = Entry->HashNext) {
+        if (Entry->Hash == Hash && Entry->Font == Font && Entry->Fg == Fg && Entry->Bg == Bg &&
+            Entry->Opaque == Opaque && StrCmp(Entry->String, String) == 0) {
+            Cache->Stats.Hits++;
+            if (Entry != Cache->Newest) {
+                UnlinkEntry(Cache, Entry);
+                LinkNewest(Cache, Entry);
+            }
+            return Entry;
+        }
+    }
+    Cache->Stats.Misses++;
+    Entry = RenderString(Cache, Hash, Font, String, Fg, Bg, Opaque);
+    if (!Entry) {
+        Cache->Stats.Uncached++;
+        return NULL;
+    }
+    Entry->HashNext = *Bucket;
+    *Bucket = Entry;
+    LinkNewest(Cache, Entry);
+    return Entry;
+}
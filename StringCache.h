@@ -0,0 +1,78 @@
+/*
+ * File:    StringCache.h
+ *
+ * Author:  David Petrovic
+ *
+ * Description:
+ *
+ * Least recently used cache of rendered strings
+ *
+ * UI code redraws the same labels every frame. A string is rendered once,
+ * from the glyphs of a glyph cache, and kept by its characters, font,
+ * colours and transparency. An opaque string is kept as a bitmap of
+ * framebuffer pixels, replayed by copying its rows. A transparent string has
+ * no background to copy, so is kept as runs of set pixels per row, the runs
+ * of neighbouring glyphs joined. Strings are found by hash and the least
+ * recently used are freed to keep the cache within its memory cap. Strings
+ * with a character the glyph cache can't hold, or too large for the cap,
+ * aren't cached.
+ */
+
+#ifndef STRING_CACHE_H
+#define STRING_CACHE_H
+
+#include <Uefi.h>
+#include "GraphicsLib/Graphics.h"
+#include "GlyphCache.h"
+
+#define STRING_CACHE_DEFAULT_KB 256
+#define STRING_HASH_BUCKETS     64      // power of 2
+#define STRING_MAX_WIDTH        0xFFFF  // wider strings aren't cached
+
+// run of set pixels in a row of a transparent string
+typedef struct {
+    UINT16 x;
+    UINT16 Length;
+} STRING_RUN;
+
+typedef struct _STRING_ENTRY STRING_ENTRY;
+struct _STRING_ENTRY {
+    STRING_ENTRY *HashNext;
+    STRING_ENTRY *Newer;    // least recently used list
+    STRING_ENTRY *Older;
+    UINT32 Hash;
+    FONT Font;
+    UINT32 Fg, Bg;          // framebuffer pixel values, Bg 0 if transparent
+    BOOLEAN Opaque;
+    UINT32 Width;
+    UINT32 Height;
+    UINT32 *Pixels;         // opaque, Width x Height
+    UINT32 RowRun[GLYPH_MAX_HEIGHT + 1];    // transparent, runs of row y are RowRun[y]...RowRun[y+1]-1
+    STRING_RUN *Runs;
+    CHAR16 *String;
+    UINTN Bytes;            // allocated for the entry
+};
+
+typedef struct {
+    UINT64 Hits;
+    UINT64 Misses;
+    UINT64 Evictions;       // strings freed for the memory cap
+    UINT64 Uncached;        // misses that couldn't be cached
+    UINT64 PeakBytes;       // most memory held
+} STRING_CACHE_STATS;
+
+typedef struct {
+    GLYPH_CACHE *Glyphs;    // strings are rendered from
+    UINTN MaxBytes;         // memory cap
+    UINTN Bytes;            // memory held
+    STRING_ENTRY *Hash[STRING_HASH_BUCKETS];
+    STRING_ENTRY *Newest;
+    STRING_ENTRY *Oldest;
+    STRING_CACHE_STATS Stats;
+} STRING_CACHE;
+
+VOID CreateStringCache(OUT STRING_CACHE *Cache, IN GLYPH_CACHE *Glyphs, IN UINTN MaxBytes);
+VOID DestroyStringCache(IN STRING_CACHE *Cache);
+CONST STRING_ENTRY *GetStringEntry(IN STRING_CACHE *Cache, IN FONT Font, IN CONST CHAR16 *String, IN UINT32 Fg, IN UINT32 Bg, IN BOOLEAN Opaque);
+
+#endif // STRING_CACHE_H
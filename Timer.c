@@ -9,6 +9,7 @@
  */
 
 #include <Uefi.h>
+#include <Library/BaseLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include "Timer.h"
 
@@ -19,9 +20,22 @@
 #define EDK2SIM_READ_TIMER
 #endif
 
-#define CAL_TIME 100    // calibration time in ms
+#define CAL_TIME 100            // calibration time in ms
+#define CRYSTAL_ERROR_PPM 100   // nominal crystal tolerance
+
+#define CPUID_TSC_LEAF      0x15
+#define CPUID_FREQ_LEAF     0x16
+#define CPUID_EXT_PM_LEAF   0x80000007
+#define CPUID_INVARIANT_TSC BIT8
 
 STATIC UINT64 gTscPerMs = 1;
+STATIC UINT64 gTscFreq = 1000;  // Hz
+STATIC UINT32 gTscErrorPpm = 0;
+STATIC TIMER_SOURCE gTscSource = TIMER_SRC_NONE;
+
+// firmware timer ticks seen by a periodic event
+STATIC EFI_EVENT gTickEvent = NULL;
+STATIC volatile UINT32 gTickCount = 0;
 
 /*
  * ReadTimer()
@@ -37,19 +51,91 @@ UINT64 ReadTimer()
 #endif
 }
 
+#if !EDK2SIM_SUPPORT
+/*
+ * CpuidTscFreq() - TSC frequency from CPUID if TSC is invariant, 0 if not available
+ */
+STATIC UINT64 CpuidTscFreq(TIMER_SOURCE *Source, UINT32 *ErrorPpm)
+{
+    UINT32 MaxLeaf, MaxExtLeaf;
+    UINT32 Eax, Ebx, Ecx, Edx;
+
+    AsmCpuid(0x80000000, &MaxExtLeaf, NULL, NULL, NULL);
+    if (MaxExtLeaf < CPUID_EXT_PM_LEAF) {
+        return 0;
+    }
+    AsmCpuid(CPUID_EXT_PM_LEAF, NULL, NULL, NULL, &Edx);
+    if (!(Edx & CPUID_INVARIANT_TSC)) {
+        return 0;
+    }
+    AsmCpuid(0, &MaxLeaf, NULL, NULL, NULL);
+    UINT32 BaseMhz = 0;
+    if (MaxLeaf >= CPUID_FREQ_LEAF) {
+        AsmCpuid(CPUID_FREQ_LEAF, &BaseMhz, NULL, NULL, NULL);
+        BaseMhz &= 0xFFFF;
+    }
+    if (MaxLeaf >= CPUID_TSC_LEAF) {
+        // TSC = crystal * EBX / EAX
+        AsmCpuid(CPUID_TSC_LEAF, &Eax, &Ebx, &Ecx, NULL);
+        if (Eax && Ebx && Ecx) {
+            *Source = TIMER_SRC_CPUID_CRYSTAL;
+            *ErrorPpm = CRYSTAL_ERROR_PPM;
+            return ((UINT64)Ecx * Ebx + Eax/2) / Eax;
+        }
+    }
+    if (BaseMhz) {
+        // base frequency reported to nearest MHz
+        *Source = TIMER_SRC_CPUID_BASE;
+        *ErrorPpm = (500000 + BaseMhz/2) / BaseMhz;
+        return (UINT64)BaseMhz * 1000000;
+    }
+    return 0;
+}
+
+/*
+ * StallTscFreq() - Measure TSC against boot services stall, error estimated
+ *                  from the difference between the two halves of the interval
+ */
+STATIC UINT64 StallTscFreq(UINT32 *ErrorPpm)
+{
+    UINT64 t0 = ReadTimer();
+    gBS->Stall(CAL_TIME * 1000 / 2); // us parameter
+    UINT64 t1 = ReadTimer();
+    gBS->Stall(CAL_TIME * 1000 / 2);
+    UINT64 t2 = ReadTimer();
+    UINT64 Half1 = t1 - t0;
+    UINT64 Half2 = t2 - t1;
+    UINT64 Diff = Half1 > Half2 ? Half1 - Half2 : Half2 - Half1;
+    *ErrorPpm = (UINT32)((Diff * 1000000 + (t2 - t0)/2) / (t2 - t0));
+    return ((t2 - t0) * 1000 + CAL_TIME/2) / CAL_TIME;
+}
+#endif
+
 /*
- * InitTimer()
+ * InitTimer() - Calibration is done once and cached for the process lifetime
  */
 VOID InitTimer(VOID)
 {
+    if (gTscSource != TIMER_SRC_NONE) {
+        return;
+    }
 #if EDK2SIM_SUPPORT
     gTscPerMs = EDK2SIM_INIT_TIMER;
+    gTscFreq = gTscPerMs * 1000;
+    gTscSource = TIMER_SRC_SIM;
 #else
-    // determine TSC interval
-    UINT64 counter = ReadTimer();
-    gBS->Stall(CAL_TIME * 1000); // us parameter
-    gTscPerMs = (ReadTimer() - counter + CAL_TIME/2)/CAL_TIME;
-//    Print(L"TSC/Sec: %ld\n", gTscPerMs);
+    TIMER_SOURCE Source;
+    UINT32 ErrorPpm;
+    UINT64 Freq = CpuidTscFreq(&Source, &ErrorPpm);
+    if (!Freq) {
+        Freq = StallTscFreq(&ErrorPpm);
+        Source = TIMER_SRC_STALL;
+    }
+    gTscFreq = Freq;
+    gTscPerMs = (Freq + 500) / 1000;
+    gTscErrorPpm = ErrorPpm;
+    gTscSource = Source;
+//    Print(L"TSC/Sec: %ld\n", gTscFreq);
 #endif
 }
 
@@ -60,3 +146,124 @@ UINT64 CalcMsTime(UINT64 end, UINT64 start)
 {
     return (end - start + gTscPerMs/2)/gTscPerMs;
 }
+
+/*
+ * CalcNsTime()
+ */
+UINT64 CalcNsTime(UINT64 end, UINT64 start)
+{
+    return CyclesToNs(end - start);
+}
+
+/*
+ * CyclesToNs() - Split to avoid overflow for long intervals
+ */
+UINT64 CyclesToNs(UINT64 cycles)
+{
+    UINT64 Secs = cycles / gTscFreq;
+    UINT64 Rem = cycles % gTscFreq;
+    return Secs * 1000000000 + (Rem * 1000000000 + gTscFreq/2) / gTscFreq;
+}
+
+/*
+ * GetTimerFreq() - TSC frequency in Hz
+ */
+UINT64 GetTimerFreq(VOID)
+{
+    return gTscFreq;
+}
+
+/*
+ * GetTimerErrorPpm() - Estimated calibration error in parts per million
+ */
+UINT32 GetTimerErrorPpm(VOID)
+{
+    return gTscErrorPpm;
+}
+
+/*
+ * GetTimerSource()
+ */
+TIMER_SOURCE GetTimerSource(VOID)
+{
+    return gTscSource;
+}
+
+/*
+ * GetTimerSourceDesc()
+ */
+CHAR16 *GetTimerSourceDesc(TIMER_SOURCE Source)
+{
+    switch (Source) {
+    case TIMER_SRC_CPUID_CRYSTAL:
+        return L"CPUID 0x15";
+    case TIMER_SRC_CPUID_BASE:
+        return L"CPUID 0x16";
+    case TIMER_SRC_STALL:
+        return L"Stall";
+    case TIMER_SRC_SIM:
+        return L"Simulator";
+    default:
+        break;
+    }
+    return L"None";
+}
+
+#if !EDK2SIM_SUPPORT
+/*
+ * TickNotify() - Runs at TPL_NOTIFY on each firmware timer tick
+ */
+STATIC VOID EFIAPI TickNotify(IN EFI_EVENT Event, IN VOID *Context)
+{
+    gTickCount++;
+}
+#endif
+
+/*
+ * StartTickCounter() - Count firmware timer ticks, a change in the count
+ *                      shows a timer interrupt was serviced in between
+ */
+EFI_STATUS StartTickCounter(VOID)
+{
+#if EDK2SIM_SUPPORT
+    return EFI_UNSUPPORTED;
+#else
+    EFI_STATUS Status = EFI_SUCCESS;
+
+    if (gTickEvent) {
+        goto Error_exit;
+    }
+    Status = gBS->CreateEvent(EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_NOTIFY, TickNotify, NULL, &gTickEvent);
+    if (EFI_ERROR(Status)) {
+        gTickEvent = NULL;
+        goto Error_exit;
+    }
+    // zero period signals on every tick
+    Status = gBS->SetTimer(gTickEvent, TimerPeriodic, 0);
+    if (EFI_ERROR(Status)) {
+        StopTickCounter();
+    }
+
+Error_exit:
+    return Status;
+#endif
+}
+
+/*
+ * StopTickCounter()
+ */
+VOID StopTickCounter(VOID)
+{
+    if (gTickEvent) {
+        gBS->CloseEvent(gTickEvent);
+        gTickEvent = NULL;
+    }
+}
+
+/*
+ * GetTickCount()
+ */
+UINT32 GetTickCount(VOID)
+{
+    return gTickCount;
+}
@@ -13,8 +13,26 @@
 
 #include <Uefi.h>
 
+// source of TSC frequency
+typedef enum {
+    TIMER_SRC_NONE=0,       // not calibrated
+    TIMER_SRC_CPUID_CRYSTAL,// CPUID 0x15 crystal clock and ratio
+    TIMER_SRC_CPUID_BASE,   // CPUID 0x16 processor base frequency
+    TIMER_SRC_STALL,        // measured against boot services stall
+    TIMER_SRC_SIM           // EDK2 simulator
+} TIMER_SOURCE;
+
 VOID InitTimer(VOID);
 UINT64 ReadTimer(VOID);
 UINT64 CalcMsTime(UINT64 end, UINT64 start);
+UINT64 CalcNsTime(UINT64 end, UINT64 start);
+UINT64 CyclesToNs(UINT64 cycles);
+UINT64 GetTimerFreq(VOID);
+UINT32 GetTimerErrorPpm(VOID);
+TIMER_SOURCE GetTimerSource(VOID);
+CHAR16 *GetTimerSourceDesc(TIMER_SOURCE Source);
+EFI_STATUS StartTickCounter(VOID);
+VOID StopTickCounter(VOID);
+UINT32 GetTickCount(VOID);
 
 #endif // TIMER_H
@@ -0,0 +1,63 @@
+/*
+ * File:    Workload.c
+ * 
+ * Author:  David Petrovic
+ * 
+ * Description:
+ * 
+ * Pre-generated test parameters held as a structure-of-arrays
+ */
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+#include "Workload.h"
+
+/*
+ * CreateWorkload() - Allocate all arrays from a single arena
+ */
+EFI_STATUS CreateWorkload(WORKLOAD *Wl, UINT32 Size, UINT32 NumParams)
+{
+    EFI_STATUS Status;
+
+    if (!Wl || !Size || NumParams > WL_MAX_PARAMS) {
+        return EFI_INVALID_PARAMETER;
+    }
+    ZeroMem(Wl, sizeof(WORKLOAD));
+    if (Size > WL_MAX_ENTRIES) {
+        Size = WL_MAX_ENTRIES;
+    }
+    UINTN ArraySize = ALIGN_VALUE((UINTN)Size * sizeof(UINT32), ARENA_DEFAULT_ALIGN);
+    Status = ArenaCreate(&Wl->Arena, (NumParams + 1) * ArraySize);
+    if (EFI_ERROR(Status)) {
+        return Status;
+    }
+    Wl->Size = Size;
+    Wl->NumParams = NumParams;
+    Wl->Colour = (UINT32 *)ArenaAlloc(&Wl->Arena, ArraySize, 0);
+    for (UINT32 n = 0; n < NumParams; n++) {
+        Wl->Param[n] = (INT32 *)ArenaAlloc(&Wl->Arena, ArraySize, 0);
+    }
+    return EFI_SUCCESS;
+}
+
+/*
+ * DestroyWorkload()
+ */
+VOID DestroyWorkload(WORKLOAD *Wl)
+{
+    if (Wl) {
+        ArenaDestroy(&Wl->Arena);
+        ZeroMem(Wl, sizeof(WORKLOAD));
+    }
+}
+
+/*
+ * SetWorkloadEntry()
+ */
+VOID SetWorkloadEntry(WORKLOAD *Wl, UINT32 Index, WORKLOAD_ENTRY *Entry)
+{
+    Wl->Colour[Index] = Entry->Colour;
+    for (UINT32 n = 0; n < Wl->NumParams; n++) {
+        Wl->Param[n][Index] = Entry->P[n];
+    }
+}
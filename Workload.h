@@ -0,0 +1,39 @@
+/*
+ * File:    Workload.h
+ * 
+ * Author:  David Petrovic
+ *
+ * Description:
+ * 
+ * Pre-generated test parameters held as a structure-of-arrays
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <Uefi.h>
+#include "Arena.h"
+
+#define WL_MAX_PARAMS   6           // max coordinate parameters per entry
+#define WL_MAX_ENTRIES  0x100000    // cap on number of entries (1M)
+
+// single set of test parameters
+typedef struct {
+    INT32 P[WL_MAX_PARAMS];
+    UINT32 Colour;
+} WORKLOAD_ENTRY;
+
+// pre-generated parameters, Param[n][i] is parameter n of entry i
+typedef struct {
+    ARENA Arena;
+    UINT32 Size;        // number of entries
+    UINT32 NumParams;   // number of parameter arrays in use
+    UINT32 *Colour;
+    INT32 *Param[WL_MAX_PARAMS];
+} WORKLOAD;
+
+EFI_STATUS CreateWorkload(WORKLOAD *Wl, UINT32 Size, UINT32 NumParams);
+VOID DestroyWorkload(WORKLOAD *Wl);
+VOID SetWorkloadEntry(WORKLOAD *Wl, UINT32 Index, WORKLOAD_ENTRY *Entry);
+
+#endif // WORKLOAD_H